@@ -0,0 +1,147 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Compares the range-coded arithmetic index for several bases with the
+// bit-sliced index for several precisions. For every combination of column,
+// index, and operator, the benchmark reports the append and lookup latency,
+// the memory usage, and the fraction of false positives that the candidate
+// check has to filter out.
+
+#include "bench.hpp"
+
+#include <vast/bitmap_algorithms.hpp>
+#include <vast/ids.hpp>
+#include <vast/index/arithmetic_index.hpp>
+#include <vast/index/bitslice_index.hpp>
+#include <vast/time.hpp>
+#include <vast/type.hpp>
+#include <vast/value_index.hpp>
+
+#include <caf/settings.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+using namespace vast;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr size_t num_lookups = 10;
+
+struct candidate {
+  std::string name;
+  std::function<value_index_ptr()> make;
+};
+
+template <class T>
+std::vector<candidate> candidates(const type& t) {
+  std::vector<candidate> result;
+  for (auto base : {"uniform64(2)", "uniform64(4)", "uniform64(8)",
+                    "uniform64(10)", "uniform64(16)"}) {
+    auto name = std::string{"range-"} + base;
+    result.push_back({std::move(name), [=] {
+                        caf::settings opts;
+                        opts["base"] = std::string{base};
+                        return value_index_ptr{
+                          std::make_unique<arithmetic_index<T>>(t, opts)};
+                      }});
+  }
+  for (auto precision : {0, 3, 6, 9}) {
+    auto name = "bitslice-" + std::to_string(precision);
+    result.push_back({std::move(name), [=] {
+                        caf::settings opts;
+                        opts["precision"] = int64_t{precision};
+                        return value_index_ptr{
+                          std::make_unique<bitslice_index<T>>(t, opts)};
+                      }});
+  }
+  return result;
+}
+
+template <class T>
+void run(bench::context& ctx, const std::string& column, const type& t,
+         const std::vector<T>& xs) {
+  using predicate = std::function<bool(const T&, const T&)>;
+  using op_type = std::tuple<relational_operator, const char*, predicate>;
+  auto ops = std::vector<op_type>{
+    {relational_operator::equal, "equal", std::equal_to<T>{}},
+    {relational_operator::less, "less", std::less<T>{}},
+    {relational_operator::greater_equal, "greater_equal",
+     std::greater_equal<T>{}},
+  };
+  auto rng = std::mt19937_64{ctx.opts().seed};
+  auto probes = std::vector<T>{};
+  for (size_t i = 0; i < num_lookups; ++i)
+    probes.push_back(xs[rng() % xs.size()]);
+  for (auto& c : candidates<T>(t)) {
+    auto prefix = "arithmetic_index." + column + '.' + c.name;
+    auto append = [&] {
+      auto idx = c.make();
+      for (const auto& x : xs)
+        if (!idx->append(make_data_view(x)))
+          std::abort();
+      return idx;
+    };
+    ctx.measure(prefix + ".append", xs.size(), append);
+    auto idx = append();
+    auto memusage = static_cast<double>(idx->memusage());
+    for (const auto& [op, op_name, pred] : ops) {
+      auto name = prefix + '.' + op_name;
+      if (!ctx.enabled(name))
+        continue;
+      uint64_t hits = 0;
+      uint64_t matches = 0;
+      for (const auto& probe : probes) {
+        auto result = idx->lookup(op, make_data_view(probe));
+        if (!result)
+          std::abort();
+        hits += rank(*result);
+        for (const auto& x : xs)
+          matches += pred(x, probe);
+      }
+      auto false_positives
+        = hits > 0 ? static_cast<double>(hits - matches) / hits : 0.0;
+      auto lookup = [&, op = op] {
+        for (const auto& probe : probes)
+          if (!idx->lookup(op, make_data_view(probe)))
+            std::abort();
+      };
+      ctx.measure(name, probes.size(), lookup,
+                  {{"memusage", memusage},
+                   {"false_positives", false_positives}});
+    }
+  }
+}
+
+} // namespace
+
+VAST_BENCHMARK(arithmetic_index) {
+  auto num_rows = ctx.opts().events;
+  auto rng = std::mt19937_64{ctx.opts().seed};
+  // A dense column of roughly sorted timestamps with sub-second jitter, as
+  // found in most imported event data.
+  auto timestamps = std::vector<vast::time>{};
+  auto ts = vast::time{} + 1'600'000'000s;
+  for (size_t i = 0; i < num_rows; ++i) {
+    ts += std::chrono::microseconds(rng() % 1000);
+    timestamps.push_back(ts);
+  }
+  // A column of uniformly distributed integers.
+  auto counts = std::vector<count>{};
+  for (size_t i = 0; i < num_rows; ++i)
+    counts.push_back(rng() % 100'000);
+  run(ctx, "time", time_type{}, timestamps);
+  run(ctx, "count", count_type{}, counts);
+}
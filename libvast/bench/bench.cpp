@@ -0,0 +1,150 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "bench.hpp"
+
+#include <vast/concept/parseable/parse.hpp>
+#include <vast/concept/parseable/vast/schema.hpp>
+#include <vast/config.hpp>
+#include <vast/defaults.hpp>
+#include <vast/detail/assert.hpp>
+#include <vast/error.hpp>
+#include <vast/format/test.hpp>
+#include <vast/system/configuration.hpp>
+
+#include <caf/settings.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <system_error>
+
+#include <unistd.h>
+
+namespace vast::bench {
+
+namespace {
+
+// Resembles a connection log, with distributions that yield a realistic mix
+// of unique and repetitive values.
+constexpr std::string_view bench_schema = R"__(
+  type test.conn = record{
+    ts: time #default="uniform(1600000000,1600086400)",
+    uid: string #default="uniform(0,10000000)",
+    orig_h: addr #default="uniform(167772160,167837695)",
+    orig_p: count #default="uniform(1024,65535)",
+    resp_h: addr #default="uniform(167772160,167772415)",
+    resp_p: count #default="uniform(0,1024)",
+    proto: string #default="uniform(0,2)",
+    duration: duration #default="uniform(1000,10000000)",
+    orig_bytes: count #default="pareto(0,1)",
+    resp_bytes: count #default="pareto(0,1)",
+  }
+)__";
+
+} // namespace
+
+context::context(options opts, system::configuration& cfg, std::ostream& out)
+  : opts_{std::move(opts)}, cfg_{cfg}, out_{out} {
+  // nop
+}
+
+context::~context() noexcept {
+  system_.reset();
+  if (!directory_.empty()) {
+    std::error_code err{};
+    std::filesystem::remove_all(directory_, err);
+  }
+}
+
+const options& context::opts() const noexcept {
+  return opts_;
+}
+
+bool context::enabled(std::string_view name) const {
+  auto filter = std::string_view{opts_.filter};
+  return name.substr(0, filter.size()) == filter
+         || filter.substr(0, name.size()) == name;
+}
+
+void context::write(std::string_view name, size_t items,
+                    std::vector<clock::duration> samples,
+                    const counters& extra) {
+  VAST_ASSERT(!samples.empty());
+  std::sort(samples.begin(), samples.end());
+  auto ns = [](clock::duration x) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(x).count();
+  };
+  auto median = samples[samples.size() / 2];
+  auto seconds = std::chrono::duration<double>{median}.count();
+  auto rate = seconds > 0.0 ? static_cast<double>(items) / seconds : 0.0;
+  out_ << R"({"benchmark":")" << name << R"(","version":")"
+       << version::version << R"(","items":)" << items
+       << R"(,"repetitions":)" << samples.size() << R"(,"min_ns":)"
+       << ns(samples.front()) << R"(,"median_ns":)" << ns(median)
+       << R"(,"max_ns":)" << ns(samples.back()) << R"(,"items_per_second":)"
+       << rate;
+  for (const auto& [key, value] : extra)
+    out_ << R"(,")" << key << R"(":)" << value;
+  out_ << "}\n" << std::flush;
+}
+
+std::vector<table_slice>
+context::generate(size_t events, table_slice_encoding encoding) const {
+  auto opts = caf::settings{};
+  caf::put(opts, "vast.import.max-events", events);
+  caf::put(opts, "vast.import.test.seed", opts_.seed);
+  caf::put(opts, "vast.import.batch-encoding", to_string(encoding));
+  auto reader = format::test::reader{opts};
+  if (auto err = reader.schema(schema())) {
+    std::cerr << "failed to set benchmark schema: " << render(err) << '\n';
+    std::abort();
+  }
+  auto result = std::vector<table_slice>{};
+  auto add = [&](table_slice slice) { result.push_back(std::move(slice)); };
+  auto [err, produced]
+    = reader.read(events, defaults::import::table_slice_size, add);
+  if (err && err != ec::end_of_input) {
+    std::cerr << "failed to generate events: " << render(err) << '\n';
+    std::abort();
+  }
+  VAST_ASSERT(produced == events);
+  return result;
+}
+
+const vast::schema& context::schema() {
+  static const auto result = [] {
+    auto sch = vast::schema{};
+    if (!parsers::schema(bench_schema, sch))
+      std::abort();
+    return sch;
+  }();
+  return result;
+}
+
+caf::actor_system& context::system() {
+  if (!system_)
+    system_ = std::make_unique<caf::actor_system>(cfg_);
+  return *system_;
+}
+
+const std::filesystem::path& context::directory() {
+  if (directory_.empty()) {
+    directory_ = std::filesystem::temp_directory_path()
+                 / ("vast-bench-" + std::to_string(::getpid()));
+    std::filesystem::create_directories(directory_);
+  }
+  return directory_;
+}
+
+std::vector<benchmark>& benchmarks() {
+  static auto result = std::vector<benchmark>{};
+  return result;
+}
+
+} // namespace vast::bench
@@ -0,0 +1,157 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include <vast/fwd.hpp>
+
+#include <vast/schema.hpp>
+#include <vast/table_slice.hpp>
+#include <vast/table_slice_encoding.hpp>
+
+#include <caf/actor_system.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace vast::system {
+
+class configuration;
+
+} // namespace vast::system
+
+namespace vast::bench {
+
+/// Controls the size and the reproducibility of a benchmark run.
+struct options {
+  /// The number of events or values that every benchmark processes.
+  size_t events = 100'000;
+
+  /// The number of measured repetitions after one warm-up run.
+  size_t repetitions = 5;
+
+  /// The seed for all random number generators.
+  uint64_t seed = 42;
+
+  /// Only benchmarks whose name starts with this string run.
+  std::string filter = {};
+};
+
+/// Additional measurements of a benchmark, e.g., memory usage.
+using counters = std::vector<std::pair<std::string, double>>;
+
+/// Runs benchmarks and writes one JSON object per line for every result, so
+/// that results of different versions can be compared mechanically.
+class context {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /// Constructs a benchmark context.
+  /// @param opts The options for the run.
+  /// @param cfg The configuration for actor systems of macro benchmarks.
+  /// @param out The stream to write results to.
+  context(options opts, system::configuration& cfg, std::ostream& out);
+
+  ~context() noexcept;
+
+  /// @returns The options of the run.
+  [[nodiscard]] const options& opts() const noexcept;
+
+  /// @returns Whether the filter selects the given name, or a result nested
+  /// below it.
+  [[nodiscard]] bool enabled(std::string_view name) const;
+
+  /// Runs a function once for warm-up and then once per repetition, and
+  /// writes the timings as a result.
+  /// @param name The name of the result.
+  /// @param items The number of items that a single run processes.
+  /// @param f The function to measure.
+  /// @param extra Additional measurements to include in the result.
+  template <class F>
+  void measure(std::string_view name, size_t items, F&& f,
+               const counters& extra = {}) {
+    if (!enabled(name))
+      return;
+    f();
+    auto samples = std::vector<clock::duration>{};
+    samples.reserve(opts_.repetitions);
+    for (size_t i = 0; i < opts_.repetitions; ++i) {
+      auto start = clock::now();
+      f();
+      samples.push_back(clock::now() - start);
+    }
+    write(name, items, std::move(samples), extra);
+  }
+
+  /// Writes a result that was measured by the caller.
+  /// @param name The name of the result.
+  /// @param items The number of items that a single sample processed.
+  /// @param samples The duration of every repetition.
+  /// @param extra Additional measurements to include in the result.
+  void write(std::string_view name, size_t items,
+             std::vector<clock::duration> samples, const counters& extra = {});
+
+  /// Generates events from the benchmark schema with the test reader.
+  /// @param events The number of events to generate.
+  /// @param encoding The encoding of the table slices.
+  /// @returns The generated table slices.
+  [[nodiscard]] std::vector<table_slice>
+  generate(size_t events, table_slice_encoding encoding
+                          = table_slice_encoding::arrow) const;
+
+  /// @returns The schema of the generated events.
+  [[nodiscard]] static const vast::schema& schema();
+
+  /// @returns The actor system for macro benchmarks, created on first use.
+  caf::actor_system& system();
+
+  /// @returns A scratch directory that gets removed at the end of the run.
+  const std::filesystem::path& directory();
+
+private:
+  options opts_;
+  system::configuration& cfg_;
+  std::ostream& out_;
+  std::unique_ptr<caf::actor_system> system_;
+  std::filesystem::path directory_;
+};
+
+/// A group of related benchmarks.
+struct benchmark {
+  std::string_view name;
+  void (*run)(context&);
+};
+
+/// @returns All registered benchmarks.
+std::vector<benchmark>& benchmarks();
+
+/// Registers a benchmark at static initialization time.
+struct registrar {
+  registrar(std::string_view name, void (*run)(context&)) {
+    benchmarks().push_back({name, run});
+  }
+};
+
+} // namespace vast::bench
+
+/// Defines a group of benchmarks. The results of the group should be named
+/// with the group name as prefix, separated by a dot.
+#define VAST_BENCHMARK(id)                                                     \
+  static void vast_benchmark_##id(::vast::bench::context&);                    \
+  static ::vast::bench::registrar vast_benchmark_registrar_##id{               \
+    #id, vast_benchmark_##id};                                                 \
+  static void vast_benchmark_##id(::vast::bench::context& ctx)
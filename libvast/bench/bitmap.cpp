@@ -0,0 +1,100 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Measures the primitives that all bitmap indexes build upon: appending to
+// and combining EWAH bitmaps, and encoding and decoding values with the
+// bitmap coders.
+
+#include "bench.hpp"
+
+#include <vast/base.hpp>
+#include <vast/coder.hpp>
+#include <vast/ewah_bitmap.hpp>
+#include <vast/operator.hpp>
+
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace vast;
+
+namespace {
+
+template <class Coder>
+void run_coder(bench::context& ctx, const std::string& name,
+               const std::vector<size_t>& xs, Coder prototype) {
+  auto encode = [&] {
+    auto coder = prototype;
+    for (auto x : xs)
+      coder.encode(x);
+    return coder;
+  };
+  ctx.measure("bitmap.coder." + name + ".encode", xs.size(), encode);
+  auto coder = encode();
+  auto probes = std::vector<size_t>(xs.begin(), xs.begin() + 10);
+  auto decode = [&] {
+    for (auto probe : probes) {
+      auto result = coder.decode(relational_operator::less_equal, probe);
+      if (result.size() != xs.size())
+        std::abort();
+    }
+  };
+  ctx.measure("bitmap.coder." + name + ".decode", probes.size(), decode,
+              {{"memusage", static_cast<double>(coder.memusage())}});
+}
+
+} // namespace
+
+VAST_BENCHMARK(bitmap) {
+  auto n = ctx.opts().events;
+  auto rng = std::mt19937_64{ctx.opts().seed};
+  // Sparse bitmaps compress well, dense bitmaps with random bits do not; the
+  // indexes produce both kinds.
+  auto make_bits = [&](double density) {
+    auto dist = std::bernoulli_distribution{density};
+    auto result = std::vector<bool>{};
+    result.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+      result.push_back(dist(rng));
+    return result;
+  };
+  auto sparse = make_bits(0.01);
+  auto dense = make_bits(0.5);
+  auto append = [](const std::vector<bool>& bits) {
+    auto result = ewah_bitmap{};
+    for (auto bit : bits)
+      result.append_bit(bit);
+    return result;
+  };
+  ctx.measure("bitmap.ewah.append_bit.sparse", n, [&] { append(sparse); });
+  ctx.measure("bitmap.ewah.append_bit.dense", n, [&] { append(dense); });
+  auto runs = [&] {
+    auto result = ewah_bitmap{};
+    for (size_t i = 0; i < n / 1000; ++i)
+      result.append_bits(i % 2 == 0, 1000);
+    return result;
+  };
+  ctx.measure("bitmap.ewah.append_bits", n, runs);
+  auto x = append(sparse);
+  auto y = append(dense);
+  ctx.measure("bitmap.ewah.and", n, [&] {
+    if ((x & y).size() != n)
+      std::abort();
+  });
+  ctx.measure("bitmap.ewah.or", n, [&] {
+    if ((x | y).size() != n)
+      std::abort();
+  });
+  auto values = std::vector<size_t>{};
+  values.reserve(n);
+  for (size_t i = 0; i < n; ++i)
+    values.push_back(rng() % 65536);
+  run_coder(ctx, "range", values,
+            multi_level_coder<range_coder<ewah_bitmap>>{base::uniform(10, 5)});
+  run_coder(ctx, "bitslice", values, bitslice_coder<ewah_bitmap>{16});
+}
@@ -0,0 +1,81 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Measures the row-wise evaluation of expressions over table slices, as done
+// by the CANDIDATE CHECKER, and selecting the matching rows.
+
+#include "bench.hpp"
+
+#include <vast/bitmap_algorithms.hpp>
+#include <vast/concept/parseable/to.hpp>
+#include <vast/concept/parseable/vast/expression.hpp>
+#include <vast/expression.hpp>
+#include <vast/ids.hpp>
+#include <vast/table_slice.hpp>
+
+#include <cstdlib>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace vast;
+
+namespace {
+
+// Covers the common predicate shapes: equality on a low-cardinality column,
+// a range over a skewed column, a subnet, and a conjunction.
+constexpr std::string_view queries[] = {
+  R"(resp_p == 443)",
+  R"(orig_bytes > 1000)",
+  R"(orig_h in 10.0.0.0/24)",
+  R"(proto == "1" && resp_p < 100)",
+};
+
+} // namespace
+
+VAST_BENCHMARK(evaluate) {
+  auto slices = ctx.generate(ctx.opts().events);
+  id offset = 0;
+  for (auto& slice : slices) {
+    slice.offset(offset);
+    offset += slice.rows();
+  }
+  for (size_t i = 0; i < std::size(queries); ++i) {
+    auto expr = to<expression>(queries[i]);
+    if (!expr)
+      std::abort();
+    auto tailored = std::vector<expression>{};
+    for (const auto& slice : slices) {
+      auto x = tailor(*expr, slice.layout());
+      if (!x)
+        std::abort();
+      tailored.push_back(std::move(*x));
+    }
+    auto prefix = "evaluate.q" + std::to_string(i);
+    auto hits = std::vector<ids>(slices.size());
+    auto evaluate_all = [&] {
+      for (size_t j = 0; j < slices.size(); ++j)
+        hits[j] = evaluate(tailored[j], slices[j]);
+    };
+    ctx.measure(prefix + ".evaluate", ctx.opts().events, evaluate_all);
+    evaluate_all();
+    auto selected = uint64_t{0};
+    for (const auto& x : hits)
+      selected += rank(x);
+    auto selectivity = static_cast<double>(selected) / ctx.opts().events;
+    ctx.measure(
+      prefix + ".select", ctx.opts().events,
+      [&] {
+        for (size_t j = 0; j < slices.size(); ++j)
+          if (rows(select(slices[j], hits[j])) != rank(hits[j]))
+            std::abort();
+      },
+      {{"selectivity", selectivity}});
+  }
+}
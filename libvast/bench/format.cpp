@@ -0,0 +1,121 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Measures the JSON and Zeek parsers on input that the matching writers
+// produce from generated events, and the writers themselves, both into memory
+// and into a file through the output stream that the sink uses.
+
+#include "bench.hpp"
+
+#include <vast/defaults.hpp>
+#include <vast/detail/make_io_stream.hpp>
+#include <vast/error.hpp>
+#include <vast/format/ascii.hpp>
+#include <vast/format/csv.hpp>
+#include <vast/format/json.hpp>
+#include <vast/format/json/default_selector.hpp>
+#include <vast/format/reader.hpp>
+#include <vast/format/zeek.hpp>
+
+#include <caf/settings.hpp>
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace vast;
+
+namespace {
+
+void run_reader(bench::context& ctx, std::string_view name,
+                const std::string& input, format::reader& reader) {
+  auto events = ctx.opts().events;
+  ctx.measure(name, events, [&] {
+    reader.reset(std::make_unique<std::istringstream>(input));
+    auto [err, produced] = reader.read(
+      events, defaults::import::table_slice_size, [](table_slice) {});
+    if (err && err != ec::end_of_input && err != ec::stalled)
+      std::abort();
+    if (produced != events)
+      std::abort();
+  });
+}
+
+// Writes all slices with a fresh writer of the given type.
+template <class Writer>
+void write_all(std::unique_ptr<std::ostream> out,
+               const std::vector<table_slice>& slices) {
+  auto writer = Writer{std::move(out), caf::settings{}};
+  for (const auto& slice : slices)
+    if (writer.write(slice))
+      std::abort();
+  if (!writer.flush())
+    std::abort();
+}
+
+// Measures a writer into memory and into a file, and returns the output.
+template <class Writer>
+std::string run_writer(bench::context& ctx, std::string_view name,
+                       const std::vector<table_slice>& slices) {
+  auto events = ctx.opts().events;
+  auto result = std::string{};
+  auto prefix = "format." + std::string{name};
+  auto write_memory = [&] {
+    auto out = std::make_unique<std::ostringstream>();
+    auto* buffer = out.get();
+    write_all<Writer>(std::move(out), slices);
+    result = buffer->str();
+  };
+  ctx.measure(prefix + ".write", events, write_memory);
+  auto path = ctx.directory() / ("output." + std::string{name});
+  ctx.measure(prefix + ".write-file", events, [&] {
+    auto out = detail::make_output_stream(path.string());
+    if (!out)
+      std::abort();
+    write_all<Writer>(std::move(*out), slices);
+  });
+  // The filter may have skipped the measurement, but readers need the output.
+  if (result.empty())
+    write_memory();
+  return result;
+}
+
+} // namespace
+
+VAST_BENCHMARK(format) {
+  auto slices = ctx.generate(ctx.opts().events);
+  auto opts = caf::settings{};
+  run_writer<format::ascii::writer>(ctx, "ascii", slices);
+  run_writer<format::csv::writer>(ctx, "csv", slices);
+  auto json = run_writer<format::json::writer>(ctx, "json", slices);
+  auto json_reader
+    = format::json::reader<format::json::default_selector>{opts};
+  if (json_reader.schema(ctx.schema()))
+    std::abort();
+  run_reader(ctx, "format.json.read", json, json_reader);
+  // The Zeek writer only writes to files, one per layout.
+  auto dir = ctx.directory() / "zeek";
+  {
+    auto zeek_opts = caf::settings{};
+    caf::put(zeek_opts, "vast.export.write", dir.string());
+    auto writer = format::zeek::writer{zeek_opts};
+    for (const auto& slice : slices)
+      if (writer.write(slice))
+        std::abort();
+  }
+  auto file = std::ifstream{dir / "test.conn.log"};
+  auto zeek = std::string{std::istreambuf_iterator<char>{file},
+                          std::istreambuf_iterator<char>{}};
+  auto zeek_reader = format::zeek::reader{opts};
+  run_reader(ctx, "format.zeek.read", zeek, zeek_reader);
+}
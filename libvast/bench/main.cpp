@@ -0,0 +1,90 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Runs all registered benchmarks and prints one JSON object per result to
+// standard output. Run with --help for the available options.
+
+#include "bench.hpp"
+
+#include <vast/command.hpp>
+#include <vast/logger.hpp>
+#include <vast/system/configuration.hpp>
+
+#include <caf/settings.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+constexpr std::string_view usage
+  = "usage: vast-bench [--events N] [--repetitions N] [--seed N]\n"
+    "                  [--filter NAME] [--list]\n";
+
+} // namespace
+
+int main(int argc, char** argv) {
+  auto opts = vast::bench::options{};
+  auto list = false;
+  for (int i = 1; i < argc; ++i) {
+    auto arg = std::string_view{argv[i]};
+    auto has_value = i + 1 < argc;
+    try {
+      if (arg == "--events" && has_value)
+        opts.events = std::stoull(argv[++i]);
+      else if (arg == "--repetitions" && has_value)
+        opts.repetitions = std::stoull(argv[++i]);
+      else if (arg == "--seed" && has_value)
+        opts.seed = std::stoull(argv[++i]);
+      else if (arg == "--filter" && has_value)
+        opts.filter = argv[++i];
+      else if (arg == "--list")
+        list = true;
+      else {
+        std::cerr << usage;
+        return arg == "--help" ? EXIT_SUCCESS : EXIT_FAILURE;
+      }
+    } catch (const std::exception&) {
+      std::cerr << "invalid value for " << arg << '\n' << usage;
+      return EXIT_FAILURE;
+    }
+  }
+  if (opts.events == 0 || opts.repetitions == 0) {
+    std::cerr << "events and repetitions must be positive\n";
+    return EXIT_FAILURE;
+  }
+  auto& benchmarks = vast::bench::benchmarks();
+  std::sort(benchmarks.begin(), benchmarks.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.name < rhs.name;
+            });
+  if (list) {
+    for (const auto& benchmark : benchmarks)
+      std::cout << benchmark.name << '\n';
+    return EXIT_SUCCESS;
+  }
+  // Log output would interfere with the measurements.
+  auto log_settings = caf::settings{};
+  caf::put(log_settings, "vast.console-verbosity", "quiet");
+  caf::put(log_settings, "vast.file-verbosity", "quiet");
+  auto log_context
+    = vast::create_log_context(vast::invocation{}, log_settings);
+  if (!log_context)
+    return EXIT_FAILURE;
+  // Constructing the configuration initializes the factories and registers
+  // the message types of VAST.
+  auto cfg = vast::system::configuration{};
+  auto ctx = vast::bench::context{opts, cfg, std::cout};
+  for (const auto& benchmark : benchmarks)
+    if (ctx.enabled(benchmark.name))
+      benchmark.run(ctx);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Measures VAST end to end: importing events through a local node until the
+// INDEX flushed them to disk, and running a fixed mix of queries against the
+// imported events.
+
+#include "bench.hpp"
+
+#include <vast/atoms.hpp>
+#include <vast/command.hpp>
+#include <vast/detail/spawn_container_source.hpp>
+#include <vast/error.hpp>
+#include <vast/system/actors.hpp>
+#include <vast/system/node.hpp>
+#include <vast/system/query_status.hpp>
+#include <vast/uuid.hpp>
+
+#include <caf/scoped_actor.hpp>
+
+#include <chrono>
+#include <filesystem>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace vast;
+
+namespace {
+
+// Resembles the queries of a typical investigation: a point lookup, a
+// range, a subnet, a type extractor, and a conjunction.
+constexpr std::string_view query_mix[] = {
+  R"(resp_p == 443)",
+  R"(orig_bytes > 1000)",
+  R"(orig_h in 10.0.0.0/24)",
+  R"(:addr == 10.0.0.1)",
+  R"(proto == "1" && resp_p < 100)",
+};
+
+class local_node {
+public:
+  local_node(caf::actor_system& sys, const std::filesystem::path& dir)
+    : sys_{sys}, self_{sys} {
+    std::filesystem::remove_all(dir);
+    handle_ = self_->spawn(system::node, "bench", dir,
+                           std::chrono::milliseconds::zero());
+    for (auto component : {"type-registry", "archive", "index", "importer"})
+      spawn(component);
+  }
+
+  ~local_node() {
+    self_->monitor(handle_);
+    self_->send_exit(handle_, caf::exit_reason::user_shutdown);
+    self_->receive([](const caf::down_msg&) {});
+  }
+
+  caf::actor spawn(std::string component, std::vector<std::string> args = {}) {
+    auto inv = invocation{};
+    inv.full_name = "spawn " + component;
+    inv.arguments = std::move(args);
+    auto result = caf::actor{};
+    self_->request(handle_, caf::infinite, atom::spawn_v, std::move(inv))
+      .receive([&](const caf::actor& a) { result = a; },
+               [&](const caf::error& err) {
+                 std::cerr << "failed to spawn " << component << ": "
+                           << render(err) << '\n';
+                 std::abort();
+               });
+    return result;
+  }
+
+  /// Imports table slices and waits until the INDEX persisted them.
+  void import(const std::vector<table_slice>& slices) {
+    auto importer = caf::actor{};
+    self_
+      ->request(handle_, caf::infinite, atom::get_v, atom::label_v, "importer")
+      .receive([&](const caf::actor& a) { importer = a; },
+               [&](const caf::error&) { std::abort(); });
+    auto src = detail::spawn_container_source(sys_, slices, importer);
+    self_->monitor(src);
+    self_->receive([](const caf::down_msg&) {});
+    self_->send(importer, atom::subscribe_v, atom::flush::value,
+                caf::actor_cast<system::flush_listener_actor>(self_));
+    self_->receive([](atom::flush) {});
+  }
+
+  /// Runs a query to completion and returns the number of results.
+  uint64_t query(std::string_view expr) {
+    auto exporter = spawn("exporter", {std::string{expr}});
+    self_->monitor(exporter);
+    self_->send(exporter, atom::sink_v, caf::actor_cast<caf::actor>(self_));
+    self_->send(exporter, atom::run_v);
+    auto result = uint64_t{0};
+    auto running = true;
+    self_->receive_while(running)(
+      [&](table_slice slice) { result += slice.rows(); },
+      [&](const uuid&, const system::query_status&) {},
+      [&](const caf::down_msg& msg) {
+        if (msg.reason != caf::exit_reason::normal)
+          std::abort();
+        running = false;
+      });
+    return result;
+  }
+
+private:
+  caf::actor_system& sys_;
+  caf::scoped_actor self_;
+  system::node_actor handle_;
+};
+
+} // namespace
+
+VAST_BENCHMARK(node) {
+  // Both benchmarks need a running node, which is too expensive to set up
+  // if the filter excludes them anyway.
+  auto events = ctx.opts().events;
+  auto slices = std::vector<table_slice>{};
+  if (ctx.enabled("node.import") || ctx.enabled("node.query"))
+    slices = ctx.generate(events);
+  if (ctx.enabled("node.import")) {
+    auto samples = std::vector<bench::context::clock::duration>{};
+    // Every repetition imports into an empty database; the first one is a
+    // warm-up run.
+    for (size_t i = 0; i <= ctx.opts().repetitions; ++i) {
+      auto node = local_node{ctx.system(), ctx.directory() / "import"};
+      auto start = bench::context::clock::now();
+      node.import(slices);
+      if (i > 0)
+        samples.push_back(bench::context::clock::now() - start);
+    }
+    ctx.write("node.import", events, std::move(samples));
+  }
+  if (ctx.enabled("node.query")) {
+    auto node = local_node{ctx.system(), ctx.directory() / "query"};
+    node.import(slices);
+    for (size_t i = 0; i < std::size(query_mix); ++i)
+      ctx.measure("node.query.q" + std::to_string(i), events,
+                  [&] { node.query(query_mix[i]); });
+  }
+}
@@ -0,0 +1,130 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Measures queries against a single persisted partition, once with INDEXER
+// and EVALUATOR actors and once with direct lookups of the value indexes.
+
+#include "bench.hpp"
+
+#include <vast/atoms.hpp>
+#include <vast/concept/parseable/to.hpp>
+#include <vast/concept/parseable/vast/expression.hpp>
+#include <vast/detail/spawn_container_source.hpp>
+#include <vast/expression.hpp>
+#include <vast/partition_synopsis.hpp>
+#include <vast/query.hpp>
+#include <vast/system/actors.hpp>
+#include <vast/system/partition.hpp>
+#include <vast/system/posix_filesystem.hpp>
+#include <vast/uuid.hpp>
+
+#include <caf/scoped_actor.hpp>
+#include <caf/settings.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace vast;
+
+namespace {
+
+// Cheap predicates are where spawning actors matters most: a point lookup, a
+// range, a subnet, a type extractor, a meta predicate, and a conjunction.
+constexpr std::string_view queries[] = {
+  R"(resp_p == 443)",
+  R"(orig_bytes > 1000)",
+  R"(orig_h in 10.0.0.0/24)",
+  R"(:addr == 10.0.0.1)",
+  R"(#type == "test.conn")",
+  R"(proto == "1" && resp_p < 100)",
+};
+
+// Counts the hits of a query without fetching events from a store.
+uint64_t count(caf::scoped_actor& self, const system::partition_actor& part,
+               const expression& expr) {
+  self
+    ->request(part, caf::infinite,
+              query::make_count(self, query::count::estimate, expr))
+    .receive([](atom::done) {}, [](const caf::error&) { std::abort(); });
+  // The partition sends the hits before it responds.
+  auto result = uint64_t{0};
+  auto more = true;
+  while (more)
+    self->receive([&](uint64_t hits) { result += hits; },
+                  caf::after(std::chrono::seconds{0}) >> [&] { more = false; });
+  return result;
+}
+
+} // namespace
+
+VAST_BENCHMARK(partition) {
+  if (!ctx.enabled("partition"))
+    return;
+  auto& sys = ctx.system();
+  auto self = caf::scoped_actor{sys};
+  auto events = ctx.opts().events;
+  auto slices = ctx.generate(events);
+  id offset = 0;
+  for (auto& slice : slices) {
+    slice.offset(offset);
+    offset += slice.rows();
+  }
+  // Build and persist a single partition that holds all events. Paths are
+  // relative to the root directory of the filesystem actor.
+  auto fs = self->spawn(system::posix_filesystem, ctx.directory());
+  auto id = uuid::random();
+  auto path = std::filesystem::path{"partition"};
+  auto synopsis_path = std::filesystem::path{"partition.mdx"};
+  {
+    auto active = self->spawn(system::active_partition, id, fs,
+                              caf::settings{}, caf::settings{},
+                              system::store_actor{}, false);
+    auto src = detail::spawn_container_source(sys, slices, active);
+    self->monitor(src);
+    self->receive([](const caf::down_msg&) {});
+    self->request(active, caf::infinite, atom::persist_v, path, synopsis_path)
+      .receive([](std::shared_ptr<partition_synopsis>&) {},
+               [](const caf::error&) { std::abort(); });
+    self->send_exit(active, caf::exit_reason::user_shutdown);
+  }
+  auto spawn_passive = [&](bool direct_evaluation) {
+    return self->spawn(system::passive_partition, id, fs, path,
+                       system::store_actor{}, nullptr, direct_evaluation);
+  };
+  auto actors = spawn_passive(false);
+  auto direct = spawn_passive(true);
+  for (size_t i = 0; i < std::size(queries); ++i) {
+    auto expr = to<expression>(queries[i]);
+    if (!expr)
+      std::abort();
+    auto normalized = normalize_and_validate(*expr);
+    if (!normalized)
+      std::abort();
+    // Both paths must agree before we compare their latency.
+    auto hits = count(self, actors, *normalized);
+    if (count(self, direct, *normalized) != hits)
+      std::abort();
+    auto selectivity = static_cast<double>(hits) / events;
+    auto prefix = "partition.q" + std::to_string(i);
+    ctx.measure(
+      prefix + ".actors", events, [&] { count(self, actors, *normalized); },
+      {{"selectivity", selectivity}});
+    ctx.measure(
+      prefix + ".direct", events, [&] { count(self, direct, *normalized); },
+      {{"selectivity", selectivity}});
+  }
+  for (const auto& part : {actors, direct})
+    self->send_exit(part, caf::exit_reason::user_shutdown);
+  self->send_exit(fs, caf::exit_reason::user_shutdown);
+}
@@ -0,0 +1,61 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Measures building and querying the synopses that the META INDEX consults
+// for every query.
+
+#include "bench.hpp"
+
+#include <vast/data.hpp>
+#include <vast/factory.hpp>
+#include <vast/operator.hpp>
+#include <vast/synopsis.hpp>
+#include <vast/synopsis_factory.hpp>
+#include <vast/type.hpp>
+#include <vast/view.hpp>
+
+#include <caf/settings.hpp>
+
+#include <cstdlib>
+
+using namespace vast;
+
+VAST_BENCHMARK(synopsis) {
+  auto slices = ctx.generate(ctx.opts().events);
+  if (slices.empty())
+    return;
+  const auto& layout = slices[0].layout();
+  auto each = record_type::each(layout);
+  auto field_it = each.begin();
+  for (size_t col = 0; col < layout.num_leaves(); ++col, ++field_it) {
+    const auto& t = field_it->type();
+    auto make = [&] {
+      auto syn = factory<synopsis>::make(t, caf::settings{});
+      if (syn)
+        for (const auto& slice : slices)
+          for (size_t row = 0; row < slice.rows(); ++row)
+            syn->add(slice.at(row, col, t));
+      return syn;
+    };
+    // Not every type has a synopsis.
+    if (!make())
+      continue;
+    auto name = "synopsis." + field_it->key();
+    ctx.measure(name + ".add", ctx.opts().events, make);
+    auto syn = make();
+    auto probe = materialize(slices[0].at(0, col, t));
+    ctx.measure(
+      name + ".lookup", 1,
+      [&] {
+        auto result = syn->lookup(relational_operator::equal, make_view(probe));
+        if (result && !*result)
+          std::abort();
+      },
+      {{"memusage", static_cast<double>(syn->memusage())}});
+  }
+}
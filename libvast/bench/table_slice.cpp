@@ -0,0 +1,77 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Measures building table slices row by row with every encoding, and
+// accessing their values.
+
+#include "bench.hpp"
+
+#include <vast/data.hpp>
+#include <vast/defaults.hpp>
+#include <vast/factory.hpp>
+#include <vast/table_slice_builder.hpp>
+#include <vast/table_slice_builder_factory.hpp>
+#include <vast/type.hpp>
+#include <vast/view.hpp>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace vast;
+
+VAST_BENCHMARK(table_slice) {
+  auto slices = ctx.generate(ctx.opts().events);
+  if (slices.empty())
+    return;
+  auto layout = slices[0].layout();
+  auto types = std::vector<type>{};
+  for (const auto& field : record_type::each(layout))
+    types.push_back(field.type());
+  // Materialize the rows up front, so that only the builders get measured.
+  auto rows = std::vector<std::vector<data>>{};
+  rows.reserve(ctx.opts().events);
+  for (const auto& slice : slices) {
+    for (size_t row = 0; row < slice.rows(); ++row) {
+      auto& xs = rows.emplace_back();
+      for (size_t col = 0; col < slice.columns(); ++col)
+        xs.push_back(materialize(slice.at(row, col, types[col])));
+    }
+  }
+  for (auto encoding :
+       {table_slice_encoding::msgpack, table_slice_encoding::arrow}) {
+    auto prefix = "table_slice." + to_string(encoding);
+    ctx.measure(prefix + ".build", rows.size(), [&] {
+      auto builder = factory<table_slice_builder>::make(encoding, layout);
+      if (!builder)
+        std::abort();
+      for (const auto& xs : rows) {
+        for (const auto& x : xs)
+          if (!builder->add(x))
+            std::abort();
+        if (builder->rows() == defaults::import::table_slice_size)
+          if (builder->finish().encoding() == table_slice_encoding::none)
+            std::abort();
+      }
+      if (builder->rows() > 0)
+        if (builder->finish().encoding() == table_slice_encoding::none)
+          std::abort();
+    });
+    auto encoded = ctx.generate(ctx.opts().events, encoding);
+    ctx.measure(prefix + ".at", rows.size() * types.size(), [&] {
+      size_t nils = 0;
+      for (const auto& slice : encoded)
+        for (size_t row = 0; row < slice.rows(); ++row)
+          for (size_t col = 0; col < slice.columns(); ++col)
+            nils += caf::holds_alternative<caf::none_t>(
+              slice.at(row, col, types[col]));
+      if (nils == rows.size() * types.size())
+        std::abort();
+    });
+  }
+}
@@ -0,0 +1,61 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+// Measures appending to and looking up values in the value indexes that the
+// INDEXERs create for the columns of the benchmark schema.
+
+#include "bench.hpp"
+
+#include <vast/data.hpp>
+#include <vast/factory.hpp>
+#include <vast/operator.hpp>
+#include <vast/type.hpp>
+#include <vast/value_index.hpp>
+#include <vast/value_index_factory.hpp>
+#include <vast/view.hpp>
+
+#include <caf/settings.hpp>
+
+#include <cstdlib>
+
+using namespace vast;
+
+VAST_BENCHMARK(value_index) {
+  auto slices = ctx.generate(ctx.opts().events);
+  if (slices.empty())
+    return;
+  const auto& layout = slices[0].layout();
+  auto each = record_type::each(layout);
+  auto field_it = each.begin();
+  for (size_t col = 0; col < layout.num_leaves(); ++col, ++field_it) {
+    const auto& t = field_it->type();
+    auto name = "value_index." + field_it->key();
+    auto make = [&] {
+      auto idx = factory<value_index>::make(t, caf::settings{});
+      if (!idx)
+        std::abort();
+      for (const auto& slice : slices)
+        for (size_t row = 0; row < slice.rows(); ++row)
+          if (!idx->append(slice.at(row, col, t)))
+            std::abort();
+      return idx;
+    };
+    ctx.measure(name + ".append", ctx.opts().events, make);
+    auto idx = make();
+    // Look up a value that is known to exist, so that the lookup cannot
+    // short-circuit.
+    auto probe = materialize(slices[0].at(0, col, t));
+    ctx.measure(
+      name + ".lookup", 1,
+      [&] {
+        if (!idx->lookup(relational_operator::equal, make_view(probe)))
+          std::abort();
+      },
+      {{"memusage", static_cast<double>(idx->memusage())}});
+  }
+}
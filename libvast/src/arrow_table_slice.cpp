@@ -26,6 +26,7 @@
 
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace vast {
 
@@ -163,6 +164,14 @@ void decode(const type& t, const arrow::StringArray& arr, F& f) {
             kind(t));
 }
 
+template <class F>
+void decode(const type& t, const arrow::DictionaryArray& arr, F& f) {
+  DECODE_TRY_DISPATCH(string);
+  DECODE_TRY_DISPATCH(pattern);
+  VAST_WARN("{} expected to decode a string or pattern but got a {}", __func__,
+            kind(t));
+}
+
 template <class F>
 void decode(const type& t, const arrow::TimestampArray& arr, F& f) {
   DECODE_TRY_DISPATCH(time);
@@ -198,6 +207,9 @@ void decode(const type& t, const arrow::Array& arr, F& f) {
     case arrow::Type::STRING: {
       return decode(t, static_cast<const arrow::StringArray&>(arr), f);
     }
+    case arrow::Type::DICTIONARY: {
+      return decode(t, static_cast<const arrow::DictionaryArray&>(arr), f);
+    }
     case arrow::Type::TIMESTAMP: {
       return decode(t, static_cast<const arrow::TimestampArray&>(arr), f);
     }
@@ -302,6 +314,18 @@ auto pattern_at(const arrow::StringArray& arr, int64_t row) {
   return pattern_view{string_at(arr, row)};
 }
 
+const arrow::StringArray& dictionary_of(const arrow::DictionaryArray& arr) {
+  return static_cast<const arrow::StringArray&>(*arr.dictionary());
+}
+
+auto dictionary_string_at(const arrow::DictionaryArray& arr, int64_t row) {
+  return string_at(dictionary_of(arr), arr.GetValueIndex(row));
+}
+
+auto dictionary_pattern_at(const arrow::DictionaryArray& arr, int64_t row) {
+  return pattern_view{dictionary_string_at(arr, row)};
+}
+
 auto address_at(const arrow::FixedSizeBinaryArray& arr, int64_t row) {
   auto bytes = arr.raw_values() + (row * 16);
   return address::v6(static_cast<const void*>(bytes), address::network);
@@ -434,6 +458,18 @@ public:
     }
   }
 
+  template <class T>
+  void operator()(const arrow::DictionaryArray& arr, const T&) {
+    if (arr.IsNull(row_))
+      return;
+    if constexpr (std::is_same_v<T, string_type>) {
+      result_ = dictionary_string_at(arr, row_);
+    } else {
+      static_assert(std::is_same_v<T, pattern_type>);
+      result_ = dictionary_pattern_at(arr, row_);
+    }
+  }
+
   void operator()(const arrow::TimestampArray& arr, const time_type&) {
     if (arr.IsNull(row_))
       return;
@@ -531,6 +567,24 @@ public:
     apply(arr, pattern_at);
   }
 
+  // Decodes every distinct value of a dictionary-encoded column only once and
+  // appends the values to the index by their codes.
+  template <class T>
+  void operator()(const arrow::DictionaryArray& arr, const T&) {
+    const auto& dictionary = dictionary_of(arr);
+    auto values = std::vector<data_view>{};
+    values.reserve(dictionary.length());
+    for (int64_t code = 0; code < dictionary.length(); ++code) {
+      if constexpr (std::is_same_v<T, string_type>)
+        values.emplace_back(string_at(dictionary, code));
+      else
+        values.emplace_back(pattern_at(dictionary, code));
+    }
+    apply(arr, [&](const auto& arr, int64_t row) {
+      return values[arr.GetValueIndex(row)];
+    });
+  }
+
   void operator()(const arrow::TimestampArray& arr, const time_type&) {
     apply(arr, timestamp_at);
   }
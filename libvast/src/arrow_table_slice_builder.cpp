@@ -17,12 +17,18 @@
 #include "vast/fbs/table_slice.hpp"
 #include "vast/fbs/utils.hpp"
 #include "vast/logger.hpp"
+#include "vast/memory_pool.hpp"
 
 #include <arrow/api.h>
 #include <arrow/io/api.h>
 #include <arrow/ipc/api.h>
 #include <arrow/util/config.h>
 
+#include <algorithm>
+#include <deque>
+#include <string_view>
+#include <unordered_map>
+
 namespace vast {
 
 // -- column builder implementations ------------------------------------------
@@ -451,6 +457,204 @@ private:
   std::vector<std::unique_ptr<column_builder>> field_builders_;
 };
 
+/// Builds a string column that stores every distinct value only once and
+/// refers to it by a 32-bit code. The builder only emits a dictionary-encoded
+/// column if values repeat often enough to make up for the codes, and falls
+/// back to a plain string column otherwise.
+class dictionary_column_builder final
+  : public arrow_table_slice_builder::column_builder {
+public:
+  /// The maximum number of distinct values before the builder gives up on
+  /// dictionary encoding for the current slice.
+  static constexpr size_t max_dictionary_size = 1 << 16;
+
+  explicit dictionary_column_builder(arrow::MemoryPool* pool)
+    : pool_{pool},
+      plain_builder_{std::make_shared<arrow::StringBuilder>(pool)} {
+    // nop
+  }
+
+  bool add(data_view x) override {
+    if (caf::holds_alternative<view<caf::none_t>>(x)) {
+      if (!encoding_)
+        return plain_builder_->AppendNull().ok();
+      codes_.push_back(null_code);
+      return true;
+    }
+    auto xptr = caf::get_if<view<std::string>>(&x);
+    if (!xptr)
+      return false;
+    if (!encoding_)
+      return append_plain(*xptr);
+    auto it = dictionary_index_.find(*xptr);
+    if (it == dictionary_index_.end()) {
+      if (dictionary_.size() == max_dictionary_size)
+        return fall_back() && append_plain(*xptr);
+      const auto& value = dictionary_.emplace_back(*xptr);
+      auto code = detail::narrow_cast<int32_t>(dictionary_.size() - 1);
+      it = dictionary_index_.emplace(value, code).first;
+    }
+    codes_.push_back(it->second);
+    return true;
+  }
+
+  std::shared_ptr<arrow::Array> finish() override {
+    // Dictionary encoding only pays off if values repeat at least twice on
+    // average; otherwise the codes merely add to the size of the column.
+    if (encoding_ && dictionary_.size() * 2 > codes_.size())
+      if (!fall_back())
+        die("failed to finish Arrow column builder");
+    std::shared_ptr<arrow::Array> result;
+    if (encoding_) {
+      auto indices_builder = arrow::Int32Builder{pool_};
+      auto values_builder = arrow::StringBuilder{pool_};
+      auto ok = indices_builder.Reserve(codes_.size()).ok();
+      for (auto code : codes_)
+        ok = ok
+             && (code == null_code ? indices_builder.AppendNull()
+                                   : indices_builder.Append(code))
+                  .ok();
+      for (const auto& value : dictionary_)
+        ok = ok && values_builder.Append(value).ok();
+      std::shared_ptr<arrow::Array> indices;
+      std::shared_ptr<arrow::Array> values;
+      if (!ok || !indices_builder.Finish(&indices).ok()
+          || !values_builder.Finish(&values).ok())
+        die("failed to finish Arrow column builder");
+      auto type = arrow::dictionary(arrow::int32(), arrow::utf8());
+      result = arrow::DictionaryArray::FromArrays(type, indices, values)
+                 .ValueOrDie();
+    } else if (!plain_builder_->Finish(&result).ok()) {
+      die("failed to finish Arrow column builder");
+    }
+    // Start the next slice with a fresh dictionary.
+    encoding_ = true;
+    codes_.clear();
+    dictionary_index_.clear();
+    dictionary_.clear();
+    return result;
+  }
+
+  /// Dictionary-encoded columns cannot be nested in other columns, so there
+  /// is no underlying array builder to share.
+  [[nodiscard]] std::shared_ptr<arrow::ArrayBuilder>
+  arrow_builder() const override {
+    return nullptr;
+  }
+
+private:
+  /// The code that marks a null value.
+  static constexpr int32_t null_code = -1;
+
+  bool append_plain(std::string_view x) {
+    auto str = arrow::util::string_view(x.data(), x.size());
+    return plain_builder_->Append(str).ok();
+  }
+
+  /// Copies the values added so far into the plain string builder and stops
+  /// encoding further values for the current slice.
+  bool fall_back() {
+    encoding_ = false;
+    if (!plain_builder_->Reserve(codes_.size()).ok())
+      return false;
+    for (auto code : codes_) {
+      auto ok = code == null_code ? plain_builder_->AppendNull().ok()
+                                  : append_plain(dictionary_[code]);
+      if (!ok)
+        return false;
+    }
+    codes_.clear();
+    dictionary_index_.clear();
+    dictionary_.clear();
+    return true;
+  }
+
+  arrow::MemoryPool* pool_;
+
+  /// Whether the builder encodes the values of the current slice.
+  bool encoding_ = true;
+
+  /// The code of every value of the current slice, in order.
+  std::vector<int32_t> codes_;
+
+  /// The distinct values, ordered by their codes. We use a deque so that the
+  /// keys of the index remain valid when the dictionary grows.
+  std::deque<std::string> dictionary_;
+
+  /// Maps distinct values to their codes.
+  std::unordered_map<std::string_view, int32_t> dictionary_index_;
+
+  /// The builder for the plain string column after falling back.
+  std::shared_ptr<arrow::StringBuilder> plain_builder_;
+};
+
+/// Checks whether a column holds strings, which makes it a candidate for
+/// dictionary encoding.
+bool is_string_column(const type& t) {
+  if (auto alias = caf::get_if<alias_type>(&t))
+    return is_string_column(alias->value_type);
+  return caf::holds_alternative<string_type>(t);
+}
+
+/// Checks whether the schema of a record batch contains dictionary-encoded
+/// columns.
+bool has_dictionaries(const arrow::Schema& schema) {
+  const auto& fields = schema.fields();
+  return std::any_of(fields.begin(), fields.end(), [](const auto& field) {
+    return field->type()->id() == arrow::Type::DICTIONARY;
+  });
+}
+
+/// Serializes the schema and the record batch of an Arrow-encoded table slice
+/// into the FlatBuffers builder. For record batches with dictionary-encoded
+/// columns, the serialized record batch additionally contains the dictionary
+/// batches that must precede the record batch in an Arrow IPC stream.
+std::pair<flatbuffers::Offset<flatbuffers::Vector<uint8_t>>,
+          flatbuffers::Offset<flatbuffers::Vector<uint8_t>>>
+pack_record_batch(flatbuffers::FlatBufferBuilder& builder,
+                  const std::shared_ptr<arrow::RecordBatch>& record_batch) {
+  const auto& schema = record_batch->schema();
+  if (has_dictionaries(*schema)) {
+    auto sink = arrow::io::BufferOutputStream::Create(
+                  4096, memory_pool::local().arrow_pool())
+                  .ValueOrDie();
+#if ARROW_VERSION_MAJOR >= 2
+    auto writer = arrow::ipc::MakeStreamWriter(sink.get(), schema).ValueOrDie();
+#else
+    auto writer = arrow::ipc::NewStreamWriter(sink.get(), schema).ValueOrDie();
+#endif
+    // The stream writer writes the schema on construction, and the
+    // dictionaries along with the first record batch.
+    auto schema_size = sink->Tell().ValueOrDie();
+    if (!writer->WriteRecordBatch(*record_batch).ok())
+      die("failed to serialize Arrow record batch");
+    auto size = sink->Tell().ValueOrDie();
+    if (!writer->Close().ok())
+      die("failed to serialize Arrow record batch");
+    auto buffer = sink->Finish().ValueOrDie();
+    auto schema_buffer = builder.CreateVector(buffer->data(), schema_size);
+    auto record_batch_buffer = builder.CreateVector(
+      buffer->data() + schema_size, detail::narrow_cast<size_t>(size)
+                                      - detail::narrow_cast<size_t>(
+                                        schema_size));
+    return {schema_buffer, record_batch_buffer};
+  }
+#if ARROW_VERSION_MAJOR >= 2
+  auto flat_schema = arrow::ipc::SerializeSchema(*schema).ValueOrDie();
+#else
+  auto flat_schema = arrow::ipc::SerializeSchema(*schema, nullptr).ValueOrDie();
+#endif
+  auto schema_buffer
+    = builder.CreateVector(flat_schema->data(), flat_schema->size());
+  auto flat_record_batch
+    = arrow::ipc::SerializeRecordBatch(*record_batch,
+                                       arrow::ipc::IpcWriteOptions::Defaults())
+        .ValueOrDie();
+  auto record_batch_buffer = builder.CreateVector(flat_record_batch->data(),
+                                                  flat_record_batch->size());
+  return {schema_buffer, record_batch_buffer};
+}
+
 } // namespace
 
 // -- member types -------------------------------------------------------------
@@ -537,28 +741,23 @@ table_slice arrow_table_slice_builder::finish(
                          : (!serialized_layout_cache_.empty()
                               ? use_layout(serialized_layout_cache_)
                               : gen_layout());
-  // Pack schema.
-#if ARROW_VERSION_MAJOR >= 2
-  auto flat_schema = arrow::ipc::SerializeSchema(*schema_).ValueOrDie();
-#else
-  auto flat_schema
-    = arrow::ipc::SerializeSchema(*schema_, nullptr).ValueOrDie();
-#endif
-  auto schema_buffer
-    = builder_.CreateVector(flat_schema->data(), flat_schema->size());
-  // Pack record batch.
+  // Pack schema and record batch. Dictionary-encoded columns change their
+  // type from slice to slice, so we adjust the schema to the actual columns.
+  auto schema = schema_;
   auto columns = std::vector<std::shared_ptr<arrow::Array>>{};
   columns.reserve(column_builders_.size());
-  for (auto&& builder : column_builders_)
-    columns.emplace_back(builder->finish());
+  for (auto&& builder : column_builders_) {
+    auto column = builder->finish();
+    auto i = detail::narrow_cast<int>(columns.size());
+    if (!column->type()->Equals(schema->field(i)->type()))
+      schema = schema->SetField(i, schema->field(i)->WithType(column->type()))
+                 .ValueOrDie();
+    columns.emplace_back(std::move(column));
+  }
   auto record_batch
-    = arrow::RecordBatch::Make(schema_, rows_, std::move(columns));
-  auto flat_record_batch
-    = arrow::ipc::SerializeRecordBatch(*record_batch,
-                                       arrow::ipc::IpcWriteOptions::Defaults())
-        .ValueOrDie();
-  auto record_batch_buffer = builder_.CreateVector(flat_record_batch->data(),
-                                                   flat_record_batch->size());
+    = arrow::RecordBatch::Make(schema, rows_, std::move(columns));
+  auto [schema_buffer, record_batch_buffer]
+    = pack_record_batch(builder_, record_batch);
   // Create Arrow-encoded table slices.
   auto arrow_table_slice_buffer = fbs::table_slice::arrow::Createv0(
     builder_, layout_buffer, schema_buffer, record_batch_buffer);
@@ -577,9 +776,11 @@ table_slice arrow_table_slice_builder::finish(
 table_slice arrow_table_slice_builder::create(
   const std::shared_ptr<arrow::RecordBatch>& record_batch,
   const record_type& layout, size_t initial_buffer_size) {
-  VAST_ASSERT(record_batch->schema()->Equals(make_arrow_schema(layout)),
+  VAST_ASSERT(record_batch->schema()->num_fields()
+                == make_arrow_schema(layout)->num_fields(),
               "record layout doesn't match record batch schema");
-  auto builder = flatbuffers::FlatBufferBuilder{initial_buffer_size};
+  auto builder = flatbuffers::FlatBufferBuilder{
+    initial_buffer_size, memory_pool::local().flatbuffers_allocator()};
   // Pack layout.
   auto flat_layout = std::vector<char>{};
   caf::binary_serializer source(nullptr, flat_layout);
@@ -588,23 +789,9 @@ table_slice arrow_table_slice_builder::create(
   auto layout_buffer = builder.CreateVector(
     reinterpret_cast<const unsigned char*>(flat_layout.data()),
     flat_layout.size());
-  // Pack schema.
-#if ARROW_VERSION_MAJOR >= 2
-  auto flat_schema
-    = arrow::ipc::SerializeSchema(*record_batch->schema()).ValueOrDie();
-#else
-  auto flat_schema
-    = arrow::ipc::SerializeSchema(*record_batch->schema(), nullptr).ValueOrDie();
-#endif
-  auto schema_buffer
-    = builder.CreateVector(flat_schema->data(), flat_schema->size());
-  // Pack record batch.
-  auto flat_record_batch
-    = arrow::ipc::SerializeRecordBatch(*record_batch,
-                                       arrow::ipc::IpcWriteOptions::Defaults())
-        .ValueOrDie();
-  auto record_batch_buffer = builder.CreateVector(flat_record_batch->data(),
-                                                  flat_record_batch->size());
+  // Pack schema and record batch.
+  auto [schema_buffer, record_batch_buffer]
+    = pack_record_batch(builder, record_batch);
   // Create Arrow-encoded table slices.
   auto arrow_table_slice_buffer = fbs::table_slice::arrow::Createv0(
     builder, layout_buffer, schema_buffer, record_batch_buffer);
@@ -637,14 +824,20 @@ arrow_table_slice_builder::arrow_table_slice_builder(record_type layout,
                                                      size_t initial_buffer_size)
   : table_slice_builder{std::move(layout)},
     schema_{make_arrow_schema(this->layout())},
-    builder_{initial_buffer_size} {
+    builder_{initial_buffer_size,
+             memory_pool::local().flatbuffers_allocator()} {
   VAST_ASSERT(schema_);
   VAST_ASSERT(schema_->num_fields()
               == detail::narrow_cast<int>(this->layout().num_leaves()));
   column_builders_.reserve(columns());
-  auto* pool = arrow::default_memory_pool();
-  for (const auto& field : record_type::each(this->layout()))
-    column_builders_.emplace_back(column_builder::make(field.type(), pool));
+  auto* pool = memory_pool::local().arrow_pool();
+  for (const auto& field : record_type::each(this->layout())) {
+    if (is_string_column(field.type()))
+      column_builders_.emplace_back(
+        std::make_unique<dictionary_column_builder>(pool));
+    else
+      column_builders_.emplace_back(column_builder::make(field.type(), pool));
+  }
 }
 
 bool arrow_table_slice_builder::add_impl(data_view x) {
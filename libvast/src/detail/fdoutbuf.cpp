@@ -8,6 +8,10 @@
 
 #include "vast/detail/fdoutbuf.hpp"
 
+#include "vast/detail/posix.hpp"
+
+#include <caf/expected.hpp>
+
 #include <cstdio>
 #include <unistd.h>
 
@@ -27,7 +31,12 @@ fdoutbuf::int_type fdoutbuf::overflow(int_type c) {
 }
 
 std::streamsize fdoutbuf::xsputn(const char* s, std::streamsize n) {
-  return ::write(fd_, s, n);
+  // Writers hand over large buffers at once, which write(2) may only accept
+  // partially, e.g., when writing to a pipe.
+  auto written = detail::write(fd_, s, static_cast<size_t>(n));
+  if (!written)
+    return 0;
+  return static_cast<std::streamsize>(*written);
 }
 
 } // namespace detail
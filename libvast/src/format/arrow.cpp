@@ -19,6 +19,7 @@
 #  include "vast/table_slice_builder.hpp"
 #  include "vast/type.hpp"
 
+#  include <arrow/api.h>
 #  include <arrow/util/config.h>
 #  include <arrow/util/io_util.h>
 #  include <caf/none.hpp>
@@ -27,6 +28,41 @@
 
 namespace vast::format::arrow {
 
+namespace {
+
+/// Replaces dictionary-encoded string columns with plain string columns. The
+/// stream writer requires all record batches to match the schema of the
+/// layout, whereas table slices choose to encode string columns per slice.
+std::shared_ptr<::arrow::RecordBatch>
+decode_dictionaries(std::shared_ptr<::arrow::RecordBatch> batch) {
+  for (int i = 0; i < batch->num_columns(); ++i) {
+    auto column = batch->column(i);
+    if (column->type_id() != ::arrow::Type::DICTIONARY)
+      continue;
+    const auto& encoded = static_cast<const ::arrow::DictionaryArray&>(*column);
+    const auto& dictionary
+      = static_cast<const ::arrow::StringArray&>(*encoded.dictionary());
+    auto builder = ::arrow::StringBuilder{};
+    auto ok = builder.Reserve(encoded.length()).ok();
+    for (int64_t row = 0; ok && row < encoded.length(); ++row)
+      ok = encoded.IsNull(row)
+             ? builder.AppendNull().ok()
+             : builder.Append(dictionary.GetView(encoded.GetValueIndex(row)))
+                 .ok();
+    std::shared_ptr<::arrow::Array> decoded;
+    if (!ok || !builder.Finish(&decoded).ok())
+      return nullptr;
+    auto field = batch->schema()->field(i)->WithType(::arrow::utf8());
+    auto result = batch->SetColumn(i, field, decoded);
+    if (!result.ok())
+      return nullptr;
+    batch = result.MoveValueUnsafe();
+  }
+  return batch;
+}
+
+} // namespace
+
 writer::writer() {
   out_ = std::make_shared<::arrow::io::StdoutStream>();
 }
@@ -45,8 +81,10 @@ caf::error writer::write(const table_slice& slice) {
   if (!layout(slice.layout()))
     return caf::make_error(ec::logic_error, "failed to update layout");
   // Get the Record Batch and print it.
-  auto batch = as_record_batch(slice);
-  VAST_ASSERT(batch != nullptr);
+  auto batch = decode_dictionaries(as_record_batch(slice));
+  if (batch == nullptr)
+    return caf::make_error(ec::unspecified,
+                           "failed to decode dictionary-encoded columns");
   if (auto status = current_batch_writer_->WriteRecordBatch(*batch);
       !status.ok())
     return caf::make_error(ec::unspecified, "failed to write record batch",
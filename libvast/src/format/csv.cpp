@@ -27,6 +27,7 @@
 #include <ostream>
 #include <string_view>
 #include <type_traits>
+#include <vector>
 
 namespace vast::format::csv {
 
@@ -111,23 +112,28 @@ caf::error writer::write(const table_slice& x) {
       append(field.key());
     }
     append('\n');
-    write_buf();
   }
+  // Resolve the column types once per slice instead of walking the nested
+  // layout for every row.
+  auto types = std::vector<const type*>{};
+  types.reserve(x.columns());
+  for (const auto& field : record_type::each{layout})
+    types.push_back(&field.type());
+  VAST_ASSERT(types.size() == x.columns());
   // Print the cell contents.
   auto iter = std::back_inserter(buf_);
   for (size_t row = 0; row < x.rows(); ++row) {
     append(last_layout_);
-    size_t column = 0;
-    for (const auto& field : record_type::each{layout}) {
+    for (size_t column = 0; column < types.size(); ++column) {
       append(separator);
-      if (auto err = render(iter, x.at(row, column, field.type())))
+      if (auto err = render(iter, x.at(row, column, *types[column])))
         return err;
-      ++column;
     }
-    VAST_ASSERT(column == x.columns());
     append('\n');
-    write_buf();
+    if (buf_.size() >= max_buffer_size)
+      write_buf();
   }
+  write_buf();
   return caf::none;
 }
 
@@ -0,0 +1,376 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/memory_pool.hpp"
+
+#include "vast/config.hpp"
+#include "vast/detail/narrow.hpp"
+#include "vast/logger.hpp"
+
+#include <arrow/memory_pool.h>
+#include <arrow/status.h>
+#include <caf/settings.hpp>
+#include <flatbuffers/flatbuffers.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <new>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if VAST_LINUX
+#  include <sys/syscall.h>
+
+#  include <unistd.h>
+#endif
+
+namespace vast {
+
+namespace {
+
+/// The target of all zero-sized allocations.
+alignas(memory_pool::alignment) std::byte zero_size_area[1];
+
+size_t round_up(size_t size, size_t multiple) {
+  return (size + multiple - 1) / multiple * multiple;
+}
+
+#if VAST_LINUX
+
+/// The NUMA policy that prefers allocating from a given node, from
+/// <numaif.h>. We avoid the dependency on libnuma by using the system call
+/// directly.
+constexpr int mpol_preferred = 1;
+
+/// @returns The number of NUMA nodes of the machine.
+int num_numa_nodes() {
+  auto result = 0;
+  auto err = std::error_code{};
+  auto dir = std::filesystem::directory_iterator{"/sys/devices/system/node",
+                                                 err};
+  for (; !err && dir != std::filesystem::directory_iterator{};
+       dir.increment(err)) {
+    auto name = dir->path().filename().string();
+    if (name.size() > 4 && name.compare(0, 4, "node") == 0
+        && std::all_of(name.begin() + 4, name.end(), ::isdigit))
+      result = std::max(result, std::stoi(name.substr(4)) + 1);
+  }
+  return std::max(result, 1);
+}
+
+/// @returns The NUMA node that the calling thread currently runs on.
+int current_numa_node() {
+  unsigned cpu = 0;
+  unsigned node = 0;
+  if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+    return 0;
+  return detail::narrow_cast<int>(node);
+}
+
+#else
+
+int num_numa_nodes() {
+  return 1;
+}
+
+int current_numa_node() {
+  return 0;
+}
+
+#endif
+
+/// The process-wide pools.
+struct global_pools {
+  std::mutex mutex;
+  memory_pool_options options;
+  /// The current pool for every NUMA node.
+  std::vector<memory_pool*> current;
+  /// All pools ever created, including the ones that `configure` replaced.
+  std::vector<std::unique_ptr<memory_pool>> all;
+};
+
+global_pools& pools() {
+  // Intentionally leaked: buffers that are released during static
+  // destruction must still find their pool.
+  static auto* result = new global_pools;
+  return *result;
+}
+
+/// Adapts a memory pool to the Arrow memory pool interface.
+class arrow_adapter final : public arrow::MemoryPool {
+public:
+  explicit arrow_adapter(memory_pool& pool) : pool_{pool} {
+    // nop
+  }
+
+  arrow::Status Allocate(int64_t size, uint8_t** out) override {
+    auto* ptr = pool_.allocate(detail::narrow_cast<size_t>(size));
+    if (ptr == nullptr)
+      return arrow::Status::OutOfMemory("failed to allocate ", size, " bytes");
+    *out = reinterpret_cast<uint8_t*>(ptr);
+    return arrow::Status::OK();
+  }
+
+  arrow::Status
+  Reallocate(int64_t old_size, int64_t new_size, uint8_t** ptr) override {
+    auto* result = pool_.reallocate(reinterpret_cast<std::byte*>(*ptr),
+                                    detail::narrow_cast<size_t>(old_size),
+                                    detail::narrow_cast<size_t>(new_size));
+    if (result == nullptr)
+      return arrow::Status::OutOfMemory("failed to reallocate ", new_size,
+                                        " bytes");
+    *ptr = reinterpret_cast<uint8_t*>(result);
+    return arrow::Status::OK();
+  }
+
+  void Free(uint8_t* buffer, int64_t size) override {
+    pool_.deallocate(reinterpret_cast<std::byte*>(buffer),
+                     detail::narrow_cast<size_t>(size));
+  }
+
+  [[nodiscard]] int64_t bytes_allocated() const override {
+    return detail::narrow_cast<int64_t>(pool_.bytes_allocated());
+  }
+
+  [[nodiscard]] int64_t max_memory() const override {
+    return detail::narrow_cast<int64_t>(pool_.peak_bytes_allocated());
+  }
+
+  [[nodiscard]] std::string backend_name() const override {
+    return "vast";
+  }
+
+private:
+  memory_pool& pool_;
+};
+
+/// Adapts a memory pool to the FlatBuffers allocator interface.
+class flatbuffers_adapter final : public flatbuffers::Allocator {
+public:
+  explicit flatbuffers_adapter(memory_pool& pool) : pool_{pool} {
+    // nop
+  }
+
+  uint8_t* allocate(size_t size) override {
+    auto* result = pool_.allocate(size);
+    if (result == nullptr)
+      throw std::bad_alloc{};
+    return reinterpret_cast<uint8_t*>(result);
+  }
+
+  void deallocate(uint8_t* ptr, size_t size) override {
+    pool_.deallocate(reinterpret_cast<std::byte*>(ptr), size);
+  }
+
+private:
+  memory_pool& pool_;
+};
+
+} // namespace
+
+struct memory_pool::adapters {
+  explicit adapters(memory_pool& pool)
+    : arrow_pool{pool}, flatbuffers_allocator{pool} {
+    // nop
+  }
+
+  arrow_adapter arrow_pool;
+  flatbuffers_adapter flatbuffers_allocator;
+};
+
+// -- constructors, destructors, and assignment operators ----------------------
+
+memory_pool::memory_pool(int node, bool huge_pages)
+  : node_{node},
+    huge_pages_{huge_pages},
+    adapters_{std::make_unique<adapters>(*this)} {
+  // nop
+}
+
+memory_pool::~memory_pool() noexcept {
+  // nop
+}
+
+// -- allocation ---------------------------------------------------------------
+
+std::byte* memory_pool::allocate(size_t size) noexcept {
+  if (size == 0)
+    return zero_size_area;
+  std::byte* result = nullptr;
+  if (size >= mapping_threshold) {
+    result = map(size);
+  } else {
+    void* ptr = nullptr;
+    if (::posix_memalign(&ptr, alignment, round_up(size, alignment)) == 0)
+      result = static_cast<std::byte*>(ptr);
+  }
+  if (result != nullptr)
+    account(size, true);
+  return result;
+}
+
+void memory_pool::deallocate(std::byte* ptr, size_t size) noexcept {
+  if (ptr == zero_size_area || ptr == nullptr)
+    return;
+  if (size >= mapping_threshold) {
+    auto length = round_up(size, huge_pages_ ? huge_page_size : alignment);
+    ::munmap(ptr, length);
+    mapped_bytes_ -= length;
+  } else {
+    std::free(ptr);
+  }
+  account(size, false);
+}
+
+std::byte* memory_pool::reallocate(std::byte* ptr, size_t old_size,
+                                   size_t new_size) noexcept {
+  auto* result = allocate(new_size);
+  if (result == nullptr)
+    return nullptr;
+  if (ptr != zero_size_area)
+    std::memcpy(result, ptr, std::min(old_size, new_size));
+  deallocate(ptr, old_size);
+  return result;
+}
+
+// -- adapters -----------------------------------------------------------------
+
+arrow::MemoryPool* memory_pool::arrow_pool() noexcept {
+  return &adapters_->arrow_pool;
+}
+
+flatbuffers::Allocator* memory_pool::flatbuffers_allocator() noexcept {
+  return &adapters_->flatbuffers_allocator;
+}
+
+// -- properties ---------------------------------------------------------------
+
+int memory_pool::node() const noexcept {
+  return node_;
+}
+
+size_t memory_pool::bytes_allocated() const noexcept {
+  return bytes_allocated_;
+}
+
+size_t memory_pool::peak_bytes_allocated() const noexcept {
+  return peak_bytes_allocated_;
+}
+
+caf::settings memory_pool::status() const {
+  caf::settings result;
+  if (node_ >= 0)
+    put(result, "numa-node", node_);
+  put(result, "huge-pages", huge_pages_);
+  put(result, "bytes-allocated", bytes_allocated_.load());
+  put(result, "peak-bytes-allocated", peak_bytes_allocated_.load());
+  put(result, "mapped-bytes", mapped_bytes_.load());
+  put(result, "allocations", allocations_.load());
+  return result;
+}
+
+// -- global pools -------------------------------------------------------------
+
+void memory_pool::configure(const memory_pool_options& options) {
+  auto& global = pools();
+  auto lock = std::lock_guard{global.mutex};
+  global.options = options;
+  global.current.clear();
+  if (!options.numa) {
+    global.all.push_back(std::make_unique<memory_pool>(-1, options.huge_pages));
+    global.current.push_back(global.all.back().get());
+    return;
+  }
+  auto nodes = num_numa_nodes();
+  for (auto node = 0; node < nodes; ++node) {
+    global.all.push_back(
+      std::make_unique<memory_pool>(node, options.huge_pages));
+    global.current.push_back(global.all.back().get());
+  }
+  VAST_VERBOSE("{} created memory pools for {} NUMA nodes", __func__, nodes);
+}
+
+memory_pool& memory_pool::local() {
+  auto& global = pools();
+  auto lock = std::lock_guard{global.mutex};
+  if (global.current.empty()) {
+    global.all.push_back(std::make_unique<memory_pool>(-1, false));
+    global.current.push_back(global.all.back().get());
+  }
+  if (global.current.size() == 1)
+    return *global.current.front();
+  auto node = detail::narrow_cast<size_t>(current_numa_node());
+  return *global.current[node < global.current.size() ? node : 0];
+}
+
+caf::settings memory_pool::global_status() {
+  auto& global = pools();
+  auto lock = std::lock_guard{global.mutex};
+  caf::settings result;
+  size_t bytes_allocated = 0;
+  size_t peak_bytes_allocated = 0;
+  for (const auto& pool : global.all) {
+    bytes_allocated += pool->bytes_allocated();
+    peak_bytes_allocated += pool->peak_bytes_allocated();
+  }
+  put(result, "huge-pages", global.options.huge_pages);
+  put(result, "numa", global.options.numa);
+  put(result, "bytes-allocated", bytes_allocated);
+  put(result, "peak-bytes-allocated", peak_bytes_allocated);
+  auto pools = caf::config_value::list{};
+  for (const auto* pool : global.current)
+    pools.emplace_back(pool->status());
+  put(result, "pools", std::move(pools));
+  return result;
+}
+
+// -- implementation details ---------------------------------------------------
+
+std::byte* memory_pool::map(size_t size) noexcept {
+  auto length = round_up(size, huge_pages_ ? huge_page_size : alignment);
+  auto* ptr = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ptr == MAP_FAILED)
+    return nullptr;
+#if VAST_LINUX
+  if (huge_pages_ && ::madvise(ptr, length, MADV_HUGEPAGE) != 0)
+    VAST_DEBUG("{} failed to enable huge pages: {}", __func__,
+               std::strerror(errno));
+  if (node_ >= 0 && node_ < 64) {
+    auto nodemask = 1ul << node_;
+    if (::syscall(SYS_mbind, ptr, length, mpol_preferred, &nodemask,
+                  sizeof(nodemask) * 8, 0)
+        != 0)
+      VAST_DEBUG("{} failed to bind memory to NUMA node {}: {}", __func__,
+                 node_, std::strerror(errno));
+  }
+#endif
+  mapped_bytes_ += length;
+  return static_cast<std::byte*>(ptr);
+}
+
+void memory_pool::account(size_t size, bool allocated) noexcept {
+  if (!allocated) {
+    bytes_allocated_ -= size;
+    return;
+  }
+  ++allocations_;
+  auto current = bytes_allocated_ += size;
+  auto peak = peak_bytes_allocated_.load();
+  while (current > peak
+         && !peak_bytes_allocated_.compare_exchange_weak(peak, current))
+    ; // nop
+}
+
+} // namespace vast
@@ -12,6 +12,7 @@
 #include "vast/fbs/table_slice.hpp"
 #include "vast/fbs/utils.hpp"
 #include "vast/logger.hpp"
+#include "vast/memory_pool.hpp"
 #include "vast/msgpack_table_slice.hpp"
 
 #include <cstddef>
@@ -170,7 +171,8 @@ msgpack_table_slice_builder::msgpack_table_slice_builder(
   : table_slice_builder{std::move(layout)},
     flat_layout_{flatten(this->layout())},
     msgpack_builder_{data_},
-    builder_{initial_buffer_size} {
+    builder_{initial_buffer_size,
+             memory_pool::local().flatbuffers_allocator()} {
   data_.reserve(initial_buffer_size);
 }
 
@@ -8,9 +8,13 @@
 
 #include "vast/partition_synopsis.hpp"
 
+#include "vast/chunk.hpp"
 #include "vast/error.hpp"
 #include "vast/fbs/utils.hpp"
 #include "vast/synopsis_factory.hpp"
+#include "vast/time_synopsis.hpp"
+
+#include <algorithm>
 
 namespace vast {
 
@@ -88,6 +92,27 @@ size_t partition_synopsis::memusage() const {
   return result;
 }
 
+std::optional<std::pair<time, time>> partition_synopsis::time_range() const {
+  auto result = std::optional<std::pair<time, time>>{};
+  auto update = [&](const synopsis_ptr& x) {
+    const auto* ts = dynamic_cast<const time_synopsis*>(x.get());
+    // Synopses that never saw any data have an inverted range.
+    if (ts == nullptr || ts->min() > ts->max())
+      return;
+    if (!result) {
+      result.emplace(ts->min(), ts->max());
+    } else {
+      result->first = std::min(result->first, ts->min());
+      result->second = std::max(result->second, ts->max());
+    }
+  };
+  for (const auto& [_, synopsis] : field_synopses_)
+    update(synopsis);
+  for (const auto& [_, synopsis] : type_synopses_)
+    update(synopsis);
+  return result;
+}
+
 caf::expected<flatbuffers::Offset<fbs::partition_synopsis::v0>>
 pack(flatbuffers::FlatBufferBuilder& builder, const partition_synopsis& x) {
   std::vector<flatbuffers::Offset<fbs::synopsis::v0>> synopses;
@@ -113,6 +138,11 @@ pack(flatbuffers::FlatBufferBuilder& builder, const partition_synopsis& x) {
 
 caf::error
 unpack(const fbs::partition_synopsis::v0& x, partition_synopsis& ps) {
+  return unpack(x, ps, nullptr);
+}
+
+caf::error unpack(const fbs::partition_synopsis::v0& x, partition_synopsis& ps,
+                  chunk_ptr chunk) {
   if (!x.synopses())
     return caf::make_error(ec::format_error, "missing synopses");
   for (auto synopsis : *x.synopses()) {
@@ -123,7 +153,7 @@ unpack(const fbs::partition_synopsis::v0& x, partition_synopsis& ps) {
         = fbs::deserialize_bytes(synopsis->qualified_record_field(), qf))
       return error;
     synopsis_ptr ptr;
-    if (auto error = unpack(*synopsis, ptr))
+    if (auto error = unpack(*synopsis, ptr, chunk))
       return error;
     if (!qf.field_name.empty())
       ps.field_synopses_[qf] = std::move(ptr);
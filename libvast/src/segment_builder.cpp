@@ -16,6 +16,7 @@
 #include "vast/fbs/utils.hpp"
 #include "vast/ids.hpp"
 #include "vast/logger.hpp"
+#include "vast/memory_pool.hpp"
 #include "vast/segment.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/uuid.hpp"
@@ -25,7 +26,8 @@
 namespace vast {
 
 segment_builder::segment_builder(size_t initial_buffer_size)
-  : builder_{initial_buffer_size} {
+  : builder_{initial_buffer_size,
+             memory_pool::local().flatbuffers_allocator()} {
   reset();
 }
 
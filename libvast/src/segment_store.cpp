@@ -9,14 +9,20 @@
 #include "vast/segment_store.hpp"
 
 #include "vast/bitmap_algorithms.hpp"
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/uuid.hpp"
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/error.hpp"
 #include "vast/concept/printable/vast/uuid.hpp"
 #include "vast/detail/overload.hpp"
+#include "vast/detail/deserialize.hpp"
+#include "vast/detail/serialize.hpp"
 #include "vast/error.hpp"
 #include "vast/fbs/segment.hpp"
 #include "vast/fbs/utils.hpp"
 #include "vast/ids.hpp"
+#include "vast/io/read.hpp"
+#include "vast/io/save.hpp"
 #include "vast/logger.hpp"
 #include "vast/system/status_verbosity.hpp"
 #include "vast/table_slice.hpp"
@@ -59,44 +65,56 @@ segment_store::lookup::handle_segment() {
                detail::pretty_type_name(this), cand);
     return store_.builder_.lookup(xs_);
   }
+  auto selection = store_.live(cand, xs_);
+  auto slices = caf::expected<std::vector<table_slice>>{caf::no_error};
   auto i = store_.cache_.find(cand);
   if (i != store_.cache_.end()) {
     VAST_DEBUG("{} got cache hit for segment {}",
                detail::pretty_type_name(this), cand);
-    return i->second.lookup(xs_);
+    slices = i->second.lookup(selection);
+  } else {
+    VAST_DEBUG("{} got cache miss for segment {}",
+               detail::pretty_type_name(this), cand);
+    auto s = store_.load_segment(cand);
+    if (!s)
+      return s.error();
+    store_.cache_.emplace(cand, *s);
+    slices = s->lookup(selection);
   }
-  VAST_DEBUG("{} got cache miss for segment {}", detail::pretty_type_name(this),
-             cand);
-  auto s = store_.load_segment(cand);
-  if (!s)
-    return s.error();
-  store_.cache_.emplace(cand, *s);
-  return s->lookup(xs_);
+  if (!slices)
+    return slices.error();
+  return store_.prune(cand, std::move(*slices));
 }
 
 // TODO: return expected<segment_store_ptr> for better error propagation.
 segment_store_ptr
 segment_store::make(std::filesystem::path dir, size_t max_segment_size,
-                    size_t in_memory_segments) {
-  VAST_TRACE_SCOPE("{} {} {}", VAST_ARG(dir), VAST_ARG(max_segment_size),
-                   VAST_ARG(in_memory_segments));
+                    size_t in_memory_segments, double compaction_threshold) {
+  VAST_TRACE_SCOPE("{} {} {} {}", VAST_ARG(dir), VAST_ARG(max_segment_size),
+                   VAST_ARG(in_memory_segments),
+                   VAST_ARG(compaction_threshold));
   VAST_ASSERT(max_segment_size > 0);
-  auto result = segment_store_ptr{
-    new segment_store{std::move(dir), max_segment_size, in_memory_segments}};
+  auto result = segment_store_ptr{new segment_store{
+    std::move(dir), max_segment_size, in_memory_segments,
+    compaction_threshold}};
   if (auto err = result->register_segments())
     return nullptr;
+  if (auto err = result->register_tombstones())
+    return nullptr;
   return result;
 }
 
 segment_store::segment_store(std::filesystem::path dir,
                              uint64_t max_segment_size,
-                             size_t in_memory_segments)
+                             size_t in_memory_segments,
+                             double compaction_threshold)
   : dir_{std::move(dir)},
     max_segment_size_{max_segment_size},
     cache_{in_memory_segments},
     // TODO: Make vast.max-segment-size a hard instead of a soft limit, such
     // that we do not need to multiplay with an arbitrary value above 1 here.
-    builder_{detail::narrow_cast<size_t>(max_segment_size * 1.1)} {
+    builder_{detail::narrow_cast<size_t>(max_segment_size * 1.1)},
+    compaction_threshold_{compaction_threshold} {
   // nop
 }
 
@@ -132,6 +150,113 @@ segment_store::extract(const ids& xs) const {
   return std::make_unique<lookup>(*this, std::move(xs), std::move(candidates));
 }
 
+template <class Segment>
+uint64_t segment_store::rewrite(Segment& seg, const ids& xs) {
+  // This algorithm removes all events with IDs in `xs` from a segment. For
+  // existing segments, we create a new segment that contains all table slices
+  // that remain after erasing `xs` from the input segment. For builders, we
+  // update the builder directly by replacing the set of table slices. In any
+  // case, we have to update `segments_` to point to the new segment ID.
+  auto segment_id = seg.id();
+  // Get all slices in the segment and generate a new segment that contains
+  // only what's left after dropping the selection.
+  auto segment_ids = seg.ids();
+  // Check whether we can drop the entire segment.
+  if (is_subset(segment_ids, xs)) {
+    return drop(seg);
+  }
+  std::vector<table_slice> slices;
+  if (auto maybe_slices = seg.lookup(segment_ids)) {
+    slices = std::move(*maybe_slices);
+    if (slices.empty()) {
+      VAST_WARN("{} got no slices after lookup for segment {} => "
+                "erases entire segment!",
+                detail::pretty_type_name(this), segment_id);
+      return drop(seg);
+    }
+  } else {
+    VAST_WARN("{} was unable to get table slice for segment {} => "
+              "erases entire segment!",
+              detail::pretty_type_name(this), segment_id);
+    return drop(seg);
+  }
+  VAST_ASSERT(slices.size() > 0);
+  // We have IDs we wish to delete in `xs`, but we need a bitmap of what to
+  // keep for `select` in order to fill `new_slices` with the table slices
+  // that remain after dropping all deleted IDs from the segment.
+  auto keep_mask = ~xs;
+  std::vector<table_slice> new_slices;
+  uint64_t erased_events = 0;
+  for (auto& slice : slices) {
+    // Expand keep_mask on-the-fly if needed.
+    auto max_id = slice.offset() + slice.rows();
+    if (keep_mask.size() < max_id)
+      keep_mask.append_bits(true, max_id - keep_mask.size());
+    size_t new_slices_size_before = new_slices.size();
+    select(new_slices, slice, keep_mask);
+    size_t remaining_rows = 0;
+    for (size_t i = new_slices_size_before; i < new_slices.size(); ++i)
+      remaining_rows += new_slices[i].rows();
+    erased_events += slice.rows() - remaining_rows;
+  }
+  if (new_slices.empty()) {
+    VAST_WARN("{} was unable to generate any new slice for segment "
+              "{} => erases entire segment!",
+              detail::pretty_type_name(this), segment_id);
+    return drop(seg);
+  }
+  VAST_VERBOSE("{} shrinks segment {} from {} to {} slices",
+               detail::pretty_type_name(this), segment_id, slices.size(),
+               new_slices.size());
+  // Remove stale state.
+  segments_.erase_value(segment_id);
+  // Estimate the size of the new segment.
+  auto size_estimate = size_t{};
+  for (const auto& slice : new_slices)
+    size_estimate += as_bytes(slice).size();
+  size_estimate *= 1.1;
+  // Create a new segment from the remaining slices.
+  segment_builder tmp_builder{size_estimate};
+  segment_builder* builder = &tmp_builder;
+  if constexpr (std::is_same_v<Segment, segment_builder>) {
+    // If `update` got called with a builder then we simply use that by
+    // resetting it and filling it with new content. Otherwise, we fill
+    // `tmp_builder` instead and replace the the segment `seg` in the next
+    // `if constexpr` block.
+    seg.reset();
+    builder = &seg;
+  }
+  for (auto& slice : new_slices) {
+    if (auto err = builder->add(slice)) {
+      VAST_ERROR("{} failed to add slice to builder: {}",
+                 detail::pretty_type_name(this), err);
+    } else if (!segments_.inject(slice.offset(),
+                                 slice.offset() + slice.rows(),
+                                 builder->id()))
+      VAST_ERROR("{} failed to update range_map",
+                 detail::pretty_type_name(this));
+  }
+  // Flush the new segment and remove the previous segment.
+  if constexpr (std::is_same_v<Segment, segment>) {
+    auto new_segment = builder->finish();
+    auto filename = segment_path() / to_string(new_segment.id());
+    if (auto err = write(filename, new_segment.chunk()))
+      VAST_ERROR("{} failed to persist the new segment",
+                 detail::pretty_type_name(this));
+    else
+      track(new_segment.id(), new_segment.chunk()->size());
+    untrack(segment_id);
+    auto stale_filename = segment_path() / to_string(segment_id);
+    // Schedule deletion of the segment file when releasing the chunk.
+    seg.chunk()->add_deletion_step([=]() noexcept {
+      std::error_code err{};
+      std::filesystem::remove(stale_filename, err);
+    });
+  }
+  // else: nothing to do, since we can continue filling the active segment.
+  return erased_events;
+}
+
 caf::error segment_store::erase(const ids& xs) {
   VAST_TRACE_SCOPE("{}", VAST_ARG(xs));
   VAST_VERBOSE("erasing {} ids from store", rank(xs));
@@ -141,131 +266,25 @@ caf::error segment_store::erase(const ids& xs) {
     return err;
   if (candidates.empty())
     return caf::none;
-  auto is_subset_of_xs = [&](const ids& ys) { return is_subset(ys, xs); };
   // Counts number of total erased events for user-facing output.
   uint64_t erased_events = 0;
-  // Implements the body of the for-loop below. This lambda must be generic,
-  // because the argument is either a `segment` or a `segment_builder`. This
-  // algorithm removes all events with IDs in `xs` from a segment. For existing
-  // segments, we create a new segment that contains all table slices that
-  // remain after erasing `xs` from the input segment. For builders, we update
-  // the builder directly by replacing the set of table slices. In any case, we
-  // have to update `segments_` to point to the new segment ID.
-  auto impl = [&](auto& seg) {
-    auto segment_id = seg.id();
-    // Get all slices in the segment and generate a new segment that contains
-    // only what's left after dropping the selection.
-    auto segment_ids = seg.ids();
-    // Check whether we can drop the entire segment.
-    if (is_subset_of_xs(segment_ids)) {
-      erased_events += drop(seg);
-      return;
-    }
-    std::vector<table_slice> slices;
-    if (auto maybe_slices = seg.lookup(segment_ids)) {
-      slices = std::move(*maybe_slices);
-      if (slices.empty()) {
-        VAST_WARN("{} got no slices after lookup for segment {} => "
-                  "erases entire segment!",
-                  detail::pretty_type_name(this), segment_id);
-        erased_events += drop(seg);
-        return;
-      }
-    } else {
-      VAST_WARN("{} was unable to get table slice for segment {} => "
-                "erases entire segment!",
-                detail::pretty_type_name(this), segment_id);
-      erased_events += drop(seg);
-      return;
-    }
-    VAST_ASSERT(slices.size() > 0);
-    // We have IDs we wish to delete in `xs`, but we need a bitmap of what to
-    // keep for `select` in order to fill `new_slices` with the table slices
-    // that remain after dropping all deleted IDs from the segment.
-    auto keep_mask = ~xs;
-    std::vector<table_slice> new_slices;
-    for (auto& slice : slices) {
-      // Expand keep_mask on-the-fly if needed.
-      auto max_id = slice.offset() + slice.rows();
-      if (keep_mask.size() < max_id)
-        keep_mask.append_bits(true, max_id - keep_mask.size());
-      size_t new_slices_size_before = new_slices.size();
-      select(new_slices, slice, keep_mask);
-      size_t remaining_rows = 0;
-      for (size_t i = new_slices_size_before; i < new_slices.size(); ++i)
-        remaining_rows += new_slices[i].rows();
-      erased_events += slice.rows() - remaining_rows;
-    }
-    if (new_slices.empty()) {
-      VAST_WARN("{} was unable to generate any new slice for segment "
-                "{} => erases entire segment!",
-                detail::pretty_type_name(this), segment_id);
-      erased_events += drop(seg);
-      return;
-    }
-    VAST_VERBOSE("{} shrinks segment {} from {} to {} slices",
-                 detail::pretty_type_name(this), segment_id, slices.size(),
-                 new_slices.size());
-    // Remove stale state.
-    segments_.erase_value(segment_id);
-    // Estimate the size of the new segment.
-    auto size_estimate = size_t{};
-    for (const auto& slice : new_slices)
-      size_estimate += as_bytes(slice).size();
-    size_estimate *= 1.1;
-    // Create a new segment from the remaining slices.
-    segment_builder tmp_builder{size_estimate};
-    segment_builder* builder = &tmp_builder;
-    if constexpr (std::is_same_v<decltype(seg), segment_builder&>) {
-      // If `update` got called with a builder then we simply use that by
-      // resetting it and filling it with new content. Otherwise, we fill
-      // `tmp_builder` instead and replace the the segment `seg` in the next
-      // `if constexpr` block.
-      seg.reset();
-      builder = &seg;
-    }
-    for (auto& slice : new_slices) {
-      if (auto err = builder->add(slice)) {
-        VAST_ERROR("{} failed to add slice to builder: {}",
-                   detail::pretty_type_name(this), err);
-      } else if (!segments_.inject(slice.offset(),
-                                   slice.offset() + slice.rows(),
-                                   builder->id()))
-        VAST_ERROR("{} failed to update range_map",
-                   detail::pretty_type_name(this));
-    }
-    // Flush the new segment and remove the previous segment.
-    if constexpr (std::is_same_v<decltype(seg), segment&>) {
-      auto new_segment = builder->finish();
-      auto filename = segment_path() / to_string(new_segment.id());
-      if (auto err = write(filename, new_segment.chunk()))
-        VAST_ERROR("{} failed to persist the new segment",
-                   detail::pretty_type_name(this));
-      auto stale_filename = segment_path() / to_string(segment_id);
-      // Schedule deletion of the segment file when releasing the chunk.
-      seg.chunk()->add_deletion_step([=]() noexcept {
-        std::error_code err{};
-        std::filesystem::remove(stale_filename, err);
-      });
-    }
-    // else: nothing to do, since we can continue filling the active segment.
-  };
-  // Iterate affected segments.
+  auto result = caf::error{};
+  // The segment-under-construction lives in memory, so we update it in place.
+  // For segments on disk, we only record the erased events in a tombstone,
+  // and leave rewriting the segment to compaction.
   for (auto& candidate : candidates) {
-    auto j = cache_.find(candidate);
-    if (j != cache_.end()) {
-      VAST_DEBUG("{} erases from the cached segment {}",
-                 detail::pretty_type_name(this), candidate);
-      impl(j->second);
-      cache_.erase(j);
-    } else if (candidate == builder_.id()) {
+    if (candidate == builder_.id()) {
       VAST_DEBUG("{} erases from the active segment {}",
                  detail::pretty_type_name(this), candidate);
-      impl(builder_);
-    } else if (auto s = load_segment(candidate)) {
-      VAST_DEBUG("{} erases from the segment {}",
-                 detail::pretty_type_name(this), candidate);
-      impl(*s);
+      erased_events += rewrite(builder_, xs);
+    } else if (auto erased = tombstone(candidate, xs)) {
+      erased_events += *erased;
+    } else {
+      VAST_ERROR("{} failed to erase from the segment {}: {}",
+                 detail::pretty_type_name(this), candidate,
+                 render(erased.error()));
+      if (!result)
+        result = std::move(erased.error());
     }
   }
   if (erased_events > 0) {
@@ -274,7 +293,7 @@ caf::error segment_store::erase(const ids& xs) {
     VAST_INFO("{} erased {} events", detail::pretty_type_name(this),
               erased_events);
   }
-  return caf::none;
+  return result;
 }
 
 caf::expected<std::vector<table_slice>> segment_store::get(const ids& xs) {
@@ -313,7 +332,9 @@ caf::expected<std::vector<table_slice>> segment_store::get(const ids& xs) {
       }
       VAST_DEBUG("{} looks into segment {}", detail::pretty_type_name(this),
                  id);
-      slices = i->second.lookup(xs);
+      slices = i->second.lookup(live(id, xs));
+      if (slices)
+        *slices = prune(id, std::move(*slices));
     }
     if (!slices)
       return slices.error();
@@ -331,6 +352,7 @@ caf::error segment_store::flush() {
   auto filename = segment_path() / to_string(seg.id());
   if (auto err = write(filename, seg.chunk()))
     return err;
+  track(seg.id(), seg.chunk()->size());
   // Keep new segment in the cache.
   cache_.emplace(seg.id(), seg);
   VAST_DEBUG("{} wrote new segment to {}", detail::pretty_type_name(this),
@@ -347,6 +369,7 @@ void segment_store::inspect_status(caf::settings& xs,
     for (auto& segment : cache_)
       mem += segment.second.chunk()->size();
     put(xs, "memory-usage", mem);
+    put(xs, "disk-usage", disk_usage_);
   }
   if (v >= system::status_verbosity::detailed) {
     auto& segments = put_dictionary(xs, "segments");
@@ -356,9 +379,44 @@ void segment_store::inspect_status(caf::settings& xs,
     auto& current = put_dictionary(segments, "current");
     put(current, "uuid", to_string(builder_.id()));
     put(current, "size", builder_.table_slice_bytes());
+    auto& tombstones = put_dictionary(segments, "tombstones");
+    for (const auto& [id, erased] : tombstones_)
+      put(tombstones, to_string(id), rank(erased));
   }
 }
 
+std::vector<uuid> segment_store::compaction_candidates() const {
+  auto result = std::vector<uuid>{};
+  for (const auto& [id, erased] : tombstones_) {
+    auto total = rank(segment_ids(id));
+    if (static_cast<double>(rank(erased))
+        >= compaction_threshold_ * static_cast<double>(total))
+      result.push_back(id);
+  }
+  return result;
+}
+
+caf::error segment_store::compact(const uuid& id) {
+  auto i = tombstones_.find(id);
+  if (i == tombstones_.end())
+    return caf::none;
+  auto seg = caf::expected<segment>{caf::no_error};
+  if (auto j = cache_.find(id); j != cache_.end())
+    seg = j->second;
+  else
+    seg = load_segment(id);
+  if (!seg)
+    return seg.error();
+  VAST_VERBOSE("{} compacts segment {} with {} erased events",
+               detail::pretty_type_name(this), id, rank(i->second));
+  cache_.erase(id);
+  // The erased events no longer count towards the number of events, so we
+  // don't need the return value here.
+  rewrite(*seg, i->second);
+  drop_tombstone(id);
+  return caf::none;
+}
+
 caf::error segment_store::register_segments() {
   if (!std::filesystem::exists(segment_path()))
     return caf::none;
@@ -397,6 +455,7 @@ segment_store::register_segment(const std::filesystem::path& filename) {
   uuid segment_uuid;
   if (auto error = unpack(*s0->uuid(), segment_uuid))
     return error;
+  track(segment_uuid, chk->get()->size());
   VAST_DEBUG("{} found segment {}", detail::pretty_type_name(this),
              segment_uuid);
   for (auto interval : *s0->ids())
@@ -405,6 +464,38 @@ segment_store::register_segment(const std::filesystem::path& filename) {
   return caf::none;
 }
 
+caf::error segment_store::register_tombstones() {
+  if (!std::filesystem::exists(tombstone_path()))
+    return caf::none;
+  std::error_code err{};
+  std::filesystem::directory_iterator dir{tombstone_path(), err};
+  if (err)
+    return caf::make_error(ec::filesystem_error,
+                           fmt::format("failed to find tombstone path {} : {}",
+                                       tombstone_path(), err.message()));
+  for (const auto& entry : dir) {
+    auto id = to<uuid>(entry.path().filename().string());
+    if (!id || segment_bytes_.count(*id) == 0) {
+      // Compaction removes the tombstone after the segment, so we may find
+      // leftovers of a compaction that got interrupted.
+      VAST_DEBUG("{} removes stale tombstone {}",
+                 detail::pretty_type_name(this), entry.path());
+      std::filesystem::remove(entry.path(), err);
+      continue;
+    }
+    auto buffer = io::read(entry.path());
+    if (!buffer)
+      return buffer.error();
+    auto erased = ids{};
+    if (auto error = detail::deserialize(*buffer, erased))
+      return error;
+    VAST_ASSERT(rank(erased) <= num_events_);
+    num_events_ -= rank(erased);
+    tombstones_.emplace(*id, std::move(erased));
+  }
+  return caf::none;
+}
+
 caf::expected<segment> segment_store::load_segment(uuid id) const {
   auto filename = segment_path() / to_string(id);
   VAST_DEBUG("{} mmaps segment from {}", detail::pretty_type_name(this),
@@ -438,6 +529,87 @@ caf::error segment_store::select_segments(const ids& selection,
   return select_with(selection, begin, end, f, g);
 }
 
+ids segment_store::segment_ids(const uuid& id) const {
+  auto result = ids{};
+  for (const auto& x : segments_) {
+    if (x.value == id) {
+      result.append_bits(false, x.left - result.size());
+      result.append_bits(true, x.right - x.left);
+    }
+  }
+  return result;
+}
+
+ids segment_store::live(const uuid& id, const ids& xs) const {
+  if (auto i = tombstones_.find(id); i != tombstones_.end())
+    return xs - i->second;
+  return xs;
+}
+
+std::vector<table_slice>
+segment_store::prune(const uuid& id, std::vector<table_slice> slices) const {
+  auto i = tombstones_.find(id);
+  if (i == tombstones_.end())
+    return slices;
+  auto keep_mask = ~i->second;
+  auto result = std::vector<table_slice>{};
+  for (auto& slice : slices) {
+    auto max_id = slice.offset() + slice.rows();
+    if (keep_mask.size() < max_id)
+      keep_mask.append_bits(true, max_id - keep_mask.size());
+    select(result, slice, keep_mask);
+  }
+  return result;
+}
+
+caf::expected<uint64_t>
+segment_store::tombstone(const uuid& id, const ids& xs) {
+  auto all = segment_ids(id);
+  auto& erased = tombstones_[id];
+  auto before = rank(erased);
+  erased |= all & xs;
+  auto after = rank(erased);
+  if (after == before) {
+    if (before == 0)
+      tombstones_.erase(id);
+    return 0;
+  }
+  if (after == rank(all)) {
+    // Nothing remains of the segment, so we can drop it right away.
+    auto seg = caf::expected<segment>{caf::no_error};
+    if (auto i = cache_.find(id); i != cache_.end())
+      seg = i->second;
+    else
+      seg = load_segment(id);
+    if (!seg)
+      return seg.error();
+    cache_.erase(id);
+    drop_tombstone(id);
+    return drop(*seg) - before;
+  }
+  VAST_VERBOSE("{} marks {} events of segment {} as erased",
+               detail::pretty_type_name(this), after - before, id);
+  if (auto err = persist_tombstone(id))
+    return err;
+  return after - before;
+}
+
+caf::error segment_store::persist_tombstone(const uuid& id) const {
+  auto i = tombstones_.find(id);
+  VAST_ASSERT(i != tombstones_.end());
+  auto buffer = std::vector<char>{};
+  if (auto err = detail::serialize(buffer, i->second))
+    return err;
+  return io::save(tombstone_path() / to_string(id), as_bytes(buffer));
+}
+
+void segment_store::drop_tombstone(const uuid& id) {
+  if (tombstones_.erase(id) == 0)
+    return;
+  std::error_code err{};
+  std::filesystem::remove(tombstone_path() / to_string(id), err);
+}
+
 uint64_t segment_store::drop(segment& x) {
   uint64_t erased_events = 0;
   auto segment_id = x.id();
@@ -460,6 +632,7 @@ uint64_t segment_store::drop(segment& x) {
     std::filesystem::remove(filename, err);
   });
   segments_.erase_value(segment_id);
+  untrack(segment_id);
   return erased_events;
 }
 
@@ -475,4 +648,17 @@ uint64_t segment_store::drop(segment_builder& x) {
   return erased_events;
 }
 
+void segment_store::track(const uuid& id, uint64_t bytes) {
+  auto& tracked = segment_bytes_[id];
+  disk_usage_ = disk_usage_ - tracked + bytes;
+  tracked = bytes;
+}
+
+void segment_store::untrack(const uuid& id) {
+  if (auto it = segment_bytes_.find(id); it != segment_bytes_.end()) {
+    disk_usage_ -= it->second;
+    segment_bytes_.erase(it);
+  }
+}
+
 } // namespace vast
@@ -8,12 +8,17 @@
 
 #include "vast/synopsis.hpp"
 
+#include "vast/address_synopsis.hpp"
+#include "vast/bloom_filter_synopsis.hpp"
 #include "vast/bool_synopsis.hpp"
+#include "vast/chunk.hpp"
+#include "vast/concept/hashable/xxhash.hpp"
 #include "vast/detail/overload.hpp"
 #include "vast/error.hpp"
 #include "vast/fbs/utils.hpp"
 #include "vast/logger.hpp"
 #include "vast/qualified_record_field.hpp"
+#include "vast/string_synopsis.hpp"
 #include "vast/synopsis_factory.hpp"
 #include "vast/time_synopsis.hpp"
 
@@ -21,6 +26,7 @@
 #include <caf/binary_serializer.hpp>
 #include <caf/error.hpp>
 
+#include <optional>
 #include <typeindex>
 
 namespace vast {
@@ -73,6 +79,82 @@ caf::error inspect(caf::deserializer& source, synopsis_ptr& ptr) {
   return caf::none;
 }
 
+namespace {
+
+/// Retrieves the Bloom filter of a synopsis that has a native flatbuffer
+/// layout, materializing it into *buffer* if necessary.
+/// @returns A pointer to the Bloom filter, or `nullptr` if the synopsis has
+///          no native layout.
+const bloom_filter<xxhash64>*
+native_bloom_filter(const synopsis* ptr,
+                    std::optional<bloom_filter<xxhash64>>& buffer) {
+  using string_bloom_filter = bloom_filter_synopsis<std::string, xxhash64>;
+  using address_bloom_filter = bloom_filter_synopsis<address, xxhash64>;
+  using string_handle = mmapped_bloom_filter_synopsis<std::string, xxhash64>;
+  using address_handle = mmapped_bloom_filter_synopsis<address, xxhash64>;
+  if (auto x = dynamic_cast<const string_bloom_filter*>(ptr))
+    return &x->filter();
+  if (auto x = dynamic_cast<const address_bloom_filter*>(ptr))
+    return &x->filter();
+  if (auto x = dynamic_cast<const string_handle*>(ptr))
+    return &buffer.emplace(x->materialize());
+  if (auto x = dynamic_cast<const address_handle*>(ptr))
+    return &buffer.emplace(x->materialize());
+  return nullptr;
+}
+
+caf::expected<flatbuffers::Offset<fbs::bloom_filter_synopsis::v0>>
+pack(flatbuffers::FlatBufferBuilder& builder, const vast::type& type,
+     const bloom_filter<xxhash64>& bf) {
+  auto type_bytes = fbs::serialize_bytes(builder, type);
+  if (!type_bytes)
+    return type_bytes.error();
+  auto seeds = bf.hasher().seeds();
+  auto bits = builder.CreateVector(bf.bits().blocks());
+  fbs::bloom_filter_synopsis::v0Builder bloom_filter_builder(builder);
+  bloom_filter_builder.add_type(*type_bytes);
+  bloom_filter_builder.add_num_hash_functions(
+    static_cast<uint32_t>(bf.num_hash_functions()));
+  bloom_filter_builder.add_seed1(seeds[0]);
+  bloom_filter_builder.add_seed2(seeds[1]);
+  bloom_filter_builder.add_num_bits(bf.size());
+  bloom_filter_builder.add_bits(bits);
+  return bloom_filter_builder.Finish();
+}
+
+template <class T, class Synopsis>
+synopsis_ptr unpack(const fbs::bloom_filter_synopsis::v0& x, vast::type type,
+                    chunk_ptr chunk) {
+  using handle_type = mmapped_bloom_filter_synopsis<T, xxhash64>;
+  if (chunk)
+    return std::make_unique<handle_type>(std::move(type), x, std::move(chunk));
+  // Without a chunk that keeps the buffer alive we must copy the cells.
+  auto handle = handle_type{type, x, nullptr};
+  return std::make_unique<Synopsis>(std::move(type), handle.materialize());
+}
+
+caf::error unpack(const fbs::bloom_filter_synopsis::v0& x, synopsis_ptr& ptr,
+                  chunk_ptr chunk) {
+  if (!x.bits() || x.num_hash_functions() == 0 || x.num_bits() == 0
+      || x.bits()->size() * word<uint64_t>::width < x.num_bits())
+    return caf::make_error(ec::format_error, "invalid bloom filter synopsis");
+  vast::type type;
+  if (auto error = fbs::deserialize_bytes(x.type(), type))
+    return error;
+  if (caf::holds_alternative<string_type>(type))
+    ptr = unpack<std::string, string_synopsis<xxhash64>>(x, std::move(type),
+                                                         std::move(chunk));
+  else if (caf::holds_alternative<address_type>(type))
+    ptr = unpack<address, address_synopsis<xxhash64>>(x, std::move(type),
+                                                      std::move(chunk));
+  else
+    return caf::make_error(ec::format_error, "invalid bloom filter synopsis "
+                                             "type");
+  return caf::none;
+}
+
+} // namespace
+
 caf::expected<flatbuffers::Offset<fbs::synopsis::v0>>
 pack(flatbuffers::FlatBufferBuilder& builder, const synopsis_ptr& synopsis,
      const qualified_record_field& fqf) {
@@ -80,6 +162,7 @@ pack(flatbuffers::FlatBufferBuilder& builder, const synopsis_ptr& synopsis,
   if (!column_name)
     return column_name.error();
   auto ptr = synopsis.get();
+  auto buffer = std::optional<bloom_filter<xxhash64>>{};
   if (auto tptr = dynamic_cast<time_synopsis*>(ptr)) {
     auto min = tptr->min().time_since_epoch().count();
     auto max = tptr->max().time_since_epoch().count();
@@ -94,6 +177,14 @@ pack(flatbuffers::FlatBufferBuilder& builder, const synopsis_ptr& synopsis,
     synopsis_builder.add_qualified_record_field(*column_name);
     synopsis_builder.add_bool_synopsis(&bool_synopsis);
     return synopsis_builder.Finish();
+  } else if (auto bf = native_bloom_filter(ptr, buffer)) {
+    auto bloom_filter_synopsis = pack(builder, ptr->type(), *bf);
+    if (!bloom_filter_synopsis)
+      return bloom_filter_synopsis.error();
+    fbs::synopsis::v0Builder synopsis_builder(builder);
+    synopsis_builder.add_qualified_record_field(*column_name);
+    synopsis_builder.add_bloom_filter_synopsis(*bloom_filter_synopsis);
+    return synopsis_builder.Finish();
   } else {
     auto data = fbs::serialize_bytes(builder, synopsis);
     if (!data)
@@ -110,6 +201,11 @@ pack(flatbuffers::FlatBufferBuilder& builder, const synopsis_ptr& synopsis,
 }
 
 caf::error unpack(const fbs::synopsis::v0& synopsis, synopsis_ptr& ptr) {
+  return unpack(synopsis, ptr, nullptr);
+}
+
+caf::error
+unpack(const fbs::synopsis::v0& synopsis, synopsis_ptr& ptr, chunk_ptr chunk) {
   ptr = nullptr;
   if (auto bs = synopsis.bool_synopsis())
     ptr = std::make_unique<bool_synopsis>(bs->any_true(), bs->any_false());
@@ -123,6 +219,9 @@ caf::error unpack(const fbs::synopsis::v0& synopsis, synopsis_ptr& ptr) {
       os->data()->size());
     if (auto error = sink(ptr))
       return error;
+  } else if (auto bs = synopsis.bloom_filter_synopsis()) {
+    if (auto error = unpack(*bs, ptr, std::move(chunk)))
+      return error;
   } else {
     return caf::make_error(ec::format_error, "no synopsis type");
   }
@@ -18,6 +18,7 @@
 #include "vast/detail/make_io_stream.hpp"
 #include "vast/error.hpp"
 #include "vast/logger.hpp"
+#include "vast/system/metrics.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/status_verbosity.hpp"
 #include "vast/table_slice.hpp"
@@ -259,6 +260,8 @@ accountant(accountant_actor::stateful_pointer<accountant_state> self,
     // done?
     [](const bool&) { return false; });
   VAST_DEBUG("{} animates heartbeat loop", self);
+  // Metrics collected from the registry are attributed to the accountant.
+  self->state->actor_map[self->id()] = "accountant";
   self->delayed_send(self, overview_delay, atom::telemetry_v);
   return {
     [self](atom::announce, const std::string& name) {
@@ -344,6 +347,13 @@ accountant(accountant_actor::stateful_pointer<accountant_state> self,
     },
     [self](atom::telemetry) {
       self->state->command_line_heartbeat();
+      // Collect the in-process metrics that hot paths record into directly.
+      time ts = std::chrono::system_clock::now();
+      for (const auto& [key, value] : metrics_registry::instance().collect()) {
+        auto f
+          = [&, key = key](const auto& x) { self->state->record(key, x, ts); };
+        caf::visit(f, value);
+      }
       self->delayed_send(self, overview_delay, atom::telemetry_v);
     },
     [self](atom::config, accountant_config cfg) {
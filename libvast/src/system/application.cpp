@@ -50,13 +50,24 @@ command::opts_builder add_index_opts(command::opts_builder ob) {
                                             "partitions")
     .add<size_t>("max-taste-partitions", "maximum number of immediately "
                                          "scheduled partitions")
-    .add<size_t>("max-queries,q", "maximum number of concurrent queries");
+    .add<size_t>("max-queries,q", "maximum number of concurrent queries")
+    .add<size_t>("query-cache-size", "maximum number of bytes of cached "
+                                     "predicate lookups")
+    .add<bool>("direct-partition-evaluation", "evaluate queries in passive "
+                                              "partitions without spawning "
+                                              "actors")
+    .add<bool>("partition-local-stores", "store events next to their "
+                                         "partition instead of in the "
+                                         "archive");
 }
 
 command::opts_builder add_archive_opts(command::opts_builder ob) {
   return std::move(ob)
     .add<size_t>("segments,s", "number of cached segments")
-    .add<size_t>("max-segment-size,m", "maximum segment size in MB");
+    .add<size_t>("max-segment-size,m", "maximum segment size in MB")
+    .add<double>("segment-compaction-threshold", "fraction of erased events "
+                                                 "at which to rewrite a "
+                                                 "segment");
 }
 
 auto make_count_command() {
@@ -111,6 +122,9 @@ auto make_export_command() {
       // doesnt' affect the formatted output.
       //.add<bool>("preserve-ids", "don't substitute taxonomy identifiers")
       .add<size_t>("max-events,n", "maximum number of results")
+      .add<std::string>("order", "schedule partitions by time: newest-first "
+                                 "or oldest-first")
+      .add<bool>("profile", "print the time spent in each stage of the query")
       .add<std::string>("read,r", "path for reading the query")
       .add<std::string>("write,w", "path to write events to")
       .add<bool>("uds,d", "treat -w as UNIX domain socket to connect to"));
@@ -175,7 +189,16 @@ auto make_import_command() {
     opts("?vast.import")
       .add<std::string>("batch-encoding", "encoding type of table slices "
                                           "(arrow or msgpack)")
+      .add<bool>("batch-adaptive", "size table slices by the observed event "
+                                   "rate and event size")
+      .add<size_t>("batch-min-size", "lower bound for the size of an "
+                                     "adaptively sized table slice")
       .add<size_t>("batch-size", "upper bound for the size of a table slice")
+      .add<size_t>("batch-target-bytes", "upper bound for the number of bytes "
+                                         "of an adaptively sized table slice")
+      .add<std::string>("batch-target-latency", "time that an adaptively "
+                                                "sized table slice takes to "
+                                                "fill up")
       .add<std::string>("batch-timeout", "timeout after which batched "
                                          "table slices are forwarded")
       .add<bool>("blocking,b", "block until the IMPORTER forwarded all data")
@@ -259,7 +282,16 @@ auto make_spawn_source_command() {
     opts("?vast.spawn.source")
       .add<std::string>("batch-encoding", "encoding type of table slices "
                                           "(arrow or msgpack)")
+      .add<bool>("batch-adaptive", "size table slices by the observed event "
+                                   "rate and event size")
+      .add<size_t>("batch-min-size", "lower bound for the size of an "
+                                     "adaptively sized table slice")
       .add<size_t>("batch-size", "upper bound for the size of a table slice")
+      .add<size_t>("batch-target-bytes", "upper bound for the number of bytes "
+                                         "of an adaptively sized table slice")
+      .add<std::string>("batch-target-latency", "time that an adaptively "
+                                                "sized table slice takes to "
+                                                "fill up")
       .add<std::string>("batch-timeout", "timeout after which batched "
                                          "table slices are forwarded")
       .add<std::string>("listen,l", "the endpoint to listen on "
@@ -360,6 +392,8 @@ auto make_spawn_command() {
                         opts("?vast.spawn.importer"), false);
   spawn->add_subcommand("index", "creates a new index", "",
                         add_index_opts(opts("?vast.spawn.index")), false);
+  spawn->add_subcommand("matcher", "creates a new matcher", "",
+                        opts("?vast.spawn.matcher"), false);
   spawn->add_subcommand(make_spawn_source_command());
   spawn->add_subcommand(make_spawn_sink_command());
   return spawn;
@@ -386,7 +420,14 @@ auto make_start_command() {
       .add<std::string>("disk-budget-high", "high-water mark for disk budget")
       .add<std::string>("disk-budget-low", "low-water mark for disk budget")
       .add<size_t>("disk-budget-step-size", "number of partitions to erase "
-                                            "before re-checking size"));
+                                            "before re-checking size")
+      .add<size_t>("disk-budget-reconcile-interval",
+                   "time between two full scans of the database directory")
+      .add<size_t>("partition-compaction-interval",
+                   "time between two checks for small partitions to merge")
+      .add<double>("partition-compaction-threshold",
+                   "fraction of the maximum partition size below which "
+                   "partitions get merged"));
 }
 
 auto make_stop_command() {
@@ -510,6 +551,8 @@ auto make_root_command(std::string_view path) {
         .add<std::string>("aging-frequency", "interval between two aging "
                                              "cycles")
         .add<std::string>("aging-query", "query for aging out obsolete data")
+        .add<std::string>("aging-retention", "time after which events "
+                                             "expire")
         .add<std::string>("shutdown-grace-period",
                           "time to wait until component shutdown "
                           "finishes cleanly before inducing a hard kill");
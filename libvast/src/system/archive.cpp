@@ -15,18 +15,22 @@
 #include "vast/detail/assert.hpp"
 #include "vast/detail/fill_status_map.hpp"
 #include "vast/detail/overload.hpp"
+#include "vast/ids.hpp"
 #include "vast/logger.hpp"
 #include "vast/segment_store.hpp"
+#include "vast/system/query_profile.hpp"
 #include "vast/system/report.hpp"
 #include "vast/system/status_verbosity.hpp"
 #include "vast/table_slice.hpp"
 
 #include <caf/config_value.hpp>
 #include <caf/expected.hpp>
+#include <caf/scheduler/abstract_coordinator.hpp>
 #include <caf/settings.hpp>
 #include <caf/stream_sink.hpp>
 
 #include <algorithm>
+#include <utility>
 
 namespace vast::system {
 
@@ -71,6 +75,46 @@ std::unique_ptr<segment_store::lookup> archive_state::next_session() {
   return nullptr;
 }
 
+void archive_state::complete_check() {
+  VAST_ASSERT(pending_checks > 0);
+  --pending_checks;
+  if (session_exhausted) {
+    if (pending_checks == 0)
+      finish_session();
+  } else if (std::exchange(throttled, false)) {
+    self->send(self, atom::internal_v, atom::resume_v);
+  }
+}
+
+void archive_state::finish_session() {
+  VAST_ASSERT(!requests.empty());
+  auto& request = requests.front();
+  if (session_error) {
+    request.cancelled = true;
+    active_promise.deliver(std::exchange(session_error, {}));
+  } else {
+    // Let the client know how many candidates we checked, so it can relate
+    // them to the number of results.
+    if (auto* extract = caf::get_if<query::extract>(&request.query.cmd))
+      if (!request.cancelled)
+        self->send(extract->sink, atom::candidate_v, rank(session_ids));
+    active_promise.deliver(atom::done_v);
+  }
+  session_exhausted = false;
+  throttled = false;
+  // We're at the end, check for more requests.
+  session = next_session();
+  if (session)
+    self->send(self, atom::internal_v, atom::resume_v);
+}
+
+void archive_state::schedule_compaction() {
+  if (compacting || store->compaction_candidates().empty())
+    return;
+  compacting = true;
+  self->send(self, atom::internal_v, atom::compact_v);
+}
+
 caf::typed_response_promise<atom::done>
 archive_state::file_request(vast::query query, const ids& xs) {
   auto rp = self->make_response_promise<atom::done>();
@@ -109,16 +153,73 @@ archive_state::file_request(vast::query query, const ids& xs) {
   return rp;
 }
 
+candidate_checker_actor::behavior_type
+candidate_checker(candidate_checker_actor::pointer self) {
+  return {
+    [self](const vast::query& query, const table_slice& slice,
+           const ids& xs) -> caf::result<atom::done> {
+      auto start = std::chrono::system_clock::now();
+      // TODO: Add an lru cache for checkers, so we don't need to tailor the
+      // expression for every slice.
+      auto checker = expression{};
+      if (query.expr != expression{}) {
+        auto c = tailor(query.expr, slice.layout());
+        if (!c)
+          return std::move(c.error());
+        checker = prune_meta_predicates(std::move(*c));
+      }
+      auto f = detail::overload{
+        [&](const query::count& count) {
+          if (count.mode == query::count::estimate)
+            die("logic error detected");
+          auto result = count_matching(slice, checker, xs);
+          self->send(count.sink, result);
+        },
+        [&](const query::extract& extract) {
+          if (extract.policy == query::extract::preserve_ids) {
+            for (auto& sub_slice : select(slice, xs)) {
+              if (query.expr == expression{}) {
+                self->send(extract.sink, sub_slice);
+              } else {
+                auto hits = evaluate(checker, sub_slice);
+                for (auto& final_slice : select(sub_slice, hits))
+                  self->send(extract.sink, final_slice);
+              }
+            }
+          } else {
+            auto final_slice = filter(slice, checker, xs);
+            if (final_slice)
+              self->send(extract.sink, *final_slice);
+          }
+        },
+        [&](const query::erase&) { die("logic error detected"); },
+      };
+      caf::visit(f, query.cmd);
+      record_span(self, query, query_stage::candidate_check, start);
+      return atom::done_v;
+    },
+  };
+}
+
 archive_actor::behavior_type
 archive(archive_actor::stateful_pointer<archive_state> self,
         const std::filesystem::path& dir, size_t capacity,
-        size_t max_segment_size) {
+        size_t max_segment_size, double compaction_threshold) {
   VAST_VERBOSE("{} initializes archive in {} with a maximum segment "
                "size of {} and {} segments in memory",
                self, dir, max_segment_size, capacity);
   self->state.self = self;
-  self->state.store = segment_store::make(dir, max_segment_size, capacity);
+  self->state.store = segment_store::make(dir, max_segment_size, capacity,
+                                          compaction_threshold);
   VAST_ASSERT(self->state.store != nullptr);
+  // Resume compacting segments that reached the threshold before a restart.
+  self->state.schedule_compaction();
+  // Use one CANDIDATE CHECKER per scheduler thread.
+  auto num_checkers
+    = std::max(size_t{1}, self->system().scheduler().num_workers());
+  for (size_t i = 0; i < num_checkers; ++i)
+    self->state.checkers.push_back(
+      self->spawn<caf::linked>(candidate_checker));
   self->set_exit_handler([self](const caf::exit_msg& msg) {
     VAST_DEBUG("{} got EXIT from {}", self, msg.source);
     self->state.send_report();
@@ -158,85 +259,88 @@ archive(archive_actor::stateful_pointer<archive_state> self,
         // We erase eagerly.
         if (auto err = self->state.store->erase(xs))
           VAST_ERROR("{} failed to erase events: {}", self, render(err));
+        self->state.schedule_compaction();
         return atom::done_v;
       }
       return self->state.file_request(std::move(query), xs);
     },
     [self](atom::internal, atom::resume) {
-      VAST_ASSERT(self->state.session);
-      VAST_ASSERT(!self->state.requests.empty());
-      if (self->state.requests.front().cancelled) {
-        self->state.active_promise.deliver(atom::done_v);
-        self->state.session = self->state.next_session();
-        if (!self->state.session)
-          // Nothing to do at the moment;
-          return;
-      };
-      auto& request = self->state.requests.front();
-      auto slice = self->state.session->next();
-      if (slice) {
-        // Add an lru cache for checkers in the archive state.
-        auto checker = expression{};
-        if (request.query.expr != expression{}) {
-          auto c = tailor(request.query.expr, slice->layout());
-          if (!c) {
-            VAST_ERROR("{} {}", self, c.error());
-            request.cancelled = true;
-            self->state.active_promise.deliver(c.error());
-            // We deliver the remaining promises in this request regularly in
-            // the next run of `next_session()`.
-            self->send(self, atom::internal_v, atom::resume_v);
-            return;
-          }
-          checker = prune_meta_predicates(std::move(*c));
-        }
-        caf::visit(detail::overload{
-                     [&](const query::count& count) {
-                       if (count.mode == query::count::estimate)
-                         die("logic error detected");
-                       auto result = count_matching(*slice, checker,
-                                                    self->state.session_ids);
-                       self->send(count.sink, result);
-                     },
-                     [&](const query::extract& extract) {
-                       if (extract.policy == query::extract::preserve_ids) {
-                         for (auto& sub_slice :
-                              select(*slice, self->state.session_ids)) {
-                           if (request.query.expr == expression{}) {
-                             self->send(extract.sink, sub_slice);
-                           } else {
-                             auto hits = evaluate(checker, sub_slice);
-                             for (auto& final_slice : select(sub_slice, hits))
-                               self->send(extract.sink, final_slice);
-                           }
-                         }
-                       } else {
-                         auto final_slice
-                           = filter(*slice, checker, self->state.session_ids);
-                         if (final_slice)
-                           self->send(extract.sink, *final_slice);
-                       }
-                     },
-                     [&](query::erase) { die("logic error detected"); },
-                   },
-                   request.query.cmd);
-      } else {
+      auto& st = self->state;
+      // A completed check may resume a session that already finished.
+      if (!st.session || st.session_exhausted)
+        return;
+      VAST_ASSERT(!st.requests.empty());
+      auto& request = st.requests.front();
+      if (request.cancelled) {
+        st.session_exhausted = true;
+        if (st.pending_checks == 0)
+          st.finish_session();
+        return;
+      }
+      // Don't fetch more slices while all CANDIDATE CHECKERs are busy; the
+      // next completed check resumes the session.
+      if (st.pending_checks >= 2 * st.checkers.size()) {
+        st.throttled = true;
+        return;
+      }
+      // Fetching the next slice maps its segment from disk if the segment is
+      // not in the cache.
+      auto start = std::chrono::system_clock::now();
+      auto slice = st.session->next();
+      record_span(self, request.query, query_stage::store_lookup, start);
+      if (!slice) {
         // We didn't get a slice from the segment store.
         if (slice.error() != caf::no_error) {
           VAST_ERROR("{} failed to retrieve slice: {}", self, slice.error());
-          self->state.active_promise.deliver(slice.error());
-        } else {
-          self->state.active_promise.deliver(atom::done_v);
+          st.session_error = slice.error();
         }
-        // This session is done.
-        // We're at the end, check for more requests.
-        self->state.session = self->state.next_session();
-        if (!self->state.session)
-          // Nothing to do at the moment;
-          return;
+        st.session_exhausted = true;
+        if (st.pending_checks == 0)
+          st.finish_session();
+        return;
       }
+      // Distribute the candidate checks round-robin, so that slices of
+      // different segments get checked in parallel.
+      auto& checker = st.checkers[st.next_checker++ % st.checkers.size()];
+      ++st.pending_checks;
+      // Only send the IDs that fall into the slice; the IDs of the whole
+      // session can be much larger than the slice itself.
+      auto slice_ids = make_ids(*slice) & st.session_ids;
+      self
+        ->request(checker, caf::infinite, request.query, std::move(*slice),
+                  std::move(slice_ids))
+        .then([self](atom::done) { self->state.complete_check(); },
+              [self](caf::error& err) {
+                VAST_ERROR("{} failed to check candidates: {}", self, err);
+                if (!self->state.session_error)
+                  self->state.session_error = std::move(err);
+                self->state.complete_check();
+              });
       self->send(self, atom::internal_v, atom::resume_v);
     },
+    [self](atom::internal, atom::compact) {
+      auto& st = self->state;
+      // Compaction replaces segments, so we wait for the current lookup
+      // session to finish.
+      if (st.session) {
+        self->delayed_send(self, defaults::system::compaction_delay,
+                           atom::internal_v, atom::compact_v);
+        return;
+      }
+      auto candidates = st.store->compaction_candidates();
+      if (candidates.empty()) {
+        st.compacting = false;
+        return;
+      }
+      // Compact one segment at a time, so that queries can interleave.
+      if (auto err = st.store->compact(candidates.front())) {
+        VAST_ERROR("{} failed to compact segment {}: {}", self,
+                   candidates.front(), render(err));
+        st.compacting = false;
+        return;
+      }
+      self->send(self, atom::internal_v, atom::compact_v);
+    },
     [self](
       caf::stream<table_slice> in) -> caf::inbound_stream_slot<table_slice> {
       VAST_DEBUG("{} got a new stream source", self);
@@ -299,8 +403,12 @@ archive(archive_actor::stateful_pointer<archive_state> self,
     [self](atom::erase, const ids& xs) {
       if (auto err = self->state.store->erase(xs))
         VAST_ERROR("{} failed to erase events: {}", self, render(err));
+      self->state.schedule_compaction();
       return atom::done_v;
     },
+    [self](atom::disk_usage) -> uint64_t {
+      return self->state.store->disk_usage();
+    },
   };
 }
 
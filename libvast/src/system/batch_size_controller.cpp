@@ -0,0 +1,186 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/batch_size_controller.hpp"
+
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/time.hpp"
+#include "vast/error.hpp"
+#include "vast/table_slice.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+namespace vast::system {
+
+caf::expected<batch_size_options>
+batch_size_options::make(const caf::settings& options) {
+  auto result = batch_size_options{};
+  result.max_size = caf::get_or(options, "vast.import.batch-size",
+                                defaults::import::table_slice_size);
+  if (result.max_size == 0)
+    result.max_size = std::numeric_limits<size_t>::max();
+  result.adaptive = caf::get_or(options, "vast.import.batch-adaptive", false);
+  result.min_size = caf::get_or(options, "vast.import.batch-min-size",
+                                defaults::import::min_table_slice_size);
+  result.target_bytes = caf::get_or(options, "vast.import.batch-target-bytes",
+                                    defaults::import::table_slice_bytes);
+  if (auto latency_arg = caf::get_if<std::string>(
+        &options, "vast.import.batch-target-latency")) {
+    auto latency = to<duration>(*latency_arg);
+    if (!latency)
+      return caf::make_error(ec::parse_error, "invalid duration for "
+                                              "vast.import.batch-target-"
+                                              "latency:",
+                             *latency_arg);
+    result.target_latency = *latency;
+  }
+  if (result.adaptive) {
+    if (result.min_size == 0 || result.min_size > result.max_size)
+      return caf::make_error(ec::invalid_configuration,
+                             "vast.import.batch-min-size must be in the range "
+                             "from 1 to vast.import.batch-size");
+    if (result.target_latency <= duration::zero())
+      return caf::make_error(ec::invalid_configuration,
+                             "vast.import.batch-target-latency must be "
+                             "positive");
+  }
+  return result;
+}
+
+std::string_view to_string(flush_reason reason) noexcept {
+  switch (reason) {
+    case flush_reason::full:
+      return "full";
+    case flush_reason::timeout:
+      return "timeout";
+    case flush_reason::stalled:
+      return "stalled";
+    case flush_reason::end_of_input:
+      return "end-of-input";
+    case flush_reason::error:
+      return "error";
+  }
+  return "unknown";
+}
+
+batch_size_controller::batch_size_controller(batch_size_options options)
+  : options_{options}, size_{options.max_size} {
+  update();
+}
+
+size_t batch_size_controller::size() const noexcept {
+  return size_;
+}
+
+const batch_size_options& batch_size_controller::options() const noexcept {
+  return options_;
+}
+
+void batch_size_controller::observe_input(size_t events,
+                                          clock::time_point now) {
+  if (sample_start_ == clock::time_point{})
+    sample_start_ = now;
+  sample_events_ += events;
+  auto elapsed = now - sample_start_;
+  if (elapsed < sample_interval)
+    return;
+  auto seconds = std::chrono::duration<double>{elapsed}.count();
+  auto rate = static_cast<double>(sample_events_) / seconds;
+  events_per_second_ = events_per_second_
+                         ? *events_per_second_ * (1.0 - smoothing)
+                             + rate * smoothing
+                         : rate;
+  sample_start_ = now;
+  sample_events_ = 0;
+  update();
+}
+
+void batch_size_controller::observe_slice(const table_slice& slice) {
+  observe_slice(slice.rows(), as_bytes(slice).size());
+}
+
+void batch_size_controller::observe_slice(size_t rows, size_t bytes) {
+  ++slices_;
+  slice_rows_ += rows;
+  slice_bytes_ += bytes;
+  if (rows == 0)
+    return;
+  auto ratio = static_cast<double>(bytes) / static_cast<double>(rows);
+  bytes_per_event_
+    = bytes_per_event_
+        ? *bytes_per_event_ * (1.0 - smoothing) + ratio * smoothing
+        : ratio;
+  update();
+}
+
+void batch_size_controller::flushed(flush_reason reason) noexcept {
+  ++flushes_[static_cast<size_t>(reason)];
+}
+
+void batch_size_controller::append_report(std::string_view prefix,
+                                          report& r) {
+  auto key = [&](std::string_view suffix) {
+    auto result = std::string{prefix};
+    result += suffix;
+    return result;
+  };
+  r.push_back({key(".batch.size"), uint64_t{size_}});
+  r.push_back({key(".batch.slices"), uint64_t{slices_}});
+  r.push_back({key(".batch.rows"), uint64_t{slice_rows_}});
+  r.push_back({key(".batch.bytes"), uint64_t{slice_bytes_}});
+  for (auto reason :
+       {flush_reason::full, flush_reason::timeout, flush_reason::stalled,
+        flush_reason::end_of_input, flush_reason::error}) {
+    auto name = key(".flush.");
+    name += to_string(reason);
+    r.push_back({std::move(name),
+                 uint64_t{flushes_[static_cast<size_t>(reason)]}});
+  }
+  slices_ = 0;
+  slice_rows_ = 0;
+  slice_bytes_ = 0;
+  flushes_ = {};
+}
+
+caf::settings batch_size_controller::status() const {
+  caf::settings result;
+  put(result, "adaptive", options_.adaptive);
+  put(result, "size", size_);
+  if (events_per_second_)
+    put(result, "events-per-second", *events_per_second_);
+  if (bytes_per_event_)
+    put(result, "bytes-per-event", *bytes_per_event_);
+  return result;
+}
+
+void batch_size_controller::update() noexcept {
+  if (!options_.adaptive) {
+    size_ = options_.max_size;
+    return;
+  }
+  auto max_size = static_cast<double>(options_.max_size);
+  auto target = max_size;
+  if (events_per_second_) {
+    auto latency
+      = std::chrono::duration<double>{options_.target_latency}.count();
+    target = std::min(target, *events_per_second_ * latency);
+  }
+  if (bytes_per_event_ && *bytes_per_event_ > 0.0)
+    target = std::min(target, static_cast<double>(options_.target_bytes)
+                                / *bytes_per_event_);
+  if (target >= max_size)
+    size_ = options_.max_size;
+  else
+    size_ = std::clamp(static_cast<size_t>(target),
+                       std::min(options_.min_size, options_.max_size),
+                       options_.max_size);
+}
+
+} // namespace vast::system
@@ -0,0 +1,96 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/compactor.hpp"
+
+#include "vast/fwd.hpp"
+
+#include "vast/concept/printable/vast/uuid.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/status_verbosity.hpp"
+#include "vast/uuid.hpp"
+
+#include <caf/settings.hpp>
+#include <caf/typed_event_based_actor.hpp>
+
+#include <vector>
+
+namespace vast::system {
+
+caf::error validate(const compactor_config& config) {
+  if (config.interval.count() <= 0)
+    return caf::make_error(ec::invalid_configuration, "compaction interval "
+                                                      "must be positive");
+  if (config.max_events == 0)
+    return caf::make_error(ec::invalid_configuration, "compaction threshold "
+                                                      "must be positive");
+  return {};
+}
+
+compactor_actor::behavior_type
+compactor(compactor_actor::stateful_pointer<compactor_state> self,
+          const compactor_config& config, index_actor index) {
+  VAST_TRACE_SCOPE("{} {}", VAST_ARG(config.interval),
+                   VAST_ARG(config.max_events));
+  if (auto error = validate(config)) {
+    self->quit(error);
+    return compactor_actor::behavior_type::make_empty_behavior();
+  }
+  self->state.config = config;
+  self->state.index = std::move(index);
+  self->send(self, atom::ping_v);
+  return {
+    [self](atom::ping) {
+      self->delayed_send(self, self->state.config.interval, atom::ping_v);
+      if (self->state.compacting) {
+        VAST_DEBUG("{} ignores ping because a compaction is still in "
+                   "progress",
+                   self);
+        return;
+      }
+      self->state.compacting = true;
+      self->send(self, atom::compact_v);
+    },
+    [self](atom::compact) {
+      self
+        ->request(self->state.index, caf::infinite, atom::compact_v,
+                  self->state.config.max_events)
+        .then(
+          [=](const std::vector<uuid>& merged) {
+            if (merged.empty()) {
+              VAST_DEBUG("{} found no more partitions to merge", self);
+              self->state.compacting = false;
+              return;
+            }
+            VAST_VERBOSE("{} merged partitions {}", self, merged);
+            self->state.merged_partitions += merged.size();
+            ++self->state.created_partitions;
+            // Repeat until no runs of small partitions remain.
+            self->send(self, atom::compact_v);
+          },
+          [=](const caf::error& err) {
+            VAST_WARN("{} failed to merge partitions: {}", self, err);
+            self->state.compacting = false;
+          });
+    },
+    [self](atom::status, status_verbosity) {
+      auto result = caf::settings{};
+      auto& compactor_status = put_dictionary(result, "compactor");
+      put(compactor_status, "interval", self->state.config.interval.count());
+      put(compactor_status, "max-events", self->state.config.max_events);
+      put(compactor_status, "merged-partitions",
+          self->state.merged_partitions);
+      put(compactor_status, "created-partitions",
+          self->state.created_partitions);
+      return result;
+    },
+  };
+}
+
+} // namespace vast::system
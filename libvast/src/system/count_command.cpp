@@ -79,11 +79,17 @@ caf::message count_command(const invocation& inv, caf::actor_system& sys) {
   self->send(cnt, atom::run_v, self);
   bool counting = true;
   uint64_t result = 0;
+  uint64_t candidate_checks = 0;
   self->receive_while
     // Loop until false.
     (counting)
     // Message handlers.
-    ([&](uint64_t x) { result += x; }, [&](atom::done) { counting = false; });
+    ([&](uint64_t x) { result += x; },
+     [&](atom::candidate, uint64_t x) { candidate_checks = x; },
+     [&](atom::done) { counting = false; });
+  if (candidate_checks > 0)
+    VAST_INFO("{} counted {} partition(s) with a candidate check in the store",
+              detail::pretty_type_name(inv.full_name), candidate_checks);
   std::cout << result << std::endl;
   return caf::none;
 }
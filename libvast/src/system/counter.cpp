@@ -9,6 +9,7 @@
 #include "vast/system/counter.hpp"
 
 #include "vast/bitmap_algorithms.hpp"
+#include "vast/concept/printable/vast/uuid.hpp"
 #include "vast/logger.hpp"
 #include "vast/query.hpp"
 #include "vast/table_slice.hpp"
@@ -41,11 +42,22 @@ void counter_state::init(expression expr, index_actor index,
     behaviors_[await_results_until_done].as_behavior_impl()};
   behaviors_[await_results_until_done] = base.or_else(
     // Forward results to the sink.
-    [this](uint64_t num_results) { self_->send(client_, num_results); });
+    [this](uint64_t num_results) { self_->send(client_, num_results); },
+    // Keep track of partitions that could not count from the index alone.
+    [this](atom::candidate, const uuid& partition) {
+      VAST_DEBUG("{} counts partition {} with a candidate check", self_,
+                 partition);
+      ++candidate_checks_;
+    });
 }
 
 void counter_state::process_done() {
   if (!request_more_results()) {
+    VAST_VERBOSE("{} counted {} of {} partitions with a candidate check in "
+                 "the store",
+                 self_, candidate_checks_, partitions_.total);
+    // Let the client know how many partitions fell back to the store.
+    self_->send(client_, atom::candidate_v, uint64_t{candidate_checks_});
     self_->send(client_, atom::done_v);
     self_->quit();
   }
@@ -40,7 +40,7 @@ namespace vast::system {
 caf::behavior datagram_source(
   caf::stateful_actor<datagram_source_state, caf::io::broker>* self,
   uint16_t udp_listening_port, format::reader_ptr reader,
-  size_t table_slice_size, std::optional<size_t> max_events,
+  batch_size_options batching, std::optional<size_t> max_events,
   const type_registry_actor& type_registry, vast::schema local_schema,
   std::string type_filter, accountant_actor accountant,
   std::vector<transform>&& transforms) {
@@ -66,7 +66,7 @@ caf::behavior datagram_source(
   self->state.requested = max_events;
   self->state.local_schema = std::move(local_schema);
   self->state.accountant = std::move(accountant);
-  self->state.table_slice_size = table_slice_size;
+  self->state.batching = batch_size_controller{batching};
   self->state.done = false;
   // Register with the accountant.
   self->send(self->state.accountant, atom::announce_v, self->state.name);
@@ -105,22 +105,39 @@ caf::behavior datagram_source(
       self->state.reader->reset(std::make_unique<std::istream>(&buf));
       auto push_slice = [&](table_slice slice) {
         VAST_DEBUG("{} produced a slice with {} rows", self, slice.rows());
+        self->state.batching.observe_slice(slice);
         self->state.mgr->out().push(detail::framed{std::move(slice)});
       };
-      auto events = capacity * self->state.table_slice_size;
+      auto table_slice_size = self->state.batching.size();
+      auto events = capacity * table_slice_size;
       if (self->state.requested)
         events = std::min(events, *self->state.requested - self->state.count);
-      auto [err, produced] = self->state.reader->read(
-        events, self->state.table_slice_size, push_slice);
+      auto [err, produced]
+        = self->state.reader->read(events, table_slice_size, push_slice);
       t.stop(produced);
       self->state.count += produced;
+      self->state.batching.observe_input(produced,
+                                         batch_size_controller::clock::now());
       if (self->state.requested && self->state.count >= *self->state.requested)
         self->state.done = true;
       if (err != caf::none && err != ec::end_of_input)
         VAST_WARN("{} has not enough capacity left in stream, dropping input!",
                   self);
-      if (produced > 0)
+      if (produced > 0) {
+        // Every datagram is a complete input, so the reader usually stops at
+        // its end and emits whatever it has buffered.
+        if (err == caf::none)
+          self->state.batching.flushed(flush_reason::full);
+        else if (err == ec::end_of_input)
+          self->state.batching.flushed(flush_reason::end_of_input);
+        else if (err == ec::timeout)
+          self->state.batching.flushed(flush_reason::timeout);
+        else if (err == ec::stalled)
+          self->state.batching.flushed(flush_reason::stalled);
+        else
+          self->state.batching.flushed(flush_reason::error);
         self->state.mgr->push();
+      }
       if (self->state.done)
         self->state.send_report();
     },
@@ -165,6 +182,7 @@ caf::behavior datagram_source(
         if (self->state.reader)
           put(src, "format", self->state.reader->name());
         put(src, "produced", self->state.count);
+        put(src, "batching", self->state.batching.status());
         auto& xs = put_list(result, "sources");
         xs.emplace_back(std::move(src));
       }
@@ -11,7 +11,6 @@
 #include "vast/fwd.hpp"
 
 #include "vast/concept/parseable/vast/si.hpp"
-#include "vast/concept/parseable/vast/uuid.hpp"
 #include "vast/detail/process.hpp"
 #include "vast/detail/recursive_size.hpp"
 #include "vast/error.hpp"
@@ -30,17 +29,55 @@ namespace vast::system {
 
 namespace {
 
-struct partition_diskstate {
-  uuid id;
-  std::uintmax_t filesize;
-  std::filesystem::file_time_type mtime;
-};
-
 template <typename Fun>
 std::shared_ptr<caf::detail::scope_guard<Fun>> make_shared_guard(Fun f) {
   return std::make_shared<caf::detail::scope_guard<Fun>>(std::forward<Fun>(f));
 }
 
+/// Computes the size of the database directory from the disk usage ledgers
+/// of the INDEX and the ARCHIVE, and reconciles it with the file system when
+/// due. Calls `f` with the size and the persisted partitions ordered from
+/// oldest to newest.
+template <class F>
+void measure(disk_monitor_actor::stateful_pointer<disk_monitor_state> self,
+             F f) {
+  self->request(self->state.index, caf::infinite, atom::disk_usage_v)
+    .then(
+      [=](uint64_t index_bytes, std::vector<uuid>& partitions) mutable {
+        self->request(self->state.archive, caf::infinite, atom::disk_usage_v)
+          .then(
+            [=, partitions = std::move(partitions)](
+              uint64_t archive_bytes) mutable {
+              auto& st = self->state;
+              const auto tracked = index_bytes + archive_bytes;
+              const auto now = std::chrono::steady_clock::now();
+              if (!st.last_reconciliation
+                  || now - *st.last_reconciliation
+                       >= st.config.reconcile_interval) {
+                if (auto size = st.compute_dbdir_size()) {
+                  st.untracked_bytes = *size > tracked ? *size - tracked : 0;
+                  st.last_reconciliation = now;
+                  VAST_VERBOSE("{} reconciled db-directory of size {} with "
+                               "{} tracked bytes",
+                               self, *size, tracked);
+                } else {
+                  VAST_WARN("{} failed to calculate recursive size of {}: {}",
+                            self, st.dbdir, size.error());
+                }
+              }
+              f(tracked + st.untracked_bytes, std::move(partitions));
+            },
+            [=](const caf::error& err) {
+              VAST_WARN("{} failed to retrieve disk usage of the archive: {}",
+                        self, err);
+            });
+      },
+      [=](const caf::error& err) {
+        VAST_WARN("{} failed to retrieve disk usage of the index: {}", self,
+                  err);
+      });
+}
+
 } // namespace
 
 caf::error validate(const disk_monitor_config& config) {
@@ -50,6 +87,9 @@ caf::error validate(const disk_monitor_config& config) {
   if (config.low_water_mark > config.high_water_mark)
     return caf::make_error(ec::invalid_configuration, "low-water mark greater "
                                                       "than high-water mark");
+  if (config.reconcile_interval.count() <= 0)
+    return caf::make_error(ec::invalid_configuration, "reconcile interval "
+                                                      "must be positive");
   if (config.scan_binary) {
     if (config.scan_binary->empty()) {
       return caf::make_error(ec::invalid_configuration,
@@ -117,128 +157,91 @@ disk_monitor(disk_monitor_actor::stateful_pointer<disk_monitor_state> self,
                    self);
         return;
       }
-      auto size = self->state.compute_dbdir_size();
-      // TODO: This is going to do one syscall per file in the database
-      // directory. This feels a bit wasteful, but in practice we didn't
-      // see noticeable overhead even on large-ish databases.
-      // Nonetheless, if this becomes relevant we should switch to using
-      // `inotify()` or similar to do real-time tracking of the db size.
-      if (!size) {
-        VAST_WARN("{} failed to calculate recursive size of {}: {}", self,
-                  self->state.dbdir, size.error());
-        return;
-      }
-      VAST_VERBOSE("{} checks db-directory of size {}", self, *size);
-      if (*size > self->state.config.high_water_mark && !self->state.purging) {
-        self->state.purging = true;
-        // TODO: Remove the static_cast when switching to CAF 0.18.
-        self
-          ->request(static_cast<disk_monitor_actor>(self), caf::infinite,
-                    atom::erase_v)
-          .then(
-            [] {
-              // nop
-            },
-            [=](const caf::error& err) {
-              VAST_ERROR("{} failed to purge db-directory: {}", self, err);
-            });
-      }
+      measure(self, [self](size_t size, const std::vector<uuid>&) {
+        VAST_VERBOSE("{} checks db-directory of size {}", self, size);
+        if (size > self->state.config.high_water_mark
+            && !self->state.purging) {
+          self->state.purging = true;
+          // TODO: Remove the static_cast when switching to CAF 0.18.
+          self
+            ->request(static_cast<disk_monitor_actor>(self), caf::infinite,
+                      atom::erase_v)
+            .then(
+              [] {
+                // nop
+              },
+              [=](const caf::error& err) {
+                VAST_ERROR("{} failed to purge db-directory: {}", self, err);
+              });
+        }
+      });
     },
     [self](atom::erase) -> caf::result<void> {
       // Make sure the `purging` state will be reset once all continuations
       // have finished or we encountered an error.
       auto shared_guard
         = make_shared_guard([=] { self->state.purging = false; });
-      auto err = std::error_code{};
-      const auto index_dir
-        = std::filesystem::directory_iterator(self->state.dbdir / "index", err);
-      if (err)
-        return caf::make_error(ec::filesystem_error, //
-                               fmt::format("failed to find index in "
-                                           "db-directory at {}: {}",
-                                           self->state.dbdir, err));
-      // TODO(ch20006): Add some check on the overall structure on the db dir.
-      std::vector<partition_diskstate> partitions;
-      for (const auto& entry : index_dir) {
-        auto partition = entry.path().filename().string();
-        if (partition == "index.bin")
-          continue;
-        if (entry.path().extension() == ".mdx")
-          continue;
-        uuid id;
-        if (!parsers::uuid(partition, id)) {
-          VAST_VERBOSE("{} failed to find partition {}", self, partition);
-          continue;
+      measure(self, [=, sg = shared_guard](size_t,
+                                           std::vector<uuid> partitions) {
+        if (partitions.empty()) {
+          VAST_VERBOSE("{} failed to find any partitions to delete", self);
+          return;
         }
-        if (entry.is_regular_file()) {
-          std::error_code err{};
-          const auto file_size = entry.file_size(err);
-          const auto mtime = entry.last_write_time(err);
-          if (!err && file_size != static_cast<std::uintmax_t>(-1))
-            partitions.push_back({id, file_size, mtime});
-          else
-            VAST_WARN("{} failed to get file size and last write time for "
-                      "partition {}",
-                      self, partition);
+        VAST_DEBUG("{} tracks {} partitions on disk", self, partitions.size());
+        // Delete up to `step_size` partitions at once, starting with the
+        // partition that holds the oldest events.
+        partitions.resize(
+          std::min(partitions.size(), self->state.config.step_size));
+        auto remaining = std::make_shared<size_t>(partitions.size());
+        auto check = [=, sg = sg] {
+          if (--*remaining > 0)
+            return;
+          // The ledgers already reflect the erasure, so there is no race with
+          // the deletion of files here.
+          measure(self, [=, sg = sg](size_t size, const std::vector<uuid>&) {
+            VAST_VERBOSE("{} erased ids from index; leftover size is {}", self,
+                         size);
+            // Repeat until we're below the low water mark
+            if (size > self->state.config.low_water_mark)
+              self->send(self, atom::erase_v);
+          });
+        };
+        for (const auto& partition : partitions) {
+          VAST_VERBOSE("{} erases partition {} from index", self, partition);
+          self
+            ->request(self->state.index, caf::infinite, atom::erase_v,
+                      partition)
+            .then(
+              [=](ids erased_ids) {
+                // TODO: It would be more natural if we could chain these
+                // futures, instead of nesting them.
+                VAST_VERBOSE("{} erases removed ids from archive", self);
+                self
+                  ->request(self->state.archive, caf::infinite, atom::erase_v,
+                            erased_ids)
+                  .then([=](atom::done) { check(); },
+                        [=](caf::error err) {
+                          VAST_WARN("{} failed to erase from archive: {}",
+                                    self, err);
+                        });
+              },
+              [=](caf::error e) {
+                VAST_WARN("{} failed to erase from index: {}", self,
+                          render(e));
+              });
         }
-      }
-      if (partitions.empty()) {
-        VAST_VERBOSE("{} failed to find any partitions to delete", self);
-        return {};
-      }
-      VAST_DEBUG("{} found {} partitions on disk", self, partitions.size());
-      std::sort(partitions.begin(), partitions.end(),
-                [](const auto& lhs, const auto& rhs) {
-                  return lhs.mtime < rhs.mtime;
-                });
-      // Delete up to `step_size` partitions at once.
-      auto idx = std::min(partitions.size(), self->state.config.step_size);
-      for (size_t i = 0; i < idx; ++i) {
-        auto& partition = partitions.at(i);
-        VAST_VERBOSE("{} erases partition {} from index", self, partition.id);
-        self
-          ->request(self->state.index, caf::infinite, atom::erase_v,
-                    partition.id)
-          .then(
-            [=, sg = shared_guard](ids erased_ids) {
-              // TODO: It would be more natural if we could chain these futures,
-              // instead of nesting them.
-              VAST_VERBOSE("{} erases removed ids from archive", self);
-              self
-                ->request(self->state.archive, caf::infinite, atom::erase_v,
-                          erased_ids)
-                .then(
-                  [=, sg = shared_guard](atom::done) {
-                    // TODO: There's a race condition here: We calculate the
-                    // size of the database directory while we might be deleting
-                    // files from it.
-                    if (const auto size = self->state.compute_dbdir_size();
-                        !size) {
-                      VAST_WARN("{} failed to calculate size of {}: {}", self,
-                                self->state.dbdir, size.error());
-                    } else {
-                      VAST_VERBOSE("{} erased ids from index; leftover size is "
-                                   "{}",
-                                   self, *size);
-                      if (*size > self->state.config.low_water_mark) {
-                        // Repeat until we're below the low water mark
-                        self->send(self, atom::erase_v);
-                      }
-                    }
-                  },
-                  [=, sg = shared_guard](caf::error err) {
-                    VAST_WARN("{} failed to erase from archive: {}", self, err);
-                  });
-            },
-            [=, sg = shared_guard](caf::error e) {
-              VAST_WARN("{} failed to erase from index: {}", self, render(e));
-            });
-      }
+      });
       return {};
     },
-    [](atom::status, status_verbosity) {
-      // TODO: Return some useful information here.
-      return caf::settings{};
+    [self](atom::status, status_verbosity) {
+      auto result = caf::settings{};
+      auto& disk_monitor_status = put_dictionary(result, "disk-monitor");
+      put(disk_monitor_status, "high-water-mark",
+          self->state.config.high_water_mark);
+      put(disk_monitor_status, "low-water-mark",
+          self->state.config.low_water_mark);
+      put(disk_monitor_status, "untracked-bytes", self->state.untracked_bytes);
+      return result;
     },
   };
 }
@@ -12,8 +12,12 @@
 
 #include "vast/concept/parseable/to.hpp"
 #include "vast/concept/parseable/vast/expression.hpp"
+#include "vast/expression.hpp"
 #include "vast/logger.hpp"
 #include "vast/query.hpp"
+#include "vast/system/report.hpp"
+#include "vast/type.hpp"
+#include "vast/uuid.hpp"
 
 #include <caf/event_based_actor.hpp>
 #include <caf/stateful_actor.hpp>
@@ -26,39 +30,107 @@ eraser_state::eraser_state(caf::event_based_actor* self) : super{self} {
 }
 
 void eraser_state::init(caf::timespan interval, std::string query,
-                        index_actor index) {
-  VAST_TRACE_SCOPE("{} {} {} {}", VAST_ARG(interval), VAST_ARG(query),
-                   VAST_ARG(index));
+                        duration retention, index_actor index,
+                        accountant_actor accountant) {
+  VAST_TRACE_SCOPE("{} {} {} {} {}", VAST_ARG(interval), VAST_ARG(query),
+                   VAST_ARG(retention), VAST_ARG(index),
+                   VAST_ARG(accountant));
   // Set member variables.
   interval_ = interval;
   query_ = std::move(query);
+  retention_ = retention;
   index_ = std::move(index);
+  accountant_ = std::move(accountant);
+  if (accountant_)
+    self_->send(accountant_, atom::announce_v, std::string{name});
   // Override the behavior for the idle state.
   behaviors_[idle].assign([=](atom::run) {
     if (self_->current_sender() != self_->ctrl())
       promise_ = self_->make_response_promise();
-    auto expr = to<expression>(query_);
-    if (!expr) {
-      VAST_ERROR("{} failed to parse query {}", self_, query_);
-      return;
-    }
-    if (expr = normalize_and_validate(std::move(*expr)); !expr) {
-      VAST_ERROR("{} failed to normalize and validate {}", self_, query_);
+    cycle_start_ = std::chrono::steady_clock::now();
+    dropped_partitions_ = 0;
+    partitions_ = {};
+    if (retention_ <= duration::zero()) {
+      erase_remaining(std::nullopt);
       return;
     }
-    self_->send(index_, query::make_erase(std::move(*expr)));
+    // Drop the partitions that hold only expired events as a whole first, so
+    // that only partitions straddling the cutoff need a query. We leave the
+    // idle state right away to not start another cycle in the meantime.
+    time cutoff = std::chrono::system_clock::now() - retention_;
     transition_to(await_query_id);
+    self_->request(index_, caf::infinite, atom::erase_v, cutoff)
+      .then(
+        [=](const std::vector<uuid>& dropped) {
+          VAST_VERBOSE("{} dropped {} expired partitions", self_,
+                       dropped.size());
+          dropped_partitions_ = dropped.size();
+          erase_remaining(cutoff);
+        },
+        [=](const caf::error& err) {
+          VAST_WARN("{} failed to drop expired partitions: {}", self_, err);
+          erase_remaining(cutoff);
+        });
   });
   // Trigger the delayed send message.
   transition_to(idle);
 }
 
+void eraser_state::erase_remaining(std::optional<time> cutoff) {
+  auto expr = caf::expected<expression>{expression{}};
+  if (!query_.empty()) {
+    expr = to<expression>(query_);
+    if (!expr) {
+      VAST_ERROR("{} failed to parse query {}", self_, query_);
+      if (state_ != idle)
+        transition_to(idle);
+      return;
+    }
+  }
+  if (cutoff) {
+    // Equivalent to `:timestamp < cutoff`.
+    auto expired = expression{
+      predicate{type_extractor{none_type{}.name("timestamp")},
+                relational_operator::less, data{*cutoff}}};
+    expr = query_.empty()
+             ? std::move(expired)
+             : expression{disjunction{std::move(*expr), std::move(expired)}};
+  }
+  if (expr = normalize_and_validate(std::move(*expr)); !expr) {
+    VAST_ERROR("{} failed to normalize and validate {}", self_, query_);
+    if (state_ != idle)
+      transition_to(idle);
+    return;
+  }
+  self_->send(index_, query::make_erase(std::move(*expr)));
+  transition_to(await_query_id);
+}
+
+void eraser_state::send_report() {
+  VAST_VERBOSE("{} dropped {} partitions and erased events from {} "
+               "partitions",
+               self_, dropped_partitions_, partitions_.total);
+  if (!accountant_)
+    return;
+  auto runtime = std::chrono::duration_cast<duration>(
+    std::chrono::steady_clock::now() - cycle_start_);
+  auto msg = report{
+    {"eraser.partitions.dropped", dropped_partitions_},
+    {"eraser.partitions.rewritten", uint64_t{partitions_.total}},
+    {"eraser.runtime", runtime},
+  };
+  self_->send(accountant_, msg);
+}
+
 void eraser_state::transition_to(query_processor::state_name x) {
   VAST_TRACE_SCOPE("{}", VAST_ARG("state_name", x));
   if (state_ == idle && x != idle)
     VAST_INFO("{} triggers new aging cycle", self_);
+  auto cycle_completed = state_ != idle && x == idle;
   super::transition_to(x);
   if (x == idle) {
+    if (cycle_completed)
+      send_report();
     if (promise_.pending())
       promise_.deliver(atom::ok_v);
     else
@@ -68,11 +140,14 @@ void eraser_state::transition_to(query_processor::state_name x) {
 
 caf::behavior
 eraser(caf::stateful_actor<eraser_state>* self, caf::timespan interval,
-       std::string query, index_actor index) {
-  VAST_TRACE_SCOPE("{} {} {} {} {}", VAST_ARG(self), VAST_ARG(interval),
-                   VAST_ARG(query), VAST_ARG(index));
+       std::string query, duration retention, index_actor index,
+       accountant_actor accountant) {
+  VAST_TRACE_SCOPE("{} {} {} {} {} {}", VAST_ARG(self), VAST_ARG(interval),
+                   VAST_ARG(query), VAST_ARG(retention), VAST_ARG(index),
+                   VAST_ARG(accountant));
   auto& st = self->state;
-  st.init(interval, std::move(query), std::move(index));
+  st.init(interval, std::move(query), retention, std::move(index),
+          std::move(accountant));
   return st.behavior();
 }
 
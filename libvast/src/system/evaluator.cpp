@@ -121,7 +121,7 @@ void evaluator_state::handle_missing_result(const offset& position,
 }
 
 void evaluator_state::evaluate() {
-  auto expr_hits = caf::visit(ids_evaluator{predicate_hits}, expr);
+  auto expr_hits = combine_hits(expr, predicate_hits);
   VAST_DEBUG("{} got predicate_hits: {} expr_hits: {}", self, predicate_hits,
              expr_hits);
   auto delta = expr_hits - hits;
@@ -145,13 +145,22 @@ evaluator_state::hits_for(const offset& position) {
   return i != predicate_hits.end() ? &i->second : nullptr;
 }
 
+ids combine_hits(const expression& expr,
+                 const evaluator_state::predicate_hits_map& hits) {
+  return caf::visit(ids_evaluator{hits}, expr);
+}
+
 evaluator_actor::behavior_type
 evaluator(evaluator_actor::stateful_pointer<evaluator_state> self,
-          expression expr, std::vector<evaluation_triple> eval) {
+          expression expr, std::vector<evaluation_triple> eval,
+          evaluator_state::predicate_hits_map hits) {
   VAST_TRACE_SCOPE("{} {}", VAST_ARG(expr), VAST_ARG(eval));
   VAST_ASSERT(!eval.empty());
   self->state.expr = std::move(expr);
   self->state.eval = std::move(eval);
+  // Known hits count as complete results; INDEXER actors for the same
+  // predicate add to them.
+  self->state.predicate_hits = std::move(hits);
   return {
     [self](atom::run) {
       self->state.promise = self->make_response_promise<ids>();
@@ -171,7 +180,8 @@ evaluator(evaluator_actor::stateful_pointer<evaluator_state> self,
       }
       if (self->state.pending_responses == 0) {
         VAST_DEBUG("{} has nothing to evaluate for expression", self);
-        self->state.promise.deliver(ids{});
+        self->state.evaluate();
+        self->state.promise.deliver(self->state.hits);
       }
       return self->state.promise;
     },
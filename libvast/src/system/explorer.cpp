@@ -11,6 +11,7 @@
 #include "vast/fwd.hpp"
 
 #include "vast/bitmap.hpp"
+#include "vast/bitmap_algorithms.hpp"
 #include "vast/command.hpp"
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/expression.hpp"
@@ -30,7 +31,10 @@
 #include <caf/settings.hpp>
 
 #include <algorithm>
+#include <limits>
+#include <map>
 #include <optional>
+#include <utility>
 
 using namespace std::chrono_literals;
 
@@ -43,21 +47,14 @@ explorer_state::explorer_state(caf::event_based_actor*) {
 void explorer_state::forward_results(vast::table_slice slice) {
   // Check which of the ids in this slice were already sent to the sink
   // and forward those that were not.
-  vast::bitmap unseen;
-  for (size_t i = 0; i < slice.rows(); ++i) {
-    auto id = slice.offset() + i;
-    auto [_, new_] = returned_ids.insert(id);
-    if (new_) {
-      vast::ids tmp;
-      tmp.append_bits(false, id);
-      tmp.append_bits(true, 1);
-      unseen |= tmp;
-    }
-  }
-  if (unseen.empty())
+  auto slice_ids = make_ids(slice);
+  auto unseen = slice_ids - returned_ids;
+  returned_ids |= slice_ids;
+  auto num_unseen = rank(unseen);
+  if (num_unseen == 0)
     return;
   std::vector<table_slice> slices;
-  if (unseen.size() == slice.rows()) {
+  if (num_unseen == slice.rows()) {
     slices.push_back(slice);
   } else {
     // If a slice was partially known, divide it up and forward only those
@@ -80,6 +77,58 @@ void explorer_state::forward_results(vast::table_slice slice) {
   return;
 }
 
+expression coalesce_timeboxes(explorer_state::timebox_map boxes, bool bounded,
+                              const std::optional<std::string>& by) {
+  VAST_ASSERT(!boxes.empty());
+  VAST_ASSERT(bounded || by);
+  // Merge the overlapping time boxes per value, and group the values by the
+  // resulting intervals. Iterating over the ordered map keeps the values of
+  // every group sorted.
+  std::map<explorer_state::timebox, list> groups;
+  for (auto& [value, xs] : boxes) {
+    std::sort(xs.begin(), xs.end());
+    auto current = xs.front();
+    for (auto it = xs.begin() + 1; it != xs.end(); ++it) {
+      if (it->first <= current.second) {
+        current.second = std::max(current.second, it->second);
+        continue;
+      }
+      groups[current].push_back(value);
+      current = *it;
+    }
+    groups[current].push_back(value);
+  }
+  auto timestamp = type_extractor{time_type{}.name("timestamp")};
+  auto result = disjunction{};
+  result.reserve(groups.size());
+  for (auto& [box, values] : groups) {
+    auto constraints = conjunction{};
+    if (bounded) {
+      constraints.emplace_back(predicate{
+        timestamp, relational_operator::greater_equal, data{box.first}});
+      constraints.emplace_back(predicate{
+        timestamp, relational_operator::less_equal, data{box.second}});
+    }
+    if (by) {
+      if (values.size() == 1)
+        constraints.emplace_back(predicate{field_extractor{*by},
+                                           relational_operator::equal,
+                                           std::move(values.front())});
+      else
+        constraints.emplace_back(predicate{field_extractor{*by},
+                                           relational_operator::in,
+                                           data{std::move(values)}});
+    }
+    if (constraints.size() == 1)
+      result.push_back(std::move(constraints.front()));
+    else
+      result.emplace_back(std::move(constraints));
+  }
+  if (result.size() == 1)
+    return std::move(result.front());
+  return result;
+}
+
 caf::behavior
 explorer(caf::stateful_actor<explorer_state>* self, node_actor node,
          explorer_state::event_limits limits,
@@ -102,15 +151,58 @@ explorer(caf::stateful_actor<explorer_state>* self, node_actor node,
   st.by = by;
   auto quit_if_done = [=]() {
     auto& st = self->state;
-    if (st.initial_query_completed && st.running_exporters == 0)
+    if (st.initial_query_completed && st.running_exporters == 0
+        && st.pending.empty())
       self->quit();
   };
+  // Turns the pending time boxes into a single query, unless the maximum
+  // number of EXPORTERs is already running.
+  auto flush = [=]() {
+    auto& st = self->state;
+    if (st.pending.empty()
+        || st.running_exporters >= defaults::explore::max_running_exporters)
+      return;
+    auto expr = coalesce_timeboxes(std::exchange(st.pending, {}),
+                                   st.before.has_value(), st.by);
+    auto num_results = std::exchange(st.num_pending, 0);
+    auto query = to_string(expr);
+    VAST_DEBUG("{} coalesces the contexts of {} results", self, num_results);
+    VAST_TRACE_SCOPE("{} spawns new exporter with query {}", self, query);
+    auto exporter_invocation = invocation{{}, "spawn exporter", {query}};
+    caf::put(exporter_invocation.options, "vast.export.preserve-ids", true);
+    // The query covers the contexts of multiple results, so it may return as
+    // many events as all of them combined.
+    auto max_events = st.limits.per_result;
+    if (max_events > std::numeric_limits<uint64_t>::max() / num_results)
+      max_events = 0;
+    else
+      max_events *= num_results;
+    if (max_events)
+      caf::put(exporter_invocation.options, "vast.export.max-events",
+               max_events);
+    ++st.running_exporters;
+    self->request(st.node, caf::infinite, atom::spawn_v, exporter_invocation)
+      .then(
+        [=](caf::actor handle) {
+          auto exporter = caf::actor_cast<exporter_actor>(handle);
+          VAST_DEBUG("{} registers exporter {}", self, exporter);
+          self->monitor(exporter);
+          self->send(exporter, atom::sink_v, self);
+          self->send(exporter, atom::run_v);
+        },
+        [=](caf::error error) {
+          --self->state.running_exporters;
+          VAST_ERROR("{} failed to spawn exporter: {}", self, error);
+          quit_if_done();
+        });
+  };
   self->set_down_handler([=]([[maybe_unused]] const caf::down_msg& msg) {
     // Only the spawned EXPORTERs are expected to send down messages.
     auto& st = self->state;
     --st.running_exporters;
     VAST_DEBUG("{} received DOWN from {} outstanding requests: {}", self,
                msg.source, st.running_exporters);
+    flush();
     quit_if_done();
   });
   return {
@@ -168,70 +260,23 @@ explorer(caf::stateful_actor<explorer_state>* self, node_actor node,
         // Skip if no value
         if (!x)
           continue;
-        std::optional<vast::expression> before_expr;
+        // Without 'before' and 'after' the time box is infinite.
+        auto box = explorer_state::timebox{vast::time::min(),
+                                           vast::time::max()};
         if (st.before)
-          before_expr = predicate{type_extractor{time_type{}.name("timestamp")},
-                                  relational_operator::greater_equal,
-                                  data{*x - *st.before}};
-
-        std::optional<vast::expression> after_expr;
-        if (st.after)
-          after_expr
-            = predicate{type_extractor{time_type{}.name("timestamp")},
-                        relational_operator::less_equal, data{*x + *st.after}};
-        std::optional<vast::expression> by_expr;
+          box = {*x - *st.before, *x + *st.after};
+        auto value = data{};
         if (st.by) {
           VAST_ASSERT(by_column); // Should have been checked above.
           auto ci = (*by_column)[i];
           if (caf::get_if<caf::none_t>(&ci))
             continue;
-          // TODO: Make `predicate` accept a data_view as well to save
-          // the call to `materialize()`.
-          by_expr = predicate{field_extractor{*st.by},
-                              relational_operator::equal, materialize(ci)};
+          value = materialize(ci);
         }
-        auto build_conjunction
-          = [](std::optional<expression>&& lhs,
-               std::optional<expression>&& rhs) -> std::optional<expression> {
-          if (lhs && rhs)
-            return conjunction{std::move(*lhs), std::move(*rhs)};
-          if (lhs)
-            return std::move(lhs);
-          if (rhs)
-            return std::move(rhs);
-          return std::nullopt;
-        };
-        auto temporal_expr
-          = build_conjunction(std::move(before_expr), std::move(after_expr));
-        auto spatial_expr = std::move(by_expr);
-        auto expr = build_conjunction(std::move(temporal_expr),
-                                      std::move(spatial_expr));
-        // We should have checked during argument parsing that `expr` has at
-        // least one constraint.
-        VAST_ASSERT(expr);
-        auto query = to_string(*expr);
-        VAST_TRACE_SCOPE("{} spawns new exporter with query {}", self, query);
-        auto exporter_invocation = invocation{{}, "spawn exporter", {query}};
-        caf::put(exporter_invocation.options, "vast.export.preserve-ids", true);
-        if (st.limits.per_result)
-          caf::put(exporter_invocation.options, "vast.export.max-events",
-                   st.limits.per_result);
-        ++self->state.running_exporters;
-        self
-          ->request(st.node, caf::infinite, atom::spawn_v, exporter_invocation)
-          .then(
-            [=](caf::actor handle) {
-              auto exporter = caf::actor_cast<exporter_actor>(handle);
-              VAST_DEBUG("{} registers exporter {}", self, exporter);
-              self->monitor(exporter);
-              self->send(exporter, atom::sink_v, self);
-              self->send(exporter, atom::run_v);
-            },
-            [=](caf::error error) {
-              --self->state.running_exporters;
-              VAST_ERROR("{} failed to spawn exporter: {}", self, error);
-            });
+        st.pending[std::move(value)].push_back(box);
+        ++st.num_pending;
       }
+      flush();
     },
     [=](atom::provision, exporter_actor exporter) {
       self->state.initial_exporter = exporter.address();
@@ -239,6 +284,7 @@ explorer(caf::stateful_actor<explorer_state>* self, node_actor node,
     [=]([[maybe_unused]] std::string name, query_status) {
       VAST_DEBUG("{} received final status from {}", self, name);
       self->state.initial_query_completed = true;
+      flush();
       quit_if_done();
     },
     [=](atom::sink, const caf::actor& sink) {
@@ -31,14 +31,40 @@
 #include <caf/stream_slot.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
+#include <utility>
+
 namespace vast::system {
 
 namespace {
 
+void shutdown(exporter_actor::stateful_pointer<exporter_state> self);
+
+/// Tells the INDEX to stop scheduling partitions once the client received all
+/// results it asked for, and only waits for the partitions in flight.
+void drop_remaining_partitions(
+  exporter_actor::stateful_pointer<exporter_state> self) {
+  auto& st = self->state;
+  if (st.id == uuid::nil() || has_continuous_option(st.options))
+    return;
+  auto pending = st.query.received + st.query.scheduled;
+  if (pending >= st.query.expected)
+    return;
+  VAST_DEBUG("{} shipped all requested results and drops {} unscheduled "
+             "partitions",
+             self, st.query.expected - pending);
+  self->send(st.index, st.id, uint32_t{0});
+  st.query.expected = pending;
+  if (st.query.received == st.query.expected)
+    shutdown(self);
+}
+
 void ship_results(exporter_actor::stateful_pointer<exporter_state> self) {
   VAST_TRACE_SCOPE("");
   auto& st = self->state;
+  if (st.query.requested == 0 || st.query.cached == 0)
+    return;
   VAST_DEBUG("{} relays {} events", self, st.query.cached);
+  auto start = std::chrono::system_clock::now();
   while (st.query.requested > 0 && st.query.cached > 0) {
     VAST_ASSERT(!st.results.empty());
     // Fetch the next table slice. Either we grab the entire first slice in
@@ -64,17 +90,30 @@ void ship_results(exporter_actor::stateful_pointer<exporter_state> self) {
     st.query.shipped += rows;
     auto transformed = self->state.transformer.apply(std::move(slice));
     self->anon_send(st.sink, std::move(*transformed));
+    if (st.query.requested == 0)
+      drop_remaining_partitions(self);
   }
+  auto span = query_span{query_stage::sink, start,
+                         std::chrono::system_clock::now() - start};
+  trace(span);
+  if (has_profile_option(st.options))
+    st.profile.add(span);
 }
 
 void report_statistics(exporter_actor::stateful_pointer<exporter_state> self) {
   auto& st = self->state;
-  if (st.statistics_subscriber)
+  if (st.statistics_subscriber) {
+    // The profile goes first, because the subscriber may stop listening after
+    // receiving the query status.
+    if (has_profile_option(st.options))
+      self->anon_send(st.statistics_subscriber, atom::profile_v,
+                      st.profile.to_settings());
     self->anon_send(st.statistics_subscriber, st.name, st.query);
+  }
   if (st.accountant) {
     auto processed = st.query.processed;
     auto shipped = st.query.shipped;
-    auto results = shipped + st.results.size();
+    auto results = shipped + st.query.cached;
     auto selectivity = processed != 0
                          ? detail::narrow_cast<double>(results)
                              / detail::narrow_cast<double>(processed)
@@ -86,6 +125,8 @@ void report_statistics(exporter_actor::stateful_pointer<exporter_state> self) {
       {"exporter.selectivity", selectivity},
       {"exporter.runtime", st.query.runtime},
     };
+    if (has_profile_option(st.options))
+      st.profile.append_report("exporter.profile", msg);
     self->send(st.accountant, msg);
   }
 }
@@ -143,8 +184,18 @@ void handle_batch(exporter_actor::stateful_pointer<exporter_state> self,
                   table_slice slice) {
   VAST_ASSERT(slice.encoding() != table_slice_encoding::none);
   VAST_DEBUG("{} got batch of {} events", self, slice.rows());
+  // Look up the cached type for the layout of the slice.
+  auto serialized_layout = slice.serialized_layout();
+  auto key = std::string_view{
+    reinterpret_cast<const char*>(serialized_layout.data()),
+    serialized_layout.size()};
+  auto layout = self->state.layouts.find(key);
+  if (layout == self->state.layouts.end()) {
+    key = self->state.serialized_layouts.emplace_back(key);
+    layout = self->state.layouts.emplace(key, type{slice.layout()}).first;
+  }
+  const auto& t = layout->second;
   // Construct a candidate checker if we don't have one for this type.
-  type t = slice.layout();
   auto it = self->state.checkers.find(t);
   if (it == self->state.checkers.end()) {
     auto x = tailor(self->state.expr, t);
@@ -155,8 +206,7 @@ void handle_batch(exporter_actor::stateful_pointer<exporter_state> self,
       return;
     }
     VAST_DEBUG("{} tailored AST to {}: {}", self, t, x);
-    std::tie(it, std::ignore)
-      = self->state.checkers.emplace(type{slice.layout()}, std::move(*x));
+    std::tie(it, std::ignore) = self->state.checkers.emplace(t, std::move(*x));
   }
   auto& checker = it->second;
   // Perform candidate check, splitting the slice into subsets if needed.
@@ -266,6 +316,12 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
                             ? query::extract::preserve_ids
                             : query::extract::drop_ids;
       auto q = vast::query::make_extract(self, perserve_ids, self->state.expr);
+      if (has_profile_option(self->state.options))
+        caf::get<query::extract>(q.cmd).profile = true;
+      if (has_newest_first_option(self->state.options))
+        q.order = query::newest_first;
+      else if (has_oldest_first_option(self->state.options))
+        q.order = query::oldest_first;
       self
         ->request(caf::actor_cast<caf::actor>(self->state.index), caf::infinite,
                   std::move(q))
@@ -320,29 +376,43 @@ exporter(exporter_actor::stateful_pointer<exporter_state> self, expression expr,
         caf::settings exp;
         put(exp, "expression", to_string(self->state.expr));
         put(exp, "start", caf::deep_to_string(self->state.start));
+        put(exp, "processed", self->state.query.processed);
+        put(exp, "shipped", self->state.query.shipped);
+        if (!self->state.profile.empty())
+          put(exp, "profile", self->state.profile.to_settings());
         auto& xs = put_list(result, "queries");
         xs.emplace_back(std::move(exp));
         detail::fill_status_map(exporter_status, self);
       }
       return result;
     },
-    // -- receiver_actor<table_slice> ------------------------------------------
+    // -- extract_sink_actor ---------------------------------------------------
     [self](table_slice slice) { //
       VAST_ASSERT(slice.encoding() != table_slice_encoding::none);
       VAST_DEBUG("{} got batch of {} events", self, slice.rows());
-      self->state.query.processed += slice.rows();
+      // The STORE already performed the candidate check, and reports the
+      // number of candidates separately.
       self->state.query.cached += slice.rows();
       self->state.results.push_back(slice);
       // Ship slices to connected SINKs.
       ship_results(self);
     },
+    [self](atom::candidate, uint64_t candidates) {
+      VAST_DEBUG("{} got {} candidates checked by the store", self,
+                 candidates);
+      self->state.query.processed += candidates;
+    },
+    [self](atom::profile, const query_span& span) {
+      self->state.profile.add(span);
+    },
     [self](atom::done) -> caf::result<void> {
       // Figure out if we're done by bumping the counter for `received`
       // and check whether it reaches `expected`.
       caf::timespan runtime
         = std::chrono::system_clock::now() - self->state.start;
       self->state.query.runtime = runtime;
-      self->state.query.received += self->state.query.scheduled;
+      self->state.query.received
+        += std::exchange(self->state.query.scheduled, 0);
       if (self->state.query.received < self->state.query.expected) {
         VAST_DEBUG("{} received hits from {}/{} partitions", self,
                    self->state.query.received, self->state.query.expected);
@@ -23,6 +23,7 @@
 #include "vast/scope_linked.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/system/node_control.hpp"
+#include "vast/system/query_profile.hpp"
 #include "vast/system/spawn_or_connect_to_node.hpp"
 #include "vast/table_slice.hpp"
 
@@ -59,7 +60,7 @@ run(caf::scoped_actor& self, archive_actor archive, const invocation& inv) {
       return caf::make_error(ec::parse_error, c, "is not a positive integer");
     // The caf::actor_cast here is necessary because a scoped actor cannot be a
     // typed actor. The message handlers below reflect those of the
-    // receiver_actor<table_slice> exactly, but there's no way to verify that at
+    // extract_sink_actor exactly, but there's no way to verify that at
     // compile time. We can improve upon this situation when changing the
     // archive to stream its results.
     auto q = query::make_extract(self, query::extract::drop_ids, expression{});
@@ -68,6 +69,12 @@ run(caf::scoped_actor& self, archive_actor archive, const invocation& inv) {
     self->receive_while(waiting)
       // Message handlers.
       ([&](table_slice slice) { (*writer)->write(slice); },
+       [&](atom::candidate, uint64_t) {
+         // nop
+       },
+       [&](atom::profile, const query_span&) {
+         // nop
+       },
        [&](atom::done) { waiting = false; });
   }
   return caf::none;
@@ -38,8 +38,13 @@
 #include "vast/logger.hpp"
 #include "vast/partition_synopsis.hpp"
 #include "vast/system/evaluator.hpp"
+#include "vast/system/local_segment_store.hpp"
 #include "vast/system/meta_index.hpp"
+#include "vast/system/metrics.hpp"
 #include "vast/system/partition.hpp"
+#include "vast/system/partition_merger.hpp"
+#include "vast/system/query_cache.hpp"
+#include "vast/system/query_profile.hpp"
 #include "vast/system/query_supervisor.hpp"
 #include "vast/system/shutdown.hpp"
 #include "vast/system/status_verbosity.hpp"
@@ -58,6 +63,7 @@
 #include <ctime>
 #include <filesystem>
 #include <memory>
+#include <unordered_set>
 #include <unistd.h>
 
 using namespace std::chrono;
@@ -136,6 +142,39 @@ caf::error extract_partition_synopsis(
                   span{chunk_out->data(), chunk_out->size()});
 }
 
+/// Maps a partition synopsis file into memory. The Bloom filter synopses of
+/// the result probe the mapped file directly, so they occupy the page cache
+/// rather than the heap.
+caf::expected<partition_synopsis>
+mmap_partition_synopsis(const std::filesystem::path& partition_synopsis_path) {
+  auto chunk = chunk::mmap(partition_synopsis_path);
+  if (!chunk)
+    return std::move(chunk.error());
+  const auto* ps_flatbuffer = fbs::GetPartitionSynopsis(chunk->get()->data());
+  if (ps_flatbuffer->partition_synopsis_type()
+      != fbs::partition_synopsis::PartitionSynopsis::v0)
+    return caf::make_error(ec::format_error, "invalid partition synopsis "
+                                             "version");
+  partition_synopsis ps;
+  if (auto error = unpack(*ps_flatbuffer->partition_synopsis_as_v0(), ps,
+                          std::move(*chunk)))
+    return error;
+  return ps;
+}
+
+/// Removes the files of a partition, its synopsis, and its partition-local
+/// store, if they exist.
+void remove_partition_files(const std::filesystem::path& partition_path,
+                            const std::filesystem::path& synopsis_path) {
+  for (const auto& path : {local_segment_store_path(partition_path),
+                           partition_path, synopsis_path}) {
+    std::error_code err{};
+    std::filesystem::remove_all(path, err);
+    if (err)
+      VAST_WARN("index failed to remove {}: {}", path, err.message());
+  }
+}
+
 } // namespace
 
 std::filesystem::path index_state::partition_path(const uuid& id) const {
@@ -147,15 +186,236 @@ index_state::partition_synopsis_path(const uuid& id) const {
   return synopsisdir / (to_string(id) + ".mdx");
 }
 
+void index_state::track_disk_usage(const uuid& id,
+                                   std::optional<time> newest_event,
+                                   std::optional<uint64_t> events) {
+  // We only look at the files once after writing them, so the disk monitor
+  // never needs to scan the database directory.
+  auto file_size = [](const std::filesystem::path& path) {
+    std::error_code err{};
+    auto result = std::filesystem::file_size(path, err);
+    return err ? uint64_t{0} : uint64_t{result};
+  };
+  auto path = partition_path(id);
+  auto bytes = file_size(path) + file_size(partition_synopsis_path(id))
+               + file_size(local_segment_store_path(path));
+  auto& usage = disk_usage_ledger[id];
+  disk_usage = disk_usage - usage.bytes + bytes;
+  usage.bytes = bytes;
+  usage.newest_event = newest_event;
+  usage.events = events;
+}
+
+void index_state::untrack_disk_usage(const uuid& id) {
+  if (auto it = disk_usage_ledger.find(id); it != disk_usage_ledger.end()) {
+    disk_usage -= it->second.bytes;
+    disk_usage_ledger.erase(it);
+  }
+}
+
+std::vector<uuid> index_state::partitions_by_age() const {
+  auto xs = std::vector<std::pair<uuid, std::optional<time>>>{};
+  xs.reserve(disk_usage_ledger.size());
+  for (const auto& [id, usage] : disk_usage_ledger)
+    if (persisted_partitions.count(id) != 0u)
+      xs.emplace_back(id, usage.newest_event);
+  std::sort(xs.begin(), xs.end(), [](const auto& lhs, const auto& rhs) {
+    if (lhs.second.has_value() != rhs.second.has_value())
+      return lhs.second.has_value();
+    return lhs.second < rhs.second;
+  });
+  auto result = std::vector<uuid>{};
+  result.reserve(xs.size());
+  for (auto& [id, _] : xs)
+    result.push_back(id);
+  return result;
+}
+
+std::vector<uuid> index_state::compaction_candidates(uint64_t max_events) {
+  auto result = std::vector<uuid>{};
+  auto events = uint64_t{0};
+  auto run_has_local_store = false;
+  for (const auto& id : partitions_by_age()) {
+    auto& usage = disk_usage_ledger[id];
+    if (!usage.events) {
+      // Reading the header of the partition is cheap compared to the merge
+      // that may follow, and happens only once per partition.
+      auto chunk = chunk::mmap(partition_path(id));
+      if (!chunk)
+        VAST_WARN("{} failed to read partition {}: {}", self, id,
+                  chunk.error());
+      else if (const auto* partition = fbs::GetPartition(chunk->get()->data());
+               partition->partition_type() == fbs::partition::Partition::v0)
+        usage.events = partition->partition_as_v0()->events();
+    }
+    // Partitions with an unknown number of events end a run, and so do
+    // partitions with a different store backend than the run.
+    auto n = usage.events.value_or(0);
+    auto small = n > 0 && n < max_events;
+    std::error_code err{};
+    auto has_local_store = std::filesystem::exists(
+      local_segment_store_path(partition_path(id)), err);
+    if (!small || events + n > partition_capacity
+        || (!result.empty() && has_local_store != run_has_local_store)) {
+      if (result.size() >= 2)
+        return result;
+      result.clear();
+      events = 0;
+      if (!small)
+        continue;
+    }
+    result.push_back(id);
+    events += n;
+    run_has_local_store = has_local_store;
+  }
+  if (result.size() < 2)
+    result.clear();
+  return result;
+}
+
+caf::typed_response_promise<std::vector<uuid>>
+index_state::merge_partitions(std::vector<uuid> partitions) {
+  VAST_ASSERT(merging_partitions.empty());
+  auto rp = self->make_response_promise<std::vector<uuid>>();
+  auto id = uuid::random();
+  auto sources = std::vector<std::filesystem::path>{};
+  auto events = uint64_t{0};
+  for (const auto& partition : partitions) {
+    sources.push_back(partition_path(partition));
+    events += disk_usage_ledger[partition].events.value_or(0);
+  }
+  auto path = partition_path(id);
+  auto synopsis_path = partition_synopsis_path(id);
+  VAST_VERBOSE("{} merges partitions {} into partition {}", self, partitions,
+               id);
+  merging_partitions = partitions;
+  auto merger = self->spawn(partition_merger, id, std::move(sources), path,
+                            synopsis_path, filesystem, store,
+                            partition_index_options(),
+                            partition_synopsis_options());
+  auto abort = [=](const caf::error& err) mutable {
+    VAST_WARN("{} failed to merge partitions {}: {}", self, partitions, err);
+    remove_partition_files(path, synopsis_path);
+    merging_partitions.clear();
+    rp.deliver(err);
+  };
+  self->request(merger, caf::infinite, atom::run_v)
+    .then(
+      [=](std::shared_ptr<partition_synopsis>& ps) mutable {
+        if (auto mapped = mmap_partition_synopsis(synopsis_path))
+          ps = std::make_shared<partition_synopsis>(std::move(*mapped));
+        meta_index_bytes += ps->memusage();
+        auto range = ps->time_range();
+        auto newest_event
+          = range ? std::optional{range->second} : std::optional<time>{};
+        // Lookups see either the merged partitions or the new one, but
+        // never both.
+        self
+          ->request(meta_index, caf::infinite, atom::replace_v, partitions, id,
+                    std::move(ps))
+          .then(
+            [=](atom::ok) mutable {
+              ++merge_generation;
+              persisted_partitions.insert(id);
+              track_disk_usage(id, newest_event, events);
+              for (const auto& partition : partitions) {
+                persisted_partitions.erase(partition);
+                untrack_disk_usage(partition);
+                if (cache)
+                  cache->erase(partition);
+                merged_partitions.emplace(
+                  partition, merged_partition{id, merge_generation});
+                retired_partitions.emplace(partition, false);
+              }
+              merging_partitions.clear();
+              // The merged partitions must stay on disk until the index state
+              // no longer references them, or a crash would lose their events.
+              flush_to_disk([=] {
+                for (const auto& partition : partitions)
+                  if (auto it = retired_partitions.find(partition);
+                      it != retired_partitions.end())
+                    it->second = true;
+                remove_retired_partitions();
+              });
+              VAST_VERBOSE("{} merged {} partitions into partition {}", self,
+                           partitions.size(), id);
+              rp.deliver(partitions);
+            },
+            abort);
+      },
+      abort);
+  return rp;
+}
+
+void index_state::replace_merged_partitions(
+  std::vector<uuid>& candidates) const {
+  if (merged_partitions.empty())
+    return;
+  for (auto& candidate : candidates)
+    for (auto it = merged_partitions.find(candidate);
+         it != merged_partitions.end(); it = merged_partitions.find(candidate))
+      candidate = it->second.replacement;
+  // Several merged partitions map to the same partition. We keep the first
+  // occurrence to retain the order of the candidates.
+  auto seen = std::unordered_set<uuid>{};
+  candidates.erase(std::remove_if(candidates.begin(), candidates.end(),
+                                  [&](const uuid& candidate) {
+                                    return !seen.insert(candidate).second;
+                                  }),
+                   candidates.end());
+}
+
+void index_state::remove_retired_partitions() {
+  auto is_pending = [&](const uuid& id) {
+    return std::any_of(pending.begin(), pending.end(), [&](const auto& kvp) {
+      const auto& xs = kvp.second.partitions;
+      return std::find(xs.begin(), xs.end(), id) != xs.end();
+    });
+  };
+  for (auto it = retired_partitions.begin();
+       it != retired_partitions.end();) {
+    const auto& [id, unreferenced] = *it;
+    if (!unreferenced || is_pending(id)) {
+      ++it;
+      continue;
+    }
+    VAST_DEBUG("{} removes retired partition {}", self, id);
+    inmem_partitions.drop(id);
+    remove_partition_files(partition_path(id), partition_synopsis_path(id));
+    it = retired_partitions.erase(it);
+  }
+  forget_merged_partitions();
+}
+
+void index_state::forget_merged_partitions() {
+  // A lookup that started before a merge may still return the merged
+  // partitions, so we keep their replacements until it finishes.
+  auto oldest = meta_index_lookups.empty() ? merge_generation
+                                           : *meta_index_lookups.begin();
+  for (auto it = merged_partitions.begin(); it != merged_partitions.end();) {
+    auto id = it->first;
+    auto [replacement, generation] = it->second;
+    if (retired_partitions.count(id) != 0u || generation > oldest) {
+      ++it;
+      continue;
+    }
+    it = merged_partitions.erase(it);
+    // Partitions that were merged into this one now map to its replacement.
+    for (auto& [_, merged] : merged_partitions)
+      if (merged.replacement == id)
+        merged.replacement = replacement;
+  }
+}
+
 partition_actor partition_factory::operator()(const uuid& id) const {
   // Load partition from disk.
-  VAST_ASSERT(std::find(state_.persisted_partitions.begin(),
-                        state_.persisted_partitions.end(), id)
-              != state_.persisted_partitions.end());
+  VAST_ASSERT(state_.persisted_partitions.count(id) != 0u
+              || state_.retired_partitions.count(id) != 0u);
   const auto path = state_.partition_path(id);
   VAST_DEBUG("{} loads partition {} for path {}", state_.self, id, path);
   return state_.self->spawn(passive_partition, id, filesystem_, path,
-                            state_.store);
+                            state_.store, state_.cache,
+                            state_.direct_evaluation);
 }
 
 filesystem_actor& partition_factory::filesystem() {
@@ -226,10 +486,16 @@ caf::error index_state::load_from_disk() {
           != fbs::partition_synopsis::PartitionSynopsis::v0)
         return caf::make_error(ec::format_error, "invalid partition synopsis "
                                                  "version");
-      if (auto error = unpack(*ps_flatbuffer->partition_synopsis_as_v0(), ps))
+      // Passing the chunk lets Bloom filter synopses reference the mapped
+      // file instead of copying their cells to the heap.
+      if (auto error = unpack(*ps_flatbuffer->partition_synopsis_as_v0(), ps,
+                              std::move(*chunk)))
         return error;
       meta_index_bytes += ps.memusage();
       persisted_partitions.insert(partition_uuid);
+      auto range = ps.time_range();
+      track_disk_usage(partition_uuid, range ? std::optional{range->second}
+                                             : std::optional<time>{});
       synopses->emplace(partition_uuid, std::move(ps));
     }
     // We collect all synopses to send them in bulk, since the `await` interface
@@ -315,19 +581,28 @@ void index_state::notify_flush_listeners() {
   flush_listeners.clear();
 }
 
-void index_state::create_active_partition() {
-  auto id = uuid::random();
-  caf::settings index_opts;
-  index_opts["cardinality"] = partition_capacity;
+caf::settings index_state::partition_index_options() const {
+  caf::settings result;
+  result["cardinality"] = partition_capacity;
+  return result;
+}
+
+caf::settings index_state::partition_synopsis_options() const {
   // These options must be kept in sync with vast/address_synopsis.hpp and
   // vast/string_synopsis.hpp respectively.
-  auto synopsis_options = caf::settings{};
-  put(synopsis_options, "max-partition-size", partition_capacity);
-  put(synopsis_options, "address-synopsis-fp-rate", meta_index_fp_rate);
-  put(synopsis_options, "string-synopsis-fp-rate", meta_index_fp_rate);
+  auto result = caf::settings{};
+  put(result, "max-partition-size", partition_capacity);
+  put(result, "address-synopsis-fp-rate", meta_index_fp_rate);
+  put(result, "string-synopsis-fp-rate", meta_index_fp_rate);
+  return result;
+}
+
+void index_state::create_active_partition() {
+  auto id = uuid::random();
   active_partition.actor
-    = self->spawn(::vast::system::active_partition, id, filesystem, index_opts,
-                  synopsis_options, store);
+    = self->spawn(::vast::system::active_partition, id, filesystem,
+                  partition_index_options(), partition_synopsis_options(),
+                  store, local_stores);
   active_partition.stream_slot
     = stage->add_outbound_path(active_partition.actor);
   active_partition.capacity = partition_capacity;
@@ -337,8 +612,10 @@ void index_state::create_active_partition() {
 
 void index_state::decomission_active_partition() {
   auto id = active_partition.id;
+  auto events = uint64_t{partition_capacity - active_partition.capacity};
   auto actor = std::exchange(active_partition.actor, {});
   unpersisted[id] = actor;
+  unpersisted_order.push_back(id);
   // Send buffered batches and remove active partition from the stream.
   stage->out().fan_out_flush();
   stage->out().close(active_partition.stream_slot);
@@ -351,10 +628,21 @@ void index_state::decomission_active_partition() {
     .then(
       [=](std::shared_ptr<partition_synopsis>& ps) {
         VAST_DEBUG("{} successfully persisted partition {}", self, id);
+        // Replace the synopsis with one that references the persisted file,
+        // such that the meta index does not keep the Bloom filters on the
+        // heap. We fall back to the received synopsis if that fails.
+        if (auto mapped = mmap_partition_synopsis(synopsis_dir))
+          ps = std::make_shared<partition_synopsis>(std::move(*mapped));
+        else
+          VAST_DEBUG("{} keeps the synopsis of partition {} on the heap: {}",
+                     self, id, mapped.error());
         // Semantically ps is a unique_ptr, and the partition releases its
         // copy before sending. We use shared_ptr for the transport because
         // CAF message types must be copy-constructible.
         meta_index_bytes += ps->memusage();
+        auto range = ps->time_range();
+        auto newest_event
+          = range ? std::optional{range->second} : std::optional<time>{};
         // TODO: We should skip this continuation if we're currently shutting
         // down.
         self
@@ -364,7 +652,11 @@ void index_state::decomission_active_partition() {
               VAST_DEBUG("{} received ok for request to persist partition {}",
                          self, id);
               unpersisted.erase(id);
+              unpersisted_order.erase(std::remove(unpersisted_order.begin(),
+                                                  unpersisted_order.end(), id),
+                                      unpersisted_order.end());
               persisted_partitions.insert(id);
+              track_disk_usage(id, newest_event, events);
             },
             [=](const caf::error& err) {
               VAST_DEBUG("{} received error for request to persist partition "
@@ -418,6 +710,18 @@ index_state::status(status_verbosity v) const {
         active_partition.actor == nullptr ? 0 : 1);
     put(index_status, "num-cached-partitions", inmem_partitions.size());
     put(index_status, "num-unpersisted-partitions", unpersisted.size());
+    put(index_status, "disk-usage", disk_usage);
+    put(index_status, "num-retired-partitions", retired_partitions.size());
+    if (cache) {
+      auto cache_stats = cache->statistics();
+      auto& cache_status = put_dictionary(index_status, "query-cache");
+      put(cache_status, "capacity", cache->capacity());
+      put(cache_status, "bytes", cache_stats.bytes);
+      put(cache_status, "entries", cache_stats.entries);
+      put(cache_status, "hits", cache_stats.hits);
+      put(cache_status, "misses", cache_stats.misses);
+      put(cache_status, "evictions", cache_stats.evictions);
+    }
     auto& partitions = put_dictionary(index_status, "partitions");
     auto partition_status = [&](const uuid& id, const partition_actor& pa,
                                 caf::config_value::list& xs) {
@@ -477,15 +781,17 @@ index_state::collect_query_actors(query_state& lookup,
   std::vector<std::pair<uuid, partition_actor>> result;
   if (num_partitions == 0 || lookup.partitions.empty())
     return result;
-  // Prefer partitions that are already available in RAM.
+  // Prefer partitions that are already available in RAM, unless the query
+  // asks for a specific order.
   auto partition_is_loaded = [&](const uuid& candidate) {
     return (active_partition.actor != nullptr
             && active_partition.id == candidate)
            || (unpersisted.count(candidate) != 0u)
            || inmem_partitions.contains(candidate);
   };
-  std::partition(lookup.partitions.begin(), lookup.partitions.end(),
-                 partition_is_loaded);
+  if (lookup.query.order == query::unordered)
+    std::partition(lookup.partitions.begin(), lookup.partitions.end(),
+                   partition_is_loaded);
   // Helper function to spin up EVALUATOR actors for a single partition.
   auto spin_up = [&](const uuid& partition_id) -> partition_actor {
     // We need to first check whether the ID is the active partition or one
@@ -496,8 +802,8 @@ index_state::collect_query_actors(query_state& lookup,
       part = active_partition.actor;
     else if (auto it = unpersisted.find(partition_id); it != unpersisted.end())
       part = it->second;
-    else if (auto it = persisted_partitions.find(partition_id);
-             it != persisted_partitions.end())
+    else if (persisted_partitions.count(partition_id) != 0u
+             || retired_partitions.count(partition_id) != 0u)
       part = inmem_partitions.get_or_load(partition_id);
     if (!part)
       VAST_ERROR("{} could not load partition {} that was part of a "
@@ -571,7 +877,7 @@ pack(flatbuffers::FlatBufferBuilder& builder, const index_state& state) {
 }
 
 /// Persists the state to disk.
-void index_state::flush_to_disk() {
+void index_state::flush_to_disk(std::function<void()> on_success) {
   auto builder = flatbuffers::FlatBufferBuilder{};
   auto index = pack(builder, *this);
   if (!index) {
@@ -584,6 +890,8 @@ void index_state::flush_to_disk() {
     .then(
       [=](atom::ok) {
         VAST_DEBUG("{} successfully persisted index state", self);
+        if (on_success)
+          on_success();
       },
       [=](const caf::error& err) {
         VAST_WARN("{} failed to persist index state: {}", self, render(err));
@@ -595,11 +903,14 @@ index(index_actor::stateful_pointer<index_state> self, store_actor store,
       filesystem_actor filesystem, const std::filesystem::path& dir,
       size_t partition_capacity, size_t max_inmem_partitions,
       size_t taste_partitions, size_t num_workers,
-      const std::filesystem::path& meta_index_dir, double meta_index_fp_rate) {
-  VAST_TRACE_SCOPE("{} {} {} {} {} {} {}", VAST_ARG(filesystem), VAST_ARG(dir),
-                   VAST_ARG(partition_capacity), VAST_ARG(max_inmem_partitions),
-                   VAST_ARG(taste_partitions), VAST_ARG(num_workers),
-                   VAST_ARG(meta_index_dir), VAST_ARG(meta_index_fp_rate));
+      const std::filesystem::path& meta_index_dir, double meta_index_fp_rate,
+      size_t query_cache_size, bool direct_evaluation, bool local_stores) {
+  VAST_TRACE_SCOPE("{} {} {} {} {} {} {} {} {} {}", VAST_ARG(filesystem),
+                   VAST_ARG(dir), VAST_ARG(partition_capacity),
+                   VAST_ARG(max_inmem_partitions), VAST_ARG(taste_partitions),
+                   VAST_ARG(num_workers), VAST_ARG(meta_index_dir),
+                   VAST_ARG(meta_index_fp_rate), VAST_ARG(query_cache_size),
+                   VAST_ARG(direct_evaluation), VAST_ARG(local_stores));
   VAST_VERBOSE("{} initializes index in {} with a maximum partition "
                "size of {} events and {} resident partitions",
                self, dir, partition_capacity, max_inmem_partitions);
@@ -619,6 +930,14 @@ index(index_actor::stateful_pointer<index_state> self, store_actor store,
   self->state.inmem_partitions.resize(max_inmem_partitions);
   self->state.meta_index_fp_rate = meta_index_fp_rate;
   self->state.meta_index_bytes = 0;
+  if (query_cache_size > 0)
+    self->state.cache = std::make_shared<query_cache>(query_cache_size);
+  self->state.direct_evaluation = direct_evaluation;
+  if (direct_evaluation)
+    VAST_VERBOSE("{} evaluates queries in passive partitions directly", self);
+  self->state.local_stores = local_stores;
+  if (local_stores)
+    VAST_VERBOSE("{} stores events in partition-local stores", self);
   // Read persistent state.
   if (auto err = self->state.load_from_disk()) {
     VAST_ERROR("{} failed to load index state from disk: {}", self,
@@ -702,6 +1021,7 @@ index(index_actor::stateful_pointer<index_state> self, store_actor store,
     // Receiving an EXIT message does not need to coincide with the state being
     // destructed, so we explicitly clear the tables to release the references.
     self->state.unpersisted.clear();
+    self->state.unpersisted_order.clear();
     self->state.inmem_partitions.clear();
     // Terminate partition actors.
     VAST_DEBUG("{} brings down {} partitions", self, partitions.size());
@@ -764,21 +1084,64 @@ index(index_actor::stateful_pointer<index_state> self, store_actor store,
       std::vector<uuid> candidates;
       if (self->state.active_partition.actor)
         candidates.push_back(self->state.active_partition.id);
-      for (const auto& [id, _] : self->state.unpersisted)
-        candidates.push_back(id);
+      // Order the unpersisted partitions from the newest to the oldest, like
+      // the active partition that precedes them.
+      candidates.insert(candidates.end(),
+                        self->state.unpersisted_order.rbegin(),
+                        self->state.unpersisted_order.rend());
       auto rp = self->make_response_promise<void>();
       // Get all potentially matching partitions.
-      self->request(self->state.meta_index, caf::infinite, query.expr)
+      auto start = std::chrono::system_clock::now();
+      auto generation = self->state.merge_generation;
+      self->state.meta_index_lookups.insert(generation);
+      auto finish_lookup = [self, generation] {
+        auto& lookups = self->state.meta_index_lookups;
+        lookups.erase(lookups.find(generation));
+        self->state.forget_merged_partitions();
+      };
+      self->request(self->state.meta_index, caf::infinite, query)
         .then(
           [=, candidates = std::move(candidates)](
             std::vector<uuid> midx_candidates) mutable {
+            record_span(self, query, query_stage::meta_index, start);
+            static auto& lookup_latency
+              = metrics_registry::instance().histogram(
+                "index.meta-index.lookup", metric_unit::nanoseconds);
+            lookup_latency.record(std::chrono::system_clock::now() - start);
+            self->state.replace_merged_partitions(midx_candidates);
+            finish_lookup();
             VAST_DEBUG("{} got initial candidates {} and from meta-index {}",
                        self, candidates, midx_candidates);
-            candidates.insert(candidates.end(), midx_candidates.begin(),
-                              midx_candidates.end());
-            std::sort(candidates.begin(), candidates.end());
-            candidates.erase(std::unique(candidates.begin(), candidates.end()),
-                             candidates.end());
+            if (query.order == vast::query::unordered) {
+              candidates.insert(candidates.end(), midx_candidates.begin(),
+                                midx_candidates.end());
+              std::sort(candidates.begin(), candidates.end());
+              candidates.erase(
+                std::unique(candidates.begin(), candidates.end()),
+                candidates.end());
+            } else {
+              // The meta index already ordered its candidates by time. A
+              // partition that finished persisting may show up in both sets.
+              auto is_initial = [&](const uuid& x) {
+                return std::find(candidates.begin(), candidates.end(), x)
+                       != candidates.end();
+              };
+              midx_candidates.erase(std::remove_if(midx_candidates.begin(),
+                                                   midx_candidates.end(),
+                                                   is_initial),
+                                    midx_candidates.end());
+              // The active and unpersisted partitions hold the most recent
+              // events, with the active partition being the newest.
+              if (query.order == vast::query::newest_first) {
+                candidates.insert(candidates.end(), midx_candidates.begin(),
+                                  midx_candidates.end());
+              } else {
+                std::reverse(candidates.begin(), candidates.end());
+                midx_candidates.insert(midx_candidates.end(),
+                                       candidates.begin(), candidates.end());
+                candidates = std::move(midx_candidates);
+              }
+            }
             if (candidates.empty()) {
               VAST_DEBUG("{} returns without result: no partitions qualify",
                          self);
@@ -809,6 +1172,7 @@ index(index_actor::stateful_pointer<index_state> self, store_actor store,
           [=](caf::error err) mutable {
             VAST_ERROR("{} failed to receive candidates from meta-index: {}",
                        self, render(err));
+            finish_lookup();
             rp.deliver(std::move(err));
           });
       return rp;
@@ -826,6 +1190,7 @@ index(index_actor::stateful_pointer<index_state> self, store_actor store,
         VAST_DEBUG("{} drops remaining results for query id {}", self,
                    query_id);
         self->state.pending.erase(query_id);
+        self->state.remove_retired_partitions();
         return {};
       }
       auto iter = self->state.pending.find(query_id);
@@ -848,12 +1213,21 @@ index(index_actor::stateful_pointer<index_state> self, store_actor store,
                  self, actors.size(), query_id, query_state.partitions.size());
       self->send(*worker, query_state.query, std::move(actors), client);
       // Cleanup if we exhausted all candidates.
-      if (query_state.partitions.empty())
+      if (query_state.partitions.empty()) {
         self->state.pending.erase(iter);
+        self->state.remove_retired_partitions();
+      }
       return {};
     },
     [self](atom::erase, uuid partition_id) -> caf::result<ids> {
       VAST_VERBOSE("{} erases partition {}", self, partition_id);
+      const auto& merging = self->state.merging_partitions;
+      if (std::find(merging.begin(), merging.end(), partition_id)
+          != merging.end())
+        return caf::make_error(ec::unspecified,
+                               fmt::format("cannot erase partition {} while "
+                                           "merging it",
+                                           partition_id));
       auto rp = self->make_response_promise<ids>();
       auto path = self->state.partition_path(partition_id);
       auto synopsis_path = self->state.partition_synopsis_path(partition_id);
@@ -874,6 +1248,9 @@ index(index_actor::stateful_pointer<index_state> self, store_actor store,
       }
       self->state.inmem_partitions.drop(partition_id);
       self->state.persisted_partitions.erase(partition_id);
+      self->state.untrack_disk_usage(partition_id);
+      if (self->state.cache)
+        self->state.cache->erase(partition_id);
       self
         ->request(self->state.meta_index, caf::infinite, atom::erase_v,
                   partition_id)
@@ -921,6 +1298,13 @@ index(index_actor::stateful_pointer<index_state> self, store_actor store,
               if (err)
                 error_fn();
             };
+            // Partitions with a local store own their events, so erasing
+            // them is as cheap as unlinking the store file.
+            if (auto store_path = local_segment_store_path(*partition_v0, path))
+              try_remove_all(*store_path, [&] {
+                VAST_WARN("{} could not unlink partition-local store at {}",
+                          self, *store_path);
+              });
             try_remove_all(path, [&] {
               VAST_WARN("{} could not unlink partition at {}", self, path);
             });
@@ -933,6 +1317,78 @@ index(index_actor::stateful_pointer<index_state> self, store_actor store,
           [=](caf::error& err) mutable { rp.deliver(std::move(err)); });
       return rp;
     },
+    [self](atom::erase, time cutoff) -> caf::result<std::vector<uuid>> {
+      VAST_VERBOSE("{} erases partitions older than {}", self, cutoff);
+      auto rp = self->make_response_promise<std::vector<uuid>>();
+      self
+        ->request(self->state.meta_index, caf::infinite, atom::get_v,
+                  atom::timestamp_v, cutoff)
+        .then(
+          [self, rp](std::vector<uuid>& candidates) mutable {
+            // Only persisted partitions can be dropped as a whole; the
+            // active and unpersisted partitions are still being written.
+            candidates.erase(
+              std::remove_if(candidates.begin(), candidates.end(),
+                             [&](const uuid& id) {
+                               return self->state.persisted_partitions.count(id)
+                                      == 0u;
+                             }),
+              candidates.end());
+            if (candidates.empty()) {
+              rp.deliver(std::move(candidates));
+              return;
+            }
+            auto dropped = std::make_shared<std::vector<uuid>>();
+            auto remaining = std::make_shared<size_t>(candidates.size());
+            auto finish = [=]() mutable {
+              if (--*remaining == 0)
+                rp.deliver(std::move(*dropped));
+            };
+            for (const auto& id : candidates) {
+              self
+                ->request(static_cast<index_actor>(self), caf::infinite,
+                          atom::erase_v, id)
+                .then(
+                  [=](ids& xs) mutable {
+                    dropped->push_back(id);
+                    // Partitions with a local store already took their
+                    // events with them, so this is a no-op for the store.
+                    if (self->state.store)
+                      self
+                        ->request(self->state.store, caf::infinite,
+                                  atom::erase_v, std::move(xs))
+                        .then([](atom::done) { /* nop */ },
+                              [self, id](const caf::error& err) {
+                                VAST_WARN("{} failed to erase events of "
+                                          "partition {} from the store: {}",
+                                          self, id, err);
+                              });
+                    finish();
+                  },
+                  [=](const caf::error& err) mutable {
+                    VAST_WARN("{} failed to erase partition {}: {}", self, id,
+                              err);
+                    finish();
+                  });
+            }
+          },
+          [rp](caf::error& err) mutable { rp.deliver(std::move(err)); });
+      return rp;
+    },
+    [self](atom::disk_usage)
+      -> caf::result<uint64_t, std::vector<uuid>> {
+      return {self->state.disk_usage, self->state.partitions_by_age()};
+    },
+    [self](atom::compact,
+           uint64_t max_events) -> caf::result<std::vector<uuid>> {
+      // Merge one run of partitions at a time to bound the memory usage.
+      if (!self->state.merging_partitions.empty())
+        return std::vector<uuid>{};
+      auto partitions = self->state.compaction_candidates(max_events);
+      if (partitions.empty())
+        return partitions;
+      return self->state.merge_partitions(std::move(partitions));
+    },
     // -- query_supervisor_master_actor ----------------------------------------
     [self](atom::worker, query_supervisor_actor worker) {
       if (!self->state.worker_available())
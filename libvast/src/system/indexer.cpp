@@ -21,6 +21,7 @@
 #include "vast/logger.hpp"
 #include "vast/system/accountant.hpp"
 #include "vast/system/instrumentation.hpp"
+#include "vast/system/query_cache.hpp"
 #include "vast/system/report.hpp"
 #include "vast/table_slice.hpp"
 #include "vast/table_slice_column.hpp"
@@ -132,7 +133,8 @@ active_indexer(active_indexer_actor::stateful_pointer<indexer_state> self,
 
 indexer_actor::behavior_type
 passive_indexer(indexer_actor::stateful_pointer<indexer_state> self,
-                uuid partition_id, value_index_ptr idx) {
+                uuid partition_id, value_index_ptr idx, size_t position,
+                std::shared_ptr<query_cache> cache) {
   if (!idx) {
     VAST_ERROR("{} got invalid value index pointer", self);
     self->quit(caf::make_error(ec::end_of_input, "invalid value index "
@@ -142,13 +144,19 @@ passive_indexer(indexer_actor::stateful_pointer<indexer_state> self,
   self->state.name = "indexer-" + to_string(idx->type());
   self->state.partition_id = partition_id;
   self->state.idx = std::move(idx);
+  self->state.position = position;
+  self->state.cache = std::move(cache);
   return {
     [self](const curried_predicate& pred) {
       VAST_DEBUG("{} got predicate: {}", self, pred);
       VAST_ASSERT(self->state.idx);
       auto& idx = *self->state.idx;
       auto rep = to_internal(idx.type(), make_view(pred.rhs));
-      return idx.lookup(pred.op, rep);
+      auto result = idx.lookup(pred.op, rep);
+      if (result && self->state.cache)
+        self->state.cache->insert(
+          {self->state.partition_id, self->state.position, pred}, *result);
+      return result;
     },
     [self](atom::shutdown) { self->quit(caf::exit_reason::user_shutdown); },
   };
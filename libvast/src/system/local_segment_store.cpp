@@ -0,0 +1,303 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/local_segment_store.hpp"
+
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/chunk.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/error.hpp"
+#include "vast/ids.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/archive.hpp"
+#include "vast/system/query_profile.hpp"
+#include "vast/system/status_verbosity.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/settings.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <system_error>
+#include <utility>
+
+namespace vast::system {
+
+namespace {
+
+/// Removes the events with the given ids from a sequence of table slices.
+/// @returns The remaining table slices and the number of erased events.
+std::pair<std::vector<table_slice>, size_t>
+remove_ids(const std::vector<table_slice>& slices, const ids& xs) {
+  auto result = std::vector<table_slice>{};
+  auto erased = size_t{0};
+  auto keep_mask = ~xs;
+  for (const auto& slice : slices) {
+    // Expand the mask on-the-fly if needed.
+    auto max_id = slice.offset() + slice.rows();
+    if (keep_mask.size() < max_id)
+      keep_mask.append_bits(true, max_id - keep_mask.size());
+    auto size_before = result.size();
+    select(result, slice, keep_mask);
+    auto remaining_rows = size_t{0};
+    for (auto i = size_before; i < result.size(); ++i)
+      remaining_rows += result[i].rows();
+    erased += slice.rows() - remaining_rows;
+  }
+  return {std::move(result), erased};
+}
+
+/// Creates a segment from a sequence of table slices.
+segment make_segment(const std::vector<table_slice>& slices) {
+  auto size_estimate = size_t{0};
+  for (const auto& slice : slices)
+    size_estimate += as_bytes(slice).size();
+  auto builder
+    = segment_builder{std::max(size_estimate + size_estimate / 10, size_t{1})};
+  for (const auto& slice : slices)
+    if (auto err = builder.add(slice))
+      VAST_ERROR("{} failed to add table slice to segment: {}", __func__, err);
+  return builder.finish();
+}
+
+/// Evaluates a query on table slices with the CANDIDATE CHECKER, and responds
+/// once all checks completed.
+template <class Self>
+caf::result<atom::done>
+check_candidates(Self* self, vast::query query,
+                 std::vector<table_slice> slices, const ids& xs) {
+  auto rp = self->template make_response_promise<atom::done>();
+  auto pending = std::make_shared<size_t>(slices.size());
+  auto error = std::make_shared<caf::error>();
+  auto candidates = rank(xs);
+  auto finish = [=]() mutable {
+    if (*error) {
+      rp.deliver(std::move(*error));
+      return;
+    }
+    // Let the client know how many candidates we checked, so it can relate
+    // them to the number of results.
+    if (auto* extract = caf::get_if<query::extract>(&query.cmd))
+      self->send(extract->sink, atom::candidate_v, candidates);
+    rp.deliver(atom::done_v);
+  };
+  if (slices.empty()) {
+    finish();
+    return rp;
+  }
+  for (auto& slice : slices)
+    self
+      ->request(self->state.checker, caf::infinite, query, std::move(slice),
+                xs)
+      .then(
+        [=](atom::done) mutable {
+          if (--*pending == 0)
+            finish();
+        },
+        [=](caf::error& err) mutable {
+          VAST_ERROR("{} failed to check candidates: {}", self, err);
+          if (!*error)
+            *error = std::move(err);
+          if (--*pending == 0)
+            finish();
+        });
+  return rp;
+}
+
+/// Erases events from the segment of a store that was written to disk. The
+/// store file gets removed once all of its events are gone.
+template <class Self>
+caf::result<atom::done> erase_persisted(Self* self, const ids& xs) {
+  auto& st = self->state;
+  VAST_ASSERT(st.segment);
+  auto slices = st.segment->lookup(st.segment->ids());
+  if (!slices)
+    return std::move(slices.error());
+  auto [remaining, erased] = remove_ids(*slices, xs);
+  if (erased == 0)
+    return atom::done_v;
+  VAST_VERBOSE("{} erases {} events", self, erased);
+  st.segment = make_segment(remaining);
+  if (remaining.empty()) {
+    // Erasing all events is the common case when deleting old data, and
+    // requires no more than removing the file. Active queries still hold a
+    // reference to the mapped file.
+    VAST_DEBUG("{} removes {}", self, st.path);
+    std::error_code err{};
+    std::filesystem::remove(st.path, err);
+    if (err)
+      return caf::make_error(ec::filesystem_error,
+                             fmt::format("failed to remove {}: {}", st.path,
+                                         err.message()));
+    return atom::done_v;
+  }
+  auto rp = self->template make_response_promise<atom::done>();
+  self
+    ->request(st.filesystem, caf::infinite, atom::write_v, st.path,
+              st.segment->chunk())
+    .then([=](atom::ok) mutable { rp.deliver(atom::done_v); },
+          [=](caf::error& err) mutable { rp.deliver(std::move(err)); });
+  return rp;
+}
+
+} // namespace
+
+std::filesystem::path
+local_segment_store_path(const std::filesystem::path& partition_path) {
+  auto result = partition_path;
+  result += local_segment_store_extension;
+  return result;
+}
+
+std::optional<std::filesystem::path>
+local_segment_store_path(const fbs::partition::v0& partition,
+                         const std::filesystem::path& partition_path) {
+  const auto* header = partition.store();
+  if (!header || !header->id() || !header->data()
+      || header->id()->str() != local_segment_store_id)
+    return std::nullopt;
+  // The store header holds the file name of the store relative to the
+  // partition, so the database directory can be moved freely.
+  auto filename = std::string_view{
+    reinterpret_cast<const char*>(header->data()->data()),
+    header->data()->size()};
+  return partition_path.parent_path() / filename;
+}
+
+partition_store_builder_actor::behavior_type active_local_store(
+  partition_store_builder_actor::stateful_pointer<active_local_store_state>
+    self,
+  filesystem_actor filesystem) {
+  self->state.filesystem = std::move(filesystem);
+  self->state.checker = self->spawn<caf::linked>(candidate_checker);
+  auto erase = [self](const ids& xs) -> caf::result<atom::done> {
+    if (self->state.segment)
+      return erase_persisted(self, xs);
+    auto [remaining, erased]
+      = remove_ids(self->state.builder.table_slices(), xs);
+    if (erased == 0)
+      return atom::done_v;
+    VAST_VERBOSE("{} erases {} events", self, erased);
+    self->state.builder.reset();
+    for (auto& slice : remaining)
+      if (auto err = self->state.builder.add(std::move(slice)))
+        VAST_ERROR("{} failed to add table slice: {}", self, err);
+    self->state.events -= erased;
+    return atom::done_v;
+  };
+  return {
+    [self](table_slice& slice) {
+      if (self->state.segment) {
+        VAST_WARN("{} ignores table slice after persisting", self);
+        return;
+      }
+      self->state.events += slice.rows();
+      if (auto err = self->state.builder.add(std::move(slice)))
+        VAST_ERROR("{} failed to add table slice: {}", self, err);
+    },
+    [self](atom::persist,
+           std::filesystem::path& path) -> caf::result<atom::ok> {
+      if (self->state.segment)
+        return caf::make_error(ec::logic_error, "store was already persisted");
+      self->state.segment = self->state.builder.finish();
+      self->state.path = std::move(path);
+      VAST_DEBUG("{} persists {} events to {}", self, self->state.events,
+                 self->state.path);
+      auto rp = self->make_response_promise<atom::ok>();
+      self
+        ->request(self->state.filesystem, caf::infinite, atom::write_v,
+                  self->state.path, self->state.segment->chunk())
+        .then([=](atom::ok) mutable { rp.deliver(atom::ok_v); },
+              [=](caf::error& err) mutable { rp.deliver(std::move(err)); });
+      return rp;
+    },
+    [self, erase](vast::query& query, ids& xs) -> caf::result<atom::done> {
+      if (caf::holds_alternative<query::erase>(query.cmd))
+        return erase(xs);
+      auto start = std::chrono::system_clock::now();
+      auto slices = self->state.segment ? self->state.segment->lookup(xs)
+                                        : self->state.builder.lookup(xs);
+      record_span(self, query, query_stage::store_lookup, start);
+      if (!slices)
+        return std::move(slices.error());
+      return check_candidates(self, std::move(query), std::move(*slices), xs);
+    },
+    [erase](atom::erase, const ids& xs) -> caf::result<atom::done> {
+      return erase(xs);
+    },
+    [self](atom::status, status_verbosity) {
+      auto result = caf::settings{};
+      auto& store_status = put_dictionary(result, "segment-store");
+      put(store_status, "events", self->state.events);
+      put(store_status, "persisted", self->state.segment.has_value());
+      return result;
+    },
+  };
+}
+
+store_actor::behavior_type passive_local_store(
+  store_actor::stateful_pointer<passive_local_store_state> self,
+  filesystem_actor filesystem, const std::filesystem::path& path) {
+  self->state.filesystem = std::move(filesystem);
+  self->state.path = path;
+  self->state.checker = self->spawn<caf::linked>(candidate_checker);
+  self->request(self->state.filesystem, caf::infinite, atom::mmap_v, path)
+    .then(
+      [self](chunk_ptr& chunk) {
+        auto seg = segment::make(std::move(chunk));
+        if (!seg) {
+          VAST_ERROR("{} failed to load segment from {}: {}", self,
+                     self->state.path, seg.error());
+          self->quit(std::move(seg.error()));
+          return;
+        }
+        self->state.segment = std::move(*seg);
+        VAST_DEBUG("{} delegates {} deferred requests", self,
+                   self->state.deferred_requests.size());
+        for (auto&& [query, xs, rp] :
+             std::exchange(self->state.deferred_requests, {}))
+          rp.delegate(static_cast<store_actor>(self), std::move(query),
+                      std::move(xs));
+      },
+      [self](caf::error& err) {
+        VAST_ERROR("{} failed to map {}: {}", self, self->state.path, err);
+        for (auto&& [query, xs, rp] :
+             std::exchange(self->state.deferred_requests, {})) {
+          // Because of a deficiency in the typed_response_promise API, we must
+          // access the underlying response_promise to deliver the error.
+          caf::response_promise& untyped_rp = rp;
+          untyped_rp.deliver(static_cast<store_actor>(self), err);
+        }
+        self->quit(std::move(err));
+      });
+  return {
+    [self](vast::query& query, ids& xs) -> caf::result<atom::done> {
+      if (!self->state.segment)
+        return std::get<2>(self->state.deferred_requests.emplace_back(
+          std::move(query), std::move(xs),
+          self->make_response_promise<atom::done>()));
+      if (caf::holds_alternative<query::erase>(query.cmd))
+        return erase_persisted(self, xs);
+      auto start = std::chrono::system_clock::now();
+      auto slices = self->state.segment->lookup(xs);
+      record_span(self, query, query_stage::store_lookup, start);
+      if (!slices)
+        return std::move(slices.error());
+      return check_candidates(self, std::move(query), std::move(*slices), xs);
+    },
+    [self](atom::erase, ids& xs) -> caf::result<atom::done> {
+      if (!self->state.segment)
+        return std::get<2>(self->state.deferred_requests.emplace_back(
+          query::make_erase({}), std::move(xs),
+          self->make_response_promise<atom::done>()));
+      return erase_persisted(self, xs);
+    },
+  };
+}
+
+} // namespace vast::system
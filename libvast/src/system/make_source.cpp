@@ -15,6 +15,7 @@
 #include "vast/concept/parseable/vast/expression.hpp"
 #include "vast/concept/parseable/vast/schema.hpp"
 #include "vast/concept/parseable/vast/table_slice_encoding.hpp"
+#include "vast/concept/printable/std/chrono.hpp"
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/port.hpp"
 #include "vast/defaults.hpp"
@@ -25,6 +26,7 @@
 #include "vast/logger.hpp"
 #include "vast/optional.hpp"
 #include "vast/schema.hpp"
+#include "vast/system/batch_size_controller.hpp"
 #include "vast/system/datagram_source.hpp"
 #include "vast/system/signal_monitor.hpp"
 #include "vast/system/source.hpp"
@@ -69,10 +71,9 @@ make_source(caf::actor_system& sys, const std::string& format,
     return caf::make_error(ec::invalid_configuration, "failed to extract "
                                                       "batch-encoding option");
   VAST_ASSERT(encoding != table_slice_encoding::none);
-  auto slice_size = caf::get_or(options, "vast.import.batch-size",
-                                defaults::import::table_slice_size);
-  if (slice_size == 0)
-    slice_size = std::numeric_limits<decltype(slice_size)>::max();
+  auto batching = batch_size_options::make(options);
+  if (!batching)
+    return batching.error();
   // Parse schema local to the import command.
   auto schema = get_schema(options);
   if (!schema)
@@ -109,11 +110,16 @@ make_source(caf::actor_system& sys, const std::string& format,
   auto reader = format::reader::make(format, inv.options);
   if (!reader)
     return reader.error();
-  if (slice_size == std::numeric_limits<decltype(slice_size)>::max())
+  if (batching->max_size == std::numeric_limits<size_t>::max())
     VAST_VERBOSE("{} produces {} table slices", (*reader)->name(), encoding);
   else
     VAST_VERBOSE("{} produces {} table slices of at most {} events",
-                 (*reader)->name(), encoding, slice_size);
+                 (*reader)->name(), encoding, batching->max_size);
+  if (batching->adaptive)
+    VAST_VERBOSE("{} sizes table slices adaptively for a latency of {} and "
+                 "at most {} bytes",
+                 (*reader)->name(), to_string(batching->target_latency),
+                 batching->target_bytes);
   // Spawn the source, falling back to the default spawn function.
   auto local_schema = schema ? std::move(*schema) : vast::schema{};
   auto type_filter = type ? std::move(*type) : std::string{};
@@ -130,7 +136,7 @@ make_source(caf::actor_system& sys, const std::string& format,
         return sys.spawn<caf::detached>(source,
                                         std::forward<decltype(args)>(args)...);
       return sys.spawn(source, std::forward<decltype(args)>(args)...);
-    }(std::move(*reader), slice_size, max_events, std::move(type_registry),
+    }(std::move(*reader), *batching, max_events, std::move(type_registry),
       std::move(local_schema), std::move(type_filter), std::move(accountant),
       std::move(transforms));
   VAST_ASSERT(src);
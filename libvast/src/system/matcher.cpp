@@ -0,0 +1,139 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/matcher.hpp"
+
+#include "vast/fwd.hpp"
+
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/expression.hpp"
+#include "vast/detail/fill_status_map.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/metrics.hpp"
+#include "vast/system/status_verbosity.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/attach_stream_sink.hpp>
+#include <caf/settings.hpp>
+#include <caf/typed_event_based_actor.hpp>
+
+#include <chrono>
+#include <utility>
+#include <vector>
+
+namespace vast::system {
+
+namespace {
+
+void handle_slice(matcher_actor::stateful_pointer<matcher_state> self,
+                  const table_slice& slice) {
+  auto& st = self->state;
+  if (st.subscriptions.empty())
+    return;
+  auto start = std::chrono::steady_clock::now();
+  st.processed += slice.rows();
+  auto matches = st.matcher.match(slice);
+  auto matched = ids{};
+  matched.append(false, slice.offset() + slice.rows());
+  for (auto& [id, selection] : matches) {
+    auto it = st.subscriptions.find(id);
+    VAST_ASSERT(it != st.subscriptions.end());
+    auto& sub = it->second;
+    // Sinks learn the number of checked events lazily, together with their
+    // results, to avoid sending a message per sink for every table slice.
+    self->send(sub.sink, atom::candidate_v,
+               st.processed - std::exchange(sub.reported, st.processed));
+    auto results = std::vector<table_slice>{};
+    select(results, slice, selection);
+    for (auto& result : results)
+      self->send(sub.sink, std::move(result));
+    matched |= selection;
+  }
+  auto num_matched = rank(matched);
+  st.matched += num_matched;
+  // Record into the metrics registry instead of messaging the ACCOUNTANT for
+  // every table slice; the ACCOUNTANT collects the registry periodically.
+  static auto& processed
+    = metrics_registry::instance().counter("matcher.processed");
+  static auto& matched_events
+    = metrics_registry::instance().counter("matcher.matched");
+  static auto& runtime = metrics_registry::instance().histogram(
+    "matcher.runtime", metric_unit::nanoseconds);
+  processed.add(slice.rows());
+  matched_events.add(num_matched);
+  runtime.record(std::chrono::steady_clock::now() - start);
+}
+
+} // namespace
+
+matcher_actor::behavior_type
+matcher(matcher_actor::stateful_pointer<matcher_state> self,
+        accountant_actor accountant) {
+  self->state.accountant = std::move(accountant);
+  if (self->state.accountant)
+    self->send(self->state.accountant, atom::announce_v, self->name());
+  self->set_down_handler([=](const caf::down_msg& msg) {
+    auto& st = self->state;
+    for (auto it = st.subscriptions.begin(); it != st.subscriptions.end();) {
+      if (it->second.sink.address() == msg.source) {
+        VAST_DEBUG("{} drops query {} of terminated sink {}", self, it->first,
+                   msg.source);
+        st.matcher.remove(it->first);
+        it = st.subscriptions.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  });
+  return {
+    [self](atom::subscribe, expression expr,
+           extract_sink_actor sink) -> caf::result<atom::ok> {
+      auto& st = self->state;
+      auto id = st.next_id++;
+      if (auto err = st.matcher.add(id, expr))
+        return err;
+      VAST_VERBOSE("{} adds standing query {}: {}", self, id, to_string(expr));
+      self->monitor(sink);
+      st.subscriptions.emplace(id, matcher_state::subscription{
+                                     std::move(sink), st.processed});
+      return atom::ok_v;
+    },
+    [self](accountant_actor accountant) {
+      self->state.accountant = std::move(accountant);
+      self->send(self->state.accountant, atom::announce_v, self->name());
+    },
+    [self](
+      caf::stream<table_slice> in) -> caf::inbound_stream_slot<table_slice> {
+      VAST_DEBUG("{} attaches to a stream of table slices", self);
+      auto result = caf::attach_stream_sink(
+        self, in,
+        [](caf::unit_t&) {
+          // nop
+        },
+        [=](caf::unit_t&, table_slice slice) { handle_slice(self, slice); });
+      return result.inbound_slot();
+    },
+    // -- status_client_actor --------------------------------------------------
+    [self](atom::status, status_verbosity v) {
+      auto result = caf::settings{};
+      auto& matcher_status = put_dictionary(result, "matcher");
+      put(matcher_status, "queries", self->state.subscriptions.size());
+      if (v >= status_verbosity::detailed) {
+        put(matcher_status, "processed", self->state.processed);
+        put(matcher_status, "matched", self->state.matched);
+        put(matcher_status, "programs", self->state.matcher.status());
+      }
+      if (v >= status_verbosity::debug)
+        detail::fill_status_map(matcher_status, self);
+      return result;
+    },
+  };
+}
+
+} // namespace vast::system
@@ -24,41 +24,89 @@
 
 #include <caf/binary_deserializer.hpp>
 #include <caf/binary_serializer.hpp>
+#include <caf/scheduler/abstract_coordinator.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string_view>
 #include <type_traits>
 
 namespace vast::system {
 
-size_t meta_index_state::memusage() const {
+size_t meta_index_snapshot::memusage() const {
   size_t result = 0;
   for (const auto& [id, partition_synopsis] : synopses)
-    result += partition_synopsis.memusage();
+    result += partition_synopsis->memusage();
+  return result;
+}
+
+size_t meta_index_state::memusage() const {
+  return snapshot->memusage();
+}
+
+meta_index_snapshot& meta_index_state::mutable_snapshot() {
+  // Readers release their reference after a lookup completes. If we hold the
+  // only reference, we can modify the snapshot in place; the fence orders the
+  // reads of the last reader before our writes.
+  if (snapshot.use_count() == 1)
+    std::atomic_thread_fence(std::memory_order_acquire);
+  else
+    snapshot = std::make_shared<meta_index_snapshot>(*snapshot);
+  return *snapshot;
+}
+
+meta_index_reader_actor meta_index_state::next_reader() {
+  VAST_ASSERT(!readers.empty());
+  auto& result = readers[next_reader_position];
+  next_reader_position = (next_reader_position + 1) % readers.size();
   return result;
 }
 
 void meta_index_state::erase(const uuid& partition) {
-  synopses.erase(partition);
+  if (snapshot->synopses.find(partition) == snapshot->synopses.end())
+    return;
+  mutable_snapshot().synopses.erase(partition);
 }
 
 void meta_index_state::merge(const uuid& partition, partition_synopsis&& ps) {
-  synopses.emplace(partition, std::move(ps));
+  mutable_snapshot().synopses.emplace(
+    partition, std::make_shared<const partition_synopsis>(std::move(ps)));
+}
+
+void meta_index_state::replace(const std::vector<uuid>& partitions,
+                               const uuid& partition,
+                               partition_synopsis&& ps) {
+  auto& result = mutable_snapshot();
+  for (const auto& x : partitions)
+    result.synopses.erase(x);
+  result.synopses.emplace(
+    partition, std::make_shared<const partition_synopsis>(std::move(ps)));
 }
 
 void meta_index_state::create_from(std::map<uuid, partition_synopsis>&& ps) {
-  std::vector<std::pair<uuid, partition_synopsis>> flat_data;
+  using value_type = std::pair<uuid, std::shared_ptr<const partition_synopsis>>;
+  std::vector<value_type> flat_data;
+  flat_data.reserve(ps.size());
   for (auto&& [uuid, synopsis] : std::move(ps)) {
-    flat_data.emplace_back(uuid, std::move(synopsis));
+    flat_data.emplace_back(
+      uuid, std::make_shared<const partition_synopsis>(std::move(synopsis)));
   }
   std::sort(flat_data.begin(), flat_data.end(),
-            [](const std::pair<uuid, partition_synopsis>& lhs,
-               const std::pair<uuid, partition_synopsis>& rhs) {
+            [](const value_type& lhs, const value_type& rhs) {
               return lhs.first < rhs.first;
             });
-  synopses = decltype(synopses)::make_unsafe(std::move(flat_data));
+  // Publish the bulk import as a new snapshot rather than modifying the
+  // current one in place.
+  auto result = std::make_shared<meta_index_snapshot>();
+  result->synopses
+    = decltype(result->synopses)::make_unsafe(std::move(flat_data));
+  snapshot = std::move(result);
 }
 
-partition_synopsis& meta_index_state::at(const uuid& partition) {
-  return synopses.at(partition);
+const partition_synopsis& meta_index_state::at(const uuid& partition) const {
+  return *snapshot->synopses.at(partition);
 }
 
 // A custom expression visitor that optimizes a given expression specifically
@@ -116,7 +164,7 @@ expression prune_all(expression e) {
   return result;
 }
 
-std::vector<uuid> meta_index_state::lookup(const expression& expr) const {
+std::vector<uuid> meta_index_snapshot::lookup(const expression& expr) const {
   auto start = system::stopwatch::now();
   auto pruned = prune_all(expr);
   auto result = lookup_impl(pruned);
@@ -128,7 +176,8 @@ std::vector<uuid> meta_index_state::lookup(const expression& expr) const {
   return result;
 }
 
-std::vector<uuid> meta_index_state::lookup_impl(const expression& expr) const {
+std::vector<uuid>
+meta_index_snapshot::lookup_impl(const expression& expr) const {
   VAST_ASSERT(!caf::holds_alternative<caf::none_t>(expr));
   // The partition UUIDs must be sorted, otherwise the invariants of the
   // inplace union and intersection algorithms are violated, leading to
@@ -199,9 +248,8 @@ std::vector<uuid> meta_index_state::lookup_impl(const expression& expr) const {
         const auto& rhs = caf::get<data>(x.rhs);
         result_type result;
         for (const auto& [part_id, part_syn] : synopses) {
-          for (const auto& [field, syn] : part_syn.field_synopses_) {
+          for (const auto& [field, syn] : part_syn->field_synopses_) {
             if (match(field)) {
-              auto cleaned_type = vast::type{field.type}.attributes({});
               // We rely on having a field -> nullptr mapping here for the
               // fields that don't have their own synopsis.
               if (syn) {
@@ -214,8 +262,9 @@ std::vector<uuid> meta_index_state::lookup_impl(const expression& expr) const {
                 }
                 // The field has no dedicated synopsis. Check if there is one
                 // for the type in general.
-              } else if (auto it = part_syn.type_synopses_.find(cleaned_type);
-                         it != part_syn.type_synopses_.end() && it->second) {
+              } else if (auto it = part_syn->type_synopses_.find(
+                           vast::type{field.type}.attributes({}));
+                         it != part_syn->type_synopses_.end() && it->second) {
                 auto opt = it->second->lookup(x.op, make_view(rhs));
                 if (!opt || *opt) {
                   VAST_TRACE("{} selects {} at predicate {}",
@@ -246,7 +295,7 @@ std::vector<uuid> meta_index_state::lookup_impl(const expression& expr) const {
             // at the layout names.
             result_type result;
             for (const auto& [part_id, part_syn] : synopses) {
-              for (const auto& pair : part_syn.field_synopses_) {
+              for (const auto& pair : part_syn->field_synopses_) {
                 // TODO: provide an overload for view of evaluate() so that
                 // we can use string_view here. Fortunately type names are
                 // short, so we're probably not hitting the allocator due to
@@ -273,7 +322,7 @@ std::vector<uuid> meta_index_state::lookup_impl(const expression& expr) const {
                 // Compare the desired field name with each field in the
                 // partition.
                 auto matching = [&] {
-                  for (const auto& pair : synopsis.second.field_synopses_) {
+                  for (const auto& pair : synopsis.second->field_synopses_) {
                     auto fqn = pair.first.fqn();
                     if (detail::ends_with(fqn, *s))
                       return true;
@@ -349,9 +398,101 @@ std::vector<uuid> meta_index_state::lookup_impl(const expression& expr) const {
   return caf::visit(f, expr);
 }
 
+std::optional<std::pair<time, time>>
+meta_index_snapshot::time_range(const uuid& partition) const {
+  auto it = synopses.find(partition);
+  if (it == synopses.end())
+    return std::nullopt;
+  return it->second->time_range();
+}
+
+namespace {
+
+// Checks whether a type extractor for `:timestamp` resolves to a field type.
+bool is_timestamp(const type& t) {
+  if (has_attribute(t, "timestamp"))
+    return true;
+  const auto* p = &t;
+  while (const auto* a = caf::get_if<alias_type>(p)) {
+    if (a->name() == "timestamp")
+      return true;
+    p = &a->value_type;
+  }
+  return p->name() == "timestamp";
+}
+
+} // namespace
+
+std::vector<uuid> meta_index_snapshot::older_than(time cutoff) const {
+  std::vector<uuid> result;
+  for (const auto& [partition, synopsis] : synopses) {
+    // The partition synopsis has an entry for every field of every layout in
+    // the partition, even if the field has no synopsis. A layout expires only
+    // if `:timestamp < cutoff` selects all of its events, i.e., if it has a
+    // timestamp column whose newest value precedes the cutoff.
+    auto expired = std::map<std::string_view, bool>{};
+    for (const auto& [field, field_synopsis] : synopsis->field_synopses_) {
+      auto& layout_expired = expired[field.layout_name];
+      if (layout_expired || !is_timestamp(field.type))
+        continue;
+      const auto* ts = dynamic_cast<const time_synopsis*>(field_synopsis.get());
+      // Synopses that never saw any data have an inverted range.
+      if (ts != nullptr && ts->min() <= ts->max() && ts->max() < cutoff)
+        layout_expired = true;
+    }
+    auto all_expired = [](const auto& x) { return x.second; };
+    if (!expired.empty()
+        && std::all_of(expired.begin(), expired.end(), all_expired))
+      result.push_back(partition);
+  }
+  return result;
+}
+
+void meta_index_snapshot::sort_by_time(std::vector<uuid>& candidates,
+                                       enum query::order order) const {
+  if (order == query::unordered)
+    return;
+  using range = std::optional<std::pair<time, time>>;
+  std::vector<std::pair<uuid, range>> xs;
+  xs.reserve(candidates.size());
+  for (const auto& candidate : candidates)
+    xs.emplace_back(candidate, time_range(candidate));
+  auto cmp = [&](const auto& lhs, const auto& rhs) {
+    if (!lhs.second || !rhs.second)
+      return lhs.second.has_value() && !rhs.second.has_value();
+    if (order == query::newest_first)
+      return lhs.second->second > rhs.second->second;
+    return lhs.second->first < rhs.second->first;
+  };
+  std::stable_sort(xs.begin(), xs.end(), cmp);
+  for (size_t i = 0; i < xs.size(); ++i)
+    candidates[i] = xs[i].first;
+}
+
+meta_index_reader_actor::behavior_type
+meta_index_reader(meta_index_reader_actor::pointer) {
+  return {
+    [](const std::shared_ptr<const meta_index_snapshot>& snapshot,
+       const expression& expr) -> std::vector<uuid> {
+      return snapshot->lookup(expr);
+    },
+    [](const std::shared_ptr<const meta_index_snapshot>& snapshot,
+       const vast::query& query) -> std::vector<uuid> {
+      auto result = snapshot->lookup(query.expr);
+      snapshot->sort_by_time(result, query.order);
+      return result;
+    },
+  };
+}
+
 meta_index_actor::behavior_type
 meta_index(meta_index_actor::stateful_pointer<meta_index_state> self) {
   self->state.self = self;
+  // Use one META INDEX READER per scheduler thread.
+  auto num_readers
+    = std::max(size_t{1}, self->system().scheduler().num_workers());
+  for (size_t i = 0; i < num_readers; ++i)
+    self->state.readers.push_back(self->spawn<caf::linked>(meta_index_reader));
   return {
     [=](atom::merge,
         std::shared_ptr<std::map<uuid, partition_synopsis>>& ps) -> atom::ok {
@@ -369,9 +510,29 @@ meta_index(meta_index_actor::stateful_pointer<meta_index_state> self) {
       self->state.erase(partition);
       return atom::ok_v;
     },
-    [=](const expression& expr) -> std::vector<uuid> {
+    [=](atom::replace, const std::vector<uuid>& partitions, uuid partition,
+        std::shared_ptr<partition_synopsis>& synopsis) -> atom::ok {
+      VAST_TRACE_SCOPE("{} {} {}", self, VAST_ARG(partitions),
+                       VAST_ARG(partition));
+      self->state.replace(partitions, partition, std::move(*synopsis));
+      return atom::ok_v;
+    },
+    [=](atom::get, atom::timestamp, time cutoff) -> std::vector<uuid> {
+      return self->state.snapshot->older_than(cutoff);
+    },
+    [=](const expression& expr) -> caf::result<std::vector<uuid>> {
       VAST_TRACE_SCOPE("{} {}", self, VAST_ARG(expr));
-      return self->state.lookup(expr);
+      auto snapshot
+        = std::shared_ptr<const meta_index_snapshot>{self->state.snapshot};
+      return self->delegate(self->state.next_reader(), std::move(snapshot),
+                            expr);
+    },
+    [=](const vast::query& query) -> caf::result<std::vector<uuid>> {
+      VAST_TRACE_SCOPE("{} {}", self, VAST_ARG(query));
+      auto snapshot
+        = std::shared_ptr<const meta_index_snapshot>{self->state.snapshot};
+      return self->delegate(self->state.next_reader(), std::move(snapshot),
+                            query);
     },
   };
 }
@@ -0,0 +1,123 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/metrics.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace vast::system {
+
+uint64_t metric_counter::collect() noexcept {
+  auto result = uint64_t{0};
+  for (auto& shard : shards_)
+    result += shard.value.exchange(0, std::memory_order_relaxed);
+  return result;
+}
+
+uint64_t histogram_snapshot::quantile(double q) const noexcept {
+  if (count == 0)
+    return 0;
+  auto rank = static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)));
+  rank = std::clamp(rank, uint64_t{1}, count);
+  auto seen = uint64_t{0};
+  for (size_t i = 0; i < buckets.size(); ++i) {
+    seen += buckets[i];
+    if (seen >= rank)
+      return std::min(metric_histogram::upper_bound(i), max);
+  }
+  return max;
+}
+
+metric_histogram::metric_histogram(metric_unit unit) noexcept
+  : unit_{unit}, shards_{std::make_unique<std::array<shard, metric_shards>>()} {
+  // nop
+}
+
+histogram_snapshot metric_histogram::collect() noexcept {
+  auto result = histogram_snapshot{};
+  result.buckets.resize(num_buckets);
+  // A value recorded concurrently may show up partially in this snapshot and
+  // partially in the next one, which is fine for monitoring purposes.
+  for (auto& shard : *shards_) {
+    for (size_t i = 0; i < num_buckets; ++i) {
+      auto n = shard.buckets[i].exchange(0, std::memory_order_relaxed);
+      result.buckets[i] += n;
+      result.count += n;
+    }
+    result.sum += shard.sum.exchange(0, std::memory_order_relaxed);
+    result.max = std::max(result.max,
+                          shard.max.exchange(0, std::memory_order_relaxed));
+  }
+  return result;
+}
+
+metric_unit metric_histogram::unit() const noexcept {
+  return unit_;
+}
+
+uint64_t metric_histogram::upper_bound(size_t bucket) noexcept {
+  constexpr auto sub_buckets = uint64_t{1} << sub_bucket_bits;
+  if (bucket < sub_buckets)
+    return bucket;
+  auto shift = (bucket >> sub_bucket_bits) - 1;
+  auto sub_bucket = bucket & (sub_buckets - 1);
+  return ((sub_buckets + sub_bucket) << shift) + ((uint64_t{1} << shift) - 1);
+}
+
+metrics_registry& metrics_registry::instance() {
+  static auto result = metrics_registry{};
+  return result;
+}
+
+metric_counter& metrics_registry::counter(std::string_view name) {
+  auto lock = std::lock_guard{mutex_};
+  auto it = counters_.find(name);
+  if (it == counters_.end())
+    it = counters_
+           .emplace(std::string{name}, std::make_unique<metric_counter>())
+           .first;
+  return *it->second;
+}
+
+metric_histogram&
+metrics_registry::histogram(std::string_view name, metric_unit unit) {
+  auto lock = std::lock_guard{mutex_};
+  auto it = histograms_.find(name);
+  if (it == histograms_.end())
+    it = histograms_
+           .emplace(std::string{name}, std::make_unique<metric_histogram>(unit))
+           .first;
+  return *it->second;
+}
+
+report metrics_registry::collect() {
+  auto result = report{};
+  auto lock = std::lock_guard{mutex_};
+  for (auto& [name, counter] : counters_)
+    if (auto n = counter->collect(); n > 0)
+      result.push_back({name, n});
+  for (auto& [name, histogram] : histograms_) {
+    auto snapshot = histogram->collect();
+    if (snapshot.count == 0)
+      continue;
+    auto value = [&](uint64_t x) -> decltype(data_point::value) {
+      if (histogram->unit() == metric_unit::nanoseconds)
+        return duration{std::chrono::nanoseconds{x}};
+      return x;
+    };
+    result.push_back({name + ".count", snapshot.count});
+    result.push_back({name + ".p50", value(snapshot.quantile(0.5))});
+    result.push_back({name + ".p90", value(snapshot.quantile(0.9))});
+    result.push_back({name + ".p99", value(snapshot.quantile(0.99))});
+    result.push_back({name + ".max", value(snapshot.max)});
+  }
+  return result;
+}
+
+} // namespace vast::system
@@ -33,6 +33,7 @@
 #include "vast/format/test.hpp"
 #include "vast/format/zeek.hpp"
 #include "vast/logger.hpp"
+#include "vast/memory_pool.hpp"
 #include "vast/plugin.hpp"
 #include "vast/system/accountant.hpp"
 #include "vast/system/node.hpp"
@@ -40,6 +41,7 @@
 #include "vast/system/shutdown.hpp"
 #include "vast/system/spawn_archive.hpp"
 #include "vast/system/spawn_arguments.hpp"
+#include "vast/system/spawn_compactor.hpp"
 #include "vast/system/spawn_counter.hpp"
 #include "vast/system/spawn_disk_monitor.hpp"
 #include "vast/system/spawn_eraser.hpp"
@@ -47,6 +49,7 @@
 #include "vast/system/spawn_exporter.hpp"
 #include "vast/system/spawn_importer.hpp"
 #include "vast/system/spawn_index.hpp"
+#include "vast/system/spawn_matcher.hpp"
 #include "vast/system/spawn_node.hpp"
 #include "vast/system/spawn_or_connect_to_node.hpp"
 #include "vast/system/spawn_pivoter.hpp"
@@ -105,8 +108,9 @@ bool is_singleton(std::string_view type) {
   // refactoring will be much easier once the NODE itself is a typed actor, so
   // let's hold off until then.
   const char* singletons[]
-    = {"accountant", "archive",  "disk-monitor", "eraser",
-       "filesystem", "importer", "index",        "type-registry"};
+    = {"accountant", "archive", "compactor", "disk-monitor",
+       "eraser",     "filesystem", "importer", "index",
+       "matcher",    "type-registry"};
   auto pred = [&](const char* x) { return x == type; };
   return std::any_of(std::begin(singletons), std::end(singletons), pred);
 }
@@ -164,6 +168,7 @@ void collect_component_status(node_actor::stateful_pointer<node_state> self,
     put(system, "in-memory-table-slices", table_slice::instances());
     put(system, "database-path", self->state.dir.string());
     detail::merge_settings(detail::get_status(), system);
+    put(system, "memory-pool", memory_pool::global_status());
   }
   if (v >= status_verbosity::debug) {
     put(system, "running-actors", sys.registry().running());
@@ -399,6 +404,7 @@ auto make_component_factory() {
   auto result = node_state::named_component_factory{
     {"spawn accountant", lift_component_factory<spawn_accountant>()},
     {"spawn archive", lift_component_factory<spawn_archive>()},
+    {"spawn compactor", lift_component_factory<spawn_compactor>()},
     {"spawn counter", lift_component_factory<spawn_counter>()},
     {"spawn disk-monitor", lift_component_factory<spawn_disk_monitor>()},
     {"spawn eraser", lift_component_factory<spawn_eraser>()},
@@ -407,6 +413,7 @@ auto make_component_factory() {
     {"spawn importer", lift_component_factory<spawn_importer>()},
     {"spawn type-registry", lift_component_factory<spawn_type_registry>()},
     {"spawn index", lift_component_factory<spawn_index>()},
+    {"spawn matcher", lift_component_factory<spawn_matcher>()},
     {"spawn pivoter", lift_component_factory<spawn_pivoter>()},
     {"spawn source", lift_component_factory<spawn_source>()},
     {"spawn source csv", lift_component_factory<spawn_source>()},
@@ -445,6 +452,7 @@ auto make_command_factory() {
     {"send", send_command},
     {"spawn accountant", node_state::spawn_command},
     {"spawn archive", node_state::spawn_command},
+    {"spawn compactor", node_state::spawn_command},
     {"spawn counter", node_state::spawn_command},
     {"spawn disk-monitor", node_state::spawn_command},
     {"spawn eraser", node_state::spawn_command},
@@ -453,6 +461,7 @@ auto make_command_factory() {
     {"spawn importer", node_state::spawn_command},
     {"spawn type-registry", node_state::spawn_command},
     {"spawn index", node_state::spawn_command},
+    {"spawn matcher", node_state::spawn_command},
     {"spawn pivoter", node_state::spawn_command},
     {"spawn sink ascii", node_state::spawn_command},
     {"spawn sink csv", node_state::spawn_command},
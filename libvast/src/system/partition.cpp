@@ -13,13 +13,16 @@
 #include "vast/address_synopsis.hpp"
 #include "vast/aliases.hpp"
 #include "vast/chunk.hpp"
+#include "vast/concept/parseable/numeric/integral.hpp"
 #include "vast/concept/hashable/xxhash.hpp"
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/expression.hpp"
 #include "vast/concept/printable/vast/table_slice.hpp"
 #include "vast/concept/printable/vast/uuid.hpp"
+#include "vast/defaults.hpp"
 #include "vast/detail/assert.hpp"
 #include "vast/detail/notifying_stream_manager.hpp"
+#include "vast/detail/overload.hpp"
 #include "vast/detail/settings.hpp"
 #include "vast/expression_visitors.hpp"
 #include "vast/fbs/partition.hpp"
@@ -27,9 +30,13 @@
 #include "vast/fbs/uuid.hpp"
 #include "vast/ids.hpp"
 #include "vast/logger.hpp"
+#include "vast/memory_pool.hpp"
 #include "vast/qualified_record_field.hpp"
 #include "vast/synopsis.hpp"
 #include "vast/system/indexer.hpp"
+#include "vast/system/local_segment_store.hpp"
+#include "vast/system/query_cache.hpp"
+#include "vast/system/query_profile.hpp"
 #include "vast/system/shutdown.hpp"
 #include "vast/system/status_verbosity.hpp"
 #include "vast/system/terminate.hpp"
@@ -38,6 +45,7 @@
 #include "vast/time.hpp"
 #include "vast/type.hpp"
 #include "vast/value_index.hpp"
+#include "vast/view.hpp"
 
 #include <caf/attach_continuous_stream_stage.hpp>
 #include <caf/broadcast_downstream_manager.hpp>
@@ -47,8 +55,11 @@
 #include <flatbuffers/base.h> // FLATBUFFERS_MAX_BUFFER_SIZE
 #include <flatbuffers/flatbuffers.h>
 
+#include <algorithm>
 #include <filesystem>
 #include <memory>
+#include <numeric>
+#include <optional>
 
 namespace vast::system {
 
@@ -72,6 +83,42 @@ void active_partition_state::notify_flush_listeners() {
   flush_listeners.clear();
 }
 
+void sorted_time_column::add(const table_slice& slice, size_t column) {
+  if (!sorted)
+    return;
+  for (size_t row = 0; row < slice.rows(); ++row) {
+    auto x = slice.at(row, column);
+    auto ts = caf::get_if<view<time>>(&x);
+    auto value = ts ? ts->time_since_epoch().count() : time::rep{};
+    if (!ts || (!values.empty() && value < values.back())) {
+      sorted = false;
+      values = {};
+      return;
+    }
+    values.push_back(value);
+  }
+}
+
+namespace {
+
+/// Deserializes the value index at a certain position of a passive partition.
+value_index_ptr
+deserialize_value_index(const passive_partition_state& state, size_t position) {
+  auto qualified_index = state.flatbuffer->indexes()->Get(position);
+  auto index = qualified_index->index();
+  auto data = index->data();
+  value_index_ptr result;
+  if (auto error = fbs::deserialize_bytes(data, result)) {
+    VAST_ERROR("{} failed to deserialize indexer at {} with error: "
+               "{}",
+               state.self, position, render(error));
+    return nullptr;
+  }
+  return result;
+}
+
+} // namespace
+
 /// Gets the INDEXER at a certain position.
 indexer_actor passive_partition_state::indexer_at(size_t position) const {
   VAST_ASSERT(position < indexers.size());
@@ -79,60 +126,135 @@ indexer_actor passive_partition_state::indexer_at(size_t position) const {
   // Deserialize the value index and spawn a passive_indexer lazily when it is
   // requested for the first time.
   if (!indexer) {
-    auto qualified_index = flatbuffer->indexes()->Get(position);
-    auto index = qualified_index->index();
-    auto data = index->data();
-    value_index_ptr state_ptr;
-    if (auto error = fbs::deserialize_bytes(data, state_ptr)) {
-      VAST_ERROR("{} failed to deserialize indexer at {} with error: "
-                 "{}",
-                 self, position, render(error));
+    auto state_ptr = deserialize_value_index(*this, position);
+    if (!state_ptr)
       return {};
-    }
-    indexer = self->spawn(passive_indexer, id, std::move(state_ptr));
+    indexer
+      = self->spawn(passive_indexer, id, std::move(state_ptr), position, cache);
   }
   return indexer;
 }
 
+/// Gets the value index at a certain position.
+const value_index*
+passive_partition_state::value_index_at(size_t position) const {
+  VAST_ASSERT(position < value_indexes.size());
+  auto& index = value_indexes[position];
+  if (!index)
+    index = deserialize_value_index(*this, position);
+  return index.get();
+}
+
 namespace {
 
-// The functions in this namespace take PartitionState as template argument
-// because the impelementation is the same for passive and active partitions.
+/// Answers a predicate on a time column whose values are sorted within a
+/// passive partition by binary search, without consulting its value index.
+/// @param position The position of the column in the combined layout.
+/// @param op The operator.
+/// @param x The literal side of the predicate.
+/// @returns The matching IDs, or `std::nullopt` if the column is not sorted or
+///          the predicate is not a comparison with a point in time.
+/// @relates passive_partition_state
+std::optional<ids>
+lookup_sorted_time(const passive_partition_state& state, size_t position,
+                   relational_operator op, const data& x) {
+  auto column = state.sorted_time_columns.find(position);
+  if (column == state.sorted_time_columns.end())
+    return std::nullopt;
+  auto ts = caf::get_if<time>(&x);
+  if (!ts)
+    return std::nullopt;
+  const auto& values = *column->second->values();
+  const auto& layout_ids
+    = state.type_ids.at(column->second->layout_name()->str());
+  auto value = ts->time_since_epoch().count();
+  auto lower = static_cast<size_t>(
+    std::lower_bound(values.begin(), values.end(), value) - values.begin());
+  auto upper = static_cast<size_t>(
+    std::upper_bound(values.begin(), values.end(), value) - values.begin());
+  // Maps the rows [first, last) of the layout to their ids.
+  auto rows = [&](size_t first, size_t last) {
+    ids result;
+    if (first >= last)
+      return result;
+    auto begin = select(layout_ids, first + 1);
+    auto end = select(layout_ids, last) + 1;
+    result.append_bits(false, begin);
+    result.append_bits(true, end - begin);
+    return result & layout_ids;
+  };
+  switch (op) {
+    default:
+      return std::nullopt;
+    case relational_operator::equal:
+      return rows(lower, upper);
+    case relational_operator::not_equal:
+      return rows(0, lower) | rows(upper, values.size());
+    case relational_operator::less:
+      return rows(0, lower);
+    case relational_operator::less_equal:
+      return rows(0, upper);
+    case relational_operator::greater:
+      return rows(upper, values.size());
+    case relational_operator::greater_equal:
+      return rows(lower, values.size());
+  }
+}
 
-/// Gets the INDEXER at position in the layout.
+/// Answers a predicate from a sorted time column or the cache, without
+/// loading the value index. Passive partitions are immutable, so both stay
+/// valid for the lifetime of the partition.
+/// @param position The position of the column in the combined layout.
+/// @param op The operator.
+/// @param x The literal side of the predicate.
+/// @returns The matching IDs, or `std::nullopt` if only the value index can
+///          answer the predicate.
+/// @relates passive_partition_state
+std::optional<ids>
+lookup_known(const passive_partition_state& state, size_t position,
+             relational_operator op, const data& x) {
+  if (auto hits = lookup_sorted_time(state, position, op, x))
+    return hits;
+  if (state.cache)
+    return state.cache->lookup({state.id, position, {op, x}});
+  return std::nullopt;
+}
+
+// The functions below take PartitionState as template argument because the
+// impelementation is the same for passive and active partitions.
+
+/// Gets the position of a data extractor in the combined layout.
 /// @relates active_partition_state
 /// @relates passive_partition_state
 template <typename PartitionState>
-indexer_actor
-fetch_indexer(const PartitionState& state, const data_extractor& dx,
-              relational_operator op, const data& x) {
-  VAST_TRACE_SCOPE("{} {} {}", VAST_ARG(dx), VAST_ARG(op), VAST_ARG(x));
+std::optional<size_t>
+position_of(const PartitionState& state, const data_extractor& dx) {
   // Sanity check.
   if (dx.offset.empty())
-    return {};
-  if (auto index = state.combined_layout.flat_index_at(dx.offset))
-    return state.indexer_at(*index);
+    return std::nullopt;
+  if (auto position = state.combined_layout.flat_index_at(dx.offset))
+    return position;
   VAST_WARN("{} got invalid offset for the combined layout {}", state.self,
             state.combined_layout);
-  return {};
+  return std::nullopt;
 }
 
-/// Retrieves an INDEXER for a predicate with a data extractor.
-/// @param dx The extractor.
-/// @param op The operator (only used to precompute ids for type queries.
+/// Computes the IDs for a predicate with a meta extractor, which the partition
+/// answers from its own state without consulting a value index.
+/// @param ex The extractor.
+/// @param op The operator.
 /// @param x The literal side of the predicate.
+/// @returns The matching IDs, or `std::nullopt` if the predicate is not
+///          supported.
 /// @relates active_partition_state
 /// @relates passive_partition_state
 template <typename PartitionState>
-indexer_actor
-fetch_indexer(const PartitionState& state, const meta_extractor& ex,
-              relational_operator op, const data& x) {
-  VAST_TRACE_SCOPE("{} {} {}", VAST_ARG(ex), VAST_ARG(op), VAST_ARG(x));
+std::optional<ids>
+lookup_meta(const PartitionState& state, const meta_extractor& ex,
+            relational_operator op, const data& x) {
   ids row_ids;
   if (ex.kind == meta_extractor::type) {
     // We know the answer immediately: all IDs that are part of the table.
-    // However, we still have to "lift" this result into an actor for the
-    // EVALUATOR.
     for (auto& [name, ids] : state.type_ids)
       if (evaluate(name, op, x))
         row_ids |= ids;
@@ -142,7 +264,7 @@ fetch_indexer(const PartitionState& state, const meta_extractor& ex,
       VAST_WARN("{} #field meta queries only support string "
                 "comparisons",
                 state.self);
-      return {};
+      return std::nullopt;
     }
     auto neg = is_negated(op);
     for (const auto& field : record_type::each{state.combined_layout}) {
@@ -166,57 +288,314 @@ fetch_indexer(const PartitionState& state, const meta_extractor& ex,
     }
   } else {
     VAST_WARN("{} got unsupported attribute: {}", state.self, ex.kind);
-    return {};
+    return std::nullopt;
   }
-  // TODO: Spawning a one-shot actor is quite expensive. Maybe the
-  //       partition could instead maintain this actor lazily.
-  return state.self->spawn([row_ids]() -> indexer_actor::behavior_type {
-    return {
-      [=](const curried_predicate&) { return row_ids; },
-      [](atom::shutdown) {
-        VAST_DEBUG("one-shot indexer received shutdown request");
-      },
-    };
-  });
+  return row_ids;
 }
 
 /// Returns all INDEXERs that are involved in evaluating the expression.
+/// Predicates that the partition answers from its own state, like meta
+/// predicates or cached lookups, need no INDEXER; their hits go into *hits*.
+/// @param hits The hits of predicates that need no INDEXER.
 /// @relates active_partition_state
 /// @relates passive_partition_state
 template <typename PartitionState>
 std::vector<evaluation_triple>
-evaluate(const PartitionState& state, const expression& expr) {
+evaluate(const PartitionState& state, const expression& expr,
+         evaluator_state::predicate_hits_map& hits) {
   std::vector<evaluation_triple> result;
   // Pretend the partition is a table, and return fitted predicates for the
   // partitions layout.
   auto resolved = resolve(expr, state.combined_layout);
   for (auto& kvp : resolved) {
-    // For each fitted predicate, look up the corresponding INDEXER
-    // according to the specified type of extractor.
     auto& pred = kvp.second;
-    auto get_indexer_handle = [&](const auto& ext, const data& x) {
-      return fetch_indexer(state, ext, pred.op, x);
-    };
     auto v = detail::overload{
       [&](const meta_extractor& ex, const data& x) {
-        return get_indexer_handle(ex, x);
+        if (auto row_ids = lookup_meta(state, ex, pred.op, x))
+          hits[kvp.first].second |= *row_ids;
       },
       [&](const data_extractor& dx, const data& x) {
-        return get_indexer_handle(dx, x);
+        auto position = position_of(state, dx);
+        if (!position)
+          return;
+        if constexpr (std::is_same_v<PartitionState, passive_partition_state>)
+          if (auto row_ids = lookup_known(state, *position, pred.op, x)) {
+            hits[kvp.first].second |= *row_ids;
+            return;
+          }
+        // Package the predicate, its position in the query and the required
+        // INDEXER as a "job description".
+        if (auto hdl = state.indexer_at(*position))
+          result.emplace_back(kvp.first, curried(pred), std::move(hdl));
       },
       [](const auto&, const auto&) {
-        return indexer_actor{}; // clang-format fix
+        // nop
       },
     };
-    // Package the predicate, its position in the query and the required
-    // INDEXER as a "job description".
-    if (auto hdl = caf::visit(v, pred.lhs, pred.rhs))
-      result.emplace_back(kvp.first, curried(pred), std::move(hdl));
+    caf::visit(v, pred.lhs, pred.rhs);
   }
   // Return the list of jobs, to be used by the EVALUATOR.
   return result;
 }
 
+/// Looks up a predicate with a data extractor in the value index of a passive
+/// partition.
+/// @param dx The extractor.
+/// @param op The operator.
+/// @param x The literal side of the predicate.
+/// @returns The matching IDs, or `std::nullopt` if the partition has no value
+///          index for the extractor.
+/// @relates passive_partition_state
+std::optional<ids>
+lookup_data(const passive_partition_state& state, const data_extractor& dx,
+            relational_operator op, const data& x) {
+  VAST_TRACE_SCOPE("{} {} {}", VAST_ARG(dx), VAST_ARG(op), VAST_ARG(x));
+  auto position = position_of(state, dx);
+  if (!position)
+    return std::nullopt;
+  if (auto hits = lookup_known(state, *position, op, x))
+    return hits;
+  auto pred = curried_predicate{op, x};
+  const auto* index = state.value_index_at(*position);
+  if (!index)
+    return std::nullopt;
+  auto result = index->lookup(op, to_internal(index->type(), make_view(x)));
+  if (!result) {
+    // Same as in the EVALUATOR, a failed lookup contributes no hits.
+    VAST_WARN("{} failed to look up {} in field {}: {}", state.self, pred,
+              *position, render(result.error()));
+    return ids{};
+  }
+  if (state.cache)
+    state.cache->insert({state.id, *position, std::move(pred)}, *result);
+  return std::move(*result);
+}
+
+/// Evaluates an expression by looking up its predicates in the value indexes
+/// of a passive partition directly. Unlike `evaluate`, this neither spawns
+/// INDEXER actors nor requires an EVALUATOR, but runs to completion in the
+/// context of the partition actor.
+/// @returns The hits for the expression, or `std::nullopt` if the partition
+///          cannot answer any of its predicates.
+/// @relates passive_partition_state
+std::optional<ids>
+evaluate_directly(const passive_partition_state& state,
+                  const expression& expr) {
+  evaluator_state::predicate_hits_map hits;
+  auto resolved = resolve(expr, state.combined_layout);
+  for (auto& kvp : resolved) {
+    auto& pred = kvp.second;
+    auto v = detail::overload{
+      [&](const meta_extractor& ex, const data& x) {
+        return lookup_meta(state, ex, pred.op, x);
+      },
+      [&](const data_extractor& dx, const data& x) {
+        return lookup_data(state, dx, pred.op, x);
+      },
+      [](const auto&, const auto&) {
+        return std::optional<ids>{}; // clang-format fix
+      },
+    };
+    // A predicate may resolve to multiple fields, whose hits get combined
+    // just like the EVALUATOR does.
+    if (auto result = caf::visit(v, pred.lhs, pred.rhs))
+      hits[kvp.first].second |= *result;
+  }
+  if (hits.empty())
+    return std::nullopt;
+  return combine_hits(expr, hits);
+}
+
+/// Checks whether an expression contains a negation.
+bool has_negation(const expression& expr) {
+  auto f = detail::overload{
+    [](const conjunction& xs) {
+      return std::any_of(xs.begin(), xs.end(), has_negation);
+    },
+    [](const disjunction& xs) {
+      return std::any_of(xs.begin(), xs.end(), has_negation);
+    },
+    [](const negation&) { return true; },
+    [](const auto&) { return false; },
+  };
+  return caf::visit(f, expr);
+}
+
+/// Checks whether the value index of a field yields exactly the rows that
+/// satisfy a predicate, such that the result needs no candidate check.
+/// @param t The type of the field.
+/// @param op The operator of the predicate.
+/// @param x The literal side of the predicate.
+/// @param index_opts The options of the value index of the field.
+bool has_exact_index(const type& t, relational_operator op, const data& x,
+                     const caf::settings& index_opts) {
+  if (has_skip_attribute(t))
+    return false;
+  if (const auto* a = find_attribute(t, "index"); a && a->value) {
+    // A hash index compares digests, which may collide.
+    if (*a->value == "hash")
+      return false;
+    // A bit-sliced index with a precision bins values.
+    if (*a->value == "bitslice")
+      if (const auto* p = find_attribute(t, "precision"); p && p->value) {
+        uint64_t precision = 0;
+        if (!parsers::u64(*p->value, precision) || precision > 0)
+          return false;
+      }
+  }
+  auto is_equality
+    = op == relational_operator::equal || op == relational_operator::not_equal;
+  auto is_membership
+    = op == relational_operator::in || op == relational_operator::not_in;
+  auto is_ordering = op == relational_operator::less
+                     || op == relational_operator::less_equal
+                     || op == relational_operator::greater
+                     || op == relational_operator::greater_equal;
+  // The value index handles nil values itself.
+  if (caf::holds_alternative<caf::none_t>(x))
+    return is_equality;
+  // Membership tests look up every element of the list for equality.
+  if (is_membership)
+    if (const auto* xs = caf::get_if<list>(&x))
+      return std::all_of(xs->begin(), xs->end(), [&](const data& y) {
+        return has_exact_index(t, relational_operator::equal, y, index_opts);
+      });
+  auto f = detail::overload{
+    [&](const alias_type& a) {
+      return has_exact_index(a.value_type, op, x, index_opts);
+    },
+    [&](const bool_type&) {
+      return is_equality && caf::holds_alternative<bool>(x);
+    },
+    [&](const integer_type&) {
+      return (is_equality || is_ordering) && caf::holds_alternative<integer>(x);
+    },
+    [&](const count_type&) {
+      return (is_equality || is_ordering) && caf::holds_alternative<count>(x);
+    },
+    [&](const enumeration_type&) {
+      return is_equality && caf::holds_alternative<enumeration>(x);
+    },
+    [&](const address_type&) {
+      return (is_equality && caf::holds_alternative<address>(x))
+             || (is_membership && caf::holds_alternative<subnet>(x));
+    },
+    [&](const subnet_type&) {
+      return is_equality && caf::holds_alternative<subnet>(x);
+    },
+    [&](const string_type&) {
+      // The string index only considers a bounded prefix of every value.
+      const auto* str = caf::get_if<std::string>(&x);
+      auto max_size = caf::get_or(index_opts, "max-size",
+                                  defaults::index::max_string_size);
+      return is_equality && str != nullptr && str->size() < max_size;
+    },
+    // Time, duration, and real values are binned, and container indexes
+    // bound the number of elements they consider.
+    [](const auto&) { return false; },
+  };
+  return caf::visit(f, t);
+}
+
+/// Checks whether the hits of the EVALUATOR for an expression are exact, such
+/// that a count does not require a candidate check in the STORE.
+/// @relates active_partition_state
+/// @relates passive_partition_state
+template <typename PartitionState>
+bool is_exact(const PartitionState& state, const expression& expr) {
+  // The EVALUATOR flips negated results over the entire ID space rather than
+  // only the rows of the partition.
+  if (has_negation(expr))
+    return false;
+  auto resolved = resolve(expr, state.combined_layout);
+  return std::all_of(resolved.begin(), resolved.end(), [&](const auto& kvp) {
+    const auto& pred = kvp.second;
+    auto f = detail::overload{
+      [&](const meta_extractor& ex, const data& x) {
+        return ex.kind == meta_extractor::type
+               || caf::holds_alternative<std::string>(x);
+      },
+      [&](const data_extractor& dx, const data& x) {
+        if constexpr (std::is_same_v<PartitionState, passive_partition_state>) {
+          auto position = state.combined_layout.flat_index_at(dx.offset);
+          if (!position)
+            return false;
+          // Binary search in a sorted time column yields exact results.
+          if (state.sorted_time_columns.count(*position) > 0
+              && caf::holds_alternative<time>(x)
+              && pred.op != relational_operator::in
+              && pred.op != relational_operator::not_in)
+            return true;
+          // Only string indexes depend on their options, so we avoid loading
+          // the value index for other predicates.
+          if (!caf::holds_alternative<std::string>(x)
+              && !caf::holds_alternative<list>(x))
+            return has_exact_index(dx.type, pred.op, x, caf::settings{});
+          const auto* index = state.value_index_at(*position);
+          return index != nullptr
+                 && has_exact_index(dx.type, pred.op, x, index->options());
+        } else {
+          return has_exact_index(dx.type, pred.op, x, state.index_opts);
+        }
+      },
+      [](const auto&, const auto&) { return false; },
+    };
+    return caf::visit(f, pred.lhs, pred.rhs);
+  });
+}
+
+/// Responds to a query with the hits of the EVALUATOR. Counts that the index
+/// answers exactly skip the STORE; everything else gets delegated there.
+/// @relates active_partition_state
+/// @relates passive_partition_state
+template <class Self>
+void deliver_hits(Self* self, caf::typed_response_promise<atom::done>& rp,
+                  vast::query query, const ids& hits) {
+  if (auto* count = caf::get_if<query::count>(&query.cmd)) {
+    if (count->mode == query::count::estimate
+        || is_exact(self->state, query.expr)) {
+      self->send(count->sink, rank(hits));
+      rp.deliver(atom::done_v);
+      return;
+    }
+    VAST_DEBUG("{} requires a candidate check to count {}", self, query.expr);
+    self->send(count->sink, atom::candidate_v, self->state.id);
+  }
+  rp.delegate(self->state.store, std::move(query), hits);
+}
+
+/// Evaluates an expression with INDEXER and EVALUATOR actors, and responds to
+/// the query with the hits.
+/// @relates active_partition_state
+/// @relates passive_partition_state
+template <class Self>
+caf::result<atom::done> evaluate_with_actors(Self* self, vast::query query) {
+  auto start = std::chrono::system_clock::now();
+  auto known_hits = evaluator_state::predicate_hits_map{};
+  auto triples = evaluate(self->state, query.expr, known_hits);
+  record_span(self, query, query_stage::indexer_spawn, start);
+  if (triples.empty() && known_hits.empty())
+    return atom::done_v;
+  auto rp = self->make_response_promise<atom::done>();
+  // Without any INDEXER to wait for, we can skip the EVALUATOR.
+  if (triples.empty()) {
+    auto hits = combine_hits(query.expr, known_hits);
+    deliver_hits(self, rp, std::move(query), hits);
+    return rp;
+  }
+  auto eval
+    = self->spawn(evaluator, query.expr, triples, std::move(known_hits));
+  start = std::chrono::system_clock::now();
+  self->request(eval, caf::infinite, atom::run_v)
+    .then(
+      [self, rp, query = std::move(query), start](const ids& hits) mutable {
+        record_span(self, query, query_stage::evaluation, start);
+        deliver_hits(self, rp, std::move(query), hits);
+      },
+      [rp](caf::error& err) mutable { rp.deliver(std::move(err)); });
+  return rp;
+}
+
 } // namespace
 
 bool partition_selector::operator()(const qualified_record_field& filter,
@@ -268,6 +647,35 @@ pack(flatbuffers::FlatBufferBuilder& builder, const active_partition_state& x) {
     tids.push_back(tids_builder.Finish());
   }
   auto type_ids = builder.CreateVector(tids);
+  // Serialize sorted time columns.
+  std::vector<flatbuffers::Offset<fbs::sorted_time_column::v0>> stcs;
+  for (const auto& [qf, column] : x.sorted_time_columns) {
+    if (!column.sorted || column.values.empty())
+      continue;
+    auto field_name = builder.CreateString(qf.fqn());
+    auto layout_name = builder.CreateString(qf.layout_name);
+    auto values = builder.CreateVector(column.values);
+    fbs::sorted_time_column::v0Builder stc_builder(builder);
+    stc_builder.add_field_name(field_name);
+    stc_builder.add_layout_name(layout_name);
+    stc_builder.add_values(values);
+    stcs.push_back(stc_builder.Finish());
+  }
+  auto sorted_time_columns = builder.CreateVector(stcs);
+  // Serialize the store header. Partitions without one use the global archive.
+  auto store_header = flatbuffers::Offset<fbs::partition::store_header::v0>{};
+  if (x.store_builder && x.persist_path) {
+    auto store_id = builder.CreateString(std::string{local_segment_store_id});
+    auto store_filename
+      = local_segment_store_path(*x.persist_path).filename().string();
+    auto store_data = builder.CreateVector(
+      reinterpret_cast<const uint8_t*>(store_filename.data()),
+      store_filename.size());
+    fbs::partition::store_header::v0Builder store_header_builder(builder);
+    store_header_builder.add_id(store_id);
+    store_header_builder.add_data(store_data);
+    store_header = store_header_builder.Finish();
+  }
   // Serialize synopses.
   auto maybe_ps = pack(builder, *x.synopsis);
   if (!maybe_ps)
@@ -280,6 +688,9 @@ pack(flatbuffers::FlatBufferBuilder& builder, const active_partition_state& x) {
   v0_builder.add_partition_synopsis(*maybe_ps);
   v0_builder.add_combined_layout(*combined_layout);
   v0_builder.add_type_ids(type_ids);
+  v0_builder.add_sorted_time_columns(sorted_time_columns);
+  if (!store_header.IsNull())
+    v0_builder.add_store(store_header);
   auto partition_v0 = v0_builder.Finish();
   fbs::PartitionBuilder partition_builder(builder);
   partition_builder.add_partition_type(fbs::partition::Partition::v0);
@@ -340,6 +751,7 @@ unpack(const fbs::partition::v0& partition, passive_partition_state& state) {
   // vector must be the same as in `combined_layout`. The actual indexers are
   // deserialized and spawned lazily on demand.
   state.indexers.resize(indexes->size());
+  state.value_indexes.resize(indexes->size());
   VAST_DEBUG("{} found {} indexers for partition {}", state.name,
              indexes->size(), state.id);
   auto type_ids = partition.type_ids();
@@ -353,6 +765,29 @@ unpack(const fbs::partition::v0& partition, passive_partition_state& state) {
   }
   VAST_DEBUG("{} restored {} type-to-ids mapping for partition {}", state.name,
              state.type_ids.size(), state.id);
+  // Partitions written by older versions of VAST have no sorted columns.
+  if (auto columns = partition.sorted_time_columns()) {
+    for (auto column : *columns) {
+      if (!column->field_name() || !column->layout_name()
+          || !column->values())
+        return caf::make_error(ec::format_error, "missing field in sorted "
+                                                 "time column");
+      auto field_name = column->field_name()->str();
+      const auto& fields = state.combined_layout.fields;
+      auto field = std::find_if(fields.begin(), fields.end(), [&](auto& x) {
+        return x.name == field_name;
+      });
+      auto layout_ids = state.type_ids.find(column->layout_name()->str());
+      if (field == fields.end() || layout_ids == state.type_ids.end()
+          || rank(layout_ids->second) != column->values()->size()) {
+        VAST_WARN("{} ignores incoherent sorted time column {}", state.name,
+                  field_name);
+        continue;
+      }
+      auto position = static_cast<size_t>(field - fields.begin());
+      state.sorted_time_columns.emplace(position, column);
+    }
+  }
   return caf::none;
 }
 
@@ -367,7 +802,7 @@ caf::error unpack(const fbs::partition::v0& x, partition_synopsis& ps) {
 active_partition_actor::behavior_type active_partition(
   active_partition_actor::stateful_pointer<active_partition_state> self,
   uuid id, filesystem_actor filesystem, caf::settings index_opts,
-  caf::settings synopsis_opts, store_actor store) {
+  caf::settings synopsis_opts, store_actor store, bool local_store) {
   self->state.self = self;
   self->state.name = "partition-" + to_string(id);
   self->state.id = id;
@@ -375,8 +810,14 @@ active_partition_actor::behavior_type active_partition(
   self->state.events = 0;
   self->state.filesystem = std::move(filesystem);
   self->state.store = std::move(store);
+  if (local_store) {
+    self->state.store_builder = self->spawn<caf::linked>(
+      active_local_store, self->state.filesystem);
+    self->state.store = self->state.store_builder;
+  }
   self->state.streaming_initiated = false;
   self->state.synopsis = std::make_shared<partition_synopsis>();
+  self->state.index_opts = std::move(index_opts);
   self->state.synopsis_opts = std::move(synopsis_opts);
   put(self->state.synopsis_opts, "buffer-input-data", true);
   // The active partition stage is a caf stream stage that takes
@@ -405,6 +846,8 @@ active_partition_actor::behavior_type active_partition(
       self->state.offset = std::min(x.offset(), self->state.offset);
       self->state.events += x.rows();
       self->state.synopsis->add(x, self->state.synopsis_opts);
+      if (self->state.store_builder)
+        self->send(self->state.store_builder, x);
       size_t col = 0;
       VAST_ASSERT(!layout.fields.empty());
       for (auto& field : layout.fields) {
@@ -412,12 +855,15 @@ active_partition_actor::behavior_type active_partition(
         auto& idx = self->state.indexers[qf];
         if (!idx) {
           self->state.combined_layout.fields.push_back(as_record_field(qf));
-          idx = self->spawn(active_indexer, field.type, index_opts);
+          idx = self->spawn(active_indexer, field.type,
+                            self->state.index_opts);
           auto slot = self->state.stage->add_outbound_path(idx);
           self->state.stage->out().set_filter(slot, qf);
           VAST_DEBUG("{} spawned new indexer for field {} at slot {}", self,
                      field.name, slot);
         }
+        if (caf::holds_alternative<time_type>(field.type))
+          self->state.sorted_time_columns[qf].add(x, col);
         out.push(table_slice_column{x, col++, qf});
       }
     },
@@ -556,7 +1002,9 @@ active_partition_actor::behavior_type active_partition(
               // Shrink synopses for addr fields to optimal size.
               self->state.synopsis->shrink();
               // Create the partition flatbuffer.
-              flatbuffers::FlatBufferBuilder builder;
+              auto& pool = memory_pool::local();
+              flatbuffers::FlatBufferBuilder builder{
+                1024, pool.flatbuffers_allocator()};
               auto partition = pack(builder, self->state);
               if (!partition) {
                 VAST_ERROR("{} failed to serialize {} with error: {}", self,
@@ -582,39 +1030,67 @@ active_partition_actor::behavior_type active_partition(
               // regenerate the synopses as needed. This also means we don't
               // need to handle errors here, since VAST can still start
               // correctly (if a bit slower) when the write fails.
-              flatbuffers::FlatBufferBuilder synopsis_builder;
-              if (auto ps = pack(synopsis_builder, *self->state.synopsis)) {
-                fbs::PartitionSynopsisBuilder ps_builder(synopsis_builder);
-                ps_builder.add_partition_synopsis_type(
-                  fbs::partition_synopsis::PartitionSynopsis::v0);
-                ps_builder.add_partition_synopsis(ps->Union());
-                auto ps_offset = ps_builder.Finish();
-                fbs::FinishPartitionSynopsisBuffer(synopsis_builder, ps_offset);
-                auto ps_chunk = fbs::release(synopsis_builder);
-                self
-                  ->request(self->state.filesystem, caf::infinite,
-                            atom::write_v, *self->state.synopsis_path, ps_chunk)
-                  .then([=](atom::ok) {}, [=](caf::error) {});
-              }
               auto fbchunk = fbs::release(builder);
               VAST_DEBUG("{} persists partition with a total size of "
                          "{} bytes",
                          self, fbchunk->size());
               // TODO: Add a proper timeout.
+              auto write_partition = [=] {
+                self
+                  ->request(self->state.filesystem, caf::infinite,
+                            atom::write_v, *self->state.persist_path, fbchunk)
+                  .then(
+                    [=](atom::ok) {
+                      // Relinquish ownership and send the shrunken synopsis
+                      // to the index.
+                      self->state.persistence_promise.deliver(
+                        self->state.synopsis);
+                      self->state.synopsis.reset();
+                    },
+                    [=](caf::error e) {
+                      self->state.persistence_promise.deliver(std::move(e));
+                    });
+              };
+              auto write_store_and_partition = [=] {
+                if (!self->state.store_builder) {
+                  write_partition();
+                  return;
+                }
+                // Write the partition-local store first, so a partition on
+                // disk never references a missing store.
+                self
+                  ->request(self->state.store_builder, caf::infinite,
+                            atom::persist_v,
+                            local_segment_store_path(
+                              *self->state.persist_path))
+                  .then([=](atom::ok) { write_partition(); },
+                        [=](caf::error e) {
+                          self->state.persistence_promise.deliver(
+                            std::move(e));
+                        });
+              };
+              // We only reply to the index once the synopsis is on disk, so
+              // that the index sees the complete partition when it maps the
+              // synopsis and measures the disk usage.
+              flatbuffers::FlatBufferBuilder synopsis_builder{
+                1024, pool.flatbuffers_allocator()};
+              auto ps = pack(synopsis_builder, *self->state.synopsis);
+              if (!ps) {
+                write_store_and_partition();
+                return;
+              }
+              fbs::PartitionSynopsisBuilder ps_builder(synopsis_builder);
+              ps_builder.add_partition_synopsis_type(
+                fbs::partition_synopsis::PartitionSynopsis::v0);
+              ps_builder.add_partition_synopsis(ps->Union());
+              auto ps_offset = ps_builder.Finish();
+              fbs::FinishPartitionSynopsisBuffer(synopsis_builder, ps_offset);
+              auto ps_chunk = fbs::release(synopsis_builder);
               self
                 ->request(self->state.filesystem, caf::infinite, atom::write_v,
-                          *self->state.persist_path, fbchunk)
-                .then(
-                  [=](atom::ok) {
-                    // Relinquish ownership and send the shrunken synopsis to
-                    // the index.
-                    self->state.persistence_promise.deliver(
-                      self->state.synopsis);
-                    self->state.synopsis.reset();
-                  },
-                  [=](caf::error e) {
-                    self->state.persistence_promise.deliver(std::move(e));
-                  });
+                          *self->state.synopsis_path, ps_chunk)
+                .then([=](atom::ok) { write_store_and_partition(); },
+                      [=](caf::error) { write_store_and_partition(); });
               return;
             },
             [=](caf::error err) {
@@ -629,26 +1105,7 @@ active_partition_actor::behavior_type active_partition(
     [self](vast::query query) -> caf::result<atom::done> {
       // TODO: We should do a candidate check using `self->state.synopsis` and
       // return early if that doesn't yield any results.
-      auto triples = evaluate(self->state, query.expr);
-      if (triples.empty())
-        return atom::done_v;
-      auto eval = self->spawn(evaluator, query.expr, triples);
-      auto rp = self->make_response_promise<atom::done>();
-      self->request(eval, caf::infinite, atom::run_v)
-        .then(
-          [self, rp, query = std::move(query)](const ids& hits) mutable {
-            // TODO: Use the first path if the expression can be evaluated
-            // exactly.
-            auto* count = caf::get_if<query::count>(&query.cmd);
-            if (count && count->mode == query::count::estimate) {
-              self->send(count->sink, rank(hits));
-              rp.deliver(atom::done_v);
-            } else {
-              rp.delegate(self->state.store, std::move(query), hits);
-            }
-          },
-          [rp](caf::error& err) mutable { rp.deliver(std::move(err)); });
-      return rp;
+      return evaluate_with_actors(self, std::move(query));
     },
     [self](atom::status,
            status_verbosity v) -> caf::typed_response_promise<caf::settings> {
@@ -706,9 +1163,12 @@ active_partition_actor::behavior_type active_partition(
 partition_actor::behavior_type passive_partition(
   partition_actor::stateful_pointer<passive_partition_state> self, uuid id,
   filesystem_actor filesystem, const std::filesystem::path& path,
-  store_actor store) {
+  store_actor store, std::shared_ptr<query_cache> cache,
+  bool direct_evaluation) {
   self->state.self = self;
   self->state.store = std::move(store);
+  self->state.cache = std::move(cache);
+  self->state.direct_evaluation = direct_evaluation;
   self->set_exit_handler([=](const caf::exit_msg& msg) {
     VAST_DEBUG("{} received EXIT from {} with reason: {}", self, msg.source,
                msg.reason);
@@ -743,6 +1203,7 @@ partition_actor::behavior_type passive_partition(
   // We send a "read" to the fs actor and upon receiving the result deserialize
   // the flatbuffer and switch to the "normal" partition behavior for responding
   // to queries.
+  auto load_start = std::chrono::system_clock::now();
   self->request(filesystem, caf::infinite, atom::mmap_v, path)
     .then(
       [=](chunk_ptr chunk) {
@@ -782,6 +1243,12 @@ partition_actor::behavior_type passive_partition(
           self->quit(std::move(error));
           return;
         }
+        // Partitions that were written with a partition-local store answer
+        // queries from that store instead of the global archive.
+        if (auto store_path
+            = local_segment_store_path(*self->state.flatbuffer, path))
+          self->state.store = self->spawn<caf::linked>(
+            passive_local_store, filesystem, *store_path);
         if (id != self->state.id)
           VAST_WARN("{} encountered partition id mismatch: restored {}"
                     "from disk, expected {}",
@@ -790,8 +1257,10 @@ partition_actor::behavior_type passive_partition(
         VAST_DEBUG("{} delegates {} deferred evaluations", self,
                    self->state.deferred_evaluations.size());
         for (auto&& [expr, rp] :
-             std::exchange(self->state.deferred_evaluations, {}))
+             std::exchange(self->state.deferred_evaluations, {})) {
+          record_span(self, expr, query_stage::partition_load, load_start);
           rp.delegate(static_cast<partition_actor>(self), std::move(expr));
+        }
       },
       [=](caf::error err) {
         VAST_ERROR("{} failed to load partition: {}", self, render(err));
@@ -821,26 +1290,18 @@ partition_actor::behavior_type passive_partition(
       if (self->state.indexers.empty())
         return caf::make_error(ec::system_error, "can not handle query because "
                                                  "shutdown was requested");
-      auto triples = evaluate(self->state, query.expr);
-      if (triples.empty())
-        return atom::done_v;
-      auto eval = self->spawn(evaluator, query.expr, triples);
-      auto rp = self->make_response_promise<atom::done>();
-      self->request(eval, caf::infinite, atom::run_v)
-        .then(
-          [self, rp, query = std::move(query)](const ids& hits) mutable {
-            // TODO: Use the first path if the expression can be evaluated
-            // exactly.
-            auto* count = caf::get_if<query::count>(&query.cmd);
-            if (count && count->mode == query::count::estimate) {
-              self->send(count->sink, rank(hits));
-              rp.deliver(atom::done_v);
-            } else {
-              rp.delegate(self->state.store, std::move(query), hits);
-            }
-          },
-          [rp](caf::error& err) mutable { rp.deliver(std::move(err)); });
-      return rp;
+      if (self->state.direct_evaluation) {
+        auto start = std::chrono::system_clock::now();
+        auto hits = evaluate_directly(self->state, query.expr);
+        record_span(self, query, query_stage::evaluation, start);
+        if (!hits)
+          return atom::done_v;
+        auto rp = self->make_response_promise<atom::done>();
+        deliver_hits(self, rp, std::move(query), *hits);
+        return rp;
+      }
+      // Evaluating the expression spawns the INDEXERs it needs lazily.
+      return evaluate_with_actors(self, std::move(query));
     },
     [self](atom::status,
            status_verbosity /*v*/) -> caf::config_value::dictionary {
@@ -848,13 +1309,17 @@ partition_actor::behavior_type passive_partition(
       caf::put(result, "size", self->state.partition_chunk->size());
       size_t mem_indexers = 0;
       for (size_t i = 0; i < self->state.indexers.size(); ++i) {
+        auto index_size = [&] {
+          return self->state.flatbuffer->indexes()
+            ->Get(i)
+            ->index()
+            ->data()
+            ->size();
+        };
         if (self->state.indexers[i])
-          mem_indexers += sizeof(indexer_state)
-                          + self->state.flatbuffer->indexes()
-                              ->Get(i)
-                              ->index()
-                              ->data()
-                              ->size();
+          mem_indexers += sizeof(indexer_state) + index_size();
+        else if (self->state.value_indexes[i])
+          mem_indexers += index_size();
       }
       caf::put(result, "memory-usage-indexers", mem_indexers);
       auto x = self->state.partition_chunk->incore();
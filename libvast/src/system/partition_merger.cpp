@@ -0,0 +1,170 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/partition_merger.hpp"
+
+#include "vast/fwd.hpp"
+
+#include "vast/chunk.hpp"
+#include "vast/detail/spawn_container_source.hpp"
+#include "vast/error.hpp"
+#include "vast/expression.hpp"
+#include "vast/fbs/partition.hpp"
+#include "vast/fbs/utils.hpp"
+#include "vast/ids.hpp"
+#include "vast/logger.hpp"
+#include "vast/partition_synopsis.hpp"
+#include "vast/query.hpp"
+#include "vast/system/local_segment_store.hpp"
+#include "vast/system/partition.hpp"
+#include "vast/system/query_profile.hpp"
+#include "vast/table_slice.hpp"
+
+#include <caf/typed_event_based_actor.hpp>
+
+#include <algorithm>
+
+namespace vast::system {
+
+namespace {
+
+void fail(partition_merger_actor::stateful_pointer<partition_merger_state> self,
+          caf::error err) {
+  VAST_WARN("{} failed to merge partitions: {}", self, err);
+  if (self->state.promise.pending())
+    self->state.promise.deliver(err);
+  self->quit(std::move(err));
+}
+
+/// Feeds the collected events into a new partition, and persists it.
+void rebuild(
+  partition_merger_actor::stateful_pointer<partition_merger_state> self) {
+  auto& st = self->state;
+  if (st.slices.empty())
+    return fail(self, caf::make_error(ec::logic_error, "merged partitions "
+                                                       "have no events"));
+  // Mixing store backends would leave events behind in the global store
+  // that erasing the new partition never reaches.
+  if (st.local_stores != 0 && st.local_stores != st.sources.size())
+    return fail(self, caf::make_error(ec::logic_error, "merged partitions "
+                                                       "use different "
+                                                       "stores"));
+  // Partitions require the table slices of every layout in ascending order of
+  // their IDs.
+  std::sort(st.slices.begin(), st.slices.end(),
+            [](const table_slice& lhs, const table_slice& rhs) {
+              return lhs.offset() < rhs.offset();
+            });
+  VAST_DEBUG("{} rebuilds partition {} from {} table slices", self, st.id,
+             st.slices.size());
+  auto partition = self->spawn(active_partition, st.id, st.filesystem,
+                               st.index_opts, st.synopsis_opts, st.store,
+                               st.local_stores > 0);
+  detail::spawn_container_source(self->system(), std::exchange(st.slices, {}),
+                                 partition);
+  self
+    ->request(partition, caf::infinite, atom::persist_v, st.partition_path,
+              st.synopsis_path)
+    .then(
+      [=](std::shared_ptr<partition_synopsis>& ps) {
+        VAST_DEBUG("{} persisted partition {}", self, self->state.id);
+        self->state.promise.deliver(std::move(ps));
+        self->send_exit(partition, caf::exit_reason::user_shutdown);
+        self->quit();
+      },
+      [=](caf::error& err) {
+        self->send_exit(partition, caf::exit_reason::user_shutdown);
+        fail(self, std::move(err));
+      });
+}
+
+/// Requests all events of a partition from its store.
+void extract(
+  partition_merger_actor::stateful_pointer<partition_merger_state> self,
+  const std::filesystem::path& path, const chunk_ptr& chunk) {
+  auto& st = self->state;
+  const auto* partition = fbs::GetPartition(chunk->data());
+  if (partition->partition_type() != fbs::partition::Partition::v0)
+    return fail(self, caf::make_error(ec::format_error,
+                                      "unexpected format version of "
+                                      "partition "
+                                        + path.string()));
+  const auto* partition_v0 = partition->partition_as_v0();
+  auto xs = ids{};
+  for (const auto* type_ids : *partition_v0->type_ids()) {
+    auto layout_ids = ids{};
+    if (auto err = fbs::deserialize_bytes(type_ids->ids(), layout_ids))
+      return fail(self, err);
+    xs |= layout_ids;
+  }
+  auto store = st.store;
+  if (auto store_path = local_segment_store_path(*partition_v0, path)) {
+    store = self->spawn<caf::linked>(passive_local_store, st.filesystem,
+                                     *store_path);
+    ++st.local_stores;
+  }
+  if (!store)
+    return fail(self, caf::make_error(ec::missing_component,
+                                      "no store for partition "
+                                        + path.string()));
+  auto query = query::make_extract(self, query::extract::preserve_ids,
+                                   expression{});
+  self->request(store, caf::infinite, std::move(query), std::move(xs))
+    .then(
+      [=](atom::done) {
+        // The store sends all events before its reply.
+        if (--self->state.remaining == 0)
+          rebuild(self);
+      },
+      [=](caf::error& err) { fail(self, std::move(err)); });
+}
+
+} // namespace
+
+partition_merger_actor::behavior_type partition_merger(
+  partition_merger_actor::stateful_pointer<partition_merger_state> self,
+  uuid id, std::vector<std::filesystem::path> sources,
+  std::filesystem::path partition_path, std::filesystem::path synopsis_path,
+  filesystem_actor filesystem, store_actor store, caf::settings index_opts,
+  caf::settings synopsis_opts) {
+  self->state.id = id;
+  self->state.sources = std::move(sources);
+  self->state.partition_path = std::move(partition_path);
+  self->state.synopsis_path = std::move(synopsis_path);
+  self->state.filesystem = std::move(filesystem);
+  self->state.store = std::move(store);
+  self->state.index_opts = std::move(index_opts);
+  self->state.synopsis_opts = std::move(synopsis_opts);
+  return {
+    [self](atom::run) -> caf::result<std::shared_ptr<partition_synopsis>> {
+      auto& st = self->state;
+      VAST_DEBUG("{} merges {} partitions into partition {}", self,
+                 st.sources.size(), st.id);
+      st.promise = self->make_response_promise<
+        std::shared_ptr<partition_synopsis>>();
+      st.remaining = st.sources.size();
+      for (const auto& path : st.sources)
+        self->request(st.filesystem, caf::infinite, atom::mmap_v, path)
+          .then([=](const chunk_ptr& chunk) { extract(self, path, chunk); },
+                [=](caf::error& err) { fail(self, std::move(err)); });
+      return st.promise;
+    },
+    // -- extract_sink_actor ---------------------------------------------------
+    [self](table_slice& slice) {
+      self->state.slices.push_back(std::move(slice));
+    },
+    [](atom::candidate, uint64_t) {
+      // nop
+    },
+    [](atom::profile, const query_span&) {
+      // nop
+    },
+  };
+}
+
+} // namespace vast::system
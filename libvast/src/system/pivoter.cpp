@@ -13,6 +13,7 @@
 #include "vast/command.hpp"
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/expression.hpp"
+#include "vast/defaults.hpp"
 #include "vast/detail/string.hpp"
 #include "vast/expression.hpp"
 #include "vast/logger.hpp"
@@ -20,10 +21,14 @@
 #include "vast/table_slice.hpp"
 #include "vast/table_slice_column.hpp"
 #include "vast/uuid.hpp"
+#include "vast/view.hpp"
 
 #include <caf/event_based_actor.hpp>
 #include <caf/settings.hpp>
 
+#include <string_view>
+#include <utility>
+
 namespace vast::system {
 
 namespace {
@@ -85,15 +90,62 @@ caf::behavior pivoter(caf::stateful_actor<pivoter_state>* self, node_actor node,
   st.target = std::move(target);
   auto quit_if_done = [=]() {
     auto& st = self->state;
-    if (st.initial_query_completed && st.running_exporters == 0)
+    if (st.initial_query_completed && st.running_exporters == 0
+        && st.pending.empty())
       self->quit();
   };
+  // Turns the pending pivot values into a single query, unless the maximum
+  // number of EXPORTERs is already running.
+  auto flush = [=]() {
+    auto& st = self->state;
+    if (st.pending.empty()
+        || st.running_exporters >= defaults::pivot::max_running_exporters)
+      return;
+    auto type_predicate
+      = predicate{meta_extractor{meta_extractor::type},
+                  relational_operator::equal, data{st.target}};
+    auto edges = disjunction{};
+    for (auto& [field, xs] : std::exchange(st.pending, {})) {
+      VAST_DEBUG("{} queries for {} {}", self, xs.size(), field);
+      edges.emplace_back(predicate{field_extractor{field},
+                                   relational_operator::in,
+                                   data{std::move(xs)}});
+    }
+    auto expr = edges.size() == 1
+                  ? conjunction{std::move(type_predicate),
+                                std::move(edges.front())}
+                  : conjunction{std::move(type_predicate), std::move(edges)};
+    // TODO(ch9411): Drop the conversion to a string when node actors can
+    //               be spawned without going through an invocation.
+    auto query = to_string(expr);
+    VAST_TRACE_SCOPE("{} spawns new exporter with query {}", self, query);
+    auto exporter_options = caf::settings{};
+    caf::put(exporter_options, "vast.export.disable-taxonomies", true);
+    auto exporter_invocation
+      = invocation{std::move(exporter_options), "spawn exporter", {query}};
+    ++st.running_exporters;
+    self->request(st.node, caf::infinite, atom::spawn_v, exporter_invocation)
+      .then(
+        [=](caf::actor handle) {
+          auto exporter = caf::actor_cast<exporter_actor>(handle);
+          VAST_DEBUG("{} registers exporter {}", self, exporter);
+          self->monitor(exporter);
+          self->send(exporter, atom::sink_v, self->state.sink);
+          self->send(exporter, atom::run_v);
+        },
+        [=](caf::error error) {
+          --self->state.running_exporters;
+          VAST_ERROR("{} failed to spawn exporter: {}", self, render(error));
+          quit_if_done();
+        });
+  };
   self->set_down_handler([=]([[maybe_unused]] const caf::down_msg& msg) {
     // Only the spawned EXPORTERs are expected to send down messages.
     auto& st = self->state;
     st.running_exporters--;
     VAST_DEBUG("{} received DOWN from {} outstanding requests: {}", self,
                msg.source, st.running_exporters);
+    flush();
     quit_if_done();
   });
   return {
@@ -106,56 +158,32 @@ caf::behavior pivoter(caf::stateful_actor<pivoter_state>* self, node_actor node,
                  st.target);
       auto column = table_slice_column::make(slice, pivot_field->name);
       VAST_ASSERT(column);
-      auto xs = list{};
+      auto* xs = &st.pending[pivot_field->name];
+      auto num_pending = xs->size();
       for (size_t i = 0; i < column->size(); ++i) {
-        auto data = materialize((*column)[i]);
-        auto x = caf::get_if<std::string>(&data);
+        auto value = (*column)[i];
+        auto x = caf::get_if<view<std::string>>(&value);
         // Skip if no value
         if (!x)
           continue;
         // Skip if ID was already requested
-        if (st.requested_ids.count(*x) > 0)
+        auto [_, inserted] = st.requested_ids.emplace(*x);
+        if (!inserted)
           continue;
-        xs.push_back(*x);
-        st.requested_ids.insert(*x);
+        xs->emplace_back(std::string{*x});
       }
-      if (xs.empty()) {
+      if (xs->size() == num_pending) {
         VAST_DEBUG("{} already queried for all {}", self, pivot_field->name);
+        if (xs->empty())
+          st.pending.erase(pivot_field->name);
         return;
       }
-      auto expr
-        = conjunction{predicate{meta_extractor{meta_extractor::type},
-                                relational_operator::equal, data{st.target}},
-                      predicate{field_extractor{pivot_field->name},
-                                relational_operator::in, data{xs}}};
-      // TODO(ch9411): Drop the conversion to a string when node actors can
-      //               be spawned without going through an invocation.
-      auto query = to_string(expr);
-      VAST_DEBUG("{} queries for {} {}", self, xs.size(), pivot_field->name);
-      VAST_TRACE_SCOPE("{} spawns new exporter with query {}", self, query);
-      auto exporter_options = caf::settings{};
-      caf::put(exporter_options, "vast.export.disable-taxonomies", true);
-      auto exporter_invocation
-        = invocation{std::move(exporter_options), "spawn exporter", {query}};
-      ++self->state.running_exporters;
-      self->request(st.node, caf::infinite, atom::spawn_v, exporter_invocation)
-        .then(
-          [=](caf::actor handle) {
-            auto exporter = caf::actor_cast<exporter_actor>(handle);
-            VAST_DEBUG("{} registers exporter {}", self, exporter);
-            self->monitor(exporter);
-            self->send(exporter, atom::sink_v, self->state.sink);
-            self->send(exporter, atom::run_v);
-          },
-          [=](caf::error error) {
-            --self->state.running_exporters;
-            VAST_ERROR("{} failed to spawn exporter: {}", self, render(error));
-          });
-      ;
+      flush();
     },
     [=](std::string name, query_status) {
       VAST_DEBUG("{} received final status from {}", self, name);
       self->state.initial_query_completed = true;
+      flush();
       quit_if_done();
     },
     [=](atom::sink, const caf::actor& sink) {
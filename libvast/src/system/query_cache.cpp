@@ -0,0 +1,135 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/query_cache.hpp"
+
+#include "vast/concept/hashable/uhash.hpp"
+#include "vast/concept/hashable/xxhash.hpp"
+#include "vast/data.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/logger.hpp"
+
+#include <algorithm>
+
+namespace vast::system {
+
+namespace {
+
+/// Brings a curried predicate into a canonical form, so that predicates that
+/// differ only syntactically share a cache entry.
+curried_predicate normalize(curried_predicate x) {
+  switch (x.op) {
+    case relational_operator::in:
+    case relational_operator::not_in:
+      // The order of elements in a membership test does not matter.
+      if (auto xs = caf::get_if<list>(&x.rhs)) {
+        std::sort(xs->begin(), xs->end());
+        xs->erase(std::unique(xs->begin(), xs->end()), xs->end());
+      }
+      break;
+    default:
+      break;
+  }
+  return x;
+}
+
+} // namespace
+
+query_cache_key::query_cache_key(uuid partition, size_t field,
+                                 curried_predicate predicate)
+  : partition{partition},
+    field{field},
+    predicate{normalize(std::move(predicate))} {
+  // nop
+}
+
+bool operator==(const query_cache_key& x, const query_cache_key& y) {
+  return x.partition == y.partition && x.field == y.field
+         && x.predicate.op == y.predicate.op
+         && x.predicate.rhs == y.predicate.rhs;
+}
+
+size_t
+query_cache::key_hasher::operator()(const query_cache_key& x) const noexcept {
+  return uhash<xxhash>{}(x);
+}
+
+query_cache::query_cache(size_t capacity) : capacity_{capacity} {
+  // nop
+}
+
+std::optional<ids> query_cache::lookup(const query_cache_key& key) {
+  auto lock = std::lock_guard{mutex_};
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    ++statistics_.misses;
+    return std::nullopt;
+  }
+  ++statistics_.hits;
+  // Move the entry to the back of the list, which holds the most recently
+  // used entries.
+  entries_.splice(entries_.end(), entries_, it->second);
+  return it->second->second;
+}
+
+void query_cache::insert(query_cache_key key, ids result) {
+  auto lock = std::lock_guard{mutex_};
+  if (auto it = index_.find(key); it != index_.end())
+    remove(it->second);
+  auto& x = entries_.emplace_back(std::move(key), std::move(result));
+  auto size = memusage(x);
+  if (size > capacity_) {
+    VAST_DEBUG("query cache skips a result of {} bytes that exceeds its "
+               "capacity of {} bytes",
+               size, capacity_);
+    entries_.pop_back();
+    return;
+  }
+  while (statistics_.bytes + size > capacity_) {
+    VAST_ASSERT(!entries_.empty());
+    remove(entries_.begin());
+    ++statistics_.evictions;
+  }
+  index_.emplace(x.first, std::prev(entries_.end()));
+  statistics_.bytes += size;
+  ++statistics_.entries;
+}
+
+void query_cache::erase(const uuid& partition) {
+  auto lock = std::lock_guard{mutex_};
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    auto current = it++;
+    if (current->first.partition == partition)
+      remove(current);
+  }
+}
+
+size_t query_cache::capacity() const {
+  return capacity_;
+}
+
+query_cache_statistics query_cache::statistics() const {
+  auto lock = std::lock_guard{mutex_};
+  return statistics_;
+}
+
+void query_cache::remove(entry_list::iterator it) {
+  statistics_.bytes -= memusage(*it);
+  --statistics_.entries;
+  index_.erase(it->first);
+  entries_.erase(it);
+}
+
+size_t query_cache::memusage(const entry& x) {
+  // The key and the list node add a constant overhead in addition to the
+  // bitmap itself, which we account for to keep the cache bounded even for
+  // tiny results.
+  return sizeof(entry) + sizeof(entry_list::iterator) + x.second.memusage();
+}
+
+} // namespace vast::system
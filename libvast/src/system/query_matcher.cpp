@@ -0,0 +1,469 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/query_matcher.hpp"
+
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/data.hpp"
+#include "vast/detail/assert.hpp"
+#include "vast/detail/overload.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/view.hpp"
+
+#include <algorithm>
+#include <optional>
+#include <queue>
+#include <string>
+#include <string_view>
+
+namespace vast::system {
+
+namespace {
+
+/// Finds all occurrences of a set of patterns in a string in a single pass
+/// over the string, using the Aho-Corasick algorithm.
+class multi_pattern_matcher {
+public:
+  multi_pattern_matcher()
+    : children_(1), symbols_(1), fail_(1), outputs_(1) {
+    // nop
+  }
+
+  /// Adds a pattern.
+  /// @param pattern The pattern to look for.
+  /// @param value The value to report when the pattern occurs.
+  /// @pre `!pattern.empty()`
+  void add(std::string_view pattern, size_t value) {
+    VAST_ASSERT(!pattern.empty());
+    uint32_t state = 0;
+    for (auto c : pattern) {
+      if (auto next = transition(state, c)) {
+        state = *next;
+        continue;
+      }
+      auto next = static_cast<uint32_t>(outputs_.size());
+      transitions_.emplace(key(state, c), next);
+      children_[state].push_back(next);
+      children_.emplace_back();
+      symbols_.push_back(c);
+      fail_.emplace_back();
+      outputs_.emplace_back();
+      state = next;
+    }
+    outputs_[state].push_back(value);
+  }
+
+  /// Computes the failure links. Must be called after adding all patterns
+  /// and before scanning.
+  void build() {
+    auto queue = std::queue<uint32_t>{};
+    for (auto child : children_[0]) {
+      fail_[child] = 0;
+      queue.push(child);
+    }
+    // Visit the states in breadth-first order, so that the failure link of a
+    // state always points to a state that was visited before.
+    while (!queue.empty()) {
+      auto state = queue.front();
+      queue.pop();
+      for (auto child : children_[state]) {
+        auto c = symbols_[child];
+        auto f = fail_[state];
+        while (f != 0 && !transition(f, c))
+          f = fail_[f];
+        auto next = transition(f, c);
+        fail_[child] = next ? *next : 0;
+        const auto& inherited = outputs_[fail_[child]];
+        outputs_[child].insert(outputs_[child].end(), inherited.begin(),
+                               inherited.end());
+        queue.push(child);
+      }
+    }
+  }
+
+  /// Calls a function for every occurrence of a pattern in a string.
+  template <class F>
+  void scan(std::string_view str, F f) const {
+    uint32_t state = 0;
+    for (auto c : str) {
+      auto next = transition(state, c);
+      while (!next && state != 0) {
+        state = fail_[state];
+        next = transition(state, c);
+      }
+      state = next ? *next : 0;
+      for (auto value : outputs_[state])
+        f(value);
+    }
+  }
+
+  [[nodiscard]] size_t size() const noexcept {
+    return outputs_.size();
+  }
+
+private:
+  static uint64_t key(uint32_t state, char c) {
+    return (uint64_t{state} << 8) | static_cast<unsigned char>(c);
+  }
+
+  [[nodiscard]] std::optional<uint32_t>
+  transition(uint32_t state, char c) const {
+    if (auto it = transitions_.find(key(state, c)); it != transitions_.end())
+      return it->second;
+    return std::nullopt;
+  }
+
+  std::unordered_map<uint64_t, uint32_t> transitions_;
+  std::vector<std::vector<uint32_t>> children_;
+  std::vector<char> symbols_;
+  std::vector<uint32_t> fail_;
+  std::vector<std::vector<size_t>> outputs_;
+};
+
+/// Counts the predicates in an expression, including duplicates.
+size_t count_predicates(const expression& expr) {
+  auto f = detail::overload{
+    [](const caf::none_t&) -> size_t { return 0; },
+    [](const predicate&) -> size_t { return 1; },
+    [](const negation& x) -> size_t { return count_predicates(x.expr()); },
+    [](const auto& xs) -> size_t {
+      size_t result = 0;
+      for (const auto& x : xs)
+        result += count_predicates(x);
+      return result;
+    },
+  };
+  return caf::visit(f, expr);
+}
+
+/// Checks whether rows of a column can be matched against the right-hand side
+/// of an equality predicate by hashing their values. A nil right-hand side
+/// matches null rows, which the hash probe skips, so we evaluate such
+/// predicates row-wise.
+bool is_hashable(const type& t, const data& rhs) {
+  if (caf::holds_alternative<caf::none_t>(rhs))
+    return false;
+  auto f = detail::overload{
+    [](const bool_type&) { return true; },
+    [](const integer_type&) { return true; },
+    [](const count_type&) { return true; },
+    [](const real_type&) { return true; },
+    [](const duration_type&) { return true; },
+    [](const time_type&) { return true; },
+    [](const string_type&) { return true; },
+    [](const address_type&) { return true; },
+    [](const subnet_type&) { return true; },
+    [](const auto&) { return false; },
+  };
+  return caf::visit(f, t) && type_check(t, rhs);
+}
+
+/// Builds the ID set for a table slice from the sorted rows that qualify.
+ids make_selection(const table_slice& slice,
+                   const std::vector<uint32_t>& rows) {
+  auto result = ids{};
+  result.append(false, slice.offset());
+  size_t next = 0;
+  for (auto row : rows) {
+    result.append(false, row - next);
+    result.append_bit(true);
+    next = row + 1;
+  }
+  result.append(false, slice.rows() - next);
+  return result;
+}
+
+} // namespace
+
+struct query_matcher::program {
+  enum class node_kind : uint8_t {
+    never,
+    predicate,
+    conjunction,
+    disjunction,
+    negation,
+  };
+
+  struct node {
+    node_kind kind = node_kind::never;
+    vast::predicate predicate = {};
+    std::vector<size_t> children = {};
+  };
+
+  /// Equality predicates on a single column, keyed by their right-hand side.
+  struct equality_table {
+    size_t column;
+    type column_type;
+    std::unordered_map<data_view, std::vector<size_t>> nodes;
+  };
+
+  /// Substring predicates on a single string column.
+  struct substring_set {
+    size_t column;
+    type column_type;
+    multi_pattern_matcher patterns;
+    std::vector<size_t> nodes;
+  };
+
+  /// Adds an expression to the program, reusing the nodes of identical
+  /// subexpressions.
+  /// @returns The node of the expression.
+  size_t intern(const expression& expr) {
+    if (auto it = index.find(expr); it != index.end())
+      return it->second;
+    auto x = node{};
+    auto f = detail::overload{
+      [&](const caf::none_t&) { x.kind = node_kind::never; },
+      [&](const vast::predicate& p) {
+        x.kind = node_kind::predicate;
+        x.predicate = p;
+      },
+      [&](const conjunction& xs) {
+        x.kind = node_kind::conjunction;
+        for (const auto& y : xs)
+          x.children.push_back(intern(y));
+      },
+      [&](const disjunction& xs) {
+        x.kind = node_kind::disjunction;
+        for (const auto& y : xs)
+          x.children.push_back(intern(y));
+      },
+      [&](const negation& y) {
+        x.kind = node_kind::negation;
+        x.children.push_back(intern(y.expr()));
+      },
+    };
+    caf::visit(f, expr);
+    nodes.push_back(std::move(x));
+    auto result = nodes.size() - 1;
+    index.emplace(expr, result);
+    return result;
+  }
+
+  /// Assigns every predicate to its evaluation strategy.
+  void plan(const record_type& layout) {
+    auto tables = std::unordered_map<size_t, size_t>{};
+    auto sets = std::unordered_map<size_t, size_t>{};
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      if (nodes[i].kind != node_kind::predicate)
+        continue;
+      const auto& p = nodes[i].predicate;
+      const auto* lhs = caf::get_if<data_extractor>(&p.lhs);
+      const auto* rhs = caf::get_if<data>(&p.rhs);
+      auto column = lhs && rhs ? layout.flat_index_at(lhs->offset)
+                               : std::optional<size_t>{};
+      if (!column) {
+        row_wise.push_back(i);
+        continue;
+      }
+      if (p.op == relational_operator::equal
+          && is_hashable(lhs->type, *rhs)) {
+        auto [it, inserted] = tables.emplace(*column, equalities.size());
+        if (inserted)
+          equalities.push_back({*column, lhs->type, {}});
+        equalities[it->second].nodes[make_view(*rhs)].push_back(i);
+        continue;
+      }
+      const auto* str = caf::get_if<std::string>(rhs);
+      if (p.op == relational_operator::ni && str && !str->empty()
+          && caf::holds_alternative<string_type>(lhs->type)) {
+        auto [it, inserted] = sets.emplace(*column, substrings.size());
+        if (inserted)
+          substrings.push_back({*column, lhs->type, {}, {}});
+        substrings[it->second].patterns.add(*str, i);
+        substrings[it->second].nodes.push_back(i);
+        continue;
+      }
+      row_wise.push_back(i);
+    }
+    for (auto& set : substrings)
+      set.patterns.build();
+  }
+
+  /// Evaluates all nodes over a table slice.
+  /// @returns The selection of every node.
+  std::vector<ids> run(const table_slice& slice) const {
+    auto result = std::vector<ids>(nodes.size());
+    // Collect the qualifying rows for all hashed predicates and substring
+    // predicates with one pass over their columns.
+    auto rows = std::vector<std::vector<uint32_t>>(nodes.size());
+    for (const auto& table : equalities) {
+      for (size_t row = 0; row < slice.rows(); ++row) {
+        auto x = to_canonical(table.column_type,
+                              slice.at(row, table.column, table.column_type));
+        if (caf::holds_alternative<caf::none_t>(x))
+          continue;
+        if (auto it = table.nodes.find(x); it != table.nodes.end())
+          for (auto i : it->second)
+            rows[i].push_back(static_cast<uint32_t>(row));
+      }
+      for (const auto& [_, xs] : table.nodes)
+        for (auto i : xs)
+          result[i] = make_selection(slice, rows[i]);
+    }
+    for (const auto& set : substrings) {
+      for (size_t row = 0; row < slice.rows(); ++row) {
+        auto x = slice.at(row, set.column, set.column_type);
+        const auto* str = caf::get_if<view<std::string>>(&x);
+        if (!str)
+          continue;
+        set.patterns.scan(*str, [&](size_t i) {
+          // A pattern may occur more than once in the same string.
+          if (rows[i].empty() || rows[i].back() != row)
+            rows[i].push_back(static_cast<uint32_t>(row));
+        });
+      }
+      for (auto i : set.nodes)
+        result[i] = make_selection(slice, rows[i]);
+    }
+    for (auto i : row_wise)
+      result[i] = evaluate(expression{nodes[i].predicate}, slice);
+    // Combine the selections bottom-up. The children of a node always precede
+    // the node itself.
+    auto mask = make_ids(slice);
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      const auto& x = nodes[i];
+      switch (x.kind) {
+        case node_kind::never:
+          result[i] = ids{};
+          result[i].append(false, slice.offset() + slice.rows());
+          break;
+        case node_kind::predicate:
+          break;
+        case node_kind::conjunction:
+          result[i] = result[x.children[0]];
+          for (size_t j = 1; j < x.children.size(); ++j)
+            result[i] &= result[x.children[j]];
+          break;
+        case node_kind::disjunction:
+          result[i] = result[x.children[0]];
+          for (size_t j = 1; j < x.children.size(); ++j)
+            result[i] |= result[x.children[j]];
+          break;
+        case node_kind::negation:
+          result[i] = mask & ~result[x.children[0]];
+          break;
+      }
+    }
+    return result;
+  }
+
+  /// The nodes in topological order.
+  std::vector<node> nodes;
+
+  /// Maps expressions to their nodes while compiling.
+  std::unordered_map<expression, size_t> index;
+
+  /// The root node of every query that applies to the layout.
+  std::vector<std::pair<query_id, size_t>> roots;
+
+  /// The hashed equality predicates, one table per column.
+  std::vector<equality_table> equalities;
+
+  /// The substring predicates, one set of patterns per column.
+  std::vector<substring_set> substrings;
+
+  /// The predicates that get evaluated row by row.
+  std::vector<size_t> row_wise;
+
+  /// The number of predicates in all queries before removing duplicates.
+  size_t predicate_occurrences = 0;
+};
+
+query_matcher::query_matcher() = default;
+
+query_matcher::~query_matcher() noexcept = default;
+
+query_matcher::query_matcher(query_matcher&&) noexcept = default;
+
+query_matcher& query_matcher::operator=(query_matcher&&) noexcept = default;
+
+caf::error query_matcher::add(query_id id, expression expr) {
+  auto normalized = normalize_and_validate(std::move(expr));
+  if (!normalized)
+    return std::move(normalized.error());
+  queries_[id] = std::move(*normalized);
+  programs_.clear();
+  return caf::none;
+}
+
+bool query_matcher::remove(query_id id) {
+  if (queries_.erase(id) == 0)
+    return false;
+  programs_.clear();
+  return true;
+}
+
+size_t query_matcher::size() const noexcept {
+  return queries_.size();
+}
+
+std::vector<query_matcher::match_result>
+query_matcher::match(const table_slice& slice) {
+  VAST_ASSERT(slice.encoding() != table_slice_encoding::none);
+  auto result = std::vector<match_result>{};
+  if (queries_.empty())
+    return result;
+  auto& prog = compile(slice.layout());
+  if (prog.roots.empty())
+    return result;
+  auto selections = prog.run(slice);
+  for (const auto& [id, root] : prog.roots)
+    if (rank(selections[root]) > 0)
+      result.emplace_back(id, selections[root]);
+  return result;
+}
+
+caf::settings query_matcher::status() const {
+  auto result = caf::settings{};
+  put(result, "queries", queries_.size());
+  // Layout names contain dots, which CAF interprets as nested keys, so we
+  // list the programs instead of keying them by layout name.
+  auto& layouts = put_list(result, "layouts");
+  layouts.reserve(programs_.size());
+  for (const auto& [layout, prog] : programs_) {
+    auto xs = caf::settings{};
+    put(xs, "name", layout.name());
+    put(xs, "queries", prog->roots.size());
+    put(xs, "nodes", prog->nodes.size());
+    put(xs, "predicates", prog->predicate_occurrences);
+    auto hashed = size_t{0};
+    for (const auto& table : prog->equalities)
+      for (const auto& [_, nodes] : table.nodes)
+        hashed += nodes.size();
+    put(xs, "hashed-predicates", hashed);
+    auto substrings = size_t{0};
+    for (const auto& set : prog->substrings)
+      substrings += set.patterns.size() - 1;
+    put(xs, "substring-states", substrings);
+    put(xs, "row-wise-predicates", prog->row_wise.size());
+    layouts.emplace_back(std::move(xs));
+  }
+  return result;
+}
+
+query_matcher::program&
+query_matcher::compile(const record_type& layout) {
+  if (auto it = programs_.find(layout); it != programs_.end())
+    return *it->second;
+  auto prog = std::make_unique<program>();
+  for (const auto& [id, expr] : queries_) {
+    auto tailored = tailor(expr, layout);
+    // A query that does not apply to the layout matches none of its rows.
+    if (!tailored || caf::holds_alternative<caf::none_t>(*tailored))
+      continue;
+    prog->predicate_occurrences += count_predicates(*tailored);
+    prog->roots.emplace_back(id, prog->intern(*tailored));
+  }
+  prog->index.clear();
+  prog->plan(layout);
+  auto [it, _] = programs_.emplace(layout, std::move(prog));
+  return *it->second;
+}
+
+} // namespace vast::system
@@ -0,0 +1,120 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/query_profile.hpp"
+
+#include "vast/detail/tracepoint.hpp"
+
+#include <algorithm>
+#include <string>
+
+namespace vast::system {
+
+std::string_view to_string(query_stage stage) noexcept {
+  switch (stage) {
+    case query_stage::meta_index:
+      return "meta-index";
+    case query_stage::partition_load:
+      return "partition-load";
+    case query_stage::indexer_spawn:
+      return "indexer-spawn";
+    case query_stage::evaluation:
+      return "evaluation";
+    case query_stage::store_lookup:
+      return "store-lookup";
+    case query_stage::candidate_check:
+      return "candidate-check";
+    case query_stage::sink:
+      return "sink";
+  }
+  return "unknown";
+}
+
+void trace(const query_span& span) {
+  [[maybe_unused]] auto start = span.start.time_since_epoch().count();
+  [[maybe_unused]] auto elapsed = span.elapsed.count();
+  // Every stage has its own tracepoint, so that tracing tools can attach to
+  // the stages they care about.
+  switch (span.stage) {
+    case query_stage::meta_index:
+      VAST_TRACEPOINT(query_meta_index, start, elapsed);
+      break;
+    case query_stage::partition_load:
+      VAST_TRACEPOINT(query_partition_load, start, elapsed);
+      break;
+    case query_stage::indexer_spawn:
+      VAST_TRACEPOINT(query_indexer_spawn, start, elapsed);
+      break;
+    case query_stage::evaluation:
+      VAST_TRACEPOINT(query_evaluation, start, elapsed);
+      break;
+    case query_stage::store_lookup:
+      VAST_TRACEPOINT(query_store_lookup, start, elapsed);
+      break;
+    case query_stage::candidate_check:
+      VAST_TRACEPOINT(query_candidate_check, start, elapsed);
+      break;
+    case query_stage::sink:
+      VAST_TRACEPOINT(query_sink, start, elapsed);
+      break;
+  }
+}
+
+void query_profile::add(const query_span& span) noexcept {
+  auto index = static_cast<size_t>(span.stage);
+  if (index >= stages_.size())
+    return;
+  auto& stage = stages_[index];
+  auto end = span.start + span.elapsed;
+  if (stage.spans == 0 || span.start < stage.first_start)
+    stage.first_start = span.start;
+  stage.last_end = std::max(stage.last_end, end);
+  stage.total += span.elapsed;
+  stage.max = std::max(stage.max, span.elapsed);
+  ++stage.spans;
+}
+
+bool query_profile::empty() const noexcept {
+  return std::all_of(stages_.begin(), stages_.end(),
+                     [](const auto& stage) { return stage.spans == 0; });
+}
+
+void query_profile::append_report(std::string_view prefix, report& r) const {
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    const auto& stage = stages_[i];
+    if (stage.spans == 0)
+      continue;
+    auto key = std::string{prefix};
+    key += '.';
+    key += to_string(static_cast<query_stage>(i));
+    r.push_back({key + ".spans", stage.spans});
+    r.push_back({key + ".total", stage.total});
+    r.push_back({key + ".max", stage.max});
+  }
+}
+
+caf::settings query_profile::to_settings() const {
+  auto result = caf::settings{};
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    const auto& stage = stages_[i];
+    if (stage.spans == 0)
+      continue;
+    auto& xs = put_dictionary(
+      result, std::string{to_string(static_cast<query_stage>(i))});
+    put(xs, "spans", stage.spans);
+    put(xs, "total", stage.total);
+    put(xs, "max", stage.max);
+    // The wall-clock time between the first and the last span of a stage can
+    // be much shorter than the total, because partitions and candidate
+    // checkers run in parallel.
+    put(xs, "wall-clock", stage.last_end - stage.first_start);
+  }
+  return result;
+}
+
+} // namespace vast::system
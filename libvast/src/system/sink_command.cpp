@@ -13,6 +13,7 @@
 #include "vast/concept/parseable/vast/time.hpp"
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/expression.hpp"
+#include "vast/data.hpp"
 #include "vast/defaults.hpp"
 #include "vast/detail/assert.hpp"
 #include "vast/error.hpp"
@@ -187,6 +188,14 @@ sink_command(const invocation& inv, caf::actor_system& sys, caf::actor snk) {
         if (waiting_for_final_report)
           stop = true;
       },
+      [&](atom::profile, const caf::settings& profile) {
+        // Print the profile to stderr to keep it apart from the results.
+        if (auto json = to_json(to_data(profile)))
+          std::cerr << *json << std::endl;
+        else
+          VAST_WARN("{} failed to render query profile: {}", inv.full_name,
+                    json.error());
+      },
       [&](atom::signal, int signal) {
         VAST_DEBUG("{} got {}", inv.full_name, ::strsignal(signal));
         if (signal == SIGINT || signal == SIGTERM) {
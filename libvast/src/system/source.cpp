@@ -101,11 +101,15 @@ void source_state::send_report() {
 #endif
   metrics = measurement{};
   caf::unsafe_send_as(self, accountant, std::move(r));
+  // Send the chosen table slice sizes and flush reasons to the accountant.
+  auto batching_report = report{};
+  batching.append_report(name, batching_report);
+  caf::unsafe_send_as(self, accountant, std::move(batching_report));
 }
 
 caf::behavior
 source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
-       size_t table_slice_size, std::optional<size_t> max_events,
+       batch_size_options batching, std::optional<size_t> max_events,
        const type_registry_actor& type_registry, vast::schema local_schema,
        std::string type_filter, accountant_actor accountant,
        std::vector<transform>&& transforms) {
@@ -117,7 +121,7 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
   self->state.requested = max_events;
   self->state.local_schema = std::move(local_schema);
   self->state.accountant = std::move(accountant);
-  self->state.table_slice_size = table_slice_size;
+  self->state.batching = batch_size_controller{batching};
   self->state.has_sink = false;
   self->state.done = false;
   self->state.transformer
@@ -148,17 +152,23 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
       VAST_DEBUG("{} tries to generate {} messages", self, num);
       // Extract events until the source has exhausted its input or until
       // we have completed a batch.
-      auto push_slice = [&](table_slice slice) { out.push(std::move(slice)); };
+      auto push_slice = [&](table_slice slice) {
+        self->state.batching.observe_slice(slice);
+        out.push(std::move(slice));
+      };
       // We can produce up to num * table_slice_size events per run.
-      auto events = num * self->state.table_slice_size;
+      auto table_slice_size = self->state.batching.size();
+      auto events = num * table_slice_size;
       if (self->state.requested)
         events = std::min(events, *self->state.requested - self->state.count);
       auto t = timer::start(self->state.metrics);
-      auto [err, produced] = self->state.reader->read(
-        events, self->state.table_slice_size, push_slice);
+      auto [err, produced]
+        = self->state.reader->read(events, table_slice_size, push_slice);
       VAST_DEBUG("{} read {} events", self, produced);
       t.stop(produced);
       self->state.count += produced;
+      self->state.batching.observe_input(produced,
+                                         batch_size_controller::clock::now());
       auto finish = [&] {
         self->state.done = true;
         self->state.send_report();
@@ -171,6 +181,7 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
         return finish();
       }
       if (err == ec::stalled) {
+        self->state.batching.flushed(flush_reason::stalled);
         if (!self->state.waiting_for_input) {
           // This pull handler was invoked while we were waiting for a wakeup
           // message. Sending another one would create a parallel wakeup cycle.
@@ -193,14 +204,20 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
         return;
       }
       self->state.wakeup_delay = std::chrono::milliseconds::zero();
-      if (err == ec::timeout) {
+      if (err == caf::none) {
+        self->state.batching.flushed(flush_reason::full);
+      } else if (err == ec::timeout) {
         VAST_DEBUG("{} reached batch timeout and flushes its buffers", self);
+        self->state.batching.flushed(flush_reason::timeout);
         self->state.mgr->out().force_emit_batches();
-      } else if (err != caf::none) {
-        if (err != vast::ec::end_of_input)
+      } else {
+        if (err != vast::ec::end_of_input) {
+          self->state.batching.flushed(flush_reason::error);
           VAST_INFO("{} completed with message: {}", self, render(err));
-        else
+        } else {
+          self->state.batching.flushed(flush_reason::end_of_input);
           VAST_DEBUG("{} completed at end of input", self);
+        }
         return finish();
       }
       VAST_DEBUG("{} ended a generation round regularly", self);
@@ -255,6 +272,7 @@ source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
         if (self->state.reader)
           put(src, "format", self->state.reader->name());
         put(src, "produced", self->state.count);
+        put(src, "batching", self->state.batching.status());
         auto& xs = put_list(result, "sources");
         xs.emplace_back(std::move(src));
       }
@@ -39,8 +39,15 @@ spawn_archive(node_actor::stateful_pointer<node_state> self,
   auto max_segment_size
     = 1_MiB
       * get_or(args.inv.options, "vast.max-segment-size", sd::max_segment_size);
-  auto handle
-    = self->spawn(archive, args.dir / args.label, segments, max_segment_size);
+  auto compaction_threshold
+    = get_or(args.inv.options, "vast.segment-compaction-threshold",
+             sd::compaction_threshold);
+  if (compaction_threshold < 0.0 || compaction_threshold > 1.0)
+    return caf::make_error(ec::invalid_configuration,
+                           "vast.segment-compaction-threshold must be "
+                           "between 0 and 1");
+  auto handle = self->spawn(archive, args.dir / args.label, segments,
+                            max_segment_size, compaction_threshold);
   VAST_VERBOSE("{} spawned the archive", self);
   if (auto [accountant] = self->state.registry.find<accountant_actor>();
       accountant)
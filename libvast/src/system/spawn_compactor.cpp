@@ -0,0 +1,61 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/spawn_compactor.hpp"
+
+#include "vast/defaults.hpp"
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/compactor.hpp"
+#include "vast/system/node.hpp"
+#include "vast/system/spawn_arguments.hpp"
+
+#include <caf/settings.hpp>
+#include <caf/typed_event_based_actor.hpp>
+
+namespace vast::system {
+
+caf::expected<caf::actor>
+spawn_compactor(node_actor::stateful_pointer<node_state> self,
+                spawn_arguments& args) {
+  VAST_TRACE_SCOPE("{}", VAST_ARG(args));
+  auto index = self->state.registry.find<index_actor>();
+  if (!index)
+    return caf::make_error(ec::missing_component, "index");
+  const auto& opts = args.inv.options;
+  namespace sd = vast::defaults::system;
+  auto default_seconds
+    = std::chrono::seconds{sd::partition_compaction_interval}.count();
+  auto interval = caf::get_or(opts, "vast.start.partition-compaction-interval",
+                              default_seconds);
+  if (interval == 0) {
+    VAST_VERBOSE("'vast.start.partition-compaction-interval' is unset; "
+                 "compactor will not be spawned");
+    return ec::no_error;
+  }
+  auto threshold
+    = caf::get_or(opts, "vast.start.partition-compaction-threshold",
+                  sd::partition_compaction_threshold);
+  if (threshold <= 0.0 || threshold > 1.0)
+    return caf::make_error(ec::invalid_configuration,
+                           "'vast.start.partition-compaction-threshold' must "
+                           "be in (0, 1]");
+  auto partition_capacity = caf::get_or(opts, "vast.max-partition-size",
+                                        sd::max_partition_size);
+  auto config = compactor_config{
+    std::chrono::seconds{interval},
+    static_cast<uint64_t>(threshold * static_cast<double>(partition_capacity)),
+  };
+  if (auto error = validate(config))
+    return error;
+  auto handle = self->spawn(compactor, config, index);
+  VAST_VERBOSE("{} spawned a compactor", self);
+  return caf::actor_cast<caf::actor>(handle);
+}
+
+} // namespace vast::system
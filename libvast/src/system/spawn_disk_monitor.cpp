@@ -55,6 +55,11 @@ spawn_disk_monitor(node_actor::stateful_pointer<node_state> self,
                               default_seconds);
   struct disk_monitor_config config
     = {*hiwater, *lowater, step_size, command, std::chrono::seconds{interval}};
+  auto default_reconcile_seconds
+    = std::chrono::seconds{defaults::system::disk_reconcile_interval}.count();
+  config.reconcile_interval = std::chrono::seconds{
+    caf::get_or(opts, "vast.start.disk-budget-reconcile-interval",
+                default_reconcile_seconds)};
   if (auto error = validate(config))
     return error;
   if (!*hiwater) {
@@ -29,13 +29,25 @@ spawn_eraser(node_actor::stateful_pointer<node_state> self,
   VAST_TRACE_SCOPE("{} {}", VAST_ARG(self), VAST_ARG(args));
   // Parse options.
   auto eraser_query = caf::get_or(args.inv.options, "vast.aging-query", ""s);
-  if (eraser_query.empty()) {
-    VAST_VERBOSE("{} has no aging-query and skips starting the eraser", self);
+  auto retention = duration::zero();
+  if (auto str = caf::get_if<std::string>(&args.inv.options, "vast.aging-"
+                                                             "retention")) {
+    auto parsed = to<duration>(*str);
+    if (!parsed)
+      return parsed.error();
+    retention = *parsed;
+  }
+  if (eraser_query.empty() && retention <= duration::zero()) {
+    VAST_VERBOSE("{} has no aging-query or aging-retention and skips "
+                 "starting the eraser",
+                 self);
     return ec::no_error;
   }
-  if (auto expr = to<expression>(eraser_query); !expr) {
-    VAST_WARN("{} got an invalid aging-query {}", self, eraser_query);
-    return expr.error();
+  if (!eraser_query.empty()) {
+    if (auto expr = to<expression>(eraser_query); !expr) {
+      VAST_WARN("{} got an invalid aging-query {}", self, eraser_query);
+      return expr.error();
+    }
   }
   auto aging_frequency = defaults::system::aging_frequency;
   if (auto str = caf::get_if<std::string>(&args.inv.options, "vast.aging-"
@@ -46,12 +58,18 @@ spawn_eraser(node_actor::stateful_pointer<node_state> self,
     aging_frequency = *parsed;
   }
   // Ensure component dependencies.
-  auto [index] = self->state.registry.find<index_actor>();
+  auto [index, accountant]
+    = self->state.registry.find<index_actor, accountant_actor>();
   if (!index)
     return caf::make_error(ec::missing_component, "index");
   // Spawn the eraser.
-  auto handle = self->spawn(eraser, aging_frequency, eraser_query, index);
-  VAST_VERBOSE("{} spawned an eraser for {}", self, eraser_query);
+  auto handle = self->spawn(eraser, aging_frequency, eraser_query, retention,
+                            index, accountant);
+  if (retention > duration::zero())
+    VAST_VERBOSE("{} spawned an eraser with a retention of {}", self,
+                 retention);
+  else
+    VAST_VERBOSE("{} spawned an eraser for {}", self, eraser_query);
   return handle;
 }
 
@@ -11,6 +11,7 @@
 #include "vast/concept/printable/to_string.hpp"
 #include "vast/concept/printable/vast/expression.hpp"
 #include "vast/defaults.hpp"
+#include "vast/error.hpp"
 #include "vast/logger.hpp"
 #include "vast/query_options.hpp"
 #include "vast/system/exporter.hpp"
@@ -51,15 +52,45 @@ spawn_exporter(node_actor::stateful_pointer<node_state> self,
   // Check if we need to preserve ids during export.
   if (get_or(args.inv.options, "vast.export.preserve-ids", false))
     query_opts = query_opts + preserve_ids;
+  // Check whether the query stages should record timed spans.
+  if (get_or(args.inv.options, "vast.export.profile", false))
+    query_opts = query_opts + profile;
+  // Check whether the index should schedule partitions by time.
+  if (auto order = caf::get_if<std::string>(&args.inv.options,
+                                            "vast.export.order")) {
+    if (*order == "newest-first")
+      query_opts = query_opts + newest_first;
+    else if (*order == "oldest-first")
+      query_opts = query_opts + oldest_first;
+    else
+      return caf::make_error(ec::invalid_argument, "invalid export order",
+                             *order, "(expected newest-first or oldest-first)");
+  }
   auto handle
     = self->spawn(exporter, *expr, query_opts, std::move(*transforms));
   VAST_VERBOSE("{} spawned an exporter for {}", self, to_string(*expr));
   // Wire the exporter to all components.
-  auto [accountant, importer, index]
-    = self->state.registry.find<accountant_actor, importer_actor, index_actor>();
+  auto [accountant, importer, index, matcher]
+    = self->state.registry.find<accountant_actor, importer_actor, index_actor,
+                                matcher_actor>();
   if (accountant)
     self->send(handle, accountant);
-  if (importer && has_continuous_option(query_opts))
+  // Continuous queries share the MATCHER if there is one, which scans every
+  // table slice once for all of them. Otherwise, they connect to the IMPORTER
+  // and check every table slice on their own.
+  if (matcher && has_continuous_option(query_opts))
+    self
+      ->request(matcher, caf::infinite, atom::subscribe_v, *expr,
+                static_cast<extract_sink_actor>(handle))
+      .then(
+        [=](atom::ok) {
+          // nop
+        },
+        [=, matcher = matcher](caf::error err) {
+          VAST_ERROR("{} failed to subscribe to matcher {}: {}", self, matcher,
+                     err);
+        });
+  else if (importer && has_continuous_option(query_opts))
     self
       ->request(importer, caf::infinite,
                 static_cast<stream_sink_actor<table_slice>>(handle))
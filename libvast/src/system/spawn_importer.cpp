@@ -43,7 +43,13 @@ spawn_importer(node_actor::stateful_pointer<node_state> self,
     return caf::make_error(ec::missing_component, "index");
   if (!type_registry)
     return caf::make_error(ec::missing_component, "type-registry");
-  auto handle = self->spawn(importer, args.dir / args.label, archive, index,
+  // With partition-local stores, the partitions hold the events themselves,
+  // so the importer must not write a second copy to the archive.
+  auto store = store_builder_actor{archive};
+  if (caf::get_or(args.inv.options, "vast.partition-local-stores",
+                  defaults::system::partition_local_stores))
+    store = nullptr;
+  auto handle = self->spawn(importer, args.dir / args.label, store, index,
                             type_registry, std::move(*transforms));
   VAST_VERBOSE("{} spawned the importer", self);
   if (accountant) {
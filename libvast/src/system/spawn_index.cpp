@@ -47,7 +47,10 @@ spawn_index(node_actor::stateful_pointer<node_state> self,
     opt("vast.max-taste-partitions", sd::taste_partitions),
     opt("vast.max-queries", sd::num_query_supervisors),
     std::filesystem::path{opt("vast.meta-index-dir", indexdir.string())},
-    opt("vast.meta-index-fp-rate", sd::string_synopsis_fp_rate));
+    opt("vast.meta-index-fp-rate", sd::string_synopsis_fp_rate),
+    opt("vast.query-cache-size", sd::query_cache_size),
+    opt("vast.direct-partition-evaluation", sd::direct_partition_evaluation),
+    opt("vast.partition-local-stores", sd::partition_local_stores));
   VAST_VERBOSE("{} spawned the index", self);
   if (accountant)
     self->send(handle, caf::actor_cast<accountant_actor>(accountant));
@@ -0,0 +1,45 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "vast/system/spawn_matcher.hpp"
+
+#include "vast/error.hpp"
+#include "vast/logger.hpp"
+#include "vast/system/matcher.hpp"
+#include "vast/system/node.hpp"
+#include "vast/system/spawn_arguments.hpp"
+
+#include <caf/typed_event_based_actor.hpp>
+
+namespace vast::system {
+
+caf::expected<caf::actor>
+spawn_matcher(node_actor::stateful_pointer<node_state> self,
+              spawn_arguments& args) {
+  VAST_TRACE_SCOPE("{} {}", VAST_ARG(self), VAST_ARG(args));
+  auto [importer, accountant]
+    = self->state.registry.find<importer_actor, accountant_actor>();
+  if (!importer)
+    return caf::make_error(ec::missing_component, "importer");
+  auto handle = self->spawn(matcher, accountant);
+  self
+    ->request(importer, caf::infinite,
+              static_cast<stream_sink_actor<table_slice>>(handle))
+    .then(
+      [=](caf::outbound_stream_slot<table_slice>) {
+        // nop
+      },
+      [=, importer = importer](caf::error err) {
+        VAST_ERROR("{} failed to connect matcher to importer {}: {}", self,
+                   importer, err);
+      });
+  VAST_VERBOSE("{} spawned a matcher for continuous queries", self);
+  return caf::actor_cast<caf::actor>(handle);
+}
+
+} // namespace vast::system
@@ -14,6 +14,7 @@
 #include "vast/defaults.hpp"
 #include "vast/detail/pid_file.hpp"
 #include "vast/logger.hpp"
+#include "vast/memory_pool.hpp"
 #include "vast/scope_linked.hpp"
 #include "vast/system/node.hpp"
 
@@ -76,6 +77,11 @@ spawn_node(caf::scoped_actor& self, const caf::settings& opts) {
   VAST_DEBUG("{} acquires PID lock {}", node, pid_file.string());
   if (auto err = detail::acquire_pid_file(pid_file))
     return err;
+  // Set up the memory pools before any component allocates buffers.
+  memory_pool::configure({
+    get_or(opts, "vast.memory-pool.huge-pages", false),
+    get_or(opts, "vast.memory-pool.numa", false),
+  });
   // Spawn the node.
   VAST_DEBUG("{} spawns local node: {}", __func__, id);
   auto shutdown_grace_period = defaults::system::shutdown_grace_period;
@@ -113,8 +119,9 @@ spawn_node(caf::scoped_actor& self, const caf::settings& opts) {
         });
     return result;
   };
-  std::list components = {"type-registry", "archive", "index",
-                          "importer",      "eraser",  "disk-monitor"};
+  std::list components = {"type-registry", "archive",      "index",
+                          "importer",      "matcher",      "eraser",
+                          "disk-monitor",  "compactor"};
   if (accounting)
     components.push_front("accountant");
   for (auto& c : components) {
@@ -263,6 +263,19 @@ const record_type& table_slice::layout() const noexcept {
   return *visit(f, as_flatbuffer(chunk_));
 }
 
+span<const std::byte> table_slice::serialized_layout() const noexcept {
+  auto f = detail::overload{
+    []() noexcept -> span<const std::byte> {
+      return {};
+    },
+    [&](const auto& encoded) noexcept -> span<const std::byte> {
+      return {reinterpret_cast<const std::byte*>(encoded.layout()->data()),
+              encoded.layout()->size()};
+    },
+  };
+  return visit(f, as_flatbuffer(chunk_));
+}
+
 table_slice::size_type table_slice::rows() const noexcept {
   auto f = detail::overload{
     []() noexcept {
@@ -40,9 +40,19 @@ none_type none_type_singleton;
 // -- type ---------------------------------------------------------------------
 
 bool operator==(const type& x, const type& y) {
-  if (x.ptr_ && y.ptr_)
-    return *x.ptr_ == *y.ptr_;
-  return x.ptr_ == y.ptr_;
+  // Copies of a type share the same instance.
+  if (x.ptr_ == y.ptr_)
+    return true;
+  if (!x.ptr_ || !y.ptr_)
+    return false;
+  // Types with different fingerprints cannot be equal. We only compare
+  // fingerprints that are cached already, since computing them requires a
+  // full traversal of both types.
+  auto fx = x.ptr_->fingerprint_.load(std::memory_order_relaxed);
+  auto fy = y.ptr_->fingerprint_.load(std::memory_order_relaxed);
+  if (fx != 0 && fy != 0 && fx != fy)
+    return false;
+  return *x.ptr_ == *y.ptr_;
 }
 
 bool operator<(const type& x, const type& y) {
@@ -53,31 +63,33 @@ bool operator<(const type& x, const type& y) {
 
 type& type::name(const std::string& x) & {
   if (ptr_)
-    ptr_.unshared().name_ = x;
+    unshared().name_ = x;
   return *this;
 }
 
 type type::name(const std::string& x) && {
   if (ptr_)
-    ptr_.unshared().name_ = x;
+    unshared().name_ = x;
   return std::move(*this);
 }
 
 type& type::attributes(std::vector<attribute> xs) & {
-  if (ptr_)
-    ptr_.unshared().attributes_ = std::move(xs);
+  // Avoid detaching the type, and thereby losing its cached properties, if
+  // the attributes do not change.
+  if (ptr_ && ptr_->attributes_ != xs)
+    unshared().attributes_ = std::move(xs);
   return *this;
 }
 
 type type::attributes(std::vector<attribute> xs) && {
-  if (ptr_)
-    ptr_.unshared().attributes_ = std::move(xs);
+  if (ptr_ && ptr_->attributes_ != xs)
+    unshared().attributes_ = std::move(xs);
   return std::move(*this);
 }
 
 type& type::update_attributes(std::vector<attribute> xs) & {
   if (ptr_) {
-    auto& attrs = ptr_.unshared().attributes_;
+    auto& attrs = unshared().attributes_;
     for (auto& x : xs) {
       auto i = std::find_if(attrs.begin(), attrs.end(),
                             [&](auto& attr) { return attr.key == x.key; });
@@ -92,7 +104,7 @@ type& type::update_attributes(std::vector<attribute> xs) & {
 
 type type::update_attributes(std::vector<attribute> xs) && {
   if (ptr_) {
-    auto& attrs = ptr_.unshared().attributes_;
+    auto& attrs = unshared().attributes_;
     for (auto& x : xs) {
       auto i = std::find_if(attrs.begin(), attrs.end(),
                             [&](auto& attr) { return attr.key == x.key; });
@@ -119,6 +131,19 @@ const std::vector<attribute>& type::attributes() const {
   return ptr_ ? ptr_->attributes_ : no_attributes;
 }
 
+type_digest type::fingerprint() const {
+  if (!ptr_)
+    return uhash<xxhash64>{}(*this);
+  auto result = ptr_->fingerprint_.load(std::memory_order_relaxed);
+  if (result == 0) {
+    // Concurrent readers may compute the fingerprint redundantly, but they
+    // always arrive at the same value.
+    result = uhash<xxhash64>{}(*this);
+    ptr_->fingerprint_.store(result, std::memory_order_relaxed);
+  }
+  return result;
+}
+
 abstract_type_ptr type::ptr() const {
   return ptr_;
 }
@@ -139,12 +164,52 @@ type::type(abstract_type_ptr x) : ptr_{std::move(x)} {
   // nop
 }
 
+abstract_type& type::unshared() {
+  auto& result = ptr_.unshared();
+  result.reset_cache();
+  return result;
+}
+
 // -- abstract_type -----------------------------------------------------------
 
+abstract_type::abstract_type(const abstract_type& other)
+  : caf::ref_counted{other},
+    name_{other.name_},
+    attributes_{other.attributes_} {
+  // nop
+}
+
+abstract_type::abstract_type(abstract_type&& other) noexcept
+  : caf::ref_counted{other},
+    name_{std::move(other.name_)},
+    attributes_{std::move(other.attributes_)} {
+  other.reset_cache();
+}
+
+abstract_type& abstract_type::operator=(const abstract_type& other) {
+  name_ = other.name_;
+  attributes_ = other.attributes_;
+  reset_cache();
+  return *this;
+}
+
+abstract_type& abstract_type::operator=(abstract_type&& other) noexcept {
+  name_ = std::move(other.name_);
+  attributes_ = std::move(other.attributes_);
+  reset_cache();
+  other.reset_cache();
+  return *this;
+}
+
 abstract_type::~abstract_type() {
   // nop
 }
 
+void abstract_type::reset_cache() noexcept {
+  fingerprint_.store(0, std::memory_order_relaxed);
+  flat_size_.store(invalid_flat_size, std::memory_order_relaxed);
+}
+
 bool abstract_type::equals(const abstract_type& other) const {
   return typeid(*this) == typeid(other) && name_ == other.name_
          && attributes_ == other.attributes_;
@@ -642,9 +707,19 @@ size_t flat_size(const record_type& rec) {
 }
 
 size_t flat_size(const type& t) {
-  if (auto r = get_if<record_type>(&t))
-    return flat_size(*r);
-  return 1;
+  auto r = get_if<record_type>(&t);
+  if (!r)
+    return 1;
+  // Nested records are immutable once wrapped in a type, so we only need to
+  // compute their flat size once. This makes computing flat indexes linear in
+  // the number of fields instead of quadratic for deeply nested layouts.
+  auto& cache = t->flat_size_;
+  auto result = cache.load(std::memory_order_relaxed);
+  if (result == abstract_type::invalid_flat_size) {
+    result = flat_size(*r);
+    cache.store(result, std::memory_order_relaxed);
+  }
+  return result;
 }
 
 bool is_basic(const type& x) {
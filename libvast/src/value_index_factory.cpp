@@ -15,6 +15,7 @@
 #include "vast/detail/type_traits.hpp"
 #include "vast/index/address_index.hpp"
 #include "vast/index/arithmetic_index.hpp"
+#include "vast/index/bitslice_index.hpp"
 #include "vast/index/enumeration_index.hpp"
 #include "vast/index/hash_index.hpp"
 #include "vast/index/list_index.hpp"
@@ -131,16 +132,41 @@ auto add_value_index_factory() {
   return factory<value_index>::add(T{}, make<Index>);
 }
 
+/// Creates a `bitslice_index` for types with the attribute `#index=bitslice`
+/// and an `arithmetic_index` otherwise. The optional attribute `#precision`
+/// sets the number of decimal digits that the bit-sliced index drops.
+template <class T>
+value_index_ptr make_arithmetic(type x, caf::settings opts) {
+  using concrete_data = type_to_data<T>;
+  using value_type = std::conditional_t<std::is_same_v<concrete_data, integer>,
+                                        integer::value_type, concrete_data>;
+  using bitslice_index_type = bitslice_index<value_type>;
+  auto a = find_attribute(x, "index");
+  if (a && a->value && *a->value == "bitslice"sv) {
+    if constexpr (std::is_same_v<T, real_type>) {
+      VAST_WARN("{} ignores bit-sliced index for real values", __func__);
+    } else {
+      if (auto p = find_attribute(x, "precision"); p && p->value) {
+        uint64_t precision = 0;
+        if (!parsers::u64(*p->value, precision)
+            || precision > bitslice_index_type::max_precision) {
+          VAST_ERROR("{} invalid precision {}", __func__, *p->value);
+          return nullptr;
+        }
+        opts["precision"] = static_cast<int64_t>(precision);
+      }
+      return std::make_unique<bitslice_index_type>(std::move(x),
+                                                   std::move(opts));
+    }
+  }
+  return make<arithmetic_index<value_type>>(std::move(x), std::move(opts));
+}
+
 template <class T>
 auto add_arithmetic_index_factory() {
   static_assert(detail::is_any_v<T, integer_type, count_type, enumeration_type,
                                  real_type, duration_type, time_type>);
-  using concrete_data = type_to_data<T>;
-  if constexpr (detail::is_any_v<concrete_data, integer>)
-    return add_value_index_factory<
-      T, arithmetic_index<typename concrete_data::value_type>>();
-  else
-    return add_value_index_factory<T, arithmetic_index<concrete_data>>();
+  return factory<value_index>::add(T{}, make_arithmetic<T>);
 }
 
 } // namespace
@@ -153,6 +153,30 @@ TEST(single column - string) {
   CHECK_ROUNDTRIP(slice);
 }
 
+TEST(single column - dictionary-encoded string) {
+  auto t = string_type{};
+  record_type layout{record_field{"foo", t}};
+  auto builder = arrow_table_slice_builder::make(layout);
+  REQUIRE(builder->add("a"sv, "b"sv, "a"sv, caf::none, "b"sv, "a"sv));
+  auto slice = builder->finish();
+  REQUIRE_EQUAL(slice.rows(), 6u);
+  auto batch = as_record_batch(slice);
+  REQUIRE_EQUAL(batch->column(0)->type_id(), arrow::Type::DICTIONARY);
+  CHECK_VARIANT_EQUAL(slice.at(0, 0, t), "a"sv);
+  CHECK_VARIANT_EQUAL(slice.at(1, 0, t), "b"sv);
+  CHECK_VARIANT_EQUAL(slice.at(3, 0, t), caf::none);
+  CHECK_VARIANT_EQUAL(slice.at(5, 0, t), "a"sv);
+  CHECK_ROUNDTRIP(slice);
+  MESSAGE("fall back to plain strings for distinct values");
+  REQUIRE(builder->add("x"sv, "y"sv, "z"sv));
+  slice = builder->finish();
+  batch = as_record_batch(slice);
+  REQUIRE_EQUAL(batch->column(0)->type_id(), arrow::Type::STRING);
+  CHECK_VARIANT_EQUAL(slice.at(0, 0, t), "x"sv);
+  CHECK_VARIANT_EQUAL(slice.at(2, 0, t), "z"sv);
+  CHECK_ROUNDTRIP(slice);
+}
+
 TEST(single column - pattern) {
   auto t = pattern_type{};
   auto p1 = pattern("foo.ar");
@@ -133,7 +133,7 @@ TEST(bloom filter parameters : from string) {
 
 TEST(simple_hasher) {
   auto h = simple_hasher<xxhash64>{2, {0, 1}};
-  auto& xs = h(42);
+  auto xs = h(42);
   REQUIRE_EQUAL(h.size(), 2u);
   REQUIRE_EQUAL(xs.size(), 2u);
   CHECK_EQUAL(xs[0], 15516826743637085169ul);
@@ -150,7 +150,7 @@ TEST(simple_hasher) {
 
 TEST(double_hasher) {
   auto h = double_hasher<xxhash64>{4, {1337, 4711}};
-  auto& xs = h(42);
+  auto xs = h(42);
   REQUIRE_EQUAL(h.size(), 4u);
   REQUIRE_EQUAL(xs.size(), 4u);
   CHECK_EQUAL(xs[0], 340423191260729621ul);
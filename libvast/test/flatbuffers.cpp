@@ -191,7 +191,8 @@ TEST(full partition roundtrip) {
   auto partition_uuid = vast::uuid::random();
   auto partition
     = sys.spawn(vast::system::active_partition, partition_uuid, fs,
-                caf::settings{}, caf::settings{}, vast::system::store_actor{});
+                caf::settings{}, caf::settings{}, vast::system::store_actor{},
+                false);
   run();
   REQUIRE(partition);
   // Add data to the partition.
@@ -219,12 +220,18 @@ TEST(full partition roundtrip) {
     },
     [](const caf::error& err) { FAIL(err); });
   self->send_exit(partition, caf::exit_reason::user_shutdown);
-  // Spawn a read-only partition from this chunk and try to query the data we
-  // added. We make two queries, one "#type"-query and one "normal" query
+  // Spawn read-only partitions from this chunk and try to query the data we
+  // added. We make two queries, one "#type"-query and one "normal" query. One
+  // partition evaluates queries with INDEXER actors, the other one looks up
+  // its value indexes directly; both must yield the same results.
   auto readonly_partition
     = sys.spawn(vast::system::passive_partition, partition_uuid, fs,
-                persist_path, vast::system::store_actor{});
+                persist_path, vast::system::store_actor{}, nullptr, false);
   REQUIRE(readonly_partition);
+  auto direct_partition
+    = sys.spawn(vast::system::passive_partition, partition_uuid, fs,
+                persist_path, vast::system::store_actor{}, nullptr, true);
+  REQUIRE(direct_partition);
   run();
   // A minimal `partition_client_actor`that stores the results in a local
   // variable.
@@ -234,13 +241,14 @@ TEST(full partition roundtrip) {
       [count](uint64_t hits) { *count += hits; },
     };
   };
-  auto test_expression
-    = [&](const vast::expression& expression, size_t expected_ids) {
+  auto test_partition
+    = [&](vast::system::partition_actor partition,
+          const vast::expression& expression, size_t expected_ids) {
         auto done = false;
         auto result = std::make_shared<uint64_t>();
         auto dummy = self->spawn(dummy_client, result);
         auto rp = self->request(
-          readonly_partition, caf::infinite,
+          partition, caf::infinite,
           vast::query::make_count(dummy, vast::query::count::mode::estimate,
                                   expression));
         run();
@@ -253,6 +261,11 @@ TEST(full partition roundtrip) {
         CHECK_EQUAL(*result, expected_ids);
         return true;
       };
+  auto test_expression
+    = [&](const vast::expression& expression, size_t expected_ids) {
+        return test_partition(readonly_partition, expression, expected_ids)
+               && test_partition(direct_partition, expression, expected_ids);
+      };
   auto x_equals_zero = vast::expression{
     vast::predicate{vast::field_extractor{"x"},
                     vast::relational_operator::equal, vast::data{0u}}};
@@ -273,8 +286,99 @@ TEST(full partition roundtrip) {
   test_expression(type_equals_y, 1);
   // For the query `#type == "foo"`, we expect no results.
   test_expression(type_equals_foo, 0);
+  // Conjunctions combine the hits of their predicates.
+  auto x_and_y = vast::expression{vast::conjunction{x_equals_zero,
+                                                     type_equals_y}};
+  auto x_and_foo = vast::expression{vast::conjunction{x_equals_zero,
+                                                       type_equals_foo}};
+  test_expression(x_and_y, 1);
+  test_expression(x_and_foo, 0);
   // Shut down test actors.
   self->send_exit(readonly_partition, caf::exit_reason::user_shutdown);
+  self->send_exit(direct_partition, caf::exit_reason::user_shutdown);
+  self->send_exit(fs, caf::exit_reason::user_shutdown);
+  run();
+}
+
+// This test persists a partition with a sorted and an unsorted time column,
+// and checks that the passive partition answers range predicates on the
+// sorted column exactly by binary search.
+TEST(sorted time column roundtrip) {
+  using namespace std::chrono_literals;
+  auto fs = self->spawn(vast::system::posix_filesystem, directory);
+  auto partition_uuid = vast::uuid::random();
+  auto partition
+    = sys.spawn(vast::system::active_partition, partition_uuid, fs,
+                caf::settings{}, caf::settings{}, vast::system::store_actor{},
+                false);
+  run();
+  REQUIRE(partition);
+  auto layout = vast::record_type{{"sorted", vast::time_type{}},
+                                  {"unsorted", vast::time_type{}}}
+                  .name("y");
+  auto t0 = vast::time{} + 1'600'000'000s;
+  auto data = std::vector<vast::table_slice>{};
+  for (auto i = 0; i < 2; ++i) {
+    auto builder = vast::msgpack_table_slice_builder::make(layout);
+    CHECK(builder->add(t0 + (2 * i) * 1s, t0 - (2 * i) * 1s));
+    CHECK(builder->add(t0 + (2 * i + 1) * 1s, t0 - (2 * i + 1) * 1s));
+    auto slice = builder->finish();
+    slice.offset(2 * i);
+    data.push_back(std::move(slice));
+  }
+  auto src = vast::detail::spawn_container_source(sys, data, partition);
+  REQUIRE(src);
+  run();
+  std::filesystem::path persist_path = "test-sorted-partition";
+  std::filesystem::path synopsis_path = "test-sorted-partition-synopsis";
+  auto persist_promise
+    = self->request(partition, caf::infinite, vast::atom::persist_v,
+                    persist_path, synopsis_path);
+  run();
+  persist_promise.receive([](std::shared_ptr<vast::partition_synopsis>&) {},
+                          [](const caf::error& err) { FAIL(err); });
+  self->send_exit(partition, caf::exit_reason::user_shutdown);
+  auto direct_partition
+    = sys.spawn(vast::system::passive_partition, partition_uuid, fs,
+                persist_path, vast::system::store_actor{}, nullptr, true);
+  REQUIRE(direct_partition);
+  run();
+  auto dummy_client = [](std::shared_ptr<uint64_t> count)
+    -> vast::system::receiver_actor<uint64_t>::behavior_type {
+    return {
+      [count](uint64_t hits) { *count += hits; },
+    };
+  };
+  auto count = [&](std::string field, vast::relational_operator op,
+                   vast::time x) {
+    auto result = std::make_shared<uint64_t>();
+    auto dummy = self->spawn(dummy_client, result);
+    auto expr = vast::expression{
+      vast::predicate{vast::field_extractor{std::move(field)}, op,
+                      vast::data{x}}};
+    auto rp = self->request(
+      direct_partition, caf::infinite,
+      vast::query::make_count(dummy, vast::query::count::mode::estimate,
+                              expr));
+    run();
+    rp.receive([](vast::atom::done) {}, [](caf::error&) { REQUIRE(false); });
+    self->send_exit(dummy, caf::exit_reason::user_shutdown);
+    run();
+    return *result;
+  };
+  using vast::relational_operator;
+  MESSAGE("the sorted column yields exact results");
+  CHECK_EQUAL(count("sorted", relational_operator::less, t0 + 1500ms), 2u);
+  CHECK_EQUAL(count("sorted", relational_operator::greater, t0 + 1500ms), 2u);
+  CHECK_EQUAL(count("sorted", relational_operator::greater_equal, t0 + 1s),
+              3u);
+  CHECK_EQUAL(count("sorted", relational_operator::equal, t0 + 3s), 1u);
+  CHECK_EQUAL(count("sorted", relational_operator::not_equal, t0 + 3s), 3u);
+  CHECK_EQUAL(count("sorted", relational_operator::less, t0), 0u);
+  MESSAGE("the unsorted column falls back to the value index");
+  CHECK_EQUAL(count("unsorted", relational_operator::less_equal, t0 - 2s),
+              2u);
+  self->send_exit(direct_partition, caf::exit_reason::user_shutdown);
   self->send_exit(fs, caf::exit_reason::user_shutdown);
   run();
 }
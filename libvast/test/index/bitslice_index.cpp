@@ -0,0 +1,138 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE value_index
+
+#include "vast/index/bitslice_index.hpp"
+
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/time.hpp"
+#include "vast/concept/printable/to_string.hpp"
+#include "vast/concept/printable/vast/bitmap.hpp"
+#include "vast/detail/deserialize.hpp"
+#include "vast/detail/serialize.hpp"
+#include "vast/index/arithmetic_index.hpp"
+#include "vast/test/test.hpp"
+#include "vast/value_index_factory.hpp"
+
+using namespace vast;
+using namespace std::chrono_literals;
+
+namespace {
+
+struct fixture {
+  fixture() {
+    factory<value_index>::initialize();
+  }
+};
+
+} // namespace
+
+FIXTURE_SCOPE(bitslice_index_tests, fixture)
+
+TEST(bitslice index - integer) {
+  auto idx = bitslice_index<integer::value_type>{integer_type{}};
+  for (auto x : {-7, 42, 0, -7, 1000, 42, -1})
+    REQUIRE(idx.append(make_data_view(integer{x})));
+  auto lookup = [&](relational_operator op, integer::value_type x) {
+    return to_string(unbox(idx.lookup(op, make_data_view(integer{x}))));
+  };
+  CHECK_EQUAL(lookup(relational_operator::equal, -7), "1001000");
+  CHECK_EQUAL(lookup(relational_operator::not_equal, 42), "1011101");
+  CHECK_EQUAL(lookup(relational_operator::less, 0), "1001001");
+  CHECK_EQUAL(lookup(relational_operator::less_equal, 0), "1011001");
+  CHECK_EQUAL(lookup(relational_operator::greater, 42), "0000100");
+  CHECK_EQUAL(lookup(relational_operator::greater_equal, -1), "0110111");
+  CHECK_EQUAL(lookup(relational_operator::equal, 43), "0000000");
+  MESSAGE("membership");
+  auto xs = list{integer{0}, integer{1000}};
+  auto result = idx.lookup(relational_operator::in, make_data_view(xs));
+  CHECK_EQUAL(to_string(unbox(result)), "0010100");
+  MESSAGE("serialization");
+  std::vector<char> buf;
+  CHECK_EQUAL(detail::serialize(buf, idx), caf::none);
+  auto idx2 = bitslice_index<integer::value_type>{integer_type{}};
+  REQUIRE_EQUAL(detail::deserialize(buf, idx2), caf::none);
+  result = idx2.lookup(relational_operator::less, make_data_view(integer{0}));
+  CHECK_EQUAL(to_string(unbox(result)), "1001001");
+}
+
+TEST(bitslice index - time without loss of precision) {
+  auto idx = bitslice_index<vast::time>{time_type{}};
+  auto ts = unbox(to<vast::time>("2014-01-16+05:30:15"));
+  // Append more than a single word to cover the partial last word.
+  for (auto i = 0; i < 100; ++i)
+    REQUIRE(idx.append(make_data_view(ts + i * 10ms)));
+  auto result = idx.lookup(relational_operator::greater_equal,
+                           make_data_view(ts + 985ms));
+  auto expected = ids(99, false);
+  expected.append_bit(true);
+  CHECK_EQUAL(to_string(unbox(result)), to_string(expected));
+  result
+    = idx.lookup(relational_operator::less, make_data_view(ts + 10ms + 1ns));
+  expected = ids(2, true);
+  expected.append_bits(false, 98);
+  CHECK_EQUAL(to_string(unbox(result)), to_string(expected));
+  result = idx.lookup(relational_operator::equal, make_data_view(ts + 500ms));
+  CHECK_EQUAL(rank(unbox(result)), 1u);
+}
+
+TEST(bitslice index - offset) {
+  auto idx = bitslice_index<count>{count_type{}};
+  auto offset = id{1} << 40;
+  for (auto x : {1u, 2u, 3u})
+    REQUIRE(idx.append(make_data_view(count{x}), offset++));
+  MESSAGE("the slices only cover the appended rows");
+  CHECK_LESS_EQUAL(idx.memusage(), 4096u);
+  auto result
+    = unbox(idx.lookup(relational_operator::greater, make_data_view(count{1})));
+  CHECK_EQUAL(result.size(), offset);
+  CHECK_EQUAL(rank(result), 2u);
+  CHECK_EQUAL(select(result, 1), offset - 2);
+}
+
+TEST(bitslice index - precision) {
+  caf::settings opts;
+  opts["precision"] = int64_t{9};
+  auto idx = bitslice_index<vast::duration>{duration_type{}, opts};
+  for (auto x : {1000ms, 2000ms, 3000ms, 911ms, 1011ms, 1411ms, 2222ms})
+    REQUIRE(idx.append(make_data_view(vast::duration{x})));
+  auto lookup = [&](relational_operator op, vast::duration x) {
+    return to_string(unbox(idx.lookup(op, make_data_view(x))));
+  };
+  MESSAGE("lookups include all values in the same bin");
+  CHECK_EQUAL(lookup(relational_operator::equal, 1034ms), "1000110");
+  CHECK_EQUAL(lookup(relational_operator::less, 1200ms), "1001110");
+  CHECK_EQUAL(lookup(relational_operator::greater, 1200ms), "1110111");
+  CHECK_EQUAL(lookup(relational_operator::not_equal, 1200ms), "1111111");
+  CHECK_EQUAL(lookup(relational_operator::less, -1ms), "0000000");
+}
+
+TEST(bitslice index - factory) {
+  type t = time_type{}.attributes({{"index", "bitslice"}, {"precision", "3"}});
+  auto idx = factory<value_index>::make(t, caf::settings{});
+  REQUIRE_NOT_EQUAL(idx, nullptr);
+  CHECK(dynamic_cast<bitslice_index<vast::time>*>(idx.get()) != nullptr);
+  CHECK_EQUAL(caf::get_or(idx->options(), "precision", int64_t{0}), 3);
+  REQUIRE(idx->append(make_data_view(caf::none)));
+  REQUIRE(idx->append(make_data_view(vast::time{} + 1us)));
+  auto bm = idx->lookup(relational_operator::equal,
+                        make_data_view(vast::time{} + 1us));
+  CHECK_EQUAL(to_string(unbox(bm)), "01");
+  MESSAGE("reject invalid precision");
+  t = count_type{}.attributes({{"index", "bitslice"}, {"precision", "x"}});
+  CHECK_EQUAL(factory<value_index>::make(t, caf::settings{}), nullptr);
+  MESSAGE("fall back to the default index for reals");
+  t = real_type{}.attributes({{"index", "bitslice"}});
+  idx = factory<value_index>::make(t, caf::settings{});
+  REQUIRE_NOT_EQUAL(idx, nullptr);
+  CHECK(dynamic_cast<arithmetic_index<real>*>(idx.get()) != nullptr);
+}
+
+FIXTURE_SCOPE_END()
@@ -0,0 +1,96 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE memory_pool
+
+#include "vast/memory_pool.hpp"
+
+#include "vast/fbs/utils.hpp"
+#include "vast/test/test.hpp"
+
+#include <arrow/memory_pool.h>
+#include <flatbuffers/flatbuffers.h>
+
+#include <cstdint>
+#include <cstring>
+
+using namespace vast;
+
+TEST(allocation) {
+  auto pool = memory_pool{-1, false};
+  MESSAGE("small allocations come from the heap");
+  auto* small = pool.allocate(100);
+  REQUIRE(small != nullptr);
+  CHECK_EQUAL(reinterpret_cast<uintptr_t>(small) % memory_pool::alignment,
+              0u);
+  CHECK_EQUAL(pool.bytes_allocated(), 100u);
+  std::memset(small, 42, 100);
+  MESSAGE("growing beyond the threshold maps memory and keeps the contents");
+  auto large_size = memory_pool::mapping_threshold * 2;
+  auto* large = pool.reallocate(small, 100, large_size);
+  REQUIRE(large != nullptr);
+  CHECK(large[99] == std::byte{42});
+  CHECK_EQUAL(pool.bytes_allocated(), large_size);
+  CHECK_EQUAL(pool.peak_bytes_allocated(), large_size + 100);
+  pool.deallocate(large, large_size);
+  CHECK_EQUAL(pool.bytes_allocated(), 0u);
+  MESSAGE("zero-sized allocations succeed without allocating");
+  auto* empty = pool.allocate(0);
+  CHECK(empty != nullptr);
+  pool.deallocate(empty, 0);
+  CHECK_EQUAL(pool.bytes_allocated(), 0u);
+}
+
+TEST(huge pages) {
+  auto pool = memory_pool{-1, true};
+  auto size = memory_pool::huge_page_size + 1;
+  auto* ptr = pool.allocate(size);
+  REQUIRE(ptr != nullptr);
+  ptr[size - 1] = std::byte{1};
+  CHECK_EQUAL(caf::get_or(pool.status(), "mapped-bytes", size_t{0}),
+              2 * memory_pool::huge_page_size);
+  pool.deallocate(ptr, size);
+  CHECK_EQUAL(caf::get_or(pool.status(), "mapped-bytes", size_t{1}), 0u);
+}
+
+TEST(adapters) {
+  auto& pool = memory_pool::local();
+  auto before = pool.bytes_allocated();
+  MESSAGE("arrow");
+  uint8_t* buffer = nullptr;
+  REQUIRE(pool.arrow_pool()->Allocate(256, &buffer).ok());
+  CHECK_EQUAL(pool.arrow_pool()->bytes_allocated(),
+              static_cast<int64_t>(before + 256));
+  REQUIRE(pool.arrow_pool()->Reallocate(256, 512, &buffer).ok());
+  pool.arrow_pool()->Free(buffer, 512);
+  CHECK_EQUAL(pool.bytes_allocated(), before);
+  MESSAGE("flatbuffers");
+  auto chunk = chunk_ptr{};
+  {
+    flatbuffers::FlatBufferBuilder builder{1024,
+                                           pool.flatbuffers_allocator()};
+    builder.Finish(builder.CreateString("foo"));
+    chunk = fbs::release(builder);
+  }
+  CHECK_GREATER(pool.bytes_allocated(), before);
+  chunk = nullptr;
+  CHECK_EQUAL(pool.bytes_allocated(), before);
+}
+
+TEST(global pools) {
+  memory_pool::configure({false, true});
+  auto& pool = memory_pool::local();
+  auto status = memory_pool::global_status();
+  CHECK_EQUAL(caf::get_or(status, "numa", false), true);
+  auto pools = caf::get_if<caf::config_value::list>(&status, "pools");
+  REQUIRE(pools);
+  CHECK_GREATER_EQUAL(pools->size(), 1u);
+  CHECK_GREATER_EQUAL(pool.node(), 0);
+  memory_pool::configure({});
+  CHECK_EQUAL(memory_pool::local().node(), -1);
+}
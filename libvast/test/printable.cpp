@@ -23,6 +23,7 @@
 
 #include <caf/optional.hpp>
 
+#include <limits>
 #include <sstream>
 
 using namespace std::string_literals;
@@ -67,6 +68,23 @@ TEST(unsigned integers) {
   CHECK_EQUAL(str, "42");
 }
 
+TEST(integral digit boundaries) {
+  auto check = [](auto x, std::string expected) {
+    std::string str;
+    CHECK(printers::integral<decltype(x)>(str, x));
+    CHECK_EQUAL(str, expected);
+  };
+  check(0u, "0");
+  check(9u, "9");
+  check(10u, "10");
+  check(99u, "99");
+  check(100u, "100");
+  check(1009u, "1009");
+  check(uint8_t{255}, "255");
+  check(int64_t{-1234567}, "-1234567");
+  check(std::numeric_limits<uint64_t>::max(), "18446744073709551615");
+}
+
 TEST(integral minimum digits) {
   std::string str;
   auto i = 0;
@@ -293,4 +293,73 @@ TEST(erase slice part from persisted segment) {
   CHECK_SLICE(slices[3], 2, 0);
 }
 
+TEST(disk usage) {
+  CHECK_EQUAL(store->disk_usage(), 0u);
+  put(zeek_conn_log);
+  MESSAGE("the active segment does not occupy disk space");
+  CHECK_EQUAL(store->disk_usage(), 0u);
+  store->flush();
+  auto files = segment_files();
+  REQUIRE_EQUAL(files.size(), 1u);
+  auto usage = std::filesystem::file_size(files[0]);
+  CHECK_EQUAL(store->disk_usage(), usage);
+  MESSAGE("erasing a part of a segment leaves it untouched on disk");
+  erase(make_ids({{8, 16}}));
+  CHECK_EQUAL(segment_files(), files);
+  CHECK_EQUAL(store->disk_usage(), usage);
+  MESSAGE("erasing everything frees all tracked disk space");
+  erase(everything);
+  CHECK_EQUAL(store->disk_usage(), 0u);
+}
+
+TEST(erase records tombstones for persisted segments) {
+  put_cold(zeek_conn_log);
+  auto files = segment_files();
+  REQUIRE_EQUAL(files.size(), 1u);
+  erase(make_ids({{10, 14}}));
+  MESSAGE("the segment remains untouched on disk");
+  CHECK_EQUAL(segment_files(), files);
+  CHECK(std::filesystem::exists(store->tombstone_path()));
+  auto slices = get(everything);
+  REQUIRE_EQUAL(slices.size(), 4u);
+  CHECK_SLICE(slices[1], 1, 0, 2);
+  CHECK_SLICE(slices[2], 1, 6, 2);
+  MESSAGE("the tombstones survive a restart");
+  store = nullptr;
+  store = segment_store::make(directory / "segments", 512_KiB, 2);
+  REQUIRE(store != nullptr);
+  slices = get(everything);
+  REQUIRE_EQUAL(slices.size(), 4u);
+  CHECK_SLICE(slices[0], 0, 0);
+  CHECK_SLICE(slices[1], 1, 0, 2);
+  CHECK_SLICE(slices[2], 1, 6, 2);
+  CHECK_SLICE(slices[3], 2, 0);
+  MESSAGE("a small fraction of erased events does not warrant compaction");
+  CHECK(store->compaction_candidates().empty());
+}
+
+TEST(compaction rewrites segments without erased events) {
+  put_hot(zeek_conn_log);
+  auto files = segment_files();
+  REQUIRE_EQUAL(files.size(), 1u);
+  erase(make_ids({{0, 12}}));
+  auto candidates = store->compaction_candidates();
+  REQUIRE_EQUAL(candidates.size(), 1u);
+  CHECK_EQUAL(get(everything).size(), 2u);
+  CHECK_EQUAL(store->compact(candidates[0]), caf::none);
+  CHECK(store->compaction_candidates().empty());
+  auto after = get(everything);
+  REQUIRE_EQUAL(after.size(), 2u);
+  CHECK_SLICE(after[0], 1, 4);
+  CHECK_SLICE(after[1], 2, 0);
+  MESSAGE("the rewritten segment replaces the original one");
+  store = nullptr;
+  auto compacted = segment_files();
+  REQUIRE_EQUAL(compacted.size(), 1u);
+  CHECK_NOT_EQUAL(compacted, files);
+  auto tombstones = std::filesystem::directory_iterator{
+    directory / "segments" / "tombstones"};
+  CHECK(tombstones == std::filesystem::directory_iterator{});
+}
+
 FIXTURE_SCOPE_END()
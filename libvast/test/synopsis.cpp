@@ -11,6 +11,9 @@
 #include "vast/synopsis.hpp"
 
 #include "vast/bool_synopsis.hpp"
+#include "vast/chunk.hpp"
+#include "vast/fbs/utils.hpp"
+#include "vast/qualified_record_field.hpp"
 #include "vast/synopsis_factory.hpp"
 #include "vast/test/fixtures/actor_system.hpp"
 #include "vast/test/synopsis.hpp"
@@ -20,6 +23,11 @@
 #include <caf/binary_deserializer.hpp>
 #include <caf/binary_serializer.hpp>
 
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
 using namespace std::chrono_literals;
 using namespace vast;
 using namespace vast::test;
@@ -85,4 +93,74 @@ TEST(serialization) {
   CHECK_ROUNDTRIP_DEREF(factory<synopsis>::make(time_type{}, caf::settings{}));
 }
 
+TEST(native bloom filter layout) {
+  using namespace nft;
+  factory<synopsis>::initialize();
+  auto t = string_type{}.attributes({{"synopsis", "bloomfilter(1000,0.1)"}});
+  auto x = factory<synopsis>::make(t, caf::settings{});
+  REQUIRE_NOT_EQUAL(x, nullptr);
+  auto foo = std::string{"foo"};
+  auto bar = std::string{"bar"};
+  x->add(make_data_view(foo));
+  flatbuffers::FlatBufferBuilder builder;
+  auto offset = unbox(pack(builder, x, qualified_record_field{}));
+  builder.Finish(offset);
+  auto chunk = fbs::release(builder);
+  const auto* fb = flatbuffers::GetRoot<fbs::synopsis::v0>(chunk->data());
+  REQUIRE_NOT_EQUAL(fb->bloom_filter_synopsis(), nullptr);
+  MESSAGE("unpacking without a chunk copies the Bloom filter");
+  synopsis_ptr copy;
+  REQUIRE_EQUAL(unpack(*fb, copy), caf::none);
+  REQUIRE_NOT_EQUAL(copy, nullptr);
+  CHECK_EQUAL(*copy, *x);
+  MESSAGE("unpacking with a chunk references the Bloom filter in place");
+  synopsis_ptr handle;
+  REQUIRE_EQUAL(unpack(*fb, handle, chunk), caf::none);
+  REQUIRE_NOT_EQUAL(handle, nullptr);
+  CHECK_LESS(handle->memusage(), x->memusage());
+  auto verify = verifier{handle.get()};
+  verify(make_data_view(foo), {N, N, N, N, N, N, T, N, N, N, N, N});
+  CHECK_EQUAL(handle->lookup(relational_operator::equal, make_data_view(bar)),
+              x->lookup(relational_operator::equal, make_data_view(bar)));
+  MESSAGE("a handle serializes like the heap-allocated synopsis");
+  auto y = roundtrip(handle);
+  REQUIRE_NOT_EQUAL(y, nullptr);
+  CHECK_EQUAL(*y, *x);
+}
+
+TEST(concurrent bloom filter lookups) {
+  factory<synopsis>::initialize();
+  auto t = string_type{}.attributes({{"synopsis", "bloomfilter(1000,0.1)"}});
+  auto x = factory<synopsis>::make(t, caf::settings{});
+  REQUIRE_NOT_EQUAL(x, nullptr);
+  auto xs = std::vector<std::string>{};
+  for (auto i = 0; i < 1000; ++i)
+    xs.push_back(std::to_string(i));
+  for (const auto& str : xs)
+    x->add(make_data_view(str));
+  flatbuffers::FlatBufferBuilder builder;
+  auto offset = unbox(pack(builder, x, qualified_record_field{}));
+  builder.Finish(offset);
+  auto chunk = fbs::release(builder);
+  const auto* fb = flatbuffers::GetRoot<fbs::synopsis::v0>(chunk->data());
+  synopsis_ptr handle;
+  REQUIRE_EQUAL(unpack(*fb, handle, chunk), caf::none);
+  REQUIRE_NOT_EQUAL(handle, nullptr);
+  MESSAGE("concurrent lookups never miss an added value");
+  auto misses = std::atomic<size_t>{0};
+  auto threads = std::vector<std::thread>{};
+  for (size_t i = 0; i < 8; ++i)
+    threads.emplace_back([&] {
+      for (auto round = 0; round < 10; ++round)
+        for (const auto& str : xs)
+          for (const auto* y : {x.get(), handle.get()})
+            if (y->lookup(relational_operator::equal, make_data_view(str))
+                != true)
+              ++misses;
+    });
+  for (auto& thread : threads)
+    thread.join();
+  CHECK_EQUAL(misses.load(), 0u);
+}
+
 FIXTURE_SCOPE_END()
@@ -28,7 +28,7 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
   system::archive_actor a;
 
   fixture() {
-    a = self->spawn(system::archive, directory, 10, 1024 * 1024);
+    a = self->spawn(system::archive, directory, 10, 1024 * 1024, 0.5);
   }
 
   void push_to_archive(std::vector<table_slice> xs) {
@@ -45,6 +45,7 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
     run();
     self
       ->do_receive([&](vast::atom::done) { done = true; },
+                   [&](atom::candidate, uint64_t n) { candidates += n; },
                    [&](table_slice slice) {
                      result.push_back(std::move(slice));
                    })
@@ -55,6 +56,8 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
   std::vector<table_slice> query(std::initializer_list<id_range> ranges) {
     return query(make_ids(ranges));
   }
+
+  uint64_t candidates = 0;
 };
 
 } // namespace
@@ -65,6 +68,7 @@ TEST(zeek conn logs slices) {
   push_to_archive(zeek_conn_log);
   auto result = query({{10, 15}});
   CHECK_EQUAL(rows(result), 5u);
+  CHECK_EQUAL(candidates, 5u);
 }
 
 TEST(archiving and querying) {
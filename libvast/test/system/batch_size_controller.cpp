@@ -0,0 +1,124 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE batch_size_controller
+
+#include "vast/system/batch_size_controller.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <caf/settings.hpp>
+
+#include <chrono>
+#include <limits>
+
+using namespace vast;
+using namespace vast::system;
+using namespace std::chrono_literals;
+
+namespace {
+
+batch_size_options adaptive_options() {
+  auto result = batch_size_options{};
+  result.max_size = 10'000;
+  result.adaptive = true;
+  result.min_size = 100;
+  result.target_latency = 1s;
+  result.target_bytes = 1'000'000;
+  return result;
+}
+
+} // namespace
+
+TEST(fixed size) {
+  auto controller = batch_size_controller{batch_size_options{42}};
+  CHECK_EQUAL(controller.size(), 42u);
+  auto now = batch_size_controller::clock::now();
+  controller.observe_input(1, now);
+  controller.observe_input(1, now + 10s);
+  controller.observe_slice(1, 1'000'000);
+  CHECK_EQUAL(controller.size(), 42u);
+}
+
+TEST(event rate) {
+  auto controller = batch_size_controller{adaptive_options()};
+  MESSAGE("start at the maximum size without observations");
+  CHECK_EQUAL(controller.size(), 10'000u);
+  MESSAGE("shrink to the events that arrive within the target latency");
+  auto now = batch_size_controller::clock::now();
+  controller.observe_input(0, now);
+  controller.observe_input(2'000, now + 500ms);
+  CHECK_EQUAL(controller.size(), 10'000u);
+  controller.observe_input(2'000, now + 2s);
+  CHECK_EQUAL(controller.size(), 2'000u);
+  MESSAGE("smooth out changes of the event rate");
+  controller.observe_input(6'000, now + 3s);
+  CHECK_EQUAL(controller.size(), 3'000u);
+  MESSAGE("never drop below the minimum size");
+  for (auto i = 0; i < 50; ++i)
+    controller.observe_input(0, now + 4s + i * 1s);
+  CHECK_EQUAL(controller.size(), 100u);
+}
+
+TEST(event size) {
+  auto controller = batch_size_controller{adaptive_options()};
+  controller.observe_slice(1'000, 500'000);
+  CHECK_EQUAL(controller.size(), 2'000u);
+  controller.observe_slice(0, 0);
+  CHECK_EQUAL(controller.size(), 2'000u);
+}
+
+TEST(report) {
+  auto controller = batch_size_controller{adaptive_options()};
+  controller.observe_slice(10, 100);
+  controller.observe_slice(20, 200);
+  controller.flushed(flush_reason::full);
+  controller.flushed(flush_reason::timeout);
+  controller.flushed(flush_reason::timeout);
+  auto r = report{};
+  controller.append_report("foo", r);
+  auto value = [&](std::string_view key) -> uint64_t {
+    for (const auto& x : r)
+      if (x.key == key)
+        return caf::get<uint64_t>(x.value);
+    FAIL("missing key " << key);
+    return 0;
+  };
+  CHECK_EQUAL(value("foo.batch.size"), 10'000u);
+  CHECK_EQUAL(value("foo.batch.slices"), 2u);
+  CHECK_EQUAL(value("foo.batch.rows"), 30u);
+  CHECK_EQUAL(value("foo.batch.bytes"), 300u);
+  CHECK_EQUAL(value("foo.flush.full"), 1u);
+  CHECK_EQUAL(value("foo.flush.timeout"), 2u);
+  CHECK_EQUAL(value("foo.flush.stalled"), 0u);
+  CHECK_EQUAL(value("foo.flush.error"), 0u);
+  MESSAGE("reporting resets the counters");
+  r.clear();
+  controller.append_report("foo", r);
+  CHECK_EQUAL(value("foo.batch.slices"), 0u);
+  CHECK_EQUAL(value("foo.flush.timeout"), 0u);
+}
+
+TEST(options) {
+  auto options = caf::settings{};
+  auto batching = unbox(batch_size_options::make(options));
+  CHECK_EQUAL(batching.max_size, defaults::import::table_slice_size);
+  CHECK(!batching.adaptive);
+  caf::put(options, "vast.import.batch-size", size_t{0});
+  caf::put(options, "vast.import.batch-adaptive", true);
+  caf::put(options, "vast.import.batch-target-latency", "250ms");
+  batching = unbox(batch_size_options::make(options));
+  CHECK_EQUAL(batching.max_size, std::numeric_limits<size_t>::max());
+  CHECK(batching.adaptive);
+  CHECK(batching.target_latency == duration{250ms});
+  caf::put(options, "vast.import.batch-target-latency", "foo");
+  CHECK(!batch_size_options::make(options));
+  caf::put(options, "vast.import.batch-target-latency", "1s");
+  caf::put(options, "vast.import.batch-size", size_t{10});
+  CHECK(!batch_size_options::make(options));
+}
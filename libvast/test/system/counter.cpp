@@ -42,6 +42,7 @@ namespace {
 
 struct mock_client_state {
   uint64_t count = 0;
+  uint64_t candidate_checks = 0;
   bool received_done = false;
   static inline constexpr const char* name = "mock-client";
 };
@@ -53,6 +54,10 @@ caf::behavior mock_client(mock_client_actor* self) {
             CHECK(!self->state.received_done);
             self->state.count += x;
           },
+          [=](atom::candidate, uint64_t x) {
+            CHECK(!self->state.received_done);
+            self->state.candidate_checks = x;
+          },
           [=](atom::done) { self->state.received_done = true; }};
 }
 
@@ -64,10 +69,11 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
     auto indexdir = directory / "index";
     archive = self->spawn(system::archive, directory / "archive",
                           defaults::system::segments,
-                          defaults::system::max_segment_size);
+                          defaults::system::max_segment_size,
+                          defaults::system::compaction_threshold);
     index = self->spawn(system::index, archive, fs, indexdir,
                         defaults::import::table_slice_size, 100, 3, 1, indexdir,
-                        0.01);
+                        0.01, 0, false, false);
     client = sys.spawn(mock_client);
     // Fill the INDEX with 400 rows from the Zeek conn log.
     detail::spawn_container_source(sys, take(zeek_conn_log_full, 4), index);
@@ -115,15 +121,34 @@ TEST(count IP point query without candidate check) {
   //   | wc -l
   auto& client_state = deref<mock_client_actor>(client).state;
   CHECK_EQUAL(client_state.count, 133u);
+  CHECK_EQUAL(client_state.candidate_checks, 0u);
   CHECK_EQUAL(client_state.received_done, true);
 }
 
-TEST(count IP point query with candidate check) {
+TEST(count IP point query with exact index) {
   MESSAGE("spawn the COUNTER for query ':addr == 192.168.1.104'");
   spawn_aut(":addr == 192.168.1.104", false);
   // Once started, the COUNTER reaches out to the INDEX.
   expect((query), from(aut).to(index));
   run();
+  // The address index answers point queries exactly, so the COUNTER gets the
+  // same result as without candidate check even though the ARCHIVE only
+  // contains the first 300 rows.
+  auto& client_state = deref<mock_client_actor>(client).state;
+  CHECK_EQUAL(client_state.count, 133u);
+  CHECK_EQUAL(client_state.candidate_checks, 0u);
+  CHECK_EQUAL(client_state.received_done, true);
+}
+
+TEST(count IP point query with candidate check) {
+  MESSAGE("spawn the COUNTER for query ':addr == 192.168.1.104 && ts > "
+          "1970-01-01'");
+  // The time index bins its values, so the INDEX cannot answer the second
+  // predicate exactly and must fall back to the ARCHIVE.
+  spawn_aut(":addr == 192.168.1.104 && ts > 1970-01-01", false);
+  // Once started, the COUNTER reaches out to the INDEX.
+  expect((query), from(aut).to(index));
+  run();
   // The magic number 105 was computed via:
   // bro-cut < libvast_test/artifacts/logs/zeek/conn.log
   //   | head -n 300
@@ -131,6 +156,7 @@ TEST(count IP point query with candidate check) {
   //   | wc -l
   auto& client_state = deref<mock_client_actor>(client).state;
   CHECK_EQUAL(client_state.count, 105u);
+  CHECK_GREATER(client_state.candidate_checks, 0u);
   CHECK_EQUAL(client_state.received_done, true);
 }
 
@@ -79,8 +79,9 @@ TEST(zeek conn source) {
   auto& mm = sys.middleman();
   mpx.provide_datagram_servant(8080, hdl);
   auto src = mm.spawn_broker(datagram_source, uint16_t{8080}, std::move(reader),
-                             100u, std::nullopt, type_registry_actor{},
-                             vast::schema{}, std::string{}, accountant_actor{},
+                             batch_size_options{100u}, std::nullopt,
+                             type_registry_actor{}, vast::schema{},
+                             std::string{}, accountant_actor{},
                              std::vector<transform>{});
   run();
   MESSAGE("start sink and initialize stream");
@@ -88,6 +88,15 @@ mock_index(system::index_actor::stateful_pointer<mock_index_state> self) {
       anon_self->send(hdl, atom::done_v);
     },
     [=](atom::erase, uuid) -> ids { FAIL("no mock implementation available"); },
+    [=](atom::erase, time) -> std::vector<uuid> {
+      return {unbox(to<uuid>(uuid_str))};
+    },
+    [=](atom::disk_usage) -> caf::result<uint64_t, std::vector<uuid>> {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::compact, uint64_t) -> std::vector<uuid> {
+      FAIL("no mock implementation available");
+    },
   };
 }
 
@@ -110,7 +119,8 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
   void spawn_aut(std::string query = ":timestamp < 1 week ago") {
     if (index == nullptr)
       FAIL("cannot start AUT without INDEX");
-    aut = sys.spawn(vast::system::eraser, 500ms, std::move(query), index);
+    aut = sys.spawn(vast::system::eraser, 500ms, std::move(query),
+                    duration::zero(), index, system::accountant_actor{});
     sched.run();
   }
 
@@ -140,4 +150,25 @@ TEST(eraser on mock INDEX) {
   }
 }
 
+TEST(eraser with retention on mock INDEX) {
+  aut = sys.spawn(vast::system::eraser, 500ms, std::string{},
+                  duration{std::chrono::hours{24}}, index,
+                  system::accountant_actor{});
+  sched.run();
+  sched.trigger_timeouts();
+  expect((atom::run), from(aut).to(aut));
+  MESSAGE("expired partitions get dropped without a query");
+  expect((atom::erase, time), from(aut).to(index));
+  expect((std::vector<uuid>), from(index).to(aut));
+  MESSAGE("the remaining partitions get queried for expired events");
+  expect((vast::query), from(aut).to(index));
+  expect((uuid, uint32_t, uint32_t),
+         from(index).to(aut).with(query_id, 7u, 3u));
+  expect((atom::done), from(_).to(aut));
+  expect((uuid, uint32_t), from(aut).to(index).with(query_id, 3u));
+  expect((atom::done), from(_).to(aut));
+  expect((uuid, uint32_t), from(aut).to(index).with(query_id, 1u));
+  expect((atom::done), from(_).to(aut));
+}
+
 FIXTURE_SCOPE_END()
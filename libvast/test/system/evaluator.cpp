@@ -18,6 +18,8 @@
 #include "vast/test/fixtures/actor_system_and_events.hpp"
 #include "vast/test/test.hpp"
 
+#include <map>
+#include <string>
 #include <vector>
 
 using namespace vast;
@@ -87,20 +89,29 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
 
   record_type layout;
 
-  ids query(std::string_view expr_str) {
+  /// Evaluates a query. Fields in *known* have no INDEXER; instead, their
+  /// hits get passed to the EVALUATOR directly.
+  ids query(std::string_view expr_str,
+            const std::map<std::string, ids>& known = {}) {
     auto expr = unbox(to<expression>(expr_str));
     std::vector<system::evaluation_triple> triples;
+    system::evaluator_state::predicate_hits_map hits;
     auto resolved = resolve(expr, layout);
     VAST_ASSERT(resolved.size() > 0);
     for (auto& [expr_position, pred] : resolved) {
       VAST_ASSERT(caf::holds_alternative<data_extractor>(pred.lhs));
       auto& dx = caf::get<data_extractor>(pred.lhs);
       std::string field_name = dx.offset.back() == 0 ? "x" : "y";
+      if (auto it = known.find(field_name); it != known.end()) {
+        hits[expr_position].second |= it->second;
+        continue;
+      }
       auto& xs = indexers[field_name];
       for (auto& x : xs)
         triples.emplace_back(expr_position, curried(pred), x);
     }
-    auto eval = sys.spawn(system::evaluator, expr, std::move(triples));
+    auto eval
+      = sys.spawn(system::evaluator, expr, std::move(triples), std::move(hits));
     run();
     self->send(eval, atom::run_v);
     run();
@@ -166,4 +177,14 @@ TEST(disjunctions) {
   CHECK_QUERY("x == 75 || y == 77", ({3, 5}));
 }
 
+TEST(known hits) {
+  auto y_not_10 = make_ids({1, 3, 4, 8}, result_size);
+  MESSAGE("conjunction with known hits on the right-hand side");
+  CHECK_EQUAL(pad_result(query("x == 42 && y != 10", {{"y", y_not_10}})),
+              pad_result(make_ids({1, 3, 4})));
+  MESSAGE("disjunction with known hits on the right-hand side");
+  CHECK_EQUAL(pad_result(query("x == 75 || y != 10", {{"y", y_not_10}})),
+              pad_result(make_ids({1, 3, 4, 5, 8})));
+}
+
 FIXTURE_SCOPE_END()
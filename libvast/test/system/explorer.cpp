@@ -9,12 +9,17 @@
 #define SUITE explorer
 
 #include "vast/system/spawn_explorer.hpp"
+
+#include "vast/data.hpp"
+#include "vast/expression.hpp"
+#include "vast/system/explorer.hpp"
 #include "vast/test/test.hpp"
 #include "vast/time.hpp"
 
 #include <caf/settings.hpp>
 
 using namespace std::chrono_literals;
+using namespace std::string_literals;
 
 TEST(explorer config) {
   {
@@ -67,3 +72,54 @@ TEST(explorer config) {
     CHECK_EQUAL(vast::system::explorer_validate_args(settings), caf::none);
   }
 }
+
+TEST(coalesce timeboxes) {
+  using namespace vast;
+  using system::coalesce_timeboxes;
+  auto at = [](vast::duration x) {
+    return vast::time{} + x;
+  };
+  auto timestamp = type_extractor{time_type{}.name("timestamp")};
+  auto between = [&](vast::time lo, vast::time hi) {
+    return conjunction{
+      predicate{timestamp, relational_operator::greater_equal, data{lo}},
+      predicate{timestamp, relational_operator::less_equal, data{hi}}};
+  };
+  {
+    MESSAGE("Overlapping time boxes merge into one interval.");
+    auto boxes = system::explorer_state::timebox_map{};
+    boxes[data{}]
+      = {{at(40s), at(50s)}, {at(10s), at(20s)}, {at(15s), at(30s)}};
+    auto expected = disjunction{between(at(10s), at(30s)),
+                                between(at(40s), at(50s))};
+    CHECK_EQUAL(coalesce_timeboxes(boxes, true, std::nullopt),
+                expression{expected});
+  }
+  {
+    MESSAGE("Values that share an interval merge into a membership test.");
+    auto boxes = system::explorer_state::timebox_map{};
+    boxes[data{"a"s}] = {{at(10s), at(20s)}};
+    boxes[data{"b"s}] = {{at(12s), at(18s)}, {at(10s), at(20s)}};
+    boxes[data{"c"s}] = {{at(40s), at(50s)}};
+    auto first = between(at(10s), at(20s));
+    first.emplace_back(predicate{field_extractor{"x"},
+                                 relational_operator::in,
+                                 data{list{data{"a"s}, data{"b"s}}}});
+    auto second = between(at(40s), at(50s));
+    second.emplace_back(predicate{field_extractor{"x"},
+                                  relational_operator::equal, data{"c"s}});
+    auto expected = disjunction{std::move(first), std::move(second)};
+    CHECK_EQUAL(coalesce_timeboxes(boxes, true, "x"), expression{expected});
+  }
+  {
+    MESSAGE("Without time boxes only the membership test remains.");
+    auto all = system::explorer_state::timebox{vast::time::min(),
+                                               vast::time::max()};
+    auto boxes = system::explorer_state::timebox_map{};
+    boxes[data{"a"s}] = {all};
+    boxes[data{"b"s}] = {all, all};
+    auto expected = predicate{field_extractor{"x"}, relational_operator::in,
+                              data{list{data{"a"s}, data{"b"s}}}};
+    CHECK_EQUAL(coalesce_timeboxes(boxes, false, "x"), expression{expected});
+  }
+}
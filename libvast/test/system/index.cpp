@@ -27,6 +27,7 @@
 #include "vast/test/fixtures/actor_system_and_events.hpp"
 #include "vast/test/test.hpp"
 
+#include <algorithm>
 #include <filesystem>
 
 using caf::after;
@@ -42,18 +43,22 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
   static constexpr uint32_t taste_count = 4;
   static constexpr size_t num_query_supervisors = 1;
   static constexpr double meta_index_fp_rate = 0.01;
+  static constexpr size_t query_cache_size = 1024 * 1024;
+  static constexpr bool direct_evaluation = false;
   static constexpr size_t segments = 1;
   static constexpr size_t max_segment_size = 8192;
+  static constexpr double compaction_threshold = 0.5;
 
   fixture() {
     auto fs = self->spawn(system::posix_filesystem, directory);
     auto archive_dir = directory / "archive";
     auto index_dir = directory / "index";
-    archive
-      = self->spawn(system::archive, archive_dir, segments, max_segment_size);
+    archive = self->spawn(system::archive, archive_dir, segments,
+                          max_segment_size, compaction_threshold);
     index = self->spawn(system::index, archive, fs, index_dir, slice_size,
                         in_mem_partitions, taste_count, num_query_supervisors,
-                        index_dir, meta_index_fp_rate);
+                        index_dir, meta_index_fp_rate, query_cache_size,
+                        direct_evaluation, false);
   }
 
   ~fixture() {
@@ -91,6 +96,9 @@ struct fixture : fixtures::deterministic_actor_system_and_events {
             // test
             result += slice.rows();
           },
+          [&](atom::candidate, uint64_t) {
+            // nop
+          },
           [&](atom::done) { done = true; },
           caf::others >>
             [](caf::message_view& msg) -> caf::result<caf::message> {
@@ -205,4 +213,69 @@ TEST(iterable zeek conn log query result) {
   }
 }
 
+TEST(compaction) {
+  MESSAGE("ingest " << taste_count << " partitions");
+  auto slices = rebase(first_n(alternating_integers, taste_count));
+  detail::spawn_container_source(sys, slices, archive, index);
+  run();
+  // The last partition stays active.
+  REQUIRE_EQUAL(state().persisted_partitions.size(), taste_count - 1);
+  auto merged = std::vector<uuid>{state().persisted_partitions.begin(),
+                                  state().persisted_partitions.end()};
+  for (const auto& id : merged)
+    REQUIRE(std::filesystem::exists(state().partition_path(id)));
+  auto [query_id, hits, scheduled] = query(":int == +1");
+  auto expected_result = receive_result(query_id, hits, scheduled);
+  CHECK_EQUAL(expected_result, rows(slices) / 2);
+  MESSAGE("merge the persisted partitions");
+  // All persisted partitions are full, so we raise the capacity to make room
+  // for a merged partition.
+  state().partition_capacity = slice_size * taste_count;
+  self->send(index, atom::compact_v, uint64_t{slice_size * 2});
+  run();
+  self->receive(
+    [&](std::vector<uuid>& xs) {
+      std::sort(xs.begin(), xs.end());
+      std::sort(merged.begin(), merged.end());
+      CHECK(xs == merged);
+    },
+    after(0s) >> [&] { FAIL("INDEX did not respond to compaction"); });
+  CHECK_EQUAL(state().persisted_partitions.size(), 1u);
+  CHECK(state().retired_partitions.empty());
+  CHECK(state().merged_partitions.empty());
+  for (const auto& id : merged)
+    CHECK(!std::filesystem::exists(state().partition_path(id)));
+  MESSAGE("query the merged partition");
+  std::tie(query_id, hits, scheduled) = query(":int == +1");
+  auto result = receive_result(query_id, hits, scheduled);
+  CHECK_EQUAL(result, expected_result);
+}
+
+TEST(compaction during a meta index lookup) {
+  auto slices = rebase(first_n(alternating_integers, taste_count));
+  detail::spawn_container_source(sys, slices, archive, index);
+  run();
+  auto merged = std::vector<uuid>{state().persisted_partitions.begin(),
+                                  state().persisted_partitions.end()};
+  MESSAGE("merge while a lookup from before the merge is in flight");
+  auto generation = state().merge_generation;
+  state().meta_index_lookups.insert(generation);
+  state().partition_capacity = slice_size * taste_count;
+  self->send(index, atom::compact_v, uint64_t{slice_size * 2});
+  run();
+  self->receive([](std::vector<uuid>&) {},
+                after(0s) >> [&] { FAIL("INDEX did not respond"); });
+  REQUIRE_EQUAL(state().persisted_partitions.size(), 1u);
+  auto replacement = *state().persisted_partitions.begin();
+  CHECK(state().retired_partitions.empty());
+  MESSAGE("the lookup still sees the replacement of removed partitions");
+  auto candidates = merged;
+  state().replace_merged_partitions(candidates);
+  CHECK(candidates == std::vector<uuid>{replacement});
+  MESSAGE("the replacements go away once the lookup finishes");
+  state().meta_index_lookups.erase(generation);
+  state().forget_merged_partitions();
+  CHECK(state().merged_partitions.empty());
+}
+
 FIXTURE_SCOPE_END()
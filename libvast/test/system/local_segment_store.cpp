@@ -0,0 +1,97 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE local_segment_store
+
+#include "vast/system/local_segment_store.hpp"
+
+#include "vast/ids.hpp"
+#include "vast/system/posix_filesystem.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/test/fixtures/actor_system_and_events.hpp"
+#include "vast/test/test.hpp"
+
+#include <filesystem>
+
+using namespace vast;
+
+namespace {
+
+struct fixture : fixtures::deterministic_actor_system_and_events {
+  fixture() {
+    fs = self->spawn(system::posix_filesystem, directory);
+  }
+
+  template <class Actor>
+  std::vector<table_slice> query(const Actor& store, const ids& xs) {
+    bool done = false;
+    std::vector<table_slice> result;
+    self->send(store,
+               query::make_extract(self, query::extract::drop_ids,
+                                   expression{}),
+               xs);
+    run();
+    self
+      ->do_receive([&](atom::done) { done = true; },
+                   [&](atom::candidate, uint64_t) { /* nop */ },
+                   [&](table_slice slice) {
+                     result.push_back(std::move(slice));
+                   })
+      .until(done);
+    return result;
+  }
+
+  template <class Actor>
+  void erase(const Actor& store, const ids& xs) {
+    self->send(store, atom::erase_v, xs);
+    run();
+    self->receive([](atom::done) {},
+                  [](const caf::error& err) { FAIL(err); });
+  }
+
+  system::filesystem_actor fs;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(local_segment_store_tests, fixture)
+
+TEST(active and passive store) {
+  auto path = directory / "partition";
+  auto store_path = system::local_segment_store_path(path);
+  CHECK_EQUAL(store_path.filename(), "partition.store");
+  auto builder = self->spawn(system::active_local_store, fs);
+  for (const auto& slice : zeek_conn_log)
+    self->send(builder, slice);
+  run();
+  MESSAGE("query the active store");
+  CHECK_EQUAL(rows(query(builder, make_ids({{10, 15}}))), 5u);
+  MESSAGE("erase events before persisting");
+  erase(builder, make_ids({{0, 5}}));
+  CHECK_EQUAL(rows(query(builder, make_ids({{0, 20}}))), 15u);
+  MESSAGE("persist the store");
+  self->send(builder, atom::persist_v, store_path);
+  run();
+  self->receive([](atom::ok) {}, [](const caf::error& err) { FAIL(err); });
+  CHECK(std::filesystem::exists(store_path));
+  MESSAGE("query the passive store");
+  auto store = self->spawn(system::passive_local_store, fs, store_path);
+  run();
+  CHECK_EQUAL(rows(query(store, make_ids({{0, 20}}))), 15u);
+  MESSAGE("erasing some events rewrites the store");
+  erase(store, make_ids({{5, 10}}));
+  CHECK_EQUAL(rows(query(store, make_ids({{0, 20}}))), 10u);
+  CHECK(std::filesystem::exists(store_path));
+  MESSAGE("erasing all events removes the store");
+  erase(store, make_ids({{0, 20}}));
+  CHECK(!std::filesystem::exists(store_path));
+  self->send_exit(builder, caf::exit_reason::user_shutdown);
+  self->send_exit(store, caf::exit_reason::user_shutdown);
+}
+
+FIXTURE_SCOPE_END()
@@ -14,6 +14,7 @@
 #include "vast/concept/parseable/vast/expression.hpp"
 #include "vast/defaults.hpp"
 #include "vast/detail/overload.hpp"
+#include "vast/query.hpp"
 #include "vast/synopsis.hpp"
 #include "vast/synopsis_factory.hpp"
 #include "vast/table_slice.hpp"
@@ -187,6 +188,18 @@ struct fixture : public fixtures::deterministic_actor_system_and_events {
     return lookup(meta_idx, expr);
   }
 
+  auto ordered_lookup(std::string_view expr, enum query::order order) {
+    std::vector<uuid> result;
+    auto q = query::make_erase(unbox(to<expression>(expr)));
+    q.order = order;
+    auto rp = self->request(meta_idx, caf::infinite, std::move(q));
+    run();
+    rp.receive(
+      [&](std::vector<uuid> candidates) { result = std::move(candidates); },
+      [=](caf::error e) { FAIL(render(e)); });
+    return result;
+  }
+
   void merge(meta_index_actor& meta_idx, const vast::uuid& id,
              std::shared_ptr<partition_synopsis> ps) {
     auto rp = self->request(meta_idx, caf::infinite, atom::merge_v, id, ps);
@@ -244,6 +257,20 @@ TEST(attribute extractor - type) {
   CHECK_EQUAL(lookup("#type !~ /x/"), ids);
 }
 
+TEST(time-ordered candidates) {
+  auto oldest_first = ids;
+  auto newest_first = std::vector<uuid>(ids.rbegin(), ids.rend());
+  CHECK_EQUAL(ordered_lookup("#type ~ /f.*/", query::unordered), ids);
+  CHECK_EQUAL(ordered_lookup("#type ~ /f.*/", query::newest_first),
+              newest_first);
+  CHECK_EQUAL(ordered_lookup("#type ~ /f.*/", query::oldest_first),
+              oldest_first);
+  MESSAGE("restrict the candidate set before ordering");
+  CHECK_EQUAL(ordered_lookup(":timestamp >= 1970-01-01+00:00:30.0",
+                             query::newest_first),
+              (std::vector<uuid>{ids[3], ids[2], ids[1]}));
+}
+
 TEST(meta index with bool synopsis) {
   MESSAGE("generate slice data and add it to the meta index");
   // FIXME: do we have to replace the meta index from the fixture with a new
@@ -293,4 +320,79 @@ TEST(meta index with bool synopsis) {
   CHECK_EQUAL(lookup_("y != T"), none);
 }
 
+TEST(snapshot isolation) {
+  auto lookup_snapshot = [](const meta_index_snapshot& snapshot) {
+    auto result = snapshot.lookup(unbox(to<expression>("#type ~ /f.*/")));
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+  meta_index_state state;
+  auto p0 = mock_partition{"foo", ids[0], 0};
+  state.merge(p0.id, make_partition_synopsis(p0.slice));
+  auto before = std::shared_ptr<const meta_index_snapshot>{state.snapshot};
+  MESSAGE("merging copies a snapshot that is still in use");
+  auto p1 = mock_partition{"foobar", ids[1], 1};
+  state.merge(p1.id, make_partition_synopsis(p1.slice));
+  CHECK(before != state.snapshot);
+  CHECK_EQUAL(lookup_snapshot(*before), slice(0));
+  CHECK_EQUAL(lookup_snapshot(*state.snapshot), slice(0, 2));
+  CHECK(before->synopses.at(p0.id) == state.snapshot->synopses.at(p0.id));
+  MESSAGE("erasing modifies an unused snapshot in place");
+  before.reset();
+  auto current = state.snapshot.get();
+  state.erase(p0.id);
+  CHECK(current == state.snapshot.get());
+  CHECK_EQUAL(lookup_snapshot(*state.snapshot), slice(1));
+}
+
+TEST(replacing merged partitions) {
+  meta_index_state state;
+  auto p0 = mock_partition{"foo", ids[0], 0};
+  auto p1 = mock_partition{"foo", ids[1], 1};
+  state.merge(p0.id, make_partition_synopsis(p0.slice));
+  state.merge(p1.id, make_partition_synopsis(p1.slice));
+  auto before = std::shared_ptr<const meta_index_snapshot>{state.snapshot};
+  MESSAGE("replace both partitions with a partition that holds their events");
+  auto merged = make_partition_synopsis(p0.slice);
+  merged.add(p1.slice, caf::settings{});
+  state.replace({p0.id, p1.id}, ids[2], std::move(merged));
+  auto lookup_snapshot = [](const meta_index_snapshot& snapshot,
+                            std::string_view expr) {
+    auto result = snapshot.lookup(unbox(to<expression>(expr)));
+    std::sort(result.begin(), result.end());
+    return result;
+  };
+  CHECK_EQUAL(lookup_snapshot(*before, "#type == \"foo\""), slice(0, 2));
+  CHECK_EQUAL(lookup_snapshot(*state.snapshot, "#type == \"foo\""),
+              slice(2));
+  MESSAGE("the new synopsis covers the time ranges of both partitions");
+  auto range = state.snapshot->time_range(ids[2]);
+  REQUIRE(range);
+  CHECK_EQUAL(range->first, p0.range.from);
+  CHECK_EQUAL(range->second, p1.range.to);
+}
+
+TEST(expired partitions) {
+  meta_index_state state;
+  auto p0 = mock_partition{"foo", ids[0], 0};
+  auto p1 = mock_partition{"foo", ids[1], 1};
+  auto p2 = mock_partition{"foo", ids[2], 2};
+  MESSAGE("add a layout without a timestamp column to the third partition");
+  auto layout = record_type{{"content", string_type{}}}.name("bar");
+  auto builder = factory<table_slice_builder>::make(
+    defaults::import::table_slice_type, layout);
+  REQUIRE(builder->add(make_data_view("bar")));
+  auto untimed = builder->finish();
+  auto ps2 = make_partition_synopsis(p2.slice);
+  ps2.add(untimed, caf::settings{});
+  state.merge(p0.id, make_partition_synopsis(p0.slice));
+  state.merge(p1.id, make_partition_synopsis(p1.slice));
+  state.merge(p2.id, std::move(ps2));
+  MESSAGE("only partitions whose layouts all expired qualify");
+  CHECK_EQUAL(state.snapshot->older_than(p0.range.to), std::vector<uuid>{});
+  CHECK_EQUAL(state.snapshot->older_than(p1.range.from), slice(0));
+  auto later = p2.range.to + std::chrono::hours{1};
+  CHECK_EQUAL(state.snapshot->older_than(later), slice(0, 2));
+}
+
 FIXTURE_SCOPE_END()
@@ -0,0 +1,120 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE metrics
+
+#include "vast/system/metrics.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <thread>
+#include <vector>
+
+using namespace vast;
+using namespace vast::system;
+using namespace std::chrono_literals;
+
+namespace {
+
+const data_point* find(const report& r, std::string_view key) {
+  for (const auto& x : r)
+    if (x.key == key)
+      return &x;
+  return nullptr;
+}
+
+} // namespace
+
+TEST(histogram buckets) {
+  using hist = metric_histogram;
+  for (uint64_t x = 0; x < 16; ++x) {
+    CHECK_EQUAL(hist::bucket(x), x);
+    CHECK_EQUAL(hist::upper_bound(x), x);
+  }
+  CHECK_EQUAL(hist::bucket(16), 16u);
+  CHECK_EQUAL(hist::bucket(31), 31u);
+  CHECK_EQUAL(hist::bucket(32), 32u);
+  CHECK_EQUAL(hist::bucket(33), 32u);
+  CHECK_EQUAL(hist::upper_bound(32), 33u);
+  CHECK_EQUAL(hist::bucket(uint64_t{1} << 60), hist::num_buckets - 1);
+  MESSAGE("every value falls into the bucket that bounds it tightly");
+  for (uint64_t x = 1; x < (uint64_t{1} << 40); x = x * 3 + 1) {
+    auto b = hist::bucket(x);
+    REQUIRE(b < hist::num_buckets);
+    CHECK_GREATER_EQUAL(hist::upper_bound(b), x);
+    CHECK(b == 0 || hist::upper_bound(b - 1) < x);
+    CHECK_LESS_EQUAL(hist::upper_bound(b) - x, x / 16);
+  }
+}
+
+TEST(histogram quantiles) {
+  auto hist = metric_histogram{};
+  for (uint64_t x = 1; x <= 1000; ++x)
+    hist.record(x);
+  auto snapshot = hist.collect();
+  CHECK_EQUAL(snapshot.count, 1000u);
+  CHECK_EQUAL(snapshot.sum, 500500u);
+  CHECK_EQUAL(snapshot.max, 1000u);
+  auto within = [](uint64_t actual, uint64_t expected) {
+    return actual >= expected && actual - expected <= expected / 16;
+  };
+  CHECK(within(snapshot.quantile(0.5), 500));
+  CHECK(within(snapshot.quantile(0.9), 900));
+  CHECK(within(snapshot.quantile(0.99), 990));
+  CHECK_EQUAL(snapshot.quantile(1.0), 1000u);
+  CHECK_EQUAL(snapshot.quantile(0.0), 1u);
+  MESSAGE("collecting resets the histogram");
+  auto empty = hist.collect();
+  CHECK_EQUAL(empty.count, 0u);
+  CHECK_EQUAL(empty.quantile(0.5), 0u);
+}
+
+TEST(concurrent counter) {
+  auto counter = metric_counter{};
+  auto hist = metric_histogram{};
+  auto threads = std::vector<std::thread>{};
+  for (size_t i = 0; i < 8; ++i)
+    threads.emplace_back([&] {
+      for (size_t j = 0; j < 10'000; ++j) {
+        counter.add();
+        hist.record(j);
+      }
+    });
+  for (auto& thread : threads)
+    thread.join();
+  CHECK_EQUAL(counter.collect(), 80'000u);
+  CHECK_EQUAL(counter.collect(), 0u);
+  auto snapshot = hist.collect();
+  CHECK_EQUAL(snapshot.count, 80'000u);
+  CHECK_EQUAL(snapshot.max, 9'999u);
+}
+
+TEST(registry report) {
+  auto& registry = metrics_registry::instance();
+  auto& counter = registry.counter("test.counter");
+  CHECK(&counter == &registry.counter("test.counter"));
+  auto& latency = registry.histogram("test.latency", metric_unit::nanoseconds);
+  registry.histogram("test.unused");
+  counter.add(42);
+  latency.record(duration{2ms});
+  auto r = registry.collect();
+  auto total = find(r, "test.counter");
+  REQUIRE(total != nullptr);
+  CHECK_EQUAL(caf::get<uint64_t>(total->value), 42u);
+  auto count = find(r, "test.latency.count");
+  REQUIRE(count != nullptr);
+  CHECK_EQUAL(caf::get<uint64_t>(count->value), 1u);
+  auto max = find(r, "test.latency.max");
+  REQUIRE(max != nullptr);
+  REQUIRE(caf::holds_alternative<duration>(max->value));
+  CHECK_EQUAL(caf::get<duration>(max->value), duration{2ms});
+  CHECK(find(r, "test.latency.p99") != nullptr);
+  CHECK(find(r, "test.unused.count") == nullptr);
+  MESSAGE("collecting resets the metrics");
+  CHECK(find(registry.collect(), "test.counter") == nullptr);
+}
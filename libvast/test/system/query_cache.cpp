@@ -0,0 +1,95 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE query_cache
+
+#include "vast/system/query_cache.hpp"
+
+#include "vast/data.hpp"
+#include "vast/ids.hpp"
+#include "vast/test/test.hpp"
+
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+struct fixture {
+  fixture() : cache{1024 * 1024} {
+    // nop
+  }
+
+  static curried_predicate equal(integer x) {
+    return {relational_operator::equal, data{x}};
+  }
+
+  uuid p0 = uuid::random();
+  uuid p1 = uuid::random();
+  query_cache cache;
+};
+
+} // namespace
+
+FIXTURE_SCOPE(query_cache_tests, fixture)
+
+TEST(lookup) {
+  CHECK(!cache.lookup({p0, 0, equal(42)}));
+  cache.insert({p0, 0, equal(42)}, make_ids({{10, 20}}));
+  auto hits = cache.lookup({p0, 0, equal(42)});
+  REQUIRE(hits);
+  CHECK_EQUAL(*hits, make_ids({{10, 20}}));
+  MESSAGE("keys differ in partition, field, and predicate");
+  CHECK(!cache.lookup({p1, 0, equal(42)}));
+  CHECK(!cache.lookup({p0, 1, equal(42)}));
+  CHECK(!cache.lookup({p0, 0, equal(43)}));
+  auto stats = cache.statistics();
+  CHECK_EQUAL(stats.hits, 1u);
+  CHECK_EQUAL(stats.misses, 4u);
+  CHECK_EQUAL(stats.entries, 1u);
+  CHECK_GREATER(stats.bytes, 0u);
+}
+
+TEST(normalization) {
+  auto xs = list{integer{3}, integer{1}, integer{2}, integer{1}};
+  auto ys = list{integer{1}, integer{2}, integer{3}};
+  cache.insert({p0, 0, {relational_operator::in, data{xs}}},
+               make_ids({{0, 5}}));
+  CHECK(cache.lookup({p0, 0, {relational_operator::in, data{ys}}}));
+}
+
+TEST(erase) {
+  cache.insert({p0, 0, equal(1)}, make_ids({{0, 5}}));
+  cache.insert({p0, 1, equal(2)}, make_ids({{5, 10}}));
+  cache.insert({p1, 0, equal(1)}, make_ids({{10, 15}}));
+  cache.erase(p0);
+  CHECK(!cache.lookup({p0, 0, equal(1)}));
+  CHECK(!cache.lookup({p0, 1, equal(2)}));
+  CHECK(cache.lookup({p1, 0, equal(1)}));
+  CHECK_EQUAL(cache.statistics().entries, 1u);
+}
+
+TEST(eviction) {
+  cache.insert({p0, 0, equal(0)}, make_ids({{0, 5}}));
+  auto entry_size = cache.statistics().bytes;
+  // Create a cache that holds exactly two entries of the same size.
+  query_cache small{2 * entry_size};
+  small.insert({p0, 0, equal(0)}, make_ids({{0, 5}}));
+  small.insert({p0, 0, equal(1)}, make_ids({{5, 10}}));
+  // Touch the first entry, so the second one is least recently used.
+  CHECK(small.lookup({p0, 0, equal(0)}));
+  small.insert({p0, 0, equal(2)}, make_ids({{10, 15}}));
+  CHECK(small.lookup({p0, 0, equal(0)}));
+  CHECK(!small.lookup({p0, 0, equal(1)}));
+  CHECK(small.lookup({p0, 0, equal(2)}));
+  auto stats = small.statistics();
+  CHECK_EQUAL(stats.evictions, 1u);
+  CHECK_EQUAL(stats.entries, 2u);
+  CHECK_LESS_EQUAL(stats.bytes, small.capacity());
+}
+
+FIXTURE_SCOPE_END()
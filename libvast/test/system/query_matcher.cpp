@@ -0,0 +1,155 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE query_matcher
+
+#include "vast/system/query_matcher.hpp"
+
+#include "vast/bitmap_algorithms.hpp"
+#include "vast/concept/parseable/to.hpp"
+#include "vast/concept/parseable/vast/expression.hpp"
+#include "vast/table_slice.hpp"
+#include "vast/test/fixtures/events.hpp"
+#include "vast/test/test.hpp"
+
+#include <caf/settings.hpp>
+
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
+using namespace vast;
+using namespace vast::system;
+
+namespace {
+
+// Covers all evaluation strategies of the matcher: hashed equality
+// predicates, substring predicates, and row-wise predicates, as well as
+// shared subexpressions and negations.
+constexpr std::string_view queries[] = {
+  R"(service == "dns")",
+  R"(conn_state == "S0")",
+  R"(conn_state == "SF")",
+  R"(history ni "D")",
+  R"(uid ni "Cxlv")",
+  R"(uid ni "does-not-occur")",
+  R"(orig_bytes > 300)",
+  R"(service == "dns" && orig_bytes > 300)",
+  R"(! (conn_state == "SF"))",
+  R"(id.orig_h in 192.168.1.0/24 || history ni "D")",
+  R"(#type == "zeek.conn" && history ni "Dd")",
+};
+
+expression parse(std::string_view str) {
+  return unbox(normalize_and_validate(unbox(to<expression>(str))));
+}
+
+// Evaluates a query the way the EXPORTER does without a matcher.
+ids reference(std::string_view query, const table_slice& slice) {
+  auto expr = unbox(tailor(parse(query), slice.layout()));
+  return evaluate(expr, slice);
+}
+
+} // namespace
+
+FIXTURE_SCOPE(query_matcher_tests, fixtures::events)
+
+TEST(results equal the row-wise evaluation) {
+  auto matcher = query_matcher{};
+  for (size_t i = 0; i < std::size(queries); ++i)
+    REQUIRE_EQUAL(matcher.add(i, parse(queries[i])), caf::none);
+  CHECK_EQUAL(matcher.size(), std::size(queries));
+  for (const auto& slice : zeek_conn_log) {
+    auto matches = matcher.match(slice);
+    auto it = matches.begin();
+    for (size_t i = 0; i < std::size(queries); ++i) {
+      auto expected = reference(queries[i], slice);
+      if (rank(expected) == 0)
+        continue;
+      REQUIRE(it != matches.end());
+      CHECK_EQUAL(it->first, i);
+      CHECK_EQUAL(it->second, expected);
+      ++it;
+    }
+    CHECK(it == matches.end());
+  }
+}
+
+TEST(nil predicates match null values) {
+  constexpr std::string_view nil_queries[] = {
+    R"(service == nil)",
+    R"(service == nil && orig_bytes > 0)",
+  };
+  auto matcher = query_matcher{};
+  for (size_t i = 0; i < std::size(nil_queries); ++i)
+    REQUIRE_EQUAL(matcher.add(i, parse(nil_queries[i])), caf::none);
+  auto matched = false;
+  for (const auto& slice : zeek_conn_log) {
+    auto matches = matcher.match(slice);
+    for (size_t i = 0; i < std::size(nil_queries); ++i) {
+      auto expected = reference(nil_queries[i], slice);
+      auto it = std::find_if(matches.begin(), matches.end(),
+                             [&](const auto& x) { return x.first == i; });
+      if (rank(expected) == 0) {
+        CHECK(it == matches.end());
+        continue;
+      }
+      matched = true;
+      REQUIRE(it != matches.end());
+      CHECK_EQUAL(it->second, expected);
+    }
+  }
+  CHECK(matched);
+}
+
+TEST(queries share predicates) {
+  auto matcher = query_matcher{};
+  REQUIRE_EQUAL(matcher.add(0, parse(R"(service == "dns")")), caf::none);
+  REQUIRE_EQUAL(matcher.add(1, parse(R"(service == "dns" && orig_bytes > 0)")),
+                caf::none);
+  REQUIRE_EQUAL(matcher.add(2, parse(R"(service == "dns")")), caf::none);
+  auto matches = matcher.match(zeek_conn_log[0]);
+  REQUIRE_EQUAL(matches.size(), 3u);
+  CHECK_EQUAL(matches[0].second, matches[2].second);
+  auto status = matcher.status();
+  const auto* layouts = caf::get_if<caf::config_value::list>(&status,
+                                                             "layouts");
+  REQUIRE(layouts != nullptr);
+  REQUIRE_EQUAL(layouts->size(), 1u);
+  const auto* program = caf::get_if<caf::settings>(&layouts->front());
+  REQUIRE(program != nullptr);
+  CHECK_EQUAL(caf::get_or(*program, "name", std::string{}),
+              zeek_conn_log[0].layout().name());
+  MESSAGE("the program contains each distinct predicate once");
+  CHECK_EQUAL(caf::get_or(*program, "predicates", int64_t{0}), 4);
+  CHECK_EQUAL(caf::get_or(*program, "nodes", int64_t{0}), 3);
+  CHECK_EQUAL(caf::get_or(*program, "hashed-predicates", int64_t{0}), 1);
+}
+
+TEST(removing queries) {
+  auto matcher = query_matcher{};
+  REQUIRE_EQUAL(matcher.add(0, parse(R"(service == "dns")")), caf::none);
+  REQUIRE_EQUAL(matcher.add(1, parse(R"(conn_state == "S0")")), caf::none);
+  CHECK(matcher.remove(0));
+  CHECK(!matcher.remove(0));
+  auto matches = matcher.match(zeek_conn_log[0]);
+  for (const auto& [id, _] : matches)
+    CHECK_EQUAL(id, 1u);
+  MESSAGE("queries for other layouts never match");
+  REQUIRE_EQUAL(matcher.add(2, parse(R"(#type == "zeek.dns")")), caf::none);
+  for (const auto& [id, _] : matcher.match(zeek_conn_log[0]))
+    CHECK_NOT_EQUAL(id, 2u);
+}
+
+TEST(invalid queries) {
+  auto matcher = query_matcher{};
+  CHECK_NOT_EQUAL(matcher.add(0, expression{}), caf::none);
+  CHECK_EQUAL(matcher.size(), 0u);
+}
+
+FIXTURE_SCOPE_END()
@@ -70,6 +70,15 @@ mock_index(system::index_actor::stateful_pointer<mock_index_state> self) {
       anon_self->send(hdl, atom::done_v);
     },
     [=](atom::erase, uuid) -> ids { FAIL("no mock implementation available"); },
+    [=](atom::erase, time) -> std::vector<uuid> {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::disk_usage) -> caf::result<uint64_t, std::vector<uuid>> {
+      FAIL("no mock implementation available");
+    },
+    [=](atom::compact, uint64_t) -> std::vector<uuid> {
+      FAIL("no mock implementation available");
+    },
   };
 }
 
@@ -0,0 +1,59 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#define SUITE query_profile
+
+#include "vast/system/query_profile.hpp"
+
+#include "vast/test/test.hpp"
+
+#include <caf/settings.hpp>
+
+#include <chrono>
+
+using namespace vast;
+using namespace vast::system;
+using namespace std::chrono_literals;
+
+TEST(stage names) {
+  CHECK_EQUAL(to_string(query_stage::meta_index), "meta-index");
+  CHECK_EQUAL(to_string(query_stage::candidate_check), "candidate-check");
+  CHECK_EQUAL(to_string(query_stage::sink), "sink");
+}
+
+TEST(aggregation) {
+  auto profile = query_profile{};
+  CHECK(profile.empty());
+  auto t0 = time{} + 1h;
+  profile.add({query_stage::store_lookup, t0, 10ms});
+  profile.add({query_stage::store_lookup, t0 + 5ms, 30ms});
+  profile.add({query_stage::meta_index, t0, 1ms});
+  CHECK(!profile.empty());
+  auto xs = profile.to_settings();
+  CHECK_EQUAL(caf::get_or(xs, "store-lookup.spans", int64_t{0}), 2);
+  CHECK_EQUAL(caf::get_or(xs, "store-lookup.total", duration{}),
+              duration{40ms});
+  CHECK_EQUAL(caf::get_or(xs, "store-lookup.max", duration{}), duration{30ms});
+  MESSAGE("overlapping spans count once towards the wall-clock time");
+  CHECK_EQUAL(caf::get_or(xs, "store-lookup.wall-clock", duration{}),
+              duration{35ms});
+  CHECK_EQUAL(caf::get_or(xs, "meta-index.spans", int64_t{0}), 1);
+  MESSAGE("stages without spans are absent");
+  CHECK(!caf::get_if(&xs, "sink"));
+}
+
+TEST(report) {
+  auto profile = query_profile{};
+  profile.add({query_stage::sink, time{}, 2ms});
+  auto r = report{};
+  profile.append_report("exporter.profile", r);
+  REQUIRE_EQUAL(r.size(), 3u);
+  CHECK_EQUAL(r[0].key, "exporter.profile.sink.spans");
+  CHECK_EQUAL(r[1].key, "exporter.profile.sink.total");
+  CHECK_EQUAL(r[2].key, "exporter.profile.sink.max");
+}
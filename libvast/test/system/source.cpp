@@ -69,7 +69,8 @@ TEST(zeek source) {
                                                        std::move(stream));
   MESSAGE("start source for producing table slices of size 10");
   auto src
-    = self->spawn(source, std::move(reader), events::slice_size, std::nullopt,
+    = self->spawn(source, std::move(reader),
+                  batch_size_options{events::slice_size}, std::nullopt,
                   vast::system::type_registry_actor{}, vast::schema{},
                   std::string{}, vast::system::accountant_actor{},
                   std::vector<vast::transform>{});
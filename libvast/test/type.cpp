@@ -320,6 +320,12 @@ TEST(record flat index computation) {
   using os = std::optional<size_t>;
   static const os invalid;
   CHECK_EQUAL(flat_size(x), 6u);
+  MESSAGE("flat sizes of nested records are cached");
+  auto t = type{x};
+  CHECK_EQUAL(flat_size(t), 6u);
+  CHECK_EQUAL(flat_size(t), 6u);
+  CHECK_EQUAL(flat_size(type{record_type{}}), 0u);
+  CHECK_EQUAL(flat_size(t.name("foo")), 6u);
   CHECK_EQUAL(x.flat_index_at(offset({0, 0, 0})), os(0u));
   CHECK_EQUAL(x.flat_index_at(offset({0, 0, 1})), os(1u));
   CHECK_EQUAL(x.flat_index_at(offset({0, 1, 0, 0})), os(2u));
@@ -687,6 +693,33 @@ TEST(hashable) {
   CHECK_EQUAL(to_digest(x), std::to_string(hash(type{x})));
 }
 
+TEST(fingerprint) {
+  auto hash = [&](auto&& x) { return uhash<xxhash64>{}(x); };
+  CHECK_EQUAL(type{}.fingerprint(), hash(type{}));
+  auto x = type{record_type{{"x", integer_type{}}, {"y", string_type{}}}};
+  CHECK_EQUAL(x.fingerprint(), hash(x));
+  MESSAGE("copies share the cached fingerprint");
+  auto y = x;
+  CHECK_EQUAL(y.fingerprint(), x.fingerprint());
+  CHECK_EQUAL(y, x);
+  MESSAGE("modifiers invalidate the cached fingerprint");
+  y.name("foo");
+  CHECK_EQUAL(y.fingerprint(), hash(y));
+  CHECK_NOT_EQUAL(y.fingerprint(), x.fingerprint());
+  CHECK_NOT_EQUAL(y, x);
+  y.name("");
+  CHECK_EQUAL(y.fingerprint(), x.fingerprint());
+  CHECK_EQUAL(y, x);
+  y.attributes({{"skip"}});
+  CHECK_EQUAL(y.fingerprint(), hash(y));
+  CHECK_NOT_EQUAL(y, x);
+  MESSAGE("equal types that do not share state have equal fingerprints");
+  auto z = type{record_type{{"x", integer_type{}}, {"y", string_type{}}}};
+  CHECK_EQUAL(z.fingerprint(), x.fingerprint());
+  CHECK_EQUAL(z, x);
+  CHECK_EQUAL(std::hash<type>{}(z), x.fingerprint());
+}
+
 TEST(json) {
   auto e = enumeration_type{{"foo", "bar", "baz"}};
   e = e.name("e");
@@ -68,7 +68,8 @@ public:
   [[nodiscard]] table_slice
   finish(span<const std::byte> serialized_layout = {}) override;
 
-  /// @pre `record_batch->schema()->Equals(make_arrow_schema(layout))``
+  /// @pre `record_batch->schema()` equals `make_arrow_schema(layout)`, except
+  /// that string columns may be dictionary-encoded.
   [[nodiscard]] table_slice static create(
     const std::shared_ptr<arrow::RecordBatch>& record_batch,
     const record_type& layout,
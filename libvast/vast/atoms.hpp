@@ -43,12 +43,14 @@ CAF_BEGIN_TYPE_ID_BLOCK(vast_atoms, caf::id_block::vast_types::end)
   VAST_ADD_ATOM(accept, "accept")
   VAST_ADD_ATOM(announce, "announce")
   VAST_ADD_ATOM(batch, "batch")
+  VAST_ADD_ATOM(compact, "compact")
   VAST_ADD_ATOM(config, "config")
   VAST_ADD_ATOM(continuous, "continuous")
   VAST_ADD_ATOM(cpu, "cpu")
   VAST_ADD_ATOM(data, "data")
   VAST_ADD_ATOM(disable, "disable")
   VAST_ADD_ATOM(disconnect, "disconnect")
+  VAST_ADD_ATOM(disk_usage, "diskUsage")
   VAST_ADD_ATOM(done, "done")
   VAST_ADD_ATOM(election, "election")
   VAST_ADD_ATOM(empty, "empty")
@@ -75,6 +77,7 @@ CAF_BEGIN_TYPE_ID_BLOCK(vast_atoms, caf::id_block::vast_types::end)
   VAST_ADD_ATOM(persist, "persist")
   VAST_ADD_ATOM(ping, "ping")
   VAST_ADD_ATOM(plugin, "plugin")
+  VAST_ADD_ATOM(profile, "profile")
   VAST_ADD_ATOM(pong, "pong")
   VAST_ADD_ATOM(progress, "progress")
   VAST_ADD_ATOM(prompt, "prompt")
@@ -59,12 +59,20 @@ public:
     // nop
   }
 
+  /// Constructs a Bloom filter from existing cells.
+  /// @param hasher The hasher type to generate digests.
+  /// @param bits The cells of the Bloom filter.
+  bloom_filter(hasher_type hasher, bitvector<uint64_t> bits)
+    : hasher_{std::move(hasher)}, bits_(std::move(bits)) {
+    // nop
+  }
+
   /// Adds an element to the Bloom filter.
   /// @param x The element to add.
   /// @returns `false` iff *x* already exists in the filter.
   template <class T>
   bool add(T&& x) {
-    auto& digests = hasher_(std::forward<T>(x));
+    auto digests = hasher_(std::forward<T>(x));
     auto unique = false;
     for (size_t i = 0; i < digests.size(); ++i) {
       auto bit = bits_[position(i, digests[i])];
@@ -80,7 +88,7 @@ public:
   ///          according to the false-positive probability of the filter.
   template <class T>
   bool lookup(T&& x) const {
-    auto& digests = hasher_(std::forward<T>(x));
+    auto digests = hasher_(std::forward<T>(x));
     for (size_t i = 0; i < digests.size(); ++i)
       if (!bits_[position(i, digests[i])])
         return false;
@@ -102,6 +110,16 @@ public:
     return hasher_.size();
   }
 
+  /// @returns The hasher that generates the digests.
+  [[nodiscard]] const hasher_type& hasher() const {
+    return hasher_;
+  }
+
+  /// @returns The underlying bit vector.
+  [[nodiscard]] const bitvector<uint64_t>& bits() const {
+    return bits_;
+  }
+
   // -- concepts --------------------------------------------------------------
 
   friend bool operator==(const bloom_filter& x, const bloom_filter& y) {
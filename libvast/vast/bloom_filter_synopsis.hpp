@@ -9,15 +9,62 @@
 #pragma once
 
 #include "vast/bloom_filter.hpp"
+#include "vast/chunk.hpp"
+#include "vast/error.hpp"
+#include "vast/fbs/synopsis.hpp"
 #include "vast/synopsis.hpp"
 #include "vast/type.hpp"
+#include "vast/word.hpp"
 
 #include <caf/deserializer.hpp>
 #include <caf/optional.hpp>
 #include <caf/serializer.hpp>
 
+#include <algorithm>
 #include <optional>
 
+namespace vast::detail {
+
+/// Evaluates a predicate against a Bloom filter.
+/// @param op The operator of the predicate.
+/// @param rhs The RHS of the predicate.
+/// @param contains A function that tests whether the Bloom filter may contain
+///        a `view<T>`.
+/// @returns The evaluation result of `bloom_filter op rhs`.
+template <class T, class Contains>
+std::optional<bool>
+lookup_bloom_filter(relational_operator op, data_view rhs, Contains contains) {
+  switch (op) {
+    default:
+      return {};
+    case relational_operator::equal:
+      // TODO: We should treat 'nil' as a normal value and
+      // hash it, so we can exclude synopsis where all values
+      // are non-nil.
+      if (caf::holds_alternative<view<caf::none_t>>(rhs))
+        return {};
+      if (!caf::holds_alternative<view<T>>(rhs))
+        return false;
+      return contains(caf::get<view<T>>(rhs));
+    case relational_operator::in: {
+      if (auto xs = caf::get_if<view<list>>(&rhs)) {
+        for (auto x : **xs) {
+          if (caf::holds_alternative<view<caf::none_t>>(x))
+            return {};
+          if (!caf::holds_alternative<view<T>>(x))
+            continue;
+          if (contains(caf::get<view<T>>(x)))
+            return true;
+        }
+        return false;
+      }
+      return {};
+    }
+  }
+}
+
+} // namespace vast::detail
+
 namespace vast {
 
 /// A Bloom filter synopsis.
@@ -39,33 +86,9 @@ public:
 
   [[nodiscard]] std::optional<bool>
   lookup(relational_operator op, data_view rhs) const override {
-    switch (op) {
-      default:
-        return {};
-      case relational_operator::equal:
-        // TODO: We should treat 'nil' as a normal value and
-        // hash it, so we can exclude synopsis where all values
-        // are non-nil.
-        if (caf::holds_alternative<view<caf::none_t>>(rhs))
-          return {};
-        if (!caf::holds_alternative<view<T>>(rhs))
-          return false;
-        return bloom_filter_.lookup(caf::get<view<T>>(rhs));
-      case relational_operator::in: {
-        if (auto xs = caf::get_if<view<list>>(&rhs)) {
-          for (auto x : **xs) {
-            if (caf::holds_alternative<view<caf::none_t>>(x))
-              return {};
-            if (!caf::holds_alternative<view<T>>(x))
-              continue;
-            if (bloom_filter_.lookup(caf::get<view<T>>(x)))
-              return true;
-          }
-          return false;
-        }
-        return {};
-      }
-    }
+    return detail::lookup_bloom_filter<T>(op, rhs, [&](const view<T>& x) {
+      return bloom_filter_.lookup(x);
+    });
   }
 
   [[nodiscard]] bool equals(const synopsis& other) const noexcept override {
@@ -79,6 +102,11 @@ public:
     return bloom_filter_.memusage();
   }
 
+  /// @returns The underlying Bloom filter.
+  [[nodiscard]] const bloom_filter_type& filter() const noexcept {
+    return bloom_filter_;
+  }
+
   caf::error serialize(caf::serializer& sink) const override {
     return sink(bloom_filter_);
   }
@@ -91,6 +119,96 @@ protected:
   bloom_filter<HashFunction> bloom_filter_;
 };
 
+/// A read-only Bloom filter synopsis that probes the cells of the native
+/// flatbuffer layout in place. The synopsis keeps the chunk that holds the
+/// flatbuffer alive, which usually maps a partition synopsis file into memory,
+/// such that the cells reside in the page cache instead of the heap.
+template <class T, class HashFunction>
+class mmapped_bloom_filter_synopsis final : public synopsis {
+public:
+  using bloom_filter_type = bloom_filter<HashFunction>;
+  using hasher_type = typename bloom_filter_type::hasher_type;
+
+  /// Constructs a synopsis from a native Bloom filter layout.
+  /// @param x The type of the synopsis.
+  /// @param table The flatbuffer table that describes the Bloom filter.
+  /// @param chunk The chunk that contains *table*, or `nullptr` if the caller
+  ///        guarantees that *table* outlives the synopsis.
+  /// @pre *table* has at least one hash function and cell, and its blocks
+  ///      hold all cells.
+  mmapped_bloom_filter_synopsis(vast::type x,
+                                const fbs::bloom_filter_synopsis::v0& table,
+                                chunk_ptr chunk)
+    : synopsis{std::move(x)},
+      hasher_{table.num_hash_functions(), {table.seed1(), table.seed2()}},
+      num_bits_{table.num_bits()},
+      blocks_{table.bits()},
+      chunk_{std::move(chunk)} {
+    VAST_ASSERT(num_bits_ > 0);
+    VAST_ASSERT(blocks_->size() * word<uint64_t>::width >= num_bits_);
+  }
+
+  void add(data_view) override {
+    VAST_ASSERT(false, "cannot add to a read-only synopsis");
+  }
+
+  [[nodiscard]] std::optional<bool>
+  lookup(relational_operator op, data_view rhs) const override {
+    return detail::lookup_bloom_filter<T>(op, rhs, [&](const view<T>& x) {
+      for (auto digest : hasher_(x)) {
+        auto i = digest % num_bits_;
+        auto block = blocks_->Get(i / word<uint64_t>::width);
+        if ((block & word<uint64_t>::mask(i % word<uint64_t>::width)) == 0)
+          return false;
+      }
+      return true;
+    });
+  }
+
+  [[nodiscard]] bool equals(const synopsis& other) const noexcept override {
+    if (typeid(other) != typeid(mmapped_bloom_filter_synopsis))
+      return false;
+    auto& rhs = static_cast<const mmapped_bloom_filter_synopsis&>(other);
+    return this->type() == rhs.type() && hasher_ == rhs.hasher_
+           && num_bits_ == rhs.num_bits_
+           && std::equal(blocks_->begin(), blocks_->end(),
+                         rhs.blocks_->begin(), rhs.blocks_->end());
+  }
+
+  /// @returns The memory occupied by the handle; the cells themselves are not
+  ///          part of the heap.
+  [[nodiscard]] size_t memusage() const override {
+    return sizeof(mmapped_bloom_filter_synopsis)
+           + hasher_.size() * sizeof(typename HashFunction::result_type);
+  }
+
+  /// Copies the cells into a heap-allocated Bloom filter.
+  [[nodiscard]] bloom_filter_type materialize() const {
+    bitvector<uint64_t> bits;
+    bits.append_blocks(blocks_->begin(), blocks_->end());
+    bits.resize(num_bits_);
+    return bloom_filter_type{hasher_, std::move(bits)};
+  }
+
+  /// Writes the same representation as the equivalent heap-allocated Bloom
+  /// filter synopsis.
+  caf::error serialize(caf::serializer& sink) const override {
+    auto bf = materialize();
+    return sink(bf);
+  }
+
+  caf::error deserialize(caf::deserializer&) override {
+    return caf::make_error(ec::unimplemented, "cannot deserialize into a "
+                                              "read-only synopsis");
+  }
+
+private:
+  hasher_type hasher_;
+  uint64_t num_bits_;
+  const flatbuffers::Vector<uint64_t>* blocks_;
+  chunk_ptr chunk_;
+};
+
 // Because VAST deserializes a synopsis with empty options and
 // construction of an address synopsis fails without any sizing
 // information, we augment the type with the synopsis options.
@@ -16,21 +16,44 @@
 
 namespace vast::detail {
 
+/// Renders the decimal representation of a non-negative integral value.
+/// @param out The output iterator.
+/// @param x The value to print.
+/// @returns The number of printed digits.
+/// @pre `x >= 0`
 template <class Iterator, class T>
 size_t print_numeric(Iterator& out, T x) {
   static_assert(std::is_integral<T>{}, "T must be an integral type");
-  if (x == 0) {
-    *out++ = '0';
-    return 1;
-  }
+  // Lookup table for two digits at a time, which halves the number of
+  // divisions compared to converting one digit at a time.
+  static constexpr char digit_pairs[] = "00010203040506070809"
+                                        "10111213141516171819"
+                                        "20212223242526272829"
+                                        "30313233343536373839"
+                                        "40414243444546474849"
+                                        "50515253545556575859"
+                                        "60616263646566676869"
+                                        "70717273747576777879"
+                                        "80818283848586878889"
+                                        "90919293949596979899";
   char buf[std::numeric_limits<T>::digits10 + 1];
-  auto ptr = buf;
-  while (x > 0) {
-    *ptr++ = byte_to_char(x % 10);
-    x /= 10;
+  auto last = buf + sizeof(buf);
+  auto ptr = last;
+  while (x >= 100) {
+    auto i = static_cast<size_t>(x % 100) * 2;
+    x /= 100;
+    *--ptr = digit_pairs[i + 1];
+    *--ptr = digit_pairs[i];
+  }
+  if (x >= 10) {
+    auto i = static_cast<size_t>(x) * 2;
+    *--ptr = digit_pairs[i + 1];
+    *--ptr = digit_pairs[i];
+  } else {
+    *--ptr = byte_to_char(x);
   }
-  out = std::reverse_copy(buf, ptr, out);
-  return ptr - buf;
+  out = std::copy(ptr, last, out);
+  return last - ptr;
 }
 
 } // namespace vast::detail
@@ -39,9 +39,13 @@ struct integral_printer : printer<integral_printer<T, Policy, MinDigits>> {
 
   template <class Iterator, class U>
   static void pad(Iterator& out, U x) {
-    if (MinDigits > 0) {
-      int magnitude = x == 0 ? 0 : std::log10(x < 0 ? -x : x);
-      for (auto i = 1; i < MinDigits - magnitude; ++i)
+    if constexpr (MinDigits > 0) {
+      // Count digits with integer arithmetic; this is on the hot path for
+      // printing timestamps.
+      auto digits = 1;
+      for (auto y = x; y >= 10; y /= 10)
+        ++digits;
+      for (; digits < MinDigits; ++digits)
         *out++ = '0';
     }
   }
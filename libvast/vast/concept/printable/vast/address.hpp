@@ -10,6 +10,7 @@
 
 #include "vast/address.hpp"
 #include "vast/concept/printable/core/printer.hpp"
+#include "vast/concept/printable/detail/print_numeric.hpp"
 #include "vast/concept/printable/string/string.hpp"
 
 #include <arpa/inet.h>
@@ -25,11 +26,20 @@ struct address_printer : vast::printer<address_printer> {
 
   template <class Iterator>
   bool print(Iterator& out, const address& a) const {
+    // Render IPv4 addresses directly, which is considerably faster than going
+    // through inet_ntop(3).
+    if (a.is_v4()) {
+      auto& bytes = a.data();
+      for (auto i = 12u; i < 16u; ++i) {
+        if (i > 12u)
+          *out++ = '.';
+        detail::print_numeric(out, bytes[i]);
+      }
+      return true;
+    }
     char buf[INET6_ADDRSTRLEN];
     std::memset(buf, 0, sizeof(buf));
-    auto result = a.is_v4()
-      ? inet_ntop(AF_INET, &a.data()[12], buf, INET_ADDRSTRLEN)
-      : inet_ntop(AF_INET6, &a.data(), buf, INET6_ADDRSTRLEN);
+    auto result = inet_ntop(AF_INET6, &a.data(), buf, INET6_ADDRSTRLEN);
     return result != nullptr && printers::str.print(out, result);
   }
 };
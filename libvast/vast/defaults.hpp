@@ -34,6 +34,16 @@ namespace import {
 /// Maximum size for sources that generate table slices.
 constexpr size_t table_slice_size = 1024;
 
+/// Minimum size for adaptively sized table slices.
+constexpr size_t min_table_slice_size = 128;
+
+/// The number of bytes that adaptively sized table slices should not exceed.
+constexpr size_t table_slice_bytes = 4 * 1024 * 1024;
+
+/// The time that adaptively sized table slices should take to fill up.
+constexpr std::chrono::milliseconds batch_target_latency
+  = std::chrono::seconds{1};
+
 /// The default table slice type when arrow is available.
 constexpr auto table_slice_type = table_slice_encoding::arrow;
 
@@ -87,8 +97,22 @@ constexpr size_t max_events_query = 100;
 /// Maximum number of results for every explored context.
 constexpr size_t max_events_context = 100;
 
+/// Maximum number of concurrently running context queries. The contexts of
+/// further results coalesce into the next query.
+constexpr size_t max_running_exporters = 1;
+
 } // namespace explore
 
+// -- constants for the pivot command ------------------------------------------
+
+namespace pivot {
+
+/// Maximum number of concurrently running pivot queries. The pivot values of
+/// further results coalesce into the next query.
+constexpr size_t max_running_exporters = 1;
+
+} // namespace pivot
+
 // -- constants for the export command and its subcommands ---------------------
 
 // Unfortunately, `export` is a reserved keyword. The trailing `_` exists only
@@ -204,15 +228,39 @@ constexpr std::chrono::seconds disk_scan_interval = std::chrono::minutes{1};
 /// Number of partitions to remove before re-checking disk size.
 constexpr size_t disk_monitor_step_size = 1;
 
+/// Interval between two reconciliations of the disk usage ledgers with the
+/// file system.
+constexpr std::chrono::seconds disk_reconcile_interval = std::chrono::hours{1};
+
 /// Maximum number of events per INDEX partition.
 constexpr size_t max_partition_size = 1'048'576; // 1_Mi
 
+/// Interval between two checks for small INDEX partitions to merge. A value
+/// of zero disables partition compaction.
+constexpr std::chrono::seconds partition_compaction_interval
+  = std::chrono::seconds{0};
+
+/// Fraction of the maximum partition size below which the COMPACTOR merges
+/// adjacent INDEX partitions.
+constexpr double partition_compaction_threshold = 0.5;
+
 /// Maximum number of in-memory INDEX partitions.
 constexpr size_t max_in_mem_partitions = 10;
 
 /// Number of immediately scheduled INDEX partitions.
 constexpr size_t taste_partitions = 5;
 
+/// Maximum number of bytes of cached predicate lookups in the INDEX.
+constexpr size_t query_cache_size = 64 * 1'024 * 1'024; // 64_Mi
+
+/// Whether passive partitions evaluate queries without spawning INDEXER and
+/// EVALUATOR actors.
+constexpr bool direct_partition_evaluation = false;
+
+/// Whether active partitions keep their events in a partition-local store
+/// instead of the global archive.
+constexpr bool partition_local_stores = false;
+
 /// Maximum number of concurrent INDEX queries.
 constexpr size_t num_query_supervisors = 10;
 
@@ -222,6 +270,13 @@ constexpr size_t segments = 10;
 /// Maximum size of ARCHIVE segments in MiB.
 constexpr size_t max_segment_size = 1'024;
 
+/// Fraction of erased events at which the ARCHIVE rewrites a segment.
+constexpr double compaction_threshold = 0.5;
+
+/// Time the ARCHIVE waits for a lookup to finish before compacting segments.
+constexpr std::chrono::milliseconds compaction_delay
+  = std::chrono::milliseconds{1000};
+
 /// Number of initial IDs to request in the IMPORTER.
 constexpr size_t initially_requested_ids = 128;
 
@@ -240,6 +240,7 @@ class default_application;
 class export_command;
 class meta_index;
 class node_command;
+class query_cache;
 class remote_command;
 class sink_command;
 class start_command;
@@ -256,8 +257,10 @@ struct component_state;
 struct component_state_map;
 struct data_point;
 struct measurement;
+struct meta_index_snapshot;
 struct node_state;
 struct performance_sample;
+struct query_span;
 struct query_status;
 struct query_status;
 struct spawn_arguments;
@@ -315,6 +318,7 @@ CAF_BEGIN_TYPE_ID_BLOCK(vast_types, caf::first_custom_type_id)
   VAST_ADD_TYPE_ID((vast::detail::stable_map<vast::data, vast::data>))
 
   VAST_ADD_TYPE_ID((vast::system::performance_report))
+  VAST_ADD_TYPE_ID((vast::system::query_span))
   VAST_ADD_TYPE_ID((vast::system::query_status))
   VAST_ADD_TYPE_ID((vast::system::report))
   VAST_ADD_TYPE_ID((vast::system::status_verbosity))
@@ -10,6 +10,7 @@
 
 #include "vast/detail/assert.hpp"
 #include "vast/detail/operators.hpp"
+#include "vast/detail/stack_vector.hpp"
 
 #include <caf/sec.hpp>
 
@@ -41,16 +42,19 @@ struct seeded_hash {
 
 } // namespace detail
 
-/// The CRTP base class for hashers.
+/// The CRTP base class for hashers. Hashing does not modify the hasher, so
+/// concurrent calls on a shared hasher are safe.
 template <class Derived, class DigestType>
 class hasher {
 public:
-  using result_type = const std::vector<DigestType>&;
+  /// The digests of a value. They live on the stack for the common case of a
+  /// few hash functions.
+  using result_type = detail::stack_vector<DigestType, 16 * sizeof(DigestType)>;
 
   /// Constructs a hasher that computes a fixed number of hash digests.
   /// @param k The number of hash digests to compute.
   /// @pre `k > 0`
-  explicit hasher(size_t k) : digests_(k) {
+  explicit hasher(size_t k) : k_{k} {
     VAST_ASSERT(k > 0);
   }
 
@@ -60,14 +64,14 @@ public:
   /// @post `k == size()`
   template <class T>
   result_type operator()(const T& x) const {
-    auto derived = static_cast<const Derived*>(this);
-    const_cast<Derived*>(derived)->hash(x, digests_);
-    return digests_;
+    auto result = result_type(k_);
+    static_cast<const Derived*>(this)->hash(x, result);
+    return result;
   }
 
   /// @returns The number of hash digests this hasher computes.
   size_t size() const {
-    return digests_.size();
+    return k_;
   }
 
   // -- concepts -------------------------------------------------------------
@@ -83,7 +87,7 @@ public:
       auto cb = [&]() -> caf::error {
         if (k == 0)
           return caf::sec::invalid_argument;
-        x.digests_.resize(k);
+        x.k_ = k;
         return caf::none;
       };
       return f(k, caf::meta::load_callback(cb));
@@ -91,7 +95,7 @@ public:
   }
 
 private:
-  mutable std::vector<DigestType> digests_;
+  size_t k_;
 };
 
 /// A hasher that computes *k* digests with *k* hash functions.
@@ -117,7 +121,7 @@ public:
   /// @param T x The value to hash.
   /// @param Ts xs The sequence to write the digests into.
   template <class T, class Ts>
-  void hash(const T& x, Ts& xs) {
+  void hash(const T& x, Ts& xs) const {
     VAST_ASSERT(xs.size() == seeds_.size());
     for (size_t i = 0; i < xs.size(); ++i)
       xs[i] = detail::seeded_hash<HashFunction>{seeds_[i]}(x);
@@ -163,13 +167,18 @@ public:
   /// @param T x The value to hash.
   /// @param Ts xs The sequence to write the digests into.
   template <class T, class Ts>
-  void hash(const T& x, Ts& xs) {
+  void hash(const T& x, Ts& xs) const {
     auto d1 = detail::seeded_hash<HashFunction>{seed1_}(x);
     auto d2 = detail::seeded_hash<HashFunction>{seed2_}(x);
     for (size_t i = 0; i < xs.size(); ++i)
       xs[i] = d1 + i * d2;
   }
 
+  /// @returns The seeds of the two hash functions.
+  [[nodiscard]] std::vector<size_t> seeds() const {
+    return {seed1_, seed2_};
+  }
+
   // -- concepts -------------------------------------------------------------
 
   friend bool operator==(const double_hasher& x, const double_hasher& y) {
@@ -0,0 +1,150 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include <caf/settings.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace arrow {
+
+class MemoryPool;
+
+} // namespace arrow
+
+namespace flatbuffers {
+
+class Allocator;
+
+} // namespace flatbuffers
+
+namespace vast {
+
+/// Configures the memory pools that back ingest buffers.
+struct memory_pool_options {
+  /// Whether to back large allocations with transparent huge pages.
+  bool huge_pages = false;
+
+  /// Whether to keep one pool per NUMA node and allocate from the pool of the
+  /// node that the calling thread runs on.
+  bool numa = false;
+};
+
+/// A thread-safe memory pool for the large and growing buffers of table slice
+/// builders, segment builders, and partition serialization. Large allocations
+/// are mapped directly from the operating system, which allows for binding
+/// them to a NUMA node and backing them with huge pages. Small allocations go
+/// through the global heap.
+///
+/// The pool also offers adapters for Arrow and FlatBuffers. The pools returned
+/// by `memory_pool::local` live until the process terminates, so buffers that
+/// outlive their builder can still release their memory through the adapters.
+class memory_pool {
+public:
+  // -- constants --------------------------------------------------------------
+
+  /// The alignment of all allocations, as required by Arrow.
+  static constexpr size_t alignment = 64;
+
+  /// Allocations of at least this many bytes bypass the global heap.
+  static constexpr size_t mapping_threshold = size_t{1} << 20;
+
+  /// The size of a huge page.
+  static constexpr size_t huge_page_size = size_t{2} << 20;
+
+  // -- constructors, destructors, and assignment operators --------------------
+
+  /// Constructs a memory pool.
+  /// @param node The NUMA node to bind mapped memory to, or -1 for none.
+  /// @param huge_pages Whether to back mapped memory with huge pages.
+  memory_pool(int node, bool huge_pages);
+
+  ~memory_pool() noexcept;
+
+  memory_pool(const memory_pool&) = delete;
+  memory_pool& operator=(const memory_pool&) = delete;
+
+  // -- allocation -------------------------------------------------------------
+
+  /// Allocates a block of memory.
+  /// @param size The number of bytes to allocate.
+  /// @returns A pointer aligned to `alignment`, or `nullptr` on failure.
+  [[nodiscard]] std::byte* allocate(size_t size) noexcept;
+
+  /// Releases a block of memory.
+  /// @param ptr A pointer returned by `allocate` or `reallocate`.
+  /// @param size The size that the block was allocated with.
+  void deallocate(std::byte* ptr, size_t size) noexcept;
+
+  /// Grows or shrinks a block of memory, preserving its contents.
+  /// @param ptr A pointer returned by `allocate` or `reallocate`.
+  /// @param old_size The size that the block was allocated with.
+  /// @param new_size The requested size.
+  /// @returns A pointer to the new block, or `nullptr` on failure, in which
+  /// case the old block remains valid.
+  [[nodiscard]] std::byte*
+  reallocate(std::byte* ptr, size_t old_size, size_t new_size) noexcept;
+
+  // -- adapters ---------------------------------------------------------------
+
+  /// @returns An Arrow memory pool that allocates from this pool.
+  [[nodiscard]] arrow::MemoryPool* arrow_pool() noexcept;
+
+  /// @returns A FlatBuffers allocator that allocates from this pool.
+  [[nodiscard]] flatbuffers::Allocator* flatbuffers_allocator() noexcept;
+
+  // -- properties -------------------------------------------------------------
+
+  /// @returns The NUMA node of the pool, or -1 if not bound to a node.
+  [[nodiscard]] int node() const noexcept;
+
+  /// @returns The number of bytes currently allocated.
+  [[nodiscard]] size_t bytes_allocated() const noexcept;
+
+  /// @returns The highest number of bytes allocated at a time.
+  [[nodiscard]] size_t peak_bytes_allocated() const noexcept;
+
+  /// @returns Memory usage statistics of the pool.
+  [[nodiscard]] caf::settings status() const;
+
+  // -- global pools -----------------------------------------------------------
+
+  /// Replaces the global pools. Takes effect for builders constructed
+  /// afterwards; previous pools stay alive for their outstanding buffers.
+  static void configure(const memory_pool_options& options);
+
+  /// @returns The pool for the NUMA node of the calling thread.
+  static memory_pool& local();
+
+  /// @returns Memory usage statistics of all global pools.
+  static caf::settings global_status();
+
+private:
+  struct adapters;
+
+  /// Maps a block of memory directly from the operating system.
+  std::byte* map(size_t size) noexcept;
+
+  /// Updates the statistics after allocating or releasing memory.
+  void account(size_t size, bool allocated) noexcept;
+
+  const int node_;
+  const bool huge_pages_;
+  std::atomic<size_t> bytes_allocated_{0};
+  std::atomic<size_t> peak_bytes_allocated_{0};
+  std::atomic<size_t> mapped_bytes_{0};
+  std::atomic<size_t> allocations_{0};
+  std::unique_ptr<adapters> adapters_;
+};
+
+} // namespace vast
@@ -11,6 +11,10 @@
 #include "vast/qualified_record_field.hpp"
 #include "vast/synopsis.hpp"
 #include "vast/table_slice.hpp"
+#include "vast/time.hpp"
+
+#include <optional>
+#include <utility>
 
 namespace vast {
 
@@ -28,6 +32,11 @@ struct partition_synopsis {
   ///          synopsis.
   size_t memusage() const;
 
+  /// Retrieves the time range that the time synopses cover.
+  /// @returns The oldest and newest timestamp in the partition, or
+  ///          `std::nullopt` if the partition has no time information.
+  [[nodiscard]] std::optional<std::pair<time, time>> time_range() const;
+
   /// Synopsis data structures for types.
   std::unordered_map<type, synopsis_ptr> type_synopses_;
 
@@ -41,6 +50,11 @@ struct partition_synopsis {
 
   friend caf::error
   unpack(const fbs::partition_synopsis::v0&, partition_synopsis&);
+
+  /// Unpacks a partition synopsis whose Bloom filter synopses reference the
+  /// chunk that contains the flatbuffer instead of copying it.
+  friend caf::error unpack(const fbs::partition_synopsis::v0&,
+                           partition_synopsis&, chunk_ptr chunk);
 };
 
 } // namespace vast
@@ -19,7 +19,7 @@ namespace vast {
 struct query {
   struct count {
     enum mode { estimate, exact };
-    system::receiver_actor<uint64_t> sink;
+    system::count_sink_actor sink;
     enum mode mode = {};
 
     friend bool operator==(const count& lhs, const count& rhs) {
@@ -34,16 +34,20 @@ struct query {
 
   struct extract {
     enum mode { drop_ids, preserve_ids };
-    system::receiver_actor<table_slice> sink;
+    system::extract_sink_actor sink;
     mode policy = {};
+    /// Whether the stages of the query send timed spans to the sink.
+    bool profile = false;
 
     friend bool operator==(const extract& lhs, const extract& rhs) {
-      return lhs.sink == rhs.sink && lhs.policy == rhs.policy;
+      return lhs.sink == rhs.sink && lhs.policy == rhs.policy
+             && lhs.profile == rhs.profile;
     }
 
     template <class Inspector>
     friend auto inspect(Inspector& f, extract& x) {
-      return f(caf::meta::type_name("vast.query.extract"), x.sink, x.policy);
+      return f(caf::meta::type_name("vast.query.extract"), x.sink, x.policy,
+               x.profile);
     }
   };
 
@@ -60,23 +64,27 @@ struct query {
 
   using command = caf::variant<erase, count, extract>;
 
+  /// The order in which the INDEX schedules candidate partitions, based on
+  /// the time range that their time synopses cover.
+  enum order { unordered, newest_first, oldest_first };
+
   command cmd;
   expression expr = {};
+  enum order order = unordered;
 
   // -- Helper functions to make query creation less boiler-platey.
 
   template <class Actor>
   static query
   make_count(const Actor& sink, enum count::mode m, expression expr) {
-    return {count{caf::actor_cast<system::receiver_actor<uint64_t>>(sink), m},
+    return {count{caf::actor_cast<system::count_sink_actor>(sink), m},
             std::move(expr)};
   }
 
   template <class Actor>
   static query
   make_extract(const Actor& sink, extract::mode p, expression expr) {
-    return {extract{caf::actor_cast<system::receiver_actor<table_slice>>(sink),
-                    p},
+    return {extract{caf::actor_cast<system::extract_sink_actor>(sink), p},
             std::move(expr)};
   }
 
@@ -87,12 +95,13 @@ struct query {
   // -- Helper functions to make query creation less boiler-platey.
 
   friend bool operator==(const query& lhs, const query& rhs) {
-    return lhs.cmd == rhs.cmd && lhs.expr == rhs.expr;
+    return lhs.cmd == rhs.cmd && lhs.expr == rhs.expr
+           && lhs.order == rhs.order;
   }
 
   template <class Inspector>
   friend auto inspect(Inspector& f, query& q) {
-    return f(caf::meta::type_name("vast.query"), q.cmd, q.expr);
+    return f(caf::meta::type_name("vast.query"), q.cmd, q.expr, q.order);
   }
 };
 
@@ -19,7 +19,10 @@ enum class query_options : uint32_t {
   none = 0x00,
   historical = 0x01,
   continuous = 0x02,
-  preserve_ids = 0x04
+  preserve_ids = 0x04,
+  newest_first = 0x08,
+  oldest_first = 0x10,
+  profile = 0x20
 };
 
 /// Concatenates two query options.
@@ -34,6 +37,9 @@ constexpr query_options historical = query_options::historical;
 constexpr query_options continuous = query_options::continuous;
 constexpr query_options unified = historical + continuous;
 constexpr query_options preserve_ids = query_options::preserve_ids;
+constexpr query_options newest_first = query_options::newest_first;
+constexpr query_options oldest_first = query_options::oldest_first;
+constexpr query_options profile = query_options::profile;
 
 constexpr bool has_query_option(query_options haystack, query_options needle) {
   return (static_cast<uint32_t>(haystack) & static_cast<uint32_t>(needle)) != 0;
@@ -56,4 +62,16 @@ constexpr bool has_preserve_ids_option(query_options opts) {
   return has_query_option(opts, preserve_ids);
 }
 
+constexpr bool has_newest_first_option(query_options opts) {
+  return has_query_option(opts, newest_first);
+}
+
+constexpr bool has_oldest_first_option(query_options opts) {
+  return has_query_option(opts, oldest_first);
+}
+
+constexpr bool has_profile_option(query_options opts) {
+  return has_query_option(opts, profile);
+}
+
 } // namespace vast
@@ -10,8 +10,10 @@
 
 #include "vast/fwd.hpp"
 
+#include "vast/defaults.hpp"
 #include "vast/detail/cache.hpp"
 #include "vast/detail/range_map.hpp"
+#include "vast/ids.hpp"
 #include "vast/segment.hpp"
 #include "vast/segment_builder.hpp"
 #include "vast/uuid.hpp"
@@ -22,6 +24,8 @@
 #endif
 
 #include <filesystem>
+#include <unordered_map>
+#include <vector>
 
 namespace vast {
 
@@ -29,6 +33,12 @@ namespace vast {
 using segment_store_ptr = std::unique_ptr<segment_store>;
 
 /// A store that keeps its data in terms of segments.
+///
+/// Erasing events from a segment on disk does not rewrite the segment.
+/// Instead, the store records the erased events in a deletion bitmap per
+/// segment, a *tombstone*, which lookups apply as a filter. Segments get
+/// rewritten only when compacting them, which is worthwhile once a large
+/// enough fraction of their events is gone.
 class segment_store {
 public:
   // -- helper types -----------------------------------------------------------
@@ -59,10 +69,14 @@ public:
   /// @param dir The directory where to store state.
   /// @param max_segment_size The maximum segment size in bytes.
   /// @param in_memory_segments The number of semgents to cache in memory.
+  /// @param compaction_threshold The fraction of erased events at which a
+  /// segment qualifies for compaction.
   /// @pre `max_segment_size > 0`
   static segment_store_ptr
   make(std::filesystem::path dir, size_t max_segment_size,
-       size_t in_memory_segments);
+       size_t in_memory_segments,
+       double compaction_threshold
+       = defaults::system::compaction_threshold);
 
   // -- properties -------------------------------------------------------------
 
@@ -71,6 +85,11 @@ public:
     return dir_ / "segments";
   }
 
+  /// @returns the path for storing the tombstones of segments.
+  std::filesystem::path tombstone_path() const {
+    return dir_ / "tombstones";
+  }
+
   /// @returns whether the store has no unwritten data pending.
   bool dirty() const noexcept {
     return builder_.table_slice_bytes() != 0;
@@ -86,6 +105,12 @@ public:
     return cache_.count(x) != 0;
   }
 
+  /// @returns the number of bytes that the segments of the store occupy on
+  /// disk, as tracked when writing and deleting them.
+  uint64_t disk_usage() const noexcept {
+    return disk_usage_;
+  }
+
   // -- cache management -------------------------------------------------------
 
   /// Evicts all segments from the cache.
@@ -107,9 +132,19 @@ public:
 
   void inspect_status(caf::settings& xs, system::status_verbosity v);
 
+  // -- compaction -------------------------------------------------------------
+
+  /// @returns the segments whose fraction of erased events reached the
+  /// compaction threshold.
+  std::vector<uuid> compaction_candidates() const;
+
+  /// Rewrites a segment without its erased events, and drops its tombstone.
+  /// @param id The segment to compact.
+  caf::error compact(const uuid& id);
+
 private:
   segment_store(std::filesystem::path dir, uint64_t max_segment_size,
-                size_t in_memory_segments);
+                size_t in_memory_segments, double compaction_threshold);
 
   // -- utility functions ------------------------------------------------------
 
@@ -117,12 +152,43 @@ private:
 
   caf::error register_segment(const std::filesystem::path& filename);
 
+  /// Loads the tombstones of all registered segments, and removes the
+  /// tombstones of segments that no longer exist.
+  caf::error register_tombstones();
+
   caf::expected<segment> load_segment(uuid id) const;
 
   /// Fills `candidates` with all segments that qualify for `selection`.
   caf::error
   select_segments(const ids& selection, std::vector<uuid>& candidates) const;
 
+  /// @returns the IDs of all events in a segment.
+  ids segment_ids(const uuid& id) const;
+
+  /// Removes the erased events of a segment from a selection.
+  ids live(const uuid& id, const ids& xs) const;
+
+  /// Removes the erased events of a segment from its table slices.
+  std::vector<table_slice>
+  prune(const uuid& id, std::vector<table_slice> slices) const;
+
+  /// Adds events to the tombstone of a segment on disk, and drops the segment
+  /// once the tombstone covers all of its events.
+  /// @returns The number of newly erased events.
+  caf::expected<uint64_t> tombstone(const uuid& id, const ids& xs);
+
+  /// Writes the tombstone of a segment to disk.
+  caf::error persist_tombstone(const uuid& id) const;
+
+  /// Removes the tombstone of a segment from memory and from disk.
+  void drop_tombstone(const uuid& id);
+
+  /// Replaces a segment with a new one that lacks the events in `xs`, or
+  /// updates the segment-under-construction in place.
+  /// @returns The number of erased events.
+  template <class Segment>
+  uint64_t rewrite(Segment& seg, const ids& xs);
+
   /// Drops an entire segment and erases its content from disk.
   /// @param x The segment to drop.
   /// @returns The number of events in `x`.
@@ -134,6 +200,12 @@ private:
   /// @returns The number of events in `x`.
   uint64_t drop(segment_builder& x);
 
+  /// Records the size of a segment file in the disk usage ledger.
+  void track(const uuid& id, uint64_t bytes);
+
+  /// Removes a segment file from the disk usage ledger.
+  void untrack(const uuid& id);
+
   // -- member variables -------------------------------------------------------
 
   /// Identifies the base directory for segments.
@@ -152,6 +224,19 @@ private:
 
   /// Serializes table slices into contiguous chunks of memory.
   segment_builder builder_;
+
+  /// Maps the IDs of segments on disk to the size of their files.
+  std::unordered_map<uuid, uint64_t> segment_bytes_;
+
+  /// The sum of `segment_bytes_`.
+  uint64_t disk_usage_ = 0;
+
+  /// Maps the IDs of segments on disk to the IDs of their erased events.
+  std::unordered_map<uuid, ids> tombstones_;
+
+  /// The fraction of erased events at which a segment qualifies for
+  /// compaction.
+  double compaction_threshold_;
 };
 
 } // namespace vast
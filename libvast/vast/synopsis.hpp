@@ -102,4 +102,9 @@ pack(flatbuffers::FlatBufferBuilder& builder, const synopsis_ptr&,
 
 caf::error unpack(const fbs::synopsis::v0&, synopsis_ptr&);
 
+/// Unpacks a synopsis from a flatbuffer that resides in a chunk. Synopses with
+/// a native Bloom filter layout probe the chunk directly instead of copying
+/// its contents to the heap, and keep the chunk alive.
+caf::error unpack(const fbs::synopsis::v0&, synopsis_ptr&, chunk_ptr chunk);
+
 } // namespace vast
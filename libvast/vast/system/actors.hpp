@@ -94,6 +94,23 @@ using receiver_actor = typename typed_actor_fwd<
   // Add a new source.
   typename caf::reacts_to<T, Ts...>>::unwrap;
 
+/// The COUNT SINK actor interface.
+using count_sink_actor = typed_actor_fwd<
+  // Receives a partial result of a count query.
+  caf::reacts_to<uint64_t>,
+  // Learns that a partition needed a candidate check in the STORE to produce
+  // an exact count.
+  caf::reacts_to<atom::candidate, uuid>>::unwrap;
+
+/// The EXTRACT SINK actor interface.
+using extract_sink_actor = typed_actor_fwd<
+  // Receives events that satisfy the query.
+  caf::reacts_to<table_slice>,
+  // Learns how many candidate events the STORE checked.
+  caf::reacts_to<atom::candidate, uint64_t>,
+  // Receives a timed section of a profiled query.
+  caf::reacts_to<atom::profile, query_span>>::unwrap;
+
 /// The STATUS CLIENT actor interface.
 using status_client_actor = typed_actor_fwd<
   // Reply to a status request from the NODE.
@@ -108,6 +125,12 @@ using store_actor = typed_actor_fwd<
   // Erase the events with the given ids.
   caf::replies_to<atom::erase, ids>::with<atom::done>>::unwrap;
 
+/// The CANDIDATE CHECKER actor interface.
+using candidate_checker_actor = typed_actor_fwd<
+  // Evaluates the query on the rows of a table slice that are in the given
+  // ids, and sends the result to the sink of the query.
+  caf::replies_to<query, table_slice, ids>::with<atom::done>>::unwrap;
+
 /// The STORE BUILDER actor interface.
 using store_builder_actor = typed_actor_fwd<>::extend_with<store_actor>
   // Conform to the protocol of the STREAM SINK actor for table slices.
@@ -115,6 +138,17 @@ using store_builder_actor = typed_actor_fwd<>::extend_with<store_actor>
   // Conform to the protocol of the STATUS CLIENT actor.
   ::extend_with<status_client_actor>::unwrap;
 
+/// The PARTITION STORE BUILDER actor interface.
+using partition_store_builder_actor = typed_actor_fwd<
+  // Adds a table slice to the store.
+  caf::reacts_to<table_slice>,
+  // Writes the store to the given path.
+  caf::replies_to<atom::persist, std::filesystem::path>::with<atom::ok>>
+  // Conform to the protocol of the STORE actor.
+  ::extend_with<store_actor>
+  // Conform to the protocol of the STATUS CLIENT actor.
+  ::extend_with<status_client_actor>::unwrap;
+
 /// The PARTITION actor interface.
 using partition_actor = typed_actor_fwd<
   // Evaluate the given expression and send the matching events to the receiver.
@@ -187,6 +221,16 @@ using query_supervisor_master_actor = typed_actor_fwd<
   // Enlist the QUERY SUPERVISOR as an available worker.
   caf::reacts_to<atom::worker, query_supervisor_actor>>::unwrap;
 
+/// The META INDEX READER actor interface.
+using meta_index_reader_actor = typed_actor_fwd<
+  // Evaluate the expression on a snapshot of the META INDEX.
+  caf::replies_to<std::shared_ptr<const meta_index_snapshot>,
+                  expression>::with<std::vector<uuid>>,
+  // Evaluate the expression of a query on a snapshot of the META INDEX and
+  // order the candidates as requested by the query.
+  caf::replies_to<std::shared_ptr<const meta_index_snapshot>,
+                  query>::with<std::vector<uuid>>>::unwrap;
+
 /// The META INDEX actor interface.
 using meta_index_actor = typed_actor_fwd<
   // Bulk import a set of partition synopses.
@@ -197,8 +241,18 @@ using meta_index_actor = typed_actor_fwd<
     atom::ok>,
   // Erase a single partition synopsis.
   caf::replies_to<atom::erase, uuid>::with<atom::ok>,
+  // Atomically replace a set of partition synopses with a single one.
+  caf::replies_to<atom::replace, std::vector<uuid>, uuid,
+                  std::shared_ptr<partition_synopsis>>::with<atom::ok>,
+  // Retrieve the partitions whose events all precede the given time.
+  caf::replies_to<atom::get, atom::timestamp, time>::with< //
+    std::vector<uuid>>,
   // Evaluate the expression.
   caf::replies_to<expression>::with< //
+    std::vector<uuid>>,
+  // Evaluate the expression of a query and order the candidates as requested
+  // by the query.
+  caf::replies_to<query>::with< //
     std::vector<uuid>>>::unwrap;
 
 /// The INDEX actor interface.
@@ -214,7 +268,17 @@ using index_actor = typed_actor_fwd<
   // Queries PARTITION actors for a given query id.
   caf::reacts_to<uuid, uint32_t>,
   // Erases the given events from the INDEX, and returns their ids.
-  caf::replies_to<atom::erase, uuid>::with<ids>>
+  caf::replies_to<atom::erase, uuid>::with<ids>,
+  // Erases all persisted partitions whose events all precede the given time,
+  // and returns their IDs.
+  caf::replies_to<atom::erase, time>::with<std::vector<uuid>>,
+  // Retrieves the number of bytes that the persisted partitions occupy on
+  // disk, and the persisted partitions ordered from oldest to newest.
+  caf::replies_to<atom::disk_usage>::with<uint64_t, std::vector<uuid>>,
+  // Merges the oldest run of adjacent persisted partitions with fewer than
+  // the given number of events each, and returns the IDs of the merged
+  // partitions.
+  caf::replies_to<atom::compact, uint64_t>::with<std::vector<uuid>>>
   // Conform to the protocol of the STREAM SINK actor for table slices.
   ::extend_with<stream_sink_actor<table_slice>>
   // Conform to the protocol of the QUERY SUPERVISOR MASTER actor.
@@ -229,8 +293,12 @@ using archive_actor = typed_actor_fwd<
   // INTERNAL: Handles a query for the given ids, and sends the table slices
   // back to the client.
   caf::reacts_to<atom::internal, atom::resume>,
+  // INTERNAL: Compacts the next segment that has many erased events.
+  caf::reacts_to<atom::internal, atom::compact>,
   // The internal telemetry loop of the ARCHIVE.
-  caf::reacts_to<atom::telemetry>>
+  caf::reacts_to<atom::telemetry>,
+  // Retrieves the number of bytes that the segments occupy on disk.
+  caf::replies_to<atom::disk_usage>::with<uint64_t>>
   // Conform to the protocol of the STORE BUILDER actor.
   ::extend_with<store_builder_actor>::unwrap;
 
@@ -267,6 +335,15 @@ using disk_monitor_actor = typed_actor_fwd<
   // Conform to the protocol of the STATUS CLIENT actor.
   ::extend_with<status_client_actor>::unwrap;
 
+/// The COMPACTOR actor interface.
+using compactor_actor = typed_actor_fwd<
+  // Checks for small partitions to merge.
+  caf::reacts_to<atom::ping>,
+  // INTERNAL: Merges the next run of small partitions.
+  caf::reacts_to<atom::compact>>
+  // Conform to the protocol of the STATUS CLIENT actor.
+  ::extend_with<status_client_actor>::unwrap;
+
 /// The interface for file system I/O. The filesystem actor implementation
 /// must interpret all operations that contain paths *relative* to its own
 /// root directory.
@@ -298,6 +375,13 @@ using active_partition_actor = typed_actor_fwd<
   // Conform to the protocol of the PARTITION actor.
   ::extend_with<partition_actor>::unwrap;
 
+/// The PARTITION MERGER actor interface.
+using partition_merger_actor = typed_actor_fwd<
+  // Merges the partitions and returns the synopsis of the new partition.
+  caf::replies_to<atom::run>::with<std::shared_ptr<partition_synopsis>>>
+  // Conform to the protocol of the EXTRACT SINK actor.
+  ::extend_with<extract_sink_actor>::unwrap;
+
 /// The interface of the EXPORTER actor.
 using exporter_actor = typed_actor_fwd<
   // Request extraction of all events.
@@ -314,10 +398,22 @@ using exporter_actor = typed_actor_fwd<
   caf::reacts_to<atom::run>,
   // Execute previously registered query.
   caf::reacts_to<atom::done>,
-  // Execute previously registered query.
-  caf::reacts_to<table_slice>,
   // Register a STATISTICS SUBSCRIBER actor.
   caf::reacts_to<atom::statistics, caf::actor>>
+  // Conform to the protocol of the EXTRACT SINK actor.
+  ::extend_with<extract_sink_actor>
+  // Conform to the protocol of the STREAM SINK actor for table slices.
+  ::extend_with<stream_sink_actor<table_slice>>
+  // Conform to the protocol of the STATUS CLIENT actor.
+  ::extend_with<status_client_actor>::unwrap;
+
+/// The MATCHER actor interface.
+using matcher_actor = typed_actor_fwd<
+  // Registers a standing query whose results go to the given sink.
+  caf::replies_to<atom::subscribe, expression, extract_sink_actor>::with< //
+    atom::ok>,
+  // Registers the ACCOUNTANT actor.
+  caf::reacts_to<accountant_actor>>
   // Conform to the protocol of the STREAM SINK actor for table slices.
   ::extend_with<stream_sink_actor<table_slice>>
   // Conform to the protocol of the STATUS CLIENT actor.
@@ -432,6 +528,7 @@ CAF_BEGIN_TYPE_ID_BLOCK(vast_actors, caf::id_block::vast_atoms::end)
   VAST_ADD_TYPE_ID((vast::system::active_partition_actor))
   VAST_ADD_TYPE_ID((vast::system::analyzer_plugin_actor))
   VAST_ADD_TYPE_ID((vast::system::archive_actor))
+  VAST_ADD_TYPE_ID((vast::system::compactor_actor))
   VAST_ADD_TYPE_ID((vast::system::disk_monitor_actor))
   VAST_ADD_TYPE_ID((vast::system::evaluator_actor))
   VAST_ADD_TYPE_ID((vast::system::exporter_actor))
@@ -440,6 +537,7 @@ CAF_BEGIN_TYPE_ID_BLOCK(vast_actors, caf::id_block::vast_atoms::end)
   VAST_ADD_TYPE_ID((vast::system::importer_actor))
   VAST_ADD_TYPE_ID((vast::system::index_actor))
   VAST_ADD_TYPE_ID((vast::system::indexer_actor))
+  VAST_ADD_TYPE_ID((vast::system::matcher_actor))
   VAST_ADD_TYPE_ID((vast::system::node_actor))
   VAST_ADD_TYPE_ID((vast::system::partition_actor))
   VAST_ADD_TYPE_ID((vast::system::query_map))
@@ -461,6 +559,8 @@ CAF_END_TYPE_ID_BLOCK(vast_actors)
 #define vast_uuid_synopsis_map std::map<vast::uuid, vast::partition_synopsis>
 CAF_ALLOW_UNSAFE_MESSAGE_TYPE(std::shared_ptr<vast_uuid_synopsis_map>)
 CAF_ALLOW_UNSAFE_MESSAGE_TYPE(std::shared_ptr<vast::partition_synopsis>)
+CAF_ALLOW_UNSAFE_MESSAGE_TYPE(
+  std::shared_ptr<const vast::system::meta_index_snapshot>)
 #undef vast_uuid_synopsis_map
 
 #undef VAST_ADD_TYPE_ID
@@ -24,6 +24,7 @@
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace vast::system {
 
@@ -46,6 +47,27 @@ struct archive_state {
   ids session_ids = {};
   caf::typed_response_promise<atom::done> active_promise;
 
+  /// The CANDIDATE CHECKERs that evaluate queries on the slices of a session.
+  std::vector<candidate_checker_actor> checkers;
+
+  /// The position of the next CANDIDATE CHECKER to use.
+  size_t next_checker = 0;
+
+  /// The number of candidate checks in flight for the current session.
+  size_t pending_checks = 0;
+
+  /// Set when the current session returned all of its slices.
+  bool session_exhausted = false;
+
+  /// Set when the session waits for a candidate check before continuing.
+  bool throttled = false;
+
+  /// The first error that occurred in the current session.
+  caf::error session_error = {};
+
+  /// Set while the ARCHIVE compacts segments in the background.
+  bool compacting = false;
+
   archive_actor::pointer self;
 
   std::unique_ptr<vast::segment_store> store;
@@ -65,20 +87,39 @@ struct archive_state {
   caf::typed_response_promise<atom::done>
   file_request(vast::query query, const ids& xs);
 
+  /// Accounts for a completed candidate check, and either resumes or finishes
+  /// the current session.
+  void complete_check();
+
+  /// Responds to the current session once all of its candidate checks
+  /// completed, and opens the next session.
+  void finish_session();
+
+  /// Starts compacting segments in the background if any segment has enough
+  /// erased events, unless compaction is already underway.
+  void schedule_compaction();
+
   vast::system::measurement measurement;
   accountant_actor accountant;
   static inline const char* name = "archive";
 };
 
+/// Evaluates queries on table slices on behalf of the ARCHIVE.
+/// @param self The actor handle.
+candidate_checker_actor::behavior_type
+candidate_checker(candidate_checker_actor::pointer self);
+
 /// Stores event batches and answers queries for ID sets.
 /// @param self The actor handle.
 /// @param dir The root directory of the archive.
 /// @param capacity The number of segments to cache in memory.
 /// @param max_segment_size The maximum segment size in bytes.
+/// @param compaction_threshold The fraction of erased events at which the
+/// ARCHIVE rewrites a segment.
 /// @pre `max_segment_size > 0`
 archive_actor::behavior_type
 archive(archive_actor::stateful_pointer<archive_state> self,
         const std::filesystem::path& dir, size_t capacity,
-        size_t max_segment_size);
+        size_t max_segment_size, double compaction_threshold);
 
 } // namespace vast::system
@@ -0,0 +1,131 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/defaults.hpp"
+#include "vast/system/report.hpp"
+#include "vast/time.hpp"
+
+#include <caf/expected.hpp>
+#include <caf/settings.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+namespace vast::system {
+
+/// Configures how a source sizes its table slices.
+struct batch_size_options {
+  /// The upper bound for the number of rows in a table slice.
+  size_t max_size = defaults::import::table_slice_size;
+
+  /// Whether to size table slices by the observed event rate and event size,
+  /// rather than always filling them up to `max_size`.
+  bool adaptive = false;
+
+  /// The lower bound for the number of rows in an adaptively sized table
+  /// slice.
+  size_t min_size = defaults::import::min_table_slice_size;
+
+  /// The time that an adaptively sized table slice should take to fill up.
+  duration target_latency = defaults::import::batch_target_latency;
+
+  /// The number of bytes that an adaptively sized table slice should not
+  /// exceed.
+  size_t target_bytes = defaults::import::table_slice_bytes;
+
+  /// Extracts the batching options of the import command.
+  /// @param options The options of the invocation.
+  /// @returns The batching options, or an error if an option is malformed.
+  static caf::expected<batch_size_options> make(const caf::settings& options);
+};
+
+/// The reason why a source handed table slices downstream.
+enum class flush_reason {
+  full,         ///< The reader completed a table slice.
+  timeout,      ///< The batch timeout expired.
+  stalled,      ///< The reader ran out of input.
+  end_of_input, ///< The reader reached the end of its input.
+  error,        ///< The reader failed.
+};
+
+/// @relates flush_reason
+std::string_view to_string(flush_reason reason) noexcept;
+
+/// Chooses the size of table slices for a source. In adaptive mode, the
+/// controller tracks the rate at which events arrive and the number of bytes
+/// per event, and picks the size such that a table slice fills up within the
+/// target latency without exceeding the target number of bytes. Otherwise,
+/// the size is fixed at the configured maximum.
+class batch_size_controller {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /// The minimum time between two updates of the event rate.
+  static constexpr auto sample_interval = std::chrono::seconds{1};
+
+  /// The weight of a new sample in the moving averages.
+  static constexpr double smoothing = 0.25;
+
+  /// Constructs a batch size controller.
+  /// @param options The bounds and targets for the table slice size.
+  explicit batch_size_controller(batch_size_options options = {});
+
+  /// @returns The number of rows for the next table slice.
+  [[nodiscard]] size_t size() const noexcept;
+
+  /// @returns The configured options.
+  [[nodiscard]] const batch_size_options& options() const noexcept;
+
+  /// Records the events that a source read.
+  /// @param events The number of events read, possibly zero.
+  /// @param now The current time.
+  void observe_input(size_t events, clock::time_point now);
+
+  /// Records a table slice that a source produced.
+  void observe_slice(const table_slice& slice);
+
+  /// Records a table slice with the given dimensions.
+  /// @param rows The number of rows of the table slice.
+  /// @param bytes The serialized size of the table slice.
+  void observe_slice(size_t rows, size_t bytes);
+
+  /// Records that a source handed its table slices downstream.
+  void flushed(flush_reason reason) noexcept;
+
+  /// Appends the metrics since the last call and resets them.
+  /// @param prefix The prefix for the keys of the data points.
+  /// @param r The report to append to.
+  void append_report(std::string_view prefix, report& r);
+
+  /// @returns The current state of the controller.
+  [[nodiscard]] caf::settings status() const;
+
+private:
+  /// Recomputes the table slice size from the moving averages.
+  void update() noexcept;
+
+  batch_size_options options_;
+  size_t size_;
+  std::optional<double> events_per_second_ = {};
+  std::optional<double> bytes_per_event_ = {};
+  clock::time_point sample_start_ = {};
+  size_t sample_events_ = 0;
+  size_t slices_ = 0;
+  size_t slice_rows_ = 0;
+  size_t slice_bytes_ = 0;
+  std::array<size_t, 5> flushes_ = {};
+};
+
+} // namespace vast::system
@@ -0,0 +1,63 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/system/actors.hpp"
+
+#include <caf/typed_event_based_actor.hpp>
+
+#include <chrono>
+#include <cstdint>
+
+namespace vast::system {
+
+struct compactor_config {
+  /// The timespan between two checks for small partitions.
+  std::chrono::seconds interval = std::chrono::seconds{0};
+
+  /// Partitions with fewer events than this count as small.
+  uint64_t max_events = 0;
+};
+
+/// Tests if the passed config options represent a valid compactor
+/// configuration.
+caf::error validate(const compactor_config&);
+
+struct compactor_state {
+  compactor_config config;
+
+  /// Whether a compaction run is currently in progress.
+  bool compacting = false;
+
+  /// Node handle of the INDEX.
+  index_actor index;
+
+  /// The number of partitions that got merged.
+  uint64_t merged_partitions = 0;
+
+  /// The number of partitions that got created by merging.
+  uint64_t created_partitions = 0;
+
+  constexpr static const char* name = "compactor";
+};
+
+/// Periodically asks the INDEX to merge adjacent small partitions into
+/// larger ones, until no more runs of small partitions remain. Small
+/// partitions result from frequent flushes and restarts, and slow down
+/// queries that have to consult every one of them.
+/// @param self The actor handle.
+/// @param config The configuration of the compactor.
+/// @param index The actor handle of the INDEX.
+compactor_actor::behavior_type
+compactor(compactor_actor::stateful_pointer<compactor_state> self,
+          const compactor_config& config, index_actor index);
+
+} // namespace vast::system
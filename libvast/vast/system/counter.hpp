@@ -46,6 +46,9 @@ private:
 
   /// Points to the client actor that launched the query.
   caf::actor client_;
+
+  /// Counts partitions that required a candidate check in the STORE.
+  size_t candidate_checks_ = 0;
 };
 
 caf::behavior counter(caf::stateful_actor<counter_state>* self, expression expr,
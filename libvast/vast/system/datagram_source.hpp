@@ -45,7 +45,7 @@ struct datagram_source_state : source_state {
 /// @param self The actor handle.
 /// @param udp_listening_port The requested port.
 /// @param reader The reader instance.
-/// @param table_slice_size The maximum size for a table slice.
+/// @param batching The bounds and targets for the size of table slices.
 /// @param max_events The optional maximum amount of events to import.
 /// @param type_registry The actor handle for the type-registry component.
 /// @oaram local_schema Additional local schemas to consider.
@@ -54,7 +54,7 @@ struct datagram_source_state : source_state {
 caf::behavior datagram_source(
   caf::stateful_actor<datagram_source_state, caf::io::broker>* self,
   uint16_t udp_listening_port, format::reader_ptr reader,
-  size_t table_slice_size, std::optional<size_t> max_events,
+  batch_size_options batching, std::optional<size_t> max_events,
   const type_registry_actor& type_registry, vast::schema local_schema,
   std::string type_filter, accountant_actor accountant,
   std::vector<transform>&& transforms);
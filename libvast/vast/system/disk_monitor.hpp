@@ -14,7 +14,10 @@
 
 #include <caf/typed_event_based_actor.hpp>
 
+#include <chrono>
 #include <filesystem>
+#include <optional>
+#include <string>
 
 namespace vast::system {
 
@@ -33,6 +36,10 @@ struct disk_monitor_config {
 
   /// The timespan between scans.
   std::chrono::seconds scan_interval = std::chrono::seconds{60};
+
+  /// The timespan between two reconciliations of the disk usage ledgers with
+  /// the file system.
+  std::chrono::seconds reconcile_interval = std::chrono::hours{1};
 };
 
 /// Tests if the passed config options represent a valid disk monitor
@@ -54,6 +61,15 @@ struct disk_monitor_state {
   /// Node handle of the INDEX.
   index_actor index;
 
+  /// The number of bytes in the database directory that the disk usage
+  /// ledgers of the INDEX and the ARCHIVE do not cover, e.g., the index state
+  /// or log files. Updated when reconciling with the file system.
+  uint64_t untracked_bytes = 0;
+
+  /// The time of the last reconciliation with the file system.
+  std::optional<std::chrono::steady_clock::time_point> last_reconciliation
+    = std::nullopt;
+
   /// Computes the size of the database directory.
   /// Note that this function may spawn an external process to perform the
   /// computation.
@@ -62,8 +78,11 @@ struct disk_monitor_state {
   constexpr static const char* name = "disk-monitor";
 };
 
-/// Periodically scans the size of the database directory and deletes data
-/// once it exceeds some threshold.
+/// Periodically checks the size of the database directory and deletes data
+/// once it exceeds some threshold. The size comes from the disk usage ledgers
+/// that the INDEX and the ARCHIVE maintain as they write and delete files,
+/// and the disk monitor only occasionally reconciles it with the file system.
+/// Partitions get deleted in the order of their newest event.
 /// @param self The actor handle.
 /// @param high_water Start erasing data if this limit is exceeded.
 /// @param low_water Erase until this limit is no longer exceeded.
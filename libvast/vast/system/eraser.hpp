@@ -13,13 +13,18 @@
 #include "vast/ids.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/system/query_processor.hpp"
+#include "vast/time.hpp"
 
+#include <chrono>
+#include <optional>
 #include <string>
 
 namespace vast::system {
 
 /// Periodically queries the INDEX with a configurable expression and erases
-/// all hits from the ARCHIVE.
+/// all hits from the ARCHIVE. With a retention period, the ERASER first drops
+/// all partitions whose events are older than the retention period as a whole,
+/// and only queries the INDEX for the events of the remaining partitions.
 class eraser_state : public query_processor {
 public:
   // -- member types -----------------------------------------------------------
@@ -34,7 +39,8 @@ public:
 
   eraser_state(caf::event_based_actor* self);
 
-  void init(caf::timespan interval, std::string query, index_actor index);
+  void init(caf::timespan interval, std::string query, duration retention,
+            index_actor index, accountant_actor accountant);
 
 protected:
   // -- implementation hooks ---------------------------------------------------
@@ -42,6 +48,16 @@ protected:
   void transition_to(state_name x) override;
 
 private:
+  // -- utility functions ------------------------------------------------------
+
+  /// Queries the INDEX for the events to erase that remain after dropping
+  /// expired partitions.
+  /// @param cutoff The time before which events expire, if any.
+  void erase_remaining(std::optional<time> cutoff);
+
+  /// Sends the metrics of the last aging cycle to the ACCOUNTANT.
+  void send_report();
+
   // -- member variables -------------------------------------------------------
 
   /// Configures the time between two query executions.
@@ -53,6 +69,18 @@ private:
   /// its parsing and not update properly.
   std::string query_;
 
+  /// The time after which events expire, or zero to keep events forever.
+  duration retention_ = {};
+
+  /// Receives the metrics of the aging cycles.
+  accountant_actor accountant_;
+
+  /// The start of the current aging cycle.
+  std::chrono::steady_clock::time_point cycle_start_ = {};
+
+  /// The number of partitions dropped as a whole in the current aging cycle.
+  uint64_t dropped_partitions_ = 0;
+
   /// Collects hits until all deltas arrived.
   ids hits_;
 
@@ -67,10 +95,14 @@ private:
 ///              Note that we get the query as string on purpose. Taking an
 ///              ::expression here instead would fix any query such as `#time <
 ///              1 week ago` to the time of its parsing and not update
-///              properly.
+///              properly. May be empty if `retention` is set.
+/// @param retention The time after which events expire, or zero to only erase
+///                  the events that `query` selects.
 /// @param index A handle to the INDEX under investigation.
+/// @param accountant A handle to the ACCOUNTANT; may be `nullptr`.
 caf::behavior
 eraser(caf::stateful_actor<eraser_state>* self, caf::timespan interval,
-       std::string query, index_actor index);
+       std::string query, duration retention, index_actor index,
+       accountant_actor accountant);
 
 } // namespace vast::system
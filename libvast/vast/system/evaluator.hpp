@@ -71,11 +71,24 @@ struct evaluator_state {
   static inline const char* name = "evaluator";
 };
 
+/// Combines the hits of individual predicates according to the conjunctions,
+/// disjunctions, and negations of an expression.
+/// @param expr The expression.
+/// @param hits The hits per predicate, keyed by the position of the predicate
+///        in *expr*. Predicates without an entry contribute no hits.
+/// @returns The hits for *expr*.
+ids combine_hits(const expression& expr,
+                 const evaluator_state::predicate_hits_map& hits);
+
 /// Wraps a query expression in an actor. Upon receiving hits from INDEXER
 /// actors, re-evaluates the expression and relays new hits to the INDEX CLIENT.
+/// @param expr The query expression.
+/// @param eval The INDEXER actors to ask for the hits of predicates.
+/// @param hits The hits of predicates that are known without an INDEXER.
 /// @pre `!eval.empty()`
 evaluator_actor::behavior_type
 evaluator(evaluator_actor::stateful_pointer<evaluator_state> self,
-          expression expr, std::vector<evaluation_triple> eval);
+          expression expr, std::vector<evaluation_triple> eval,
+          evaluator_state::predicate_hits_map hits);
 
 } // namespace vast::system
@@ -10,16 +10,21 @@
 
 #include "vast/fwd.hpp"
 
+#include "vast/data.hpp"
 #include "vast/expression.hpp"
+#include "vast/ids.hpp"
 #include "vast/system/node.hpp"
+#include "vast/time.hpp"
 #include "vast/type.hpp"
 
 #include <caf/actor.hpp>
 #include <caf/fwd.hpp>
 
+#include <map>
+#include <optional>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <utility>
+#include <vector>
 
 namespace vast::system {
 
@@ -29,6 +34,13 @@ struct explorer_state {
     uint64_t per_result;
   };
 
+  /// A time box around a result with inclusive bounds.
+  using timebox = std::pair<vast::time, vast::time>;
+
+  /// Time boxes around results, keyed by the value of the field by which to
+  /// restrict the result set, or `caf::none` if there is no such field.
+  using timebox_map = std::map<data, std::vector<timebox>>;
+
   static inline constexpr const char* name = "explorer";
 
   explorer_state(caf::event_based_actor* self);
@@ -53,7 +65,14 @@ struct explorer_state {
 
   /// Keeps a record of the ids that were already returned to the sink,
   /// for the purpose of deduplication.
-  std::unordered_set<size_t> returned_ids;
+  vast::ids returned_ids;
+
+  /// Time boxes around results that were not yet queried. They accumulate
+  /// while the maximum number of EXPORTERs is running.
+  timebox_map pending;
+
+  /// The number of results that contributed to `pending`.
+  size_t num_pending = 0;
 
   /// A tracking counter of spawned exporters. Used for lifetime management.
   size_t running_exporters = 0;
@@ -75,8 +94,21 @@ struct explorer_state {
   caf::actor sink;
 };
 
+/// Coalesces the time boxes around a set of results into a single query.
+/// Overlapping time boxes for the same value merge into one interval, and
+/// values that share an interval merge into a membership test.
+/// @param boxes The time boxes around the results.
+/// @param bounded Whether to restrict the query to the time boxes; if not, the
+///        query only restricts the field *by*.
+/// @param by The field by which to restrict the result set, if any.
+/// @returns A disjunction of the coalesced constraints.
+/// @pre `!boxes.empty() && (bounded || by)`
+expression coalesce_timeboxes(explorer_state::timebox_map boxes, bool bounded,
+                              const std::optional<std::string>& by);
+
 /// The EXPLORER receives table slices and constructs new queries for a time box
-/// around each result.
+/// around each result. It coalesces the time boxes of all results that arrive
+/// while a context query is running into the next query.
 /// @param self The actor handle.
 /// @param node The node actor to spawn exporters in.
 /// @param before Size of the time box prior to each result.
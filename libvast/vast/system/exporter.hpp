@@ -15,6 +15,7 @@
 #include "vast/ids.hpp"
 #include "vast/query_options.hpp"
 #include "vast/system/actors.hpp"
+#include "vast/system/query_profile.hpp"
 #include "vast/system/query_status.hpp"
 #include "vast/system/transformer.hpp"
 #include "vast/table_slice.hpp"
@@ -24,6 +25,11 @@
 #include <caf/scheduled_actor.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
 namespace vast::system {
 
 struct exporter_state {
@@ -49,6 +55,15 @@ struct exporter_state {
   /// Stores a handle to the ACCOUNTANT that collects various statistics.
   accountant_actor accountant;
 
+  /// Owns the serialized layouts that the keys of `layouts` point to.
+  std::deque<std::string> serialized_layouts;
+
+  /// Caches one type per layout of the received slices, keyed by the
+  /// serialized layout. Every slice carries its own copy of its layout, so
+  /// reusing these types avoids copying and hashing the layout for every
+  /// slice.
+  std::unordered_map<std::string_view, type> layouts;
+
   /// Caches tailored candidate checkers.
   std::unordered_map<type, expression> checkers;
 
@@ -61,6 +76,9 @@ struct exporter_state {
   /// Stores various meta information about the progress we made on the query.
   query_status query;
 
+  /// Aggregates the timed spans of the query stages if the query is profiled.
+  query_profile profile;
+
   /// Stores flags for the query for distinguishing historic and continuous
   /// queries.
   query_options options;
@@ -18,6 +18,7 @@
 #include "vast/system/actors.hpp"
 #include "vast/system/meta_index.hpp"
 #include "vast/system/partition.hpp"
+#include "vast/time.hpp"
 #include "vast/uuid.hpp"
 
 #include <caf/actor.hpp>
@@ -28,6 +29,10 @@
 #include <caf/response_promise.hpp>
 #include <caf/typed_event_based_actor.hpp>
 
+#include <functional>
+#include <memory>
+#include <optional>
+#include <set>
 #include <unordered_map>
 #include <vector>
 
@@ -92,6 +97,31 @@ private:
 using pending_query_map
   = detail::stable_map<uuid, std::vector<evaluation_triple>>;
 
+/// The disk usage of a persisted partition.
+struct partition_disk_usage {
+  /// The number of bytes that the partition, its synopsis, and its
+  /// partition-local store occupy on disk.
+  uint64_t bytes = 0;
+
+  /// The time of the newest event in the partition, if known.
+  std::optional<time> newest_event = {};
+
+  /// The number of events in the partition, if known. Partitions loaded at
+  /// startup learn their number of events only when compaction needs it, to
+  /// avoid reading every partition file while booting.
+  std::optional<uint64_t> events = {};
+};
+
+/// A partition that got replaced by a merged partition.
+struct merged_partition {
+  /// The partition that replaced it.
+  uuid replacement = {};
+
+  /// The merge generation of the replacement. Meta index lookups that started
+  /// at an earlier generation may still return the merged partition.
+  uint64_t generation = 0;
+};
+
 struct query_state {
   /// The UUID of the query.
   vast::uuid id;
@@ -99,7 +129,7 @@ struct query_state {
   /// The query expression.
   vast::query query;
 
-  /// Unscheduled partitions.
+  /// Unscheduled partitions, in the order in which they get scheduled.
   std::vector<uuid> partitions;
 
   template <class Inspector>
@@ -129,7 +159,9 @@ struct index_state {
   [[nodiscard]] caf::typed_response_promise<caf::settings>
   status(status_verbosity v) const;
 
-  void flush_to_disk();
+  /// Writes the index state to disk.
+  /// @param on_success A function to call once the state is on disk.
+  void flush_to_disk(std::function<void()> on_success = {});
 
   [[nodiscard]] std::filesystem::path
   index_filename(const std::filesystem::path& basename = {}) const;
@@ -141,6 +173,57 @@ struct index_state {
   [[nodiscard]] std::filesystem::path
   partition_synopsis_path(const uuid& id) const;
 
+  // -- disk usage -------------------------------------------------------------
+
+  /// Records the files of a persisted partition in the disk usage ledger.
+  /// @param id The partition ID.
+  /// @param newest_event The time of the newest event in the partition.
+  /// @param events The number of events in the partition.
+  void track_disk_usage(const uuid& id, std::optional<time> newest_event,
+                        std::optional<uint64_t> events = {});
+
+  /// Removes a partition from the disk usage ledger.
+  /// @param id The partition ID.
+  void untrack_disk_usage(const uuid& id);
+
+  /// @returns The persisted partitions ordered by the time of their newest
+  /// event, from oldest to newest. Partitions without time information come
+  /// last.
+  [[nodiscard]] std::vector<uuid> partitions_by_age() const;
+
+  // -- compaction -------------------------------------------------------------
+
+  /// Picks the oldest run of at least two adjacent persisted partitions that
+  /// each hold fewer than `max_events` events, that use the same store
+  /// backend, and that together fit into a single partition. Reads the number
+  /// of events of partitions that do not have one in the disk usage ledger
+  /// yet.
+  /// @param max_events The number of events below which a partition counts
+  /// as small.
+  /// @returns The partitions to merge, ordered from oldest to newest, or an
+  /// empty list if there is nothing to merge.
+  std::vector<uuid> compaction_candidates(uint64_t max_events);
+
+  /// Merges persisted partitions into a new partition in the background, and
+  /// atomically replaces them in the index and the meta index afterwards.
+  /// @param partitions The partitions to merge.
+  /// @returns A promise for the merged partitions.
+  caf::typed_response_promise<std::vector<uuid>>
+  merge_partitions(std::vector<uuid> partitions);
+
+  /// Replaces merged partitions in a list of candidates from a meta index
+  /// lookup that started before the merge finished.
+  /// @param candidates The candidates to update.
+  void replace_merged_partitions(std::vector<uuid>& candidates) const;
+
+  /// Deletes the files of retired partitions that neither the index state on
+  /// disk nor any pending query references anymore.
+  void remove_retired_partitions();
+
+  /// Forgets the replacements of removed partitions once no meta index lookup
+  /// that may still return them is in flight.
+  void forget_merged_partitions();
+
   // -- query handling ---------------------------------------------------------
 
   [[nodiscard]] bool worker_available() const;
@@ -162,6 +245,12 @@ struct index_state {
 
   // -- partition handling -----------------------------------------------------
 
+  /// @returns The options for the value indexes of new partitions.
+  [[nodiscard]] caf::settings partition_index_options() const;
+
+  /// @returns The options for the synopses of new partitions.
+  [[nodiscard]] caf::settings partition_synopsis_options() const;
+
   /// Creates a new active partition.
   void create_active_partition();
 
@@ -187,6 +276,11 @@ struct index_state {
   // unpin them after they're safely on disk.
   std::unordered_map<uuid, partition_actor> unpersisted = {};
 
+  /// The IDs of the unpersisted partitions in the order in which they were
+  /// decomissioned, i.e., from the oldest to the newest events. Their time
+  /// ranges are unknown until they are persisted.
+  std::vector<uuid> unpersisted_order = {};
+
   /// The set of passive (read-only) partitions currently loaded into memory.
   /// Uses the `partition_factory` to load new partitions as needed, and evicts
   /// old entries when the size exceeds `max_inmem_partitions`.
@@ -195,6 +289,33 @@ struct index_state {
   /// The set of partitions that exist on disk.
   std::unordered_set<uuid> persisted_partitions = {};
 
+  /// Maps persisted partitions to the disk space they occupy. Updated when
+  /// partitions get written and erased, so that the disk usage is known
+  /// without scanning the file system.
+  std::unordered_map<uuid, partition_disk_usage> disk_usage_ledger = {};
+
+  /// The sum of bytes in `disk_usage_ledger`.
+  uint64_t disk_usage = 0;
+
+  /// The persisted partitions that are currently being merged.
+  std::vector<uuid> merging_partitions = {};
+
+  /// Partitions that got replaced by a merged partition. Pending queries may
+  /// still evaluate them, so their files stay around until no pending query
+  /// references them. Maps to whether the index state on disk no longer
+  /// contains the partition.
+  std::unordered_map<uuid, bool> retired_partitions = {};
+
+  /// Maps merged partitions to the partition that replaced them.
+  std::unordered_map<uuid, merged_partition> merged_partitions = {};
+
+  /// The number of merges that replaced partitions in the meta index.
+  uint64_t merge_generation = 0;
+
+  /// The merge generations at which the in-flight meta index lookups of
+  /// queries started.
+  std::multiset<uint64_t> meta_index_lookups = {};
+
   /// This set to true after the index finished reading the meta index state
   /// from disk.
   bool accept_queries = {};
@@ -245,6 +366,16 @@ struct index_state {
   // The false positive rate for the meta index.
   double meta_index_fp_rate = {};
 
+  /// The cache for predicate lookups in passive partitions; `nullptr` if
+  /// caching is disabled.
+  std::shared_ptr<query_cache> cache = {};
+
+  /// Whether passive partitions evaluate queries without spawning actors.
+  bool direct_evaluation = false;
+
+  /// Whether active partitions keep their events in a partition-local store.
+  bool local_stores = false;
+
   constexpr static inline auto name = "index";
 };
 
@@ -265,12 +396,19 @@ pack(flatbuffers::FlatBufferBuilder& builder, const index_state& state);
 /// @param taste_partitions How many lookup partitions to schedule immediately.
 /// @param num_workers The maximum amount of concurrent lookups.
 /// @param meta_index_fp_rate The false positive rate for the meta index.
+/// @param query_cache_size The maximum number of bytes of cached predicate
+/// lookups, or 0 to disable the cache.
+/// @param direct_evaluation Whether passive partitions evaluate queries
+/// without spawning INDEXER and EVALUATOR actors.
+/// @param local_stores Whether new partitions keep their events in a
+/// partition-local store instead of the global store.
 /// @pre `partition_capacity > 0
 index_actor::behavior_type
 index(index_actor::stateful_pointer<index_state> self, store_actor store,
       filesystem_actor filesystem, const std::filesystem::path& dir,
       size_t partition_capacity, size_t max_inmem_partitions,
       size_t taste_partitions, size_t num_workers,
-      const std::filesystem::path& meta_index_dir, double meta_index_fp_rate);
+      const std::filesystem::path& meta_index_dir, double meta_index_fp_rate,
+      size_t query_cache_size, bool direct_evaluation, bool local_stores);
 
 } // namespace vast::system
@@ -18,6 +18,7 @@
 
 #include <caf/typed_event_based_actor.hpp>
 
+#include <memory>
 #include <string>
 
 namespace vast::system {
@@ -43,6 +44,13 @@ struct indexer_state {
 
   /// The response promise for a snapshot atom.
   caf::typed_response_promise<chunk_ptr> promise;
+
+  /// The position of the indexed field in the combined layout of the
+  /// partition. Only used by passive indexers.
+  size_t position = 0;
+
+  /// The cache for lookup results. Only used by passive indexers.
+  std::shared_ptr<query_cache> cache;
 };
 
 /// Indexes a table slice column with a single value index.
@@ -52,8 +60,15 @@ active_indexer(active_indexer_actor::stateful_pointer<indexer_state> self,
 
 /// An indexer that was recovered from on-disk state. It can only respond
 /// to queries, but not add eny more entries.
+/// @param self The indexer actor.
+/// @param partition_id The UUID of the partition the indexer belongs to.
+/// @param idx The value index holding the data.
+/// @param position The position of the field in the combined layout of the
+///        partition.
+/// @param cache The cache to store lookup results in; may be `nullptr`.
 indexer_actor::behavior_type
 passive_indexer(indexer_actor::stateful_pointer<indexer_state> self,
-                uuid partition_id, value_index_ptr idx);
+                uuid partition_id, value_index_ptr idx, size_t position,
+                std::shared_ptr<query_cache> cache);
 
 } // namespace vast::system
@@ -0,0 +1,120 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/fbs/partition.hpp"
+#include "vast/ids.hpp"
+#include "vast/query.hpp"
+#include "vast/segment.hpp"
+#include "vast/segment_builder.hpp"
+#include "vast/system/actors.hpp"
+
+#include <caf/typed_event_based_actor.hpp>
+#include <caf/typed_response_promise.hpp>
+
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace vast::system {
+
+/// The identifier of the partition-local segment store in the store header of
+/// a partition.
+inline constexpr std::string_view local_segment_store_id = "segment-store";
+
+/// The file extension of partition-local segment stores.
+inline constexpr std::string_view local_segment_store_extension = ".store";
+
+/// @returns The path of the store that belongs to the partition at the given
+/// path.
+/// @relates active_local_store
+std::filesystem::path
+local_segment_store_path(const std::filesystem::path& partition_path);
+
+/// @returns The path of the partition-local store that a partition references
+/// in its store header, if any.
+/// @param partition The partition flatbuffer.
+/// @param partition_path The path of the partition flatbuffer.
+/// @relates passive_local_store
+std::optional<std::filesystem::path>
+local_segment_store_path(const fbs::partition::v0& partition,
+                         const std::filesystem::path& partition_path);
+
+/// @relates active_local_store
+struct active_local_store_state {
+  /// The initial size of the buffer for the segment.
+  static constexpr size_t initial_buffer_size = 1'024 * 1'024;
+
+  /// Holds the table slices until the store is persisted.
+  segment_builder builder{initial_buffer_size};
+
+  /// The finished segment; engaged after persisting the store.
+  std::optional<vast::segment> segment;
+
+  /// The path of the store file; set when persisting the store.
+  std::filesystem::path path;
+
+  /// Actor handle of the filesystem actor.
+  filesystem_actor filesystem;
+
+  /// Evaluates queries on the table slices of the store.
+  candidate_checker_actor checker;
+
+  /// The number of events in the store.
+  size_t events = 0;
+
+  static inline const char* name = "active-local-store";
+};
+
+/// @relates passive_local_store
+struct passive_local_store_state {
+  /// The segment, once loaded from disk.
+  std::optional<vast::segment> segment;
+
+  /// The path of the store file.
+  std::filesystem::path path;
+
+  /// Actor handle of the filesystem actor.
+  filesystem_actor filesystem;
+
+  /// Evaluates queries on the table slices of the store.
+  candidate_checker_actor checker;
+
+  /// Requests that arrived before the segment was loaded.
+  std::vector<
+    std::tuple<query, ids, caf::typed_response_promise<atom::done>>>
+    deferred_requests;
+
+  static inline const char* name = "passive-local-store";
+};
+
+/// Collects the table slices of an active partition in a single segment, and
+/// writes it to a file next to the partition when the partition persists.
+/// @param self The actor handle.
+/// @param filesystem The actor handle of the filesystem actor.
+partition_store_builder_actor::behavior_type active_local_store(
+  partition_store_builder_actor::stateful_pointer<active_local_store_state>
+    self,
+  filesystem_actor filesystem);
+
+/// Answers queries for a passive partition from the segment that the
+/// partition's active local store wrote. Erasing all events of the store
+/// removes its file.
+/// @param self The actor handle.
+/// @param filesystem The actor handle of the filesystem actor.
+/// @param path The path of the store file.
+store_actor::behavior_type passive_local_store(
+  store_actor::stateful_pointer<passive_local_store_state> self,
+  filesystem_actor filesystem, const std::filesystem::path& path);
+
+} // namespace vast::system
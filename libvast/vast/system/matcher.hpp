@@ -0,0 +1,65 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/system/actors.hpp"
+#include "vast/system/query_matcher.hpp"
+
+#include <caf/typed_event_based_actor.hpp>
+
+#include <cstdint>
+#include <map>
+
+namespace vast::system {
+
+struct matcher_state {
+  /// A standing query and the sink for its results.
+  struct subscription {
+    extract_sink_actor sink;
+
+    /// The value of `processed` when the sink last learned about the number
+    /// of checked events.
+    uint64_t reported = 0;
+  };
+
+  /// Evaluates all standing queries at once.
+  query_matcher matcher;
+
+  /// The subscriptions, keyed by the ID of their query in the matcher.
+  std::map<query_matcher::query_id, subscription> subscriptions;
+
+  /// The ID for the next subscription.
+  query_matcher::query_id next_id = 0;
+
+  /// The number of events that the matcher checked.
+  uint64_t processed = 0;
+
+  /// The number of events that satisfied at least one query.
+  uint64_t matched = 0;
+
+  /// Receives metrics about the matching.
+  accountant_actor accountant;
+
+  constexpr static const char* name = "matcher";
+};
+
+/// Evaluates all standing queries over the events that the IMPORTER receives
+/// and ships the results to the subscribed sinks. Every table slice gets
+/// scanned once regardless of the number of standing queries, which makes
+/// continuous queries scale to large rule sets, e.g., translated Sigma rules.
+/// A subscription ends when its sink terminates.
+/// @param self The actor handle.
+/// @param accountant The actor handle of the ACCOUNTANT.
+matcher_actor::behavior_type
+matcher(matcher_actor::stateful_pointer<matcher_state> self,
+        accountant_actor accountant);
+
+} // namespace vast::system
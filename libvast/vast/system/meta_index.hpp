@@ -16,8 +16,10 @@
 #include "vast/ids.hpp"
 #include "vast/partition_synopsis.hpp"
 #include "vast/qualified_record_field.hpp"
+#include "vast/query.hpp"
 #include "vast/synopsis.hpp"
 #include "vast/system/actors.hpp"
+#include "vast/time.hpp"
 #include "vast/time_synopsis.hpp"
 #include "vast/type.hpp"
 #include "vast/uuid.hpp"
@@ -26,11 +28,65 @@
 #include <caf/typed_event_based_actor.hpp>
 
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace vast::system {
 
+/// An immutable view of the partition synopses of the META INDEX. Lookups
+/// evaluate a snapshot, while modifications of the META INDEX publish a new
+/// one, such that lookups never wait for merges and erasures.
+struct meta_index_snapshot {
+  // -- lookup -----------------------------------------------------------------
+
+  /// Retrieves the list of candidate partition IDs for a given expression.
+  /// @param expr The expression to lookup.
+  /// @returns A vector of UUIDs representing candidate partitions.
+  [[nodiscard]] std::vector<uuid> lookup(const expression& expr) const;
+
+  [[nodiscard]] std::vector<uuid> lookup_impl(const expression& expr) const;
+
+  /// Retrieves the time range that the time synopses of a partition cover.
+  /// @param partition The partition ID.
+  /// @returns The oldest and newest timestamp in the partition, or
+  ///          `std::nullopt` if the partition has no time information.
+  [[nodiscard]] std::optional<std::pair<time, time>>
+  time_range(const uuid& partition) const;
+
+  /// Retrieves the partitions whose events `:timestamp < cutoff` selects
+  /// entirely. A partition qualifies only if every one of its layouts has a
+  /// timestamp column whose newest value precedes the cutoff; partitions with
+  /// other layouts must go through a regular erase query instead.
+  /// @param cutoff The point in time.
+  /// @returns The IDs of all partitions that expire as a whole.
+  [[nodiscard]] std::vector<uuid> older_than(time cutoff) const;
+
+  /// Sorts candidate partitions by the time range that they cover.
+  /// Partitions without time information keep their relative order and come
+  /// last.
+  /// @param candidates The candidate partitions to sort.
+  /// @param order The requested order.
+  void sort_by_time(std::vector<uuid>& candidates,
+                    enum query::order order) const;
+
+  /// @returns A best-effort estimate of the amount of memory used for this
+  /// snapshot (in bytes).
+  [[nodiscard]] size_t memusage() const;
+
+  // -- data members -----------------------------------------------------------
+
+  /// Maps a partition ID to the synopses for that partition. The synopses are
+  /// shared between snapshots, so publishing a new snapshot copies only the
+  /// pointers.
+  // We mainly iterate over the whole map and return a sorted set, for which
+  // the `flat_map` proves to be much faster than `std::{unordered_,}set`.
+  // See also ae9dbed.
+  detail::flat_map<uuid, std::shared_ptr<const partition_synopsis>> synopses;
+};
+
 /// The state of the META INDEX actor.
 struct meta_index_state {
 public:
@@ -50,37 +106,53 @@ public:
   /// Returns the partition synopsis for a specific partition.
   /// Note that most callers will prefer to use `lookup()` instead.
   /// @pre `partition` must be a valid key for this meta index.
-  partition_synopsis& at(const uuid& partition);
+  const partition_synopsis& at(const uuid& partition) const;
 
   /// Erase this partition from the meta index.
   void erase(const uuid& partition);
 
-  /// Retrieves the list of candidate partition IDs for a given expression.
-  /// @param expr The expression to lookup.
-  /// @returns A vector of UUIDs representing candidate partitions.
-  [[nodiscard]] std::vector<uuid> lookup(const expression& expr) const;
-
-  [[nodiscard]] std::vector<uuid> lookup_impl(const expression& expr) const;
+  /// Replaces the synopses of several partitions with the synopsis of the
+  /// partition that holds their events, such that no lookup sees both.
+  void replace(const std::vector<uuid>& partitions, const uuid& partition,
+               partition_synopsis&&);
 
   /// @returns A best-effort estimate of the amount of memory used for this meta
   /// index (in bytes).
   [[nodiscard]] size_t memusage() const;
 
+  /// @returns The snapshot to modify, copying the current one if a lookup may
+  /// still be reading it.
+  meta_index_snapshot& mutable_snapshot();
+
+  /// @returns The META INDEX READER for the next lookup.
+  meta_index_reader_actor next_reader();
+
   // -- data members -----------------------------------------------------------
 
   /// A pointer to the parent actor.
   meta_index_actor::pointer self;
 
-  /// Maps a partition ID to the synopses for that partition.
-  // We mainly iterate over the whole map and return a sorted set, for which
-  // the `flat_map` proves to be much faster than `std::{unordered_,}set`.
-  // See also ae9dbed.
-  detail::flat_map<uuid, partition_synopsis> synopses;
+  /// The most recently published snapshot.
+  std::shared_ptr<meta_index_snapshot> snapshot
+    = std::make_shared<meta_index_snapshot>();
+
+  /// The actors that evaluate lookups on snapshots concurrently.
+  std::vector<meta_index_reader_actor> readers;
+
+  /// The position of the META INDEX READER for the next lookup.
+  size_t next_reader_position = 0;
 };
 
+/// The META INDEX READER evaluates lookups on a snapshot of the META INDEX.
+/// @param self The actor handle.
+meta_index_reader_actor::behavior_type
+meta_index_reader(meta_index_reader_actor::pointer self);
+
 /// The META INDEX is the first index actor that queries hit. The result
 /// represents a list of candidate partition IDs that may contain the desired
 /// data. The META INDEX may return false positives but never false negatives.
+/// It delegates lookups to a pool of META INDEX READERs, one per scheduler
+/// thread, so that lookups run concurrently with merges and each other.
 /// @param self The actor handle.
 meta_index_actor::behavior_type
 meta_index(meta_index_actor::stateful_pointer<meta_index_state> self);
@@ -0,0 +1,194 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/detail/bit.hpp"
+#include "vast/system/report.hpp"
+#include "vast/time.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vast::system {
+
+/// The number of shards of a metric. Every thread records into one shard, so
+/// that threads rarely contend for the same cache line.
+inline constexpr size_t metric_shards = 16;
+
+/// @returns The shard that the calling thread records into.
+inline size_t metric_shard() noexcept {
+  static std::atomic<size_t> next = 0;
+  thread_local const size_t shard
+    = next.fetch_add(1, std::memory_order_relaxed) % metric_shards;
+  return shard;
+}
+
+/// A counter that many threads can increment without locking.
+class metric_counter {
+public:
+  /// Increments the counter.
+  /// @param n The increment.
+  void add(uint64_t n = 1) noexcept {
+    shards_[metric_shard()].value.fetch_add(n, std::memory_order_relaxed);
+  }
+
+  /// @returns The sum of all increments since the last collection, and
+  /// resets the counter.
+  uint64_t collect() noexcept;
+
+private:
+  struct alignas(64) shard {
+    std::atomic<uint64_t> value = 0;
+  };
+
+  std::array<shard, metric_shards> shards_ = {};
+};
+
+/// The values that a histogram recorded between two collections.
+struct histogram_snapshot {
+  /// @returns An upper bound of the q-quantile of the recorded values, which
+  /// exceeds the exact quantile by less than 1/16th.
+  /// @param q The quantile in [0, 1].
+  [[nodiscard]] uint64_t quantile(double q) const noexcept;
+
+  /// The number of recorded values.
+  uint64_t count = 0;
+
+  /// The sum of the recorded values.
+  uint64_t sum = 0;
+
+  /// The largest recorded value.
+  uint64_t max = 0;
+
+  /// The number of recorded values per bucket.
+  std::vector<uint64_t> buckets = {};
+};
+
+/// The unit of the values of a histogram.
+enum class metric_unit {
+  count,
+  nanoseconds,
+};
+
+/// A histogram that many threads can record into without locking. The
+/// buckets grow exponentially in size, but split every power of two into 16
+/// linear sub-buckets, which bounds the relative error of the quantiles.
+class metric_histogram {
+public:
+  /// The number of linear sub-buckets per power of two, in bits.
+  static constexpr size_t sub_bucket_bits = 4;
+
+  /// Values at or above 2^48 fall into the last bucket.
+  static constexpr size_t value_bits = 48;
+
+  /// The total number of buckets.
+  static constexpr size_t num_buckets = (value_bits - sub_bucket_bits + 1)
+                                        << sub_bucket_bits;
+
+  explicit metric_histogram(metric_unit unit = metric_unit::count) noexcept;
+
+  /// Records a value.
+  void record(uint64_t value) noexcept {
+    auto& shard = (*shards_)[metric_shard()];
+    shard.buckets[bucket(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    auto max = shard.max.load(std::memory_order_relaxed);
+    while (value > max
+           && !shard.max.compare_exchange_weak(max, value,
+                                               std::memory_order_relaxed))
+      ; // nop
+  }
+
+  /// Records a duration in nanoseconds.
+  void record(duration x) noexcept {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(x).count();
+    record(ns > 0 ? static_cast<uint64_t>(ns) : uint64_t{0});
+  }
+
+  /// @returns The values since the last collection, and resets the
+  /// histogram.
+  histogram_snapshot collect() noexcept;
+
+  /// @returns The unit of the recorded values.
+  [[nodiscard]] metric_unit unit() const noexcept;
+
+  /// @returns The bucket of a value.
+  static constexpr size_t bucket(uint64_t value) noexcept {
+    constexpr auto sub_buckets = uint64_t{1} << sub_bucket_bits;
+    if (value < sub_buckets)
+      return value;
+    if (value >> value_bits != 0)
+      return num_buckets - 1;
+    // The highest set bit selects the power of two, and the bits below it
+    // select the linear sub-bucket.
+    auto exponent = static_cast<size_t>(detail::log2p1(value)) - 1;
+    auto shift = exponent - sub_bucket_bits;
+    return ((exponent - sub_bucket_bits + 1) << sub_bucket_bits)
+           + ((value >> shift) - sub_buckets);
+  }
+
+  /// @returns The largest value in a bucket.
+  static uint64_t upper_bound(size_t bucket) noexcept;
+
+private:
+  struct alignas(64) shard {
+    std::array<std::atomic<uint64_t>, num_buckets> buckets = {};
+    std::atomic<uint64_t> sum = 0;
+    std::atomic<uint64_t> max = 0;
+  };
+
+  metric_unit unit_;
+  std::unique_ptr<std::array<shard, metric_shards>> shards_;
+};
+
+/// A process-wide registry of named counters and histograms. Hot paths look
+/// up their metrics once and record into them directly, instead of sending a
+/// message to the ACCOUNTANT for every measurement. The ACCOUNTANT
+/// periodically collects the metrics, and emits counters as sums and
+/// histograms as quantiles.
+class metrics_registry {
+public:
+  /// @returns The registry of the process.
+  static metrics_registry& instance();
+
+  /// @returns The counter with the given name, creating it if needed. The
+  /// reference remains valid for the lifetime of the process.
+  metric_counter& counter(std::string_view name);
+
+  /// @returns The histogram with the given name, creating it if needed. The
+  /// reference remains valid for the lifetime of the process.
+  /// @param unit The unit of the values, if the histogram does not exist yet.
+  metric_histogram&
+  histogram(std::string_view name, metric_unit unit = metric_unit::count);
+
+  /// Collects and resets all metrics. Counters appear under their name, and
+  /// histograms as `<name>.count`, `<name>.p50`, `<name>.p90`, `<name>.p99`,
+  /// and `<name>.max`. Omits metrics without recordings.
+  report collect();
+
+private:
+  std::mutex mutex_;
+  std::map<std::string, std::unique_ptr<metric_counter>, std::less<>>
+    counters_;
+  std::map<std::string, std::unique_ptr<metric_histogram>, std::less<>>
+    histograms_;
+};
+
+} // namespace vast::system
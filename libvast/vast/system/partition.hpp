@@ -21,6 +21,7 @@
 #include "vast/system/indexer.hpp"
 #include "vast/system/instrumentation.hpp"
 #include "vast/table_slice_column.hpp"
+#include "vast/time.hpp"
 #include "vast/type.hpp"
 #include "vast/uuid.hpp"
 #include "vast/value_index.hpp"
@@ -30,6 +31,7 @@
 #include <caf/typed_event_based_actor.hpp>
 
 #include <filesystem>
+#include <memory>
 #include <unordered_map>
 #include <vector>
 
@@ -42,6 +44,23 @@ struct partition_selector {
                   const table_slice_column& column) const;
 };
 
+/// Records the values of a time column while they arrive in non-decreasing
+/// order, such that the passive partition can answer range predicates on the
+/// column by binary search.
+struct sorted_time_column {
+  /// Adds the values of a column of a table slice. Stops recording once a
+  /// value is nil or smaller than its predecessor.
+  /// @param slice The table slice.
+  /// @param column The offset of the column in the table slice.
+  void add(const table_slice& slice, size_t column);
+
+  /// Whether all values so far were sorted.
+  bool sorted = true;
+
+  /// The values in the order of their ids; empty if the column is not sorted.
+  std::vector<time::rep> values;
+};
+
 /// The state of the ACTIVE PARTITION actor.
 struct active_partition_state {
   // -- member types -----------------------------------------------------------
@@ -83,6 +102,10 @@ struct active_partition_state {
   /// Maps type names to IDs. Used the answer #type queries.
   std::unordered_map<std::string, ids> type_ids;
 
+  /// Tracks the order of the values of all time columns.
+  std::unordered_map<qualified_record_field, sorted_time_column>
+    sorted_time_columns;
+
   /// Partition synopsis for this partition. This is built up in parallel
   /// to the one in the index, so it can be shrinked and serialized into
   /// a `Partition` flatbuffer upon completion of this partition. Will be
@@ -92,6 +115,9 @@ struct active_partition_state {
   /// types to be copy-constructible.
   std::shared_ptr<partition_synopsis> synopsis;
 
+  /// Options for the value indexes of the INDEXER actors.
+  caf::settings index_opts;
+
   /// Options to be used when adding events to the partition_synopsis.
   caf::settings synopsis_opts;
 
@@ -126,6 +152,10 @@ struct active_partition_state {
   /// local component that holds the data for this partition.
   store_actor store;
 
+  /// The partition-local store that collects the data of this partition, if
+  /// any. Aliases `store`.
+  partition_store_builder_actor store_builder;
+
   /// Temporary storage for the serialized indexers of this partition, before
   /// they get written into the flatbuffer.
   std::map<caf::actor_id, vast::chunk_ptr> chunks;
@@ -151,6 +181,11 @@ struct passive_partition_state {
 
   indexer_actor indexer_at(size_t position) const;
 
+  /// Gets the value index at a certain position for direct evaluation.
+  /// @returns A pointer to the value index, or `nullptr` if it could not be
+  ///          deserialized.
+  const value_index* value_index_at(size_t position) const;
+
   // -- data members -----------------------------------------------------------
 
   /// Pointer to the parent actor.
@@ -165,6 +200,11 @@ struct passive_partition_state {
   /// Maps type names to ids. Used the answer #type queries.
   std::unordered_map<std::string, ids> type_ids;
 
+  /// Maps positions in the combined layout to time columns whose values are
+  /// sorted, pointing into the `partition_chunk`.
+  std::unordered_map<size_t, const fbs::sorted_time_column::v0*>
+    sorted_time_columns;
+
   /// A readable name for this partition
   std::string name;
 
@@ -191,6 +231,20 @@ struct passive_partition_state {
   /// Maps qualified fields to indexer actors. This is mutable since
   /// indexers are spawned lazily on first access.
   mutable std::vector<indexer_actor> indexers;
+
+  /// Maps qualified fields to value indexes when evaluating queries directly.
+  /// This is mutable since value indexes are deserialized lazily on first
+  /// access.
+  mutable std::vector<value_index_ptr> value_indexes;
+
+  /// The cache for predicate lookups shared by all partitions of the index;
+  /// may be `nullptr`.
+  std::shared_ptr<query_cache> cache;
+
+  /// Whether to evaluate queries by looking up the value indexes in the
+  /// context of the partition instead of spawning INDEXER and EVALUATOR
+  /// actors.
+  bool direct_evaluation = false;
 };
 
 // -- flatbuffers --------------------------------------------------------------
@@ -211,10 +265,12 @@ caf::error unpack(const fbs::partition::v0& x, partition_synopsis& y);
 /// @param index_opts Settings that are forwarded when creating indexers.
 /// @param synopsis_opts Settings that are forwarded when creating synopses.
 /// @param store The store to retrieve the events from.
+/// @param local_store Whether to keep the events in a partition-local store
+///        instead of the given store.
 active_partition_actor::behavior_type active_partition(
   active_partition_actor::stateful_pointer<active_partition_state> self,
   uuid id, filesystem_actor filesystem, caf::settings index_opts,
-  caf::settings synopsis_opts, store_actor store);
+  caf::settings synopsis_opts, store_actor store, bool local_store);
 
 /// Spawns a read-only partition.
 /// @param self The partition actor.
@@ -222,9 +278,13 @@ active_partition_actor::behavior_type active_partition(
 /// @param filesystem The actor handle of the filesystem actor.
 /// @param path The path where the partition flatbuffer can be found.
 /// @param store The store to retrieve the events from.
+/// @param cache The cache for predicate lookups; may be `nullptr`.
+/// @param direct_evaluation Whether to evaluate queries without spawning
+///        INDEXER and EVALUATOR actors.
 partition_actor::behavior_type passive_partition(
   partition_actor::stateful_pointer<passive_partition_state> self, uuid id,
   filesystem_actor filesystem, const std::filesystem::path& path,
-  store_actor store);
+  store_actor store, std::shared_ptr<query_cache> cache,
+  bool direct_evaluation);
 
 } // namespace vast::system
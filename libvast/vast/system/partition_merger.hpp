@@ -0,0 +1,88 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/system/actors.hpp"
+#include "vast/uuid.hpp"
+
+#include <caf/settings.hpp>
+#include <caf/typed_event_based_actor.hpp>
+#include <caf/typed_response_promise.hpp>
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace vast::system {
+
+struct partition_merger_state {
+  /// The ID of the new partition.
+  uuid id;
+
+  /// The paths of the partitions to merge.
+  std::vector<std::filesystem::path> sources;
+
+  /// The path of the new partition.
+  std::filesystem::path partition_path;
+
+  /// The path of the synopsis of the new partition.
+  std::filesystem::path synopsis_path;
+
+  /// Actor handle of the filesystem actor.
+  filesystem_actor filesystem;
+
+  /// Actor handle of the global store.
+  store_actor store;
+
+  /// The options for the value indexes of the new partition.
+  caf::settings index_opts;
+
+  /// The options for the synopsis of the new partition.
+  caf::settings synopsis_opts;
+
+  /// The number of merged partitions that have a partition-local store.
+  size_t local_stores = 0;
+
+  /// The number of partitions whose events did not arrive yet.
+  size_t remaining = 0;
+
+  /// The events of the merged partitions.
+  std::vector<table_slice> slices;
+
+  /// The promise for the synopsis of the new partition.
+  caf::typed_response_promise<std::shared_ptr<partition_synopsis>> promise;
+
+  static inline const char* name = "partition-merger";
+};
+
+/// Merges several persisted partitions into a new partition. Reads the events
+/// of the partitions from their stores, and feeds them into a new ACTIVE
+/// PARTITION that rebuilds the value indexes and the synopsis. The merged
+/// partitions stay untouched. Either all or none of the merged partitions
+/// must have a partition-local store, and the new partition uses the same
+/// store backend.
+/// @param self The actor handle.
+/// @param id The ID of the new partition.
+/// @param sources The paths of the partitions to merge.
+/// @param partition_path The path of the new partition.
+/// @param synopsis_path The path of the synopsis of the new partition.
+/// @param filesystem The actor handle of the filesystem actor.
+/// @param store The actor handle of the global store.
+/// @param index_opts The options for the value indexes of the new partition.
+/// @param synopsis_opts The options for the synopsis of the new partition.
+partition_merger_actor::behavior_type partition_merger(
+  partition_merger_actor::stateful_pointer<partition_merger_state> self,
+  uuid id, std::vector<std::filesystem::path> sources,
+  std::filesystem::path partition_path, std::filesystem::path synopsis_path,
+  filesystem_actor filesystem, store_actor store, caf::settings index_opts,
+  caf::settings synopsis_opts);
+
+} // namespace vast::system
@@ -10,6 +10,7 @@
 
 #include "vast/fwd.hpp"
 
+#include "vast/data.hpp"
 #include "vast/expression.hpp"
 #include "vast/system/node.hpp"
 #include "vast/type.hpp"
@@ -17,6 +18,7 @@
 #include <caf/actor.hpp>
 #include <caf/fwd.hpp>
 
+#include <map>
 #include <optional>
 #include <string>
 #include <unordered_map>
@@ -53,6 +55,11 @@ struct pivoter_state {
   ///       string.
   std::unordered_set<std::string> requested_ids;
 
+  /// Pivot values that were not yet queried, keyed by the name of the field
+  /// that connects them to the target type. They accumulate while the maximum
+  /// number of EXPORTERs is running.
+  std::map<std::string, list> pending;
+
   /// A cache for the connections between a source type and the target type,
   /// to avoid multiple computations of those.
   mutable std::unordered_map<record_type, std::optional<record_field>> cache;
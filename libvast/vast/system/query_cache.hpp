@@ -0,0 +1,124 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/expression.hpp"
+#include "vast/ids.hpp"
+#include "vast/uuid.hpp"
+
+#include <caf/meta/type_name.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace vast::system {
+
+/// Identifies the result of a single predicate lookup in the value index of a
+/// field in a passive partition.
+struct query_cache_key {
+  /// Creates a cache key and normalizes the predicate such that semantically
+  /// equivalent predicates map to the same key.
+  query_cache_key(uuid partition, size_t field, curried_predicate predicate);
+
+  /// The partition that the lookup was performed in.
+  uuid partition;
+
+  /// The position of the field in the combined layout of the partition.
+  size_t field;
+
+  /// The normalized predicate with its left-hand side bound to the field.
+  curried_predicate predicate;
+
+  friend bool operator==(const query_cache_key& x, const query_cache_key& y);
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, query_cache_key& x) {
+    return f(caf::meta::type_name("vast.system.query_cache_key"), x.partition,
+             x.field, x.predicate);
+  }
+};
+
+/// Statistics about the usage of a query cache.
+struct query_cache_statistics {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  uint64_t entries = 0;
+  uint64_t bytes = 0;
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, query_cache_statistics& x) ->
+    typename Inspector::result_type {
+    return f(caf::meta::type_name("vast.system.query_cache_statistics"),
+             x.hits, x.misses, x.evictions, x.entries, x.bytes);
+  }
+};
+
+/// A bounded cache that maps predicate lookups in passive partitions to their
+/// results. Passive partitions are immutable, so entries remain valid until
+/// the partition that they refer to gets erased. The cache is shared between
+/// all partitions of an index and may be accessed concurrently.
+class query_cache {
+public:
+  /// Constructs a query cache.
+  /// @param capacity The maximum number of bytes that cached results may
+  ///        occupy in memory.
+  explicit query_cache(size_t capacity);
+
+  /// Retrieves a cached result and marks it as recently used.
+  /// @param key The key of the lookup.
+  /// @returns The cached ids, if available.
+  std::optional<ids> lookup(const query_cache_key& key);
+
+  /// Adds a result to the cache, evicting the least recently used entries
+  /// until the result fits into the cache.
+  /// @param key The key of the lookup.
+  /// @param result The ids that the lookup produced.
+  void insert(query_cache_key key, ids result);
+
+  /// Invalidates all cached results for a partition.
+  /// @param partition The UUID of the partition.
+  void erase(const uuid& partition);
+
+  /// @returns The maximum number of bytes the cache may occupy.
+  [[nodiscard]] size_t capacity() const;
+
+  /// @returns A snapshot of the usage statistics of the cache.
+  [[nodiscard]] query_cache_statistics statistics() const;
+
+private:
+  struct key_hasher {
+    size_t operator()(const query_cache_key& x) const noexcept;
+  };
+
+  using entry = std::pair<query_cache_key, ids>;
+
+  using entry_list = std::list<entry>;
+
+  /// Removes an entry and updates the statistics accordingly.
+  /// @pre The caller holds `mutex_`.
+  void remove(entry_list::iterator it);
+
+  /// The estimated number of bytes that an entry occupies in memory.
+  static size_t memusage(const entry& x);
+
+  mutable std::mutex mutex_;
+  const size_t capacity_;
+  entry_list entries_;
+  std::unordered_map<query_cache_key, entry_list::iterator, key_hasher> index_;
+  query_cache_statistics statistics_;
+};
+
+} // namespace vast::system
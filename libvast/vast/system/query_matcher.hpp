@@ -0,0 +1,90 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/expression.hpp"
+#include "vast/ids.hpp"
+#include "vast/type.hpp"
+
+#include <caf/error.hpp>
+#include <caf/settings.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vast::system {
+
+/// Evaluates many standing queries over a stream of table slices, such that
+/// every table slice gets scanned once instead of once per query.
+///
+/// For every layout, the matcher compiles all queries into a shared program:
+/// identical subexpressions across queries become a single node, equality
+/// predicates on the same column become a single hash table lookup per row,
+/// and substring predicates on the same column become a single multi-pattern
+/// scan per row. All other predicates fall back to row-wise evaluation, but
+/// still run only once per slice, regardless of how many queries share them.
+class query_matcher {
+public:
+  /// Identifies a query within the matcher.
+  using query_id = uint64_t;
+
+  /// The rows of a table slice that satisfy a query.
+  using match_result = std::pair<query_id, ids>;
+
+  query_matcher();
+
+  ~query_matcher() noexcept;
+
+  query_matcher(query_matcher&&) noexcept;
+
+  query_matcher& operator=(query_matcher&&) noexcept;
+
+  /// Adds a query. Replaces an existing query with the same ID.
+  /// @param id The ID of the query.
+  /// @param expr The expression of the query.
+  /// @returns An error if the expression is invalid.
+  caf::error add(query_id id, expression expr);
+
+  /// Removes a query.
+  /// @param id The ID of the query.
+  /// @returns Whether the matcher contained the query.
+  bool remove(query_id id);
+
+  /// @returns The number of queries.
+  [[nodiscard]] size_t size() const noexcept;
+
+  /// Evaluates all queries over a table slice.
+  /// @param slice The table slice.
+  /// @returns The queries that at least one row satisfies, ordered by ID,
+  /// with the IDs of the satisfying rows.
+  /// @pre `slice.encoding() != table_slice_encoding::none`
+  std::vector<match_result> match(const table_slice& slice);
+
+  /// @returns Statistics about the compiled programs, with one entry per
+  /// layout in the list `layouts`.
+  [[nodiscard]] caf::settings status() const;
+
+private:
+  struct program;
+
+  /// Returns the program for a layout, compiling it on first use.
+  program& compile(const record_type& layout);
+
+  std::map<query_id, expression> queries_;
+  std::unordered_map<type, std::unique_ptr<program>> programs_;
+};
+
+} // namespace vast::system
@@ -0,0 +1,110 @@
+//    _   _____   __________
+//   | | / / _ | / __/_  __/     Visibility
+//   | |/ / __ |_\ \  / /          Across
+//   |___/_/ |_/___/ /_/       Space and Time
+//
+// SPDX-FileCopyrightText: (c) 2021 The VAST Contributors
+// SPDX-License-Identifier: BSD-3-Clause
+
+#pragma once
+
+#include "vast/fwd.hpp"
+
+#include "vast/query.hpp"
+#include "vast/system/report.hpp"
+#include "vast/time.hpp"
+
+#include <caf/meta/type_name.hpp>
+#include <caf/settings.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace vast::system {
+
+/// A stage that a query passes through on its way from the INDEX to the SINK.
+enum class query_stage : uint8_t {
+  meta_index,      ///< The INDEX looks up candidate partitions.
+  partition_load,  ///< A passive partition gets mapped from disk.
+  indexer_spawn,   ///< A partition prepares the INDEXERs for the expression.
+  evaluation,      ///< The EVALUATOR combines the bitmaps of the INDEXERs.
+  store_lookup,    ///< A STORE loads the table slices for the hits.
+  candidate_check, ///< A CANDIDATE CHECKER filters a table slice.
+  sink,            ///< The EXPORTER hands results to the SINK.
+};
+
+/// The number of query stages.
+inline constexpr size_t num_query_stages = 7;
+
+/// @relates query_stage
+std::string_view to_string(query_stage stage) noexcept;
+
+/// A timed section of a single query stage.
+struct query_span {
+  query_stage stage = {};
+  time start = {};
+  duration elapsed = {};
+
+  template <class Inspector>
+  friend auto inspect(Inspector& f, query_span& x) {
+    return f(caf::meta::type_name("vast.system.query_span"), x.stage, x.start,
+             x.elapsed);
+  }
+};
+
+/// Fires the USDT tracepoint that matches the stage of a span.
+/// @relates query_span
+void trace(const query_span& span);
+
+/// Creates a span that lasts from the given start until now, fires its
+/// tracepoint, and sends it to the sink of the query if the query is
+/// profiled.
+/// @param self The actor that records the span.
+/// @param query The query that the span belongs to.
+/// @param stage The stage of the span.
+/// @param start The beginning of the span.
+/// @relates query_span
+template <class Self>
+void record_span(Self* self, const vast::query& query, query_stage stage,
+                 time start) {
+  auto now = std::chrono::system_clock::now();
+  auto span = query_span{stage, start, now - start};
+  trace(span);
+  if (auto* extract = caf::get_if<query::extract>(&query.cmd))
+    if (extract->profile)
+      self->send(extract->sink, atom::profile_v, span);
+}
+
+/// Aggregates the spans of a single query per stage.
+class query_profile {
+public:
+  /// Adds a span to the profile.
+  void add(const query_span& span) noexcept;
+
+  /// @returns Whether the profile holds no spans.
+  [[nodiscard]] bool empty() const noexcept;
+
+  /// Appends the aggregated spans as data points to a report.
+  /// @param prefix The prefix for the keys of the data points.
+  /// @param r The report to append to.
+  void append_report(std::string_view prefix, report& r) const;
+
+  /// @returns The aggregated spans, with one entry per stage that has at
+  /// least one span.
+  [[nodiscard]] caf::settings to_settings() const;
+
+private:
+  struct stage_profile {
+    uint64_t spans = 0;
+    duration total = {};
+    duration max = {};
+    time first_start = {};
+    time last_end = {};
+  };
+
+  std::array<stage_profile, num_query_stages> stages_ = {};
+};
+
+} // namespace vast::system
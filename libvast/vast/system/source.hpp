@@ -13,6 +13,7 @@
 #include "vast/detail/framed.hpp"
 #include "vast/expression.hpp"
 #include "vast/format/reader.hpp"
+#include "vast/system/batch_size_controller.hpp"
 #include "vast/schema.hpp"
 #include "vast/system/actors.hpp"
 #include "vast/system/instrumentation.hpp"
@@ -76,8 +77,8 @@ struct source_state {
   /// The import-local schema.
   vast::schema local_schema;
 
-  /// The maximum size for a table slice.
-  size_t table_slice_size;
+  /// Chooses the size of table slices.
+  batch_size_controller batching;
 
   /// Current metrics for the accountant.
   measurement metrics;
@@ -104,7 +105,7 @@ struct source_state {
 /// @tparam Reader The concrete source implementation.
 /// @param self The actor handle.
 /// @param reader The reader instance.
-/// @param table_slice_size The maximum size for a table slice.
+/// @param batching The bounds and targets for the size of table slices.
 /// @param max_events The optional maximum amount of events to import.
 /// @param type_registry The actor handle for the type-registry component.
 /// @oaram local_schema Additional local schemas to consider.
@@ -113,7 +114,7 @@ struct source_state {
 /// @param input_transformations The input transformations to be applied.
 caf::behavior
 source(caf::stateful_actor<source_state>* self, format::reader_ptr reader,
-       size_t table_slice_size, std::optional<size_t> max_events,
+       batch_size_options batching, std::optional<size_t> max_events,
        const type_registry_actor& type_registry, vast::schema local_schema,
        std::string type_filter, accountant_actor accountant,
        std::vector<transform>&& input_transformations);
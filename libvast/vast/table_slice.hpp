@@ -122,6 +122,11 @@ public:
   /// @returns The table layout.
   [[nodiscard]] const record_type& layout() const noexcept;
 
+  /// @returns The serialized table layout, which is equal for slices with
+  /// equal layouts. Unlike `layout()`, this does not require the layout of
+  /// the slice to be deserialized.
+  [[nodiscard]] span<const std::byte> serialized_layout() const noexcept;
+
   /// @returns The number of rows in the slice.
   [[nodiscard]] size_type rows() const noexcept;
 
@@ -35,6 +35,7 @@
 #include <caf/ref_counted.hpp>
 #include <caf/sum_type.hpp>
 
+#include <atomic>
 #include <functional>
 #include <optional>
 #include <string>
@@ -163,6 +164,14 @@ public:
   /// @returns The attributes of the type.
   [[nodiscard]] const std::vector<attribute>& attributes() const;
 
+  /// Computes a fingerprint of the type that is equal for equal types. The
+  /// fingerprint is computed once and then cached in the type, which is
+  /// immutable except for the modifiers above, so repeated hashing of the
+  /// same type takes constant time. Its value is the same as hashing the type
+  /// with `uhash<xxhash64>`.
+  /// @returns The fingerprint.
+  [[nodiscard]] type_digest fingerprint() const;
+
   /// @cond PRIVATE
 
   [[nodiscard]] abstract_type_ptr ptr() const;
@@ -186,6 +195,10 @@ public:
 private:
   type(abstract_type_ptr x);
 
+  /// Provides mutable access to the underlying type after detaching it from
+  /// other instances, and invalidates its cached properties.
+  abstract_type& unshared();
+
   abstract_type_ptr ptr_;
 };
 
@@ -225,8 +238,21 @@ constexpr bool is(type_flags x) {
 class abstract_type : public caf::ref_counted,
                       detail::totally_ordered<abstract_type> {
   friend type; // to change name/attributes of a copy.
+  friend size_t flat_size(const type&);
 
 public:
+  abstract_type() = default;
+
+  /// Copies a type, but not its cached properties.
+  abstract_type(const abstract_type& other);
+
+  /// Moves a type, but not its cached properties.
+  abstract_type(abstract_type&& other) noexcept;
+
+  abstract_type& operator=(const abstract_type& other);
+
+  abstract_type& operator=(abstract_type&& other) noexcept;
+
   virtual ~abstract_type();
 
   // -- introspection ---------------------------------------------------------
@@ -259,6 +285,21 @@ protected:
 
   std::string name_;
   std::vector<attribute> attributes_;
+
+private:
+  /// Marks a cached flat size as not yet computed.
+  static constexpr size_t invalid_flat_size = static_cast<size_t>(-1);
+
+  /// Discards all cached properties.
+  void reset_cache() noexcept;
+
+  /// The cached fingerprint; 0 if not yet computed. The fingerprint is only
+  /// computed for types wrapped in a `type`, which never mutates its
+  /// `abstract_type` without resetting the cache first.
+  mutable std::atomic<type_digest> fingerprint_{0};
+
+  /// The cached number of fields in the flat representation of the type.
+  mutable std::atomic<size_t> flat_size_{invalid_flat_size};
 };
 
 /// The base class for all concrete types.
@@ -1120,7 +1161,13 @@ namespace std {
     }                                                                          \
   }
 
-VAST_DEFINE_HASH_SPECIALIZATION(type);
+template <>
+struct hash<vast::type> {
+  size_t operator()(const vast::type& x) const {
+    return x.fingerprint();
+  }
+};
+
 VAST_DEFINE_HASH_SPECIALIZATION(none_type);
 VAST_DEFINE_HASH_SPECIALIZATION(bool_type);
 VAST_DEFINE_HASH_SPECIALIZATION(integer_type);
@@ -6,10 +6,12 @@
 // SPDX-FileCopyrightText: (c) 2020 The VAST Contributors
 // SPDX-License-Identifier: BSD-3-Clause
 
+#include <vast/bloom_filter_synopsis.hpp>
 #include <vast/chunk.hpp>
 #include <vast/concept/printable/to_string.hpp>
 #include <vast/concept/printable/vast/type.hpp>
 #include <vast/concept/printable/vast/uuid.hpp>
+#include <vast/data.hpp>
 #include <vast/error.hpp>
 #include <vast/fbs/index.hpp>
 #include <vast/fbs/partition.hpp>
@@ -18,21 +20,35 @@
 #include <vast/ids.hpp>
 #include <vast/io/read.hpp>
 #include <vast/qualified_record_field.hpp>
+#include <vast/span.hpp>
 #include <vast/table_slice.hpp>
 #include <vast/type.hpp>
 #include <vast/uuid.hpp>
+#include <vast/value_index.hpp>
+#include <vast/value_index_factory.hpp>
+#include <vast/word.hpp>
 
 #include <caf/binary_deserializer.hpp>
+#include <caf/deep_to_string.hpp>
 #include <caf/error.hpp>
 #include <flatbuffers/flatbuffers.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <cstdlib>
 #include <filesystem>
 #include <iomanip>
 #include <iostream>
+#include <map>
+#include <numeric>
+#include <set>
 #include <sstream>
 #include <string>
 #include <system_error>
+#include <thread>
+#include <vector>
 
 // clang-format off
 // TODO: Implement different output formats for human-readable and
@@ -182,6 +198,17 @@ struct flatbuffer_deleter {
   std::vector<std::byte> chunk_;
 };
 
+// Get the root of a versioned flatbuffer, or nullptr if the buffer fails
+// verification.
+template <typename T>
+const T* verified_flatbuffer(vast::span<const std::byte> bytes) {
+  flatbuffers::Verifier verifier{reinterpret_cast<const uint8_t*>(bytes.data()),
+                                 bytes.size()};
+  if (!verifier.template VerifyBuffer<T>())
+    return nullptr;
+  return flatbuffers::GetRoot<T>(bytes.data());
+}
+
 // Get contents of the specified file as versioned flatbuffer, or nullptr in
 // case of a read error/version mismatch.
 // The unique_pointer is used to have a pointer with the correct flatbuffer
@@ -197,11 +224,9 @@ read_flatbuffer_file(const std::filesystem::path& path) {
   if (!maybe_bytes)
     return result;
   auto bytes = std::move(*maybe_bytes);
-  flatbuffers::Verifier verifier{reinterpret_cast<const uint8_t*>(bytes.data()),
-                                 bytes.size()};
-  if (!verifier.template VerifyBuffer<T>())
+  const auto* ptr = verified_flatbuffer<T>(bytes);
+  if (!ptr)
     return result;
-  const auto* ptr = flatbuffers::GetRoot<T>(bytes.data());
   return result_t(ptr, flatbuffer_deleter<T>(std::move(bytes)));
 }
 
@@ -535,11 +560,400 @@ void print_segment(const std::filesystem::path& path, indentation& indent,
   }
 }
 
+// -- cost analysis ------------------------------------------------------------
+
+// The storage costs of the value indexes of a single field, summed over all
+// partitions.
+struct value_index_cost {
+  std::string type;
+  uint64_t partitions = 0;
+  uint64_t events = 0;
+  uint64_t bytes = 0;
+  uint64_t memory_bytes = 0;
+  std::set<std::string> options;
+};
+
+// The storage costs of the synopses of a single field or type, summed over all
+// partitions.
+struct synopsis_cost {
+  std::string kind;
+  uint64_t partitions = 0;
+  uint64_t bytes = 0;
+  // The remaining members only apply to Bloom filter synopses.
+  std::set<double> fp_rates;
+  uint64_t bloom_filters = 0;
+  uint64_t num_bits = 0;
+  uint64_t set_bits = 0;
+  double estimated_fp_rate_sum = 0.0;
+};
+
+// The storage costs of the table slices of a single layout in the archive.
+struct layout_cost {
+  uint64_t slices = 0;
+  uint64_t events = 0;
+  uint64_t bytes = 0;
+};
+
+struct cost_report {
+  std::vector<uint64_t> partition_bytes;
+  std::vector<uint64_t> partition_events;
+  std::vector<uint64_t> segment_bytes;
+  std::map<std::string, value_index_cost> value_indexes;
+  std::map<std::string, synopsis_cost> synopses;
+  std::map<std::string, layout_cost> layouts;
+  std::vector<std::string> errors;
+};
+
+void merge(cost_report& dst, cost_report&& src) {
+  auto append = [](auto& xs, auto& ys) {
+    xs.insert(xs.end(), std::make_move_iterator(ys.begin()),
+              std::make_move_iterator(ys.end()));
+  };
+  append(dst.partition_bytes, src.partition_bytes);
+  append(dst.partition_events, src.partition_events);
+  append(dst.segment_bytes, src.segment_bytes);
+  append(dst.errors, src.errors);
+  for (auto& [name, x] : src.value_indexes) {
+    auto& y = dst.value_indexes[name];
+    if (y.type.empty())
+      y.type = std::move(x.type);
+    y.partitions += x.partitions;
+    y.events += x.events;
+    y.bytes += x.bytes;
+    y.memory_bytes += x.memory_bytes;
+    y.options.insert(x.options.begin(), x.options.end());
+  }
+  for (auto& [name, x] : src.synopses) {
+    auto& y = dst.synopses[name];
+    if (y.kind.empty())
+      y.kind = std::move(x.kind);
+    y.partitions += x.partitions;
+    y.bytes += x.bytes;
+    y.fp_rates.insert(x.fp_rates.begin(), x.fp_rates.end());
+    y.bloom_filters += x.bloom_filters;
+    y.num_bits += x.num_bits;
+    y.set_bits += x.set_bits;
+    y.estimated_fp_rate_sum += x.estimated_fp_rate_sum;
+  }
+  for (auto& [name, x] : src.layouts) {
+    auto& y = dst.layouts[name];
+    y.slices += x.slices;
+    y.events += x.events;
+    y.bytes += x.bytes;
+  }
+}
+
+void analyze_synopsis(const vast::fbs::synopsis::v0& column,
+                      const std::filesystem::path& path, cost_report& report) {
+  vast::qualified_record_field fqf;
+  if (auto err = vast::fbs::deserialize_bytes(column.qualified_record_field(),
+                                              fqf)) {
+    report.errors.push_back(path.string() + ": " + caf::to_string(err));
+    return;
+  }
+  // Type synopses have no field name; we name them like a type extractor.
+  auto name = fqf.field_name.empty() ? ":" + vast::to_string(fqf.type)
+                                     : fqf.fqn();
+  auto& cost = report.synopses[name];
+  ++cost.partitions;
+  if (const auto* bs = column.bool_synopsis()) {
+    cost.kind = "bool";
+    cost.bytes += sizeof(*bs);
+  } else if (const auto* ts = column.time_synopsis()) {
+    cost.kind = "time";
+    cost.bytes += sizeof(*ts);
+  } else if (const auto* bf = column.bloom_filter_synopsis()) {
+    cost.kind = "bloom-filter";
+    uint64_t set_bits = 0;
+    if (const auto* bits = bf->bits()) {
+      cost.bytes += bits->size() * sizeof(uint64_t);
+      for (auto block : *bits)
+        set_bits += vast::word<uint64_t>::popcount(block);
+    }
+    cost.set_bits += set_bits;
+    cost.num_bits += bf->num_bits();
+    // The configured FP rate is an attribute of the serialized type.
+    vast::type type;
+    if (!vast::fbs::deserialize_bytes(bf->type(), type))
+      if (auto params = vast::parse_parameters(type); params && params->p)
+        cost.fp_rates.insert(*params->p);
+    // The FP rate that the filter actually exhibits depends on how full it is,
+    // which tells whether the configured cardinality fits the data.
+    if (bf->num_bits() > 0) {
+      auto fill
+        = static_cast<double>(set_bits) / static_cast<double>(bf->num_bits());
+      cost.estimated_fp_rate_sum += std::pow(fill, bf->num_hash_functions());
+      ++cost.bloom_filters;
+    }
+  } else if (const auto* opaque = column.opaque_synopsis()) {
+    cost.kind = "opaque";
+    if (opaque->data())
+      cost.bytes += opaque->data()->size();
+  } else {
+    cost.kind = "unknown";
+  }
+}
+
+void analyze_partition_v0(const vast::fbs::partition::v0& partition,
+                          size_t size, const std::filesystem::path& path,
+                          cost_report& report) {
+  report.partition_bytes.push_back(size);
+  report.partition_events.push_back(partition.events());
+  // Count the events per layout, so that we can relate the size of a value
+  // index to the number of events it covers.
+  auto layout_events = std::map<std::string, uint64_t>{};
+  if (const auto* type_ids = partition.type_ids()) {
+    for (const auto* entry : *type_ids) {
+      if (!entry->name())
+        continue;
+      vast::ids ids;
+      if (auto err = vast::fbs::deserialize_bytes(entry->ids(), ids))
+        report.errors.push_back(path.string() + ": " + caf::to_string(err));
+      else
+        layout_events[entry->name()->str()] = rank(ids);
+    }
+  }
+  auto events_of = [&](const std::string& field) {
+    auto result = uint64_t{partition.events()};
+    auto longest_match = size_t{0};
+    for (const auto& [layout, events] : layout_events)
+      if (layout.size() > longest_match && field.size() > layout.size()
+          && field.compare(0, layout.size(), layout) == 0
+          && field[layout.size()] == '.') {
+        longest_match = layout.size();
+        result = events;
+      }
+    return result;
+  };
+  vast::record_type combined_layout;
+  if (auto err = vast::fbs::deserialize_bytes(partition.combined_layout(),
+                                              combined_layout))
+    report.errors.push_back(path.string() + ": " + caf::to_string(err));
+  if (const auto* indexes = partition.indexes()) {
+    for (size_t i = 0; i < indexes->size(); ++i) {
+      const auto* index = indexes->Get(i);
+      if (!index->index() || !index->index()->data())
+        continue;
+      auto name = index->field_name() ? index->field_name()->str() : ""s;
+      if (name.empty() && i < combined_layout.fields.size())
+        name = combined_layout.fields[i].name;
+      auto& cost = report.value_indexes[name];
+      ++cost.partitions;
+      cost.events += events_of(name);
+      cost.bytes += index->index()->data()->size();
+      vast::value_index_ptr value_index;
+      if (auto err = vast::fbs::deserialize_bytes(index->index()->data(),
+                                                  value_index)) {
+        report.errors.push_back(path.string() + ": " + name + ": "
+                                + caf::to_string(err));
+        continue;
+      }
+      if (!value_index)
+        continue;
+      if (cost.type.empty())
+        cost.type = vast::to_string(value_index->type());
+      cost.memory_bytes += value_index->memusage();
+      cost.options.insert(caf::deep_to_string(value_index->options()));
+    }
+  }
+  if (const auto* synopsis = partition.partition_synopsis())
+    if (const auto* synopses = synopsis->synopses())
+      for (const auto* column : *synopses)
+        analyze_synopsis(*column, path, report);
+}
+
+void analyze_segment_v0(const vast::fbs::segment::v0& segment, size_t size,
+                        cost_report& report) {
+  report.segment_bytes.push_back(size);
+  if (!segment.slices())
+    return;
+  for (const auto* flat_slice : *segment.slices()) {
+    // See `print_segment_v0` for why the chunk has no deleter.
+    auto chunk = vast::chunk::make(flat_slice->data()->data(),
+                                   flat_slice->data()->size(), {});
+    auto slice
+      = vast::table_slice(std::move(chunk), vast::table_slice::verify::no);
+    auto& cost = report.layouts[std::string{slice.layout().name()}];
+    ++cost.slices;
+    cost.events += slice.rows();
+    cost.bytes += flat_slice->data()->size();
+  }
+}
+
+void analyze_file(const std::filesystem::path& path, cost_report& report) {
+  std::error_code err{};
+  auto size = std::filesystem::file_size(path, err);
+  if (err) {
+    report.errors.push_back(path.string() + ": " + err.message());
+    return;
+  }
+  // Skip files that are too small to carry a file identifier.
+  if (size
+      < sizeof(flatbuffers::uoffset_t) + flatbuffers::kFileIdentifierLength)
+    return;
+  // Map the file instead of reading it, so that we only page in the parts
+  // that the verifier and the analysis touch.
+  auto chunk = vast::chunk::mmap(path, size);
+  if (!chunk) {
+    report.errors.push_back(path.string() + ": "
+                            + caf::to_string(chunk.error()));
+    return;
+  }
+  auto bytes = as_bytes(*chunk);
+  const auto* buf = bytes.data();
+  if (vast::fbs::PartitionBufferHasIdentifier(buf)) {
+    const auto* partition = verified_flatbuffer<vast::fbs::Partition>(bytes);
+    if (!partition || !partition->partition_as_v0())
+      report.errors.push_back(path.string() + ": invalid partition");
+    else
+      analyze_partition_v0(*partition->partition_as_v0(), bytes.size(), path,
+                           report);
+  } else if (vast::fbs::SegmentBufferHasIdentifier(buf)) {
+    const auto* segment = verified_flatbuffer<vast::fbs::Segment>(bytes);
+    if (!segment || !segment->segment_as_v0())
+      report.errors.push_back(path.string() + ": invalid segment");
+    else
+      analyze_segment_v0(*segment->segment_as_v0(), bytes.size(), report);
+  }
+}
+
+// Summarizes a distribution of sizes with nearest-rank quantiles.
+vast::data summarize(std::vector<uint64_t> xs) {
+  auto result = vast::record{};
+  result["count"] = vast::count{xs.size()};
+  if (xs.empty())
+    return result;
+  std::sort(xs.begin(), xs.end());
+  auto quantile = [&](double q) {
+    auto rank = static_cast<size_t>(std::ceil(q * xs.size()));
+    return vast::count{xs[std::max(rank, size_t{1}) - 1]};
+  };
+  auto sum = std::accumulate(xs.begin(), xs.end(), uint64_t{0});
+  result["sum"] = vast::count{sum};
+  result["min"] = vast::count{xs.front()};
+  result["p50"] = quantile(0.5);
+  result["p90"] = quantile(0.9);
+  result["p99"] = quantile(0.99);
+  result["max"] = vast::count{xs.back()};
+  result["mean"] = vast::real{static_cast<double>(sum) / xs.size()};
+  return result;
+}
+
+vast::data to_data(const cost_report& report) {
+  auto value_indexes = vast::record{};
+  for (const auto& [name, cost] : report.value_indexes) {
+    auto entry = vast::record{};
+    entry["type"] = cost.type;
+    entry["partitions"] = vast::count{cost.partitions};
+    entry["events"] = vast::count{cost.events};
+    entry["bytes"] = vast::count{cost.bytes};
+    entry["memory-bytes"] = vast::count{cost.memory_bytes};
+    // The density of the bitmap encoding, i.e., the serialized bits that the
+    // index spends on every event it covers.
+    if (cost.events > 0)
+      entry["bits-per-event"]
+        = vast::real{8.0 * cost.bytes / static_cast<double>(cost.events)};
+    auto options = vast::list{};
+    for (const auto& x : cost.options)
+      options.emplace_back(x);
+    entry["options"] = std::move(options);
+    value_indexes[name] = std::move(entry);
+  }
+  auto synopses = vast::record{};
+  for (const auto& [name, cost] : report.synopses) {
+    auto entry = vast::record{};
+    entry["kind"] = cost.kind;
+    entry["partitions"] = vast::count{cost.partitions};
+    entry["bytes"] = vast::count{cost.bytes};
+    if (cost.bloom_filters > 0) {
+      auto fp_rates = vast::list{};
+      for (auto x : cost.fp_rates)
+        fp_rates.emplace_back(vast::real{x});
+      entry["fp-rates"] = std::move(fp_rates);
+      entry["fill-ratio"] = vast::real{static_cast<double>(cost.set_bits)
+                                       / static_cast<double>(cost.num_bits)};
+      entry["estimated-fp-rate"]
+        = vast::real{cost.estimated_fp_rate_sum / cost.bloom_filters};
+    }
+    synopses[name] = std::move(entry);
+  }
+  auto layouts = vast::record{};
+  for (const auto& [name, cost] : report.layouts) {
+    auto entry = vast::record{};
+    entry["slices"] = vast::count{cost.slices};
+    entry["events"] = vast::count{cost.events};
+    entry["bytes"] = vast::count{cost.bytes};
+    layouts[name] = std::move(entry);
+  }
+  auto partitions = vast::record{};
+  partitions["bytes"] = summarize(report.partition_bytes);
+  partitions["events"] = summarize(report.partition_events);
+  auto segments = vast::record{};
+  segments["bytes"] = summarize(report.segment_bytes);
+  segments["layouts"] = std::move(layouts);
+  auto errors = vast::list{};
+  for (const auto& x : report.errors)
+    errors.emplace_back(x);
+  auto result = vast::record{};
+  result["partitions"] = std::move(partitions);
+  result["value-indexes"] = std::move(value_indexes);
+  result["synopses"] = std::move(synopses);
+  result["segments"] = std::move(segments);
+  result["errors"] = std::move(errors);
+  return result;
+}
+
+// Scans all partitions and segments of a database directory in parallel, and
+// prints where their bytes go as JSON.
+int analyze_vast_db(const std::filesystem::path& vast_db, size_t jobs) {
+  auto files = std::vector<std::filesystem::path>{};
+  const auto dirs = std::vector<std::filesystem::path>{
+    vast_db / "index",
+    vast_db / "archive" / "segments",
+  };
+  for (const auto& dir : dirs) {
+    std::error_code err{};
+    auto it = std::filesystem::directory_iterator{dir, err};
+    if (err) {
+      std::cerr << "Failed to open " << dir.string() << ": " << err.message()
+                << std::endl;
+      continue;
+    }
+    for (const auto& entry : it)
+      if (entry.is_regular_file(err))
+        files.push_back(entry.path());
+  }
+  // Every worker aggregates its own report, and we merge them at the end.
+  auto next = std::atomic<size_t>{0};
+  auto reports = std::vector<cost_report>(std::max(jobs, size_t{1}));
+  auto workers = std::vector<std::thread>{};
+  for (auto& report : reports)
+    workers.emplace_back([&] {
+      for (auto i = next++; i < files.size(); i = next++)
+        analyze_file(files[i], report);
+    });
+  for (auto& worker : workers)
+    worker.join();
+  auto result = cost_report{};
+  for (auto& report : reports)
+    merge(result, std::move(report));
+  auto json = vast::to_json(to_data(result));
+  if (!json) {
+    std::cerr << "Failed to print report: " << caf::to_string(json.error())
+              << std::endl;
+    return 1;
+  }
+  std::cout << *json << std::endl;
+  return 0;
+}
+
 int main(int argc, char** argv) {
   std::string raw_path;
   struct formatting_options format;
   format.print_bytesizes = true;
   format.verbosity = output_verbosity::verbose;
+  bool analyze = false;
+  size_t jobs = std::thread::hardware_concurrency();
   for (int i = 1; i < argc; ++i) {
     auto arg = std::string_view{argv[i]};
     if (arg == "-h" || arg == "--human-readable") {
@@ -549,6 +963,10 @@ int main(int argc, char** argv) {
       format.print_bytesizes = true;
     } else if (arg == "-v" || arg == "--verbose") {
       format.verbosity = output_verbosity::verbose;
+    } else if (arg == "-a" || arg == "--analyze") {
+      analyze = true;
+    } else if ((arg == "-j" || arg == "--jobs") && i + 1 < argc) {
+      jobs = std::strtoul(argv[++i], nullptr, 10);
     } else { // positional arg
       raw_path = arg;
     }
@@ -558,7 +976,9 @@ int main(int argc, char** argv) {
               << "Options:\n"
               << "  --verbose\n"
               << "  --print-bytesizes\n"
-              << "  --human-readable\n";
+              << "  --human-readable\n"
+              << "  --analyze\n"
+              << "  --jobs <n>\n";
     return 1;
   }
   if (raw_path.back() == '/')
@@ -574,6 +994,14 @@ int main(int argc, char** argv) {
     std::cerr << "Could not determine type of " << argv[1] << std::endl;
     return 1;
   }
+  if (analyze) {
+    if (*kind != Kind::DatabaseDir) {
+      std::cerr << "--analyze requires a vast.db directory" << std::endl;
+      return 1;
+    }
+    vast::factory<vast::value_index>::initialize();
+    return analyze_vast_db(path, jobs);
+  }
   struct indentation indent;
   auto printer = printers.at(*kind);
   printer(path, indent, format);